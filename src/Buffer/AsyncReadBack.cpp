@@ -0,0 +1,261 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "AsyncReadBack.h"
+
+#include <cstring>  // memcpy
+
+#include <ctools/Logger.h>
+#include <Profiler/TracyProfiler.h>
+
+size_t AsyncReadBack::GetBytesPerPixel(GLenum vFormat, GLenum vType) {
+    size_t countChannels = 0U;
+    switch (vFormat) {
+        case GL_RED:
+        case GL_GREEN:
+        case GL_BLUE:
+        case GL_ALPHA:
+        case GL_DEPTH_COMPONENT: countChannels = 1U; break;
+        case GL_RG: countChannels = 2U; break;
+        case GL_RGB:
+        case GL_BGR: countChannels = 3U; break;
+        case GL_RGBA:
+        case GL_BGRA: countChannels = 4U; break;
+        default: break;
+    }
+
+    size_t channelSize = 0U;
+    switch (vType) {
+        case GL_UNSIGNED_BYTE:
+        case GL_BYTE: channelSize = 1U; break;
+        case GL_UNSIGNED_SHORT:
+        case GL_SHORT:
+        case GL_HALF_FLOAT: channelSize = 2U; break;
+        case GL_UNSIGNED_INT:
+        case GL_INT:
+        case GL_FLOAT: channelSize = 4U; break;
+        default: break;
+    }
+
+    return countChannels * channelSize;
+}
+
+AsyncReadBack::AsyncReadBack(const GuiBackend_Window& vWin, size_t vRingSize) : m_Window(vWin) {
+    m_Slots.resize(ct::maxi<size_t>(vRingSize, 1U));
+}
+
+AsyncReadBack::~AsyncReadBack() {
+    // the futures must not be broken
+    Flush();
+    DestroySlots();
+}
+
+std::future<ReadBackResultPtr> AsyncReadBack::ReadPixels(GLuint vFboId,
+                                                         GLenum vReadBuffer,
+                                                         const ct::ivec4& vRect,
+                                                         GLenum vFormat,
+                                                         GLenum vType,
+                                                         ReadBackCallback vCallback) {
+    GuiBackend::MakeContextCurrent(m_Window);
+
+    TracyGpuZone("AsyncReadBack::ReadPixels");
+
+    // the finished reads free their slots
+    Update();
+
+    // ring full, backpressure on the oldest read
+    if (m_CountPending == m_Slots.size()) {
+        CompleteOldestSlot(true);
+    }
+
+    auto& slot = m_Slots[(m_OldestSlot + m_CountPending) % m_Slots.size()];
+
+    slot.result = std::make_shared<ReadBackResultStruct>();
+    slot.result->rect = vRect;
+    slot.result->format = vFormat;
+    slot.result->type = vType;
+    slot.result->bytesPerPixel = GetBytesPerPixel(vFormat, vType);
+    slot.callback = vCallback;
+    slot.promise = std::promise<ReadBackResultPtr>();
+    auto future = slot.promise.get_future();
+
+    const size_t neededSize = slot.result->bytesPerPixel * (size_t)ct::maxi(vRect.z, 0) * (size_t)ct::maxi(vRect.w, 0);
+    if (!neededSize) {
+        LogVarError("Bad read back request : rect(%i,%i,%i,%i) format(%u) type(%u)", vRect.x, vRect.y, vRect.z, vRect.w, vFormat, vType);
+        if (slot.callback) {
+            slot.callback(slot.result);
+        }
+        slot.promise.set_value(slot.result);
+        slot.result.reset();
+        slot.callback = nullptr;
+        return future;
+    }
+
+    if (!slot.pbo) {
+        glGenBuffers(1, &slot.pbo);
+        LogGlError();
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    LogGlError();
+
+    // the buffer is only reallocated when the size grow
+    if (slot.capacity < neededSize) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, neededSize, nullptr, GL_STREAM_READ);
+        LogGlError();
+        slot.capacity = neededSize;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, vFboId);
+    LogGlError();
+    glReadBuffer(vReadBuffer);
+    LogGlError();
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);  // from opengl to disk
+    LogGlError();
+    glReadPixels(vRect.x, vRect.y, vRect.z, vRect.w, vFormat, vType, nullptr);  // in the pbo
+    LogGlError();
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    LogGlError();
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    LogGlError();
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    LogGlError();
+    // the fence must reach the gpu, else a poll without flush could never see it signaled
+    glFlush();
+
+    ++m_CountPending;
+
+    return future;
+}
+
+size_t AsyncReadBack::Update() {
+    size_t count = 0U;
+
+    if (m_CountPending) {
+        GuiBackend::MakeContextCurrent(m_Window);
+
+        // in request order, a finished read wait for the previous ones
+        while (m_CountPending && IsSlotReady(m_Slots[m_OldestSlot])) {
+            CompleteOldestSlot(false);
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+void AsyncReadBack::Flush() {
+    if (m_CountPending) {
+        GuiBackend::MakeContextCurrent(m_Window);
+
+        while (m_CountPending) {
+            CompleteOldestSlot(true);
+        }
+    }
+}
+
+size_t AsyncReadBack::GetCountPending() const {
+    return m_CountPending;
+}
+
+size_t AsyncReadBack::GetRingSize() const {
+    return m_Slots.size();
+}
+
+bool AsyncReadBack::IsSlotReady(ReadBackSlotStruct& vSlot) {
+    if (!vSlot.fence)
+        return true;
+
+    const auto status = glClientWaitSync(vSlot.fence, 0, 0);
+    return (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED);
+}
+
+void AsyncReadBack::CompleteOldestSlot(bool vWait) {
+    if (!m_CountPending)
+        return;
+
+    auto& slot = m_Slots[m_OldestSlot];
+
+    if (slot.fence) {
+        if (vWait) {
+            TracyGpuZone("AsyncReadBack::Wait");
+            GLenum status = GL_TIMEOUT_EXPIRED;
+            while (status == GL_TIMEOUT_EXPIRED) {
+                status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000U);  // 1 ms
+            }
+            if (status == GL_WAIT_FAILED) {
+                LogGlError();
+            }
+        }
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+
+    if (slot.result) {
+        const size_t size = slot.result->bytesPerPixel * (size_t)slot.result->rect.z * (size_t)slot.result->rect.w;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        LogGlError();
+        const auto* ptr = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+        LogGlError();
+        if (ptr) {
+            slot.result->bytes.resize(size);
+            memcpy(slot.result->bytes.data(), ptr, size);
+            slot.result->isOk = true;
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            LogGlError();
+        } else {
+            LogVarError("glMapBufferRange failed for the read back of %u bytes", (uint32_t)size);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        LogGlError();
+    }
+
+    // the slot is released before the callback, who can ask a new read
+    auto result = std::move(slot.result);
+    auto callback = std::move(slot.callback);
+    auto promise = std::move(slot.promise);
+    slot.result = nullptr;
+    slot.callback = nullptr;
+
+    m_OldestSlot = (m_OldestSlot + 1U) % m_Slots.size();
+    --m_CountPending;
+
+    if (result) {
+        if (callback) {
+            callback(result);
+        }
+        promise.set_value(result);
+    }
+}
+
+void AsyncReadBack::DestroySlots() {
+    GuiBackend::MakeContextCurrent(m_Window);
+
+    for (auto& slot : m_Slots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+        SAFE_DELETE_GL_BUFFER(slot.pbo);
+        slot.capacity = 0U;
+    }
+}
@@ -0,0 +1,91 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <Headers/RenderPackHeaders.h>
+
+#include <glad/glad.h>
+#include <ctools/cTools.h>
+
+#include <vector>
+#include <memory>
+#include <future>
+#include <cstdint>
+#include <functional>
+
+struct ReadBackResultStruct {
+    ct::ivec4 rect;  // x, y, width, height
+    GLenum format = 0;
+    GLenum type = 0;
+    size_t bytesPerPixel = 0U;
+    std::vector<uint8_t> bytes;
+    bool isOk = false;
+};
+typedef std::shared_ptr<ReadBackResultStruct> ReadBackResultPtr;
+typedef std::function<void(ReadBackResultPtr)> ReadBackCallback;
+
+// asynchronous glReadPixels with a ring of pixel pack buffers and fence syncs
+// the read is issued in the gpu queue and the bytes are copied when the fence is signaled, typically some frames later
+// the results are given in request order, by the callback and the future, from the thread calling Update (the gl thread)
+// if the ring is full, the oldest request is waited, so there is never more than N reads in flight
+class AsyncReadBack {
+private:
+    struct ReadBackSlotStruct {
+        GLuint pbo = 0U;
+        size_t capacity = 0U;
+        GLsync fence = nullptr;
+        ReadBackResultPtr result = nullptr;
+        ReadBackCallback callback = nullptr;
+        std::promise<ReadBackResultPtr> promise;
+    };
+
+private:
+    GuiBackend_Window m_Window;
+    std::vector<ReadBackSlotStruct> m_Slots;
+    size_t m_OldestSlot = 0U;
+    size_t m_CountPending = 0U;
+
+public:
+    static size_t GetBytesPerPixel(GLenum vFormat, GLenum vType);
+
+public:
+    AsyncReadBack(const GuiBackend_Window& vWin, size_t vRingSize = 3U);
+    ~AsyncReadBack();
+
+    // read vRect of the color buffer vReadBuffer of the fbo vFboId (0 for the window)
+    std::future<ReadBackResultPtr> ReadPixels(GLuint vFboId,
+                                              GLenum vReadBuffer,
+                                              const ct::ivec4& vRect,
+                                              GLenum vFormat,
+                                              GLenum vType,
+                                              ReadBackCallback vCallback = nullptr);
+
+    // give the finished reads, without waiting the gpu
+    // return the count of given results
+    size_t Update();
+
+    // wait and give all the reads in flight
+    void Flush();
+
+    size_t GetCountPending() const;
+    size_t GetRingSize() const;
+
+private:
+    bool IsSlotReady(ReadBackSlotStruct& vSlot);
+    void CompleteOldestSlot(bool vWait);
+    void DestroySlots();
+};
@@ -231,16 +231,13 @@ void ExportBuffer::Capture(BaseModelWeak vModel, const GLuint& vRenderMode) {
 
 void ExportBuffer::ExportToFile() {
     if (puCapturedCountPoints > 0) {
-        VertexStruct::P3_N3_T2_C4* arr = new VertexStruct::P3_N3_T2_C4[puCapturedCountPoints];
-        glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0, puCapturedCountPoints * sizeof(VertexStruct::P3_N3_T2_C4), arr);
+        // read directly in the array of the saver
+        MeshSaver::workerThread_Mutex.lock();
+        MeshSaver::Instance()->vertices.resize(puCapturedCountPoints);
+        glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0, puCapturedCountPoints * sizeof(VertexStruct::P3_N3_T2_C4), MeshSaver::Instance()->vertices.data());
         LogGlError();
-
-        MeshSaver::Instance()->vertices.clear();
-        MeshSaver::Instance()->vertices.assign(arr, arr + puCapturedCountPoints);
-
-        SAFE_DELETE_ARRAY(arr);
-
         MeshSaver::Instance()->indices.clear();
+        MeshSaver::workerThread_Mutex.unlock();
 
         MeshSaver::Instance()->OpenDialog();
     }
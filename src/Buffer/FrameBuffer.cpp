@@ -18,17 +18,15 @@
 
 #include "FrameBuffer.h"
 #include "FrameBufferAttachment.h"
+#include "FloatBuffer.h"
+
+#include <Systems/ImageExportSystem.h>
 
 #include <cstring>  // memcpy
 
 #include <ctools/Logger.h>
 #include <Profiler/TracyProfiler.h>
 
-// #define STB_IMAGE_WRITE_IMPLEMENTATION
-#include <stb_image_write.h>
-// #define STB_IMAGE_RESIZE_IMPLEMENTATION
-#include <stb_image_resize2.h>
-
 #define USE_GET_TEX_IMAGE
 
 FrameBufferPtr FrameBuffer::Create(const GuiBackend_Window& vWin,
@@ -157,6 +155,9 @@ FrameBuffer::FrameBuffer(const GuiBackend_Window& vWin,
 ///////////////////////////////////////////////////
 
 FrameBuffer::~FrameBuffer() {
+    // the pending reads are given before the fbo destruction
+    puAsyncReadBack.reset();
+
     DestroyFrameBuffer();
 
     SAFE_DELETE_ARRAY(puColorDrawBuffers);
@@ -953,6 +954,76 @@ GLfloat FrameBuffer::GetOneChannelValueAtPos(const ct::ivec2& vPos, const int& v
     return value;
 }
 
+std::future<ReadBackResultPtr> FrameBuffer::ReadRGBABytesAsync(const int& vAttachmentId, ReadBackCallback vCallback) {
+    if (!puAsyncReadBack) {
+        puAsyncReadBack = std::make_unique<AsyncReadBack>(puWindow);
+    }
+
+    return puAsyncReadBack->ReadPixels(
+        puFBOId, GL_COLOR_ATTACHMENT0 + vAttachmentId, ct::ivec4(0, 0, puSize.x, puSize.y), GL_RGBA, GL_UNSIGNED_BYTE, vCallback);
+}
+
+std::future<ReadBackResultPtr> FrameBuffer::ReadRGBAValueAtPosAsync(const ct::ivec2& vPos, const int& vAttachmentId, ReadBackCallback vCallback) {
+    if (!puAsyncReadBack) {
+        puAsyncReadBack = std::make_unique<AsyncReadBack>(puWindow);
+    }
+
+    return puAsyncReadBack->ReadPixels(puFBOId, GL_COLOR_ATTACHMENT0 + vAttachmentId, ct::ivec4(vPos.x, vPos.y, 1, 1), GL_RGBA, GL_FLOAT, vCallback);
+}
+
+bool FrameBuffer::ReadFloatBufferFromColorAttachment_4_Chan_Async(const int& vAttachmentId, std::function<void(std::shared_ptr<FloatBuffer>)> vCallback) {
+    if (puTextures2D.size() <= (size_t)vAttachmentId) {
+        LogVarError("puTextures2D.size() <= %i", vAttachmentId);
+        return false;
+    }
+
+    auto at = puTextures2D[vAttachmentId];
+    if (!at)
+        return false;
+
+    auto fBuffer = at->GetFloatBuffer();
+    if (!fBuffer || fBuffer->bytesPerPixel != 4) {
+        LogVarError("the attachment %i have no RGBA float buffer", vAttachmentId);
+        return false;
+    }
+
+    if (!puAsyncReadBack) {
+        puAsyncReadBack = std::make_unique<AsyncReadBack>(puWindow);
+    }
+
+    puAsyncReadBack->ReadPixels(puFBOId,
+                                GL_COLOR_ATTACHMENT0 + vAttachmentId,
+                                ct::ivec4(0, 0, fBuffer->w, fBuffer->h),
+                                GL_RGBA,
+                                GL_FLOAT,
+                                [fBuffer, vCallback](ReadBackResultPtr vResult) {
+                                    if (vResult && vResult->isOk) {
+                                        const size_t size = ct::mini(vResult->bytes.size(), fBuffer->size * sizeof(float));
+                                        memcpy(fBuffer->buf, vResult->bytes.data(), size);
+                                        if (vCallback) {
+                                            vCallback(fBuffer);
+                                        }
+                                    } else if (vCallback) {
+                                        vCallback(nullptr);
+                                    }
+                                });
+
+    return true;
+}
+
+size_t FrameBuffer::UpdateAsyncReadBacks() {
+    if (puAsyncReadBack) {
+        return puAsyncReadBack->Update();
+    }
+    return 0U;
+}
+
+void FrameBuffer::FlushAsyncReadBacks() {
+    if (puAsyncReadBack) {
+        puAsyncReadBack->Flush();
+    }
+}
+
 GLuint FrameBuffer::getTextureID(const size_t& i) {
     if (i >= 0 && i < puTextures2D.size())
         return puTextures2D[i]->texture->glTex;
@@ -988,173 +1059,11 @@ ctTexturePtr FrameBuffer::getDepthTexture() {
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool FrameBuffer::SaveToPng(const std::string& vFilePathName, const bool& vFlipY, const int& vSubSamplesCount, const ct::ivec2& vNewSize, const int& vAttachmentId) {
-    bool res = false;
-
-    int width;
-    int height;
-    int bufSize;
-    uint8_t* bmBytesRGBA = GetRGBABytesFromFrameBuffer(&width, &height, &bufSize, vAttachmentId);
-
-    const int bytesPerPixel = 4;
-
-    const int ss = vSubSamplesCount;
-
-    // Sub Sampling
-    if (ss > 0) {
-        uint8_t* tempdata = new uint8_t[bufSize];
-        memcpy(tempdata, bmBytesRGBA, bufSize);
-
-        const unsigned indexMaxSize = width * height;
-        for (unsigned int index = 0; index < indexMaxSize; ++index) {
-            int count = 0;
-            int r = 0, g = 0, b = 0, a = 0;
-
-            for (int i = -ss; i <= ss; i += ss) {
-                for (int j = -ss; j <= ss; j += ss) {
-                    const int ssIndex = index + width * j + i;
-                    if (ssIndex > 0 && (unsigned int)ssIndex < indexMaxSize) {
-                        r += tempdata[ssIndex * bytesPerPixel + 0];
-                        g += tempdata[ssIndex * bytesPerPixel + 1];
-                        b += tempdata[ssIndex * bytesPerPixel + 2];
-                        a += tempdata[ssIndex * bytesPerPixel + 3];
-
-                        count++;
-                    }
-                }
-            }
-
-            bmBytesRGBA[index * bytesPerPixel + 0] = (uint8_t)((float)r / (float)count);
-            bmBytesRGBA[index * bytesPerPixel + 1] = (uint8_t)((float)g / (float)count);
-            bmBytesRGBA[index * bytesPerPixel + 2] = (uint8_t)((float)b / (float)count);
-            bmBytesRGBA[index * bytesPerPixel + 3] = (uint8_t)((float)a / (float)count);
-        }
-
-        SAFE_DELETE_ARRAY(tempdata);
-    }
-
-    // resize
-    if ((vNewSize.x != width) || (vNewSize.y != height)) {
-        // resize
-        const int newWidth = vNewSize.x;
-        const int newHeight = vNewSize.y;
-        const unsigned int newBufSize = newWidth * newHeight * bytesPerPixel;
-        uint8_t* resizedData = new uint8_t[newBufSize];
-
-        const uint8_t* resizeRes = stbir_resize_uint8_linear(
-            bmBytesRGBA, width, height, width * bytesPerPixel, resizedData, newWidth, newHeight, newWidth * bytesPerPixel, (stbir_pixel_layout)bytesPerPixel);
-
-        if (resizeRes) {
-            if (vFlipY)
-                stbi_flip_vertically_on_write(1);
-            const int resWrite = stbi_write_png(vFilePathName.c_str(), newWidth, newHeight, bytesPerPixel, resizedData, newWidth * bytesPerPixel);
-
-            if (resWrite)
-                res = true;
-        }
-
-        SAFE_DELETE_ARRAY(resizedData);
-    } else {
-        if (vFlipY)
-            stbi_flip_vertically_on_write(1);
-        const int resWrite = stbi_write_png(vFilePathName.c_str(), width, height, bytesPerPixel, bmBytesRGBA, width * bytesPerPixel);
-
-        if (resWrite)
-            res = true;
-    }
-
-    SAFE_DELETE_ARRAY(bmBytesRGBA);
-
-    LogVarInfo("Png picture file saved : %s", vFilePathName.c_str());
-
-    return res;
+    return SaveToFile(vFilePathName, ImageExportFormatEnum::IMAGE_EXPORT_PNG, vFlipY, vSubSamplesCount, 0, vNewSize, vAttachmentId);
 }
 
 bool FrameBuffer::SaveToBmp(const std::string& vFilePathName, const bool& vFlipY, const int& vSubSamplesCount, const ct::ivec2& vNewSize, const int& vAttachmentId) {
-    bool res = false;
-
-    int width;
-    int height;
-    int bufSize;
-    uint8_t* bmBytesRGB = GetRGBBytesFromFrameBuffer(&width, &height, &bufSize, vAttachmentId);
-
-    const int bytesPerPixel = 3;
-
-    const int ss = vSubSamplesCount;
-
-    // Sub Sampling
-    if (ss > 0) {
-        uint8_t* tempdata = new uint8_t[bufSize];
-        memcpy(tempdata, bmBytesRGB, bufSize);
-
-        const unsigned indexMaxSize = width * height;
-        for (unsigned int index = 0; index < indexMaxSize; ++index) {
-            int count = 0;
-            int r = 0, g = 0, b = 0;  // , a = 0;
-
-            for (int i = -ss; i <= ss; i += ss) {
-                for (int j = -ss; j <= ss; j += ss) {
-                    const int ssIndex = index + width * j + i;
-                    if (ssIndex > 0 && (unsigned int)ssIndex < indexMaxSize) {
-                        r += tempdata[ssIndex * bytesPerPixel + 0];
-                        g += tempdata[ssIndex * bytesPerPixel + 1];
-                        b += tempdata[ssIndex * bytesPerPixel + 2];
-
-                        count++;
-                    }
-                }
-            }
-
-            bmBytesRGB[index * bytesPerPixel + 0] = (uint8_t)((float)r / (float)count);
-            bmBytesRGB[index * bytesPerPixel + 1] = (uint8_t)((float)g / (float)count);
-            bmBytesRGB[index * bytesPerPixel + 2] = (uint8_t)((float)b / (float)count);
-        }
-
-        SAFE_DELETE_ARRAY(tempdata);
-    }
-
-    // resize
-    if ((vNewSize.x != width) || (vNewSize.y != height)) {
-        // resize
-        const int newWidth = vNewSize.x;
-        const int newHeight = vNewSize.y;
-        const unsigned int newBufSize = newWidth * newHeight * bytesPerPixel;
-        uint8_t* resizedData = new uint8_t[newBufSize];
-
-        const uint8_t* resizeRes = stbir_resize_uint8_linear(  //
-            bmBytesRGB,
-            width,
-            height,
-            width * bytesPerPixel,  //
-            resizedData,
-            newWidth,
-            newHeight,
-            newWidth * bytesPerPixel,            //
-            (stbir_pixel_layout)bytesPerPixel);  //
-
-        if (resizeRes) {
-            if (vFlipY)
-                stbi_flip_vertically_on_write(1);
-            const int resWrite = stbi_write_bmp(vFilePathName.c_str(), newWidth, newHeight, bytesPerPixel, resizedData);
-
-            if (resWrite)
-                res = true;
-        }
-
-        SAFE_DELETE_ARRAY(resizedData);
-    } else {
-        if (vFlipY)
-            stbi_flip_vertically_on_write(1);
-        const int resWrite = stbi_write_bmp(vFilePathName.c_str(), width, height, bytesPerPixel, bmBytesRGB);
-
-        if (resWrite)
-            res = true;
-    }
-
-    SAFE_DELETE_ARRAY(bmBytesRGB);
-
-    LogVarInfo("bmp picture file saved : %s", vFilePathName.c_str());
-
-    return res;
+    return SaveToFile(vFilePathName, ImageExportFormatEnum::IMAGE_EXPORT_BMP, vFlipY, vSubSamplesCount, 0, vNewSize, vAttachmentId);
 }
 
 bool FrameBuffer::SaveToJpg(const std::string& vFilePathName,
@@ -1163,274 +1072,109 @@ bool FrameBuffer::SaveToJpg(const std::string& vFilePathName,
                             const int& vQualityFrom0To100,
                             const ct::ivec2& vNewSize,
                             const int& vAttachmentId) {
-    bool res = false;
-
-    int width;
-    int height;
-    int bufSize;
-    const int bytesPerPixel = 3;
-    uint8_t* bmBytesRGB = GetRGBBytesFromFrameBuffer(&width, &height, &bufSize, vAttachmentId);
-
-    const int ss = vSubSamplesCount;
-
-    // Sub Sampling
-    if (ss > 0) {
-        uint8_t* tempdata = new uint8_t[bufSize];
-        memcpy(tempdata, bmBytesRGB, bufSize);
-
-        const unsigned indexMaxSize = width * height;
-        for (unsigned int index = 0; index < indexMaxSize; ++index) {
-            int count = 0;
-            int r = 0, g = 0, b = 0;  // , a = 0;
-
-            for (int i = -ss; i <= ss; i += ss) {
-                for (int j = -ss; j <= ss; j += ss) {
-                    const int ssIndex = index + width * j + i;
-                    if (ssIndex > 0 && (unsigned int)ssIndex < indexMaxSize) {
-                        r += tempdata[ssIndex * bytesPerPixel + 0];
-                        g += tempdata[ssIndex * bytesPerPixel + 1];
-                        b += tempdata[ssIndex * bytesPerPixel + 2];
-
-                        count++;
-                    }
-                }
-            }
-
-            bmBytesRGB[index * bytesPerPixel + 0] = (uint8_t)((float)r / (float)count);
-            bmBytesRGB[index * bytesPerPixel + 1] = (uint8_t)((float)g / (float)count);
-            bmBytesRGB[index * bytesPerPixel + 2] = (uint8_t)((float)b / (float)count);
-        }
-
-        SAFE_DELETE_ARRAY(tempdata);
-    }
-
-    // resize
-    if ((vNewSize.x != width) || (vNewSize.y != height)) {
-        // resize
-        const int newWidth = vNewSize.x;
-        const int newHeight = vNewSize.y;
-        const unsigned int newBufSize = newWidth * newHeight * bytesPerPixel;
-        uint8_t* resizedData = new uint8_t[newBufSize];
-
-        const uint8_t* resizeRes = stbir_resize_uint8_linear(  //
-            bmBytesRGB,
-            width,
-            height,
-            width * bytesPerPixel,  //
-            resizedData,
-            newWidth,
-            newHeight,
-            newWidth * bytesPerPixel,            //
-            (stbir_pixel_layout)bytesPerPixel);  //
-
-        if (resizeRes) {
-            if (vFlipY)
-                stbi_flip_vertically_on_write(1);
-            const int resWrite = stbi_write_jpg(vFilePathName.c_str(), newWidth, newHeight, bytesPerPixel, resizedData, vQualityFrom0To100);
-
-            if (resWrite)
-                res = true;
-        }
-
-        SAFE_DELETE_ARRAY(resizedData);
-    } else {
-        if (vFlipY)
-            stbi_flip_vertically_on_write(1);
-        const int resWrite = stbi_write_jpg(vFilePathName.c_str(), width, height, bytesPerPixel, bmBytesRGB, vQualityFrom0To100);
-
-        if (resWrite)
-            res = true;
-    }
-
-    SAFE_DELETE_ARRAY(bmBytesRGB);
-
-    LogVarInfo("Jpg picture file saved : %s", vFilePathName.c_str());
-
-    return res;
+    return SaveToFile(vFilePathName, ImageExportFormatEnum::IMAGE_EXPORT_JPG, vFlipY, vSubSamplesCount, vQualityFrom0To100, vNewSize, vAttachmentId);
 }
 
 bool FrameBuffer::SaveToHdr(const std::string& vFilePathName, const bool& vFlipY, const int& vSubSamplesCount, const ct::ivec2& vNewSize, const int& vAttachmentId) {
-    bool res = false;
-
-    // on force la creation d'un nouveau FloatBuffer, donc il faudra qu'on le detruise nous meme
-    std::shared_ptr<FloatBuffer> bmFloatRGBA = GetFloatBufferFromColorAttachment_4_Chan(vAttachmentId, true, 0, true);
-    if (bmFloatRGBA) {
-        const int width = bmFloatRGBA->w;
-        const int height = bmFloatRGBA->h;
-        const int bytesPerPixel = bmFloatRGBA->bytesPerPixel;
-        // int bufSize = (int)bmFloatRGBA->size;
-
-        const int ss = vSubSamplesCount;
-
-        // Sub Sampling
-        if (ss > 0) {
-            std::shared_ptr<FloatBuffer> tempdata = GetFloatBufferFromColorAttachment_4_Chan(vAttachmentId, true, 0, true);
-            if (tempdata) {
-                const unsigned indexMaxSize = width * height;
-                for (unsigned int index = 0; index < indexMaxSize; ++index) {
-                    float count = 0;
-                    float r = 0, g = 0, b = 0, a = 0;
-
-                    for (int i = -ss; i <= ss; i += ss) {
-                        for (int j = -ss; j <= ss; j += ss) {
-                            const int ssIndex = index + width * j + i;
-                            if (ssIndex > 0 && (unsigned int)ssIndex < indexMaxSize) {
-                                r += tempdata->buf[ssIndex * bytesPerPixel + 0];
-                                g += tempdata->buf[ssIndex * bytesPerPixel + 1];
-                                b += tempdata->buf[ssIndex * bytesPerPixel + 2];
-                                if (bytesPerPixel > 3)
-                                    a += tempdata->buf[ssIndex * bytesPerPixel + 3];
-
-                                count++;
-                            }
-                        }
-                    }
-
-                    bmFloatRGBA->buf[index * bytesPerPixel + 0] = r / count;
-                    bmFloatRGBA->buf[index * bytesPerPixel + 1] = g / count;
-                    bmFloatRGBA->buf[index * bytesPerPixel + 2] = b / count;
-                    if (bytesPerPixel > 3)
-                        bmFloatRGBA->buf[index * bytesPerPixel + 3] = a / count;
-                }
-
-                tempdata.reset();
-            }
-        }
+    return SaveToFile(vFilePathName, ImageExportFormatEnum::IMAGE_EXPORT_HDR, vFlipY, vSubSamplesCount, 0, vNewSize, vAttachmentId);
+}
 
-        // resize
-        if ((vNewSize.x != width) || (vNewSize.y != height)) {
-            // resize
-            const int newWidth = vNewSize.x;
-            const int newHeight = vNewSize.y;
-            const unsigned int newBufSize = newWidth * newHeight * bytesPerPixel;
-            float* resizedData = new float[newBufSize];
-
-            const float* resizeRes = stbir_resize_float_linear(  //
-                bmFloatRGBA->buf,
-                width,
-                height,
-                width * bytesPerPixel,  //
-                resizedData,
-                newWidth,
-                newHeight,
-                newWidth * bytesPerPixel,            //
-                (stbir_pixel_layout)bytesPerPixel);  //
-
-            if (resizeRes) {
-                if (vFlipY)
-                    stbi_flip_vertically_on_write(1);
-                const int resWrite = stbi_write_hdr(vFilePathName.c_str(), newWidth, newHeight, bytesPerPixel, resizedData);
-
-                if (resWrite)
-                    res = true;
-            }
+bool FrameBuffer::SaveToTga(const std::string& vFilePathName, const bool& vFlipY, const int& vSubSamplesCount, const ct::ivec2& vNewSize, const int& vAttachmentId) {
+    return SaveToFile(vFilePathName, ImageExportFormatEnum::IMAGE_EXPORT_TGA, vFlipY, vSubSamplesCount, 0, vNewSize, vAttachmentId);
+}
 
-            SAFE_DELETE_ARRAY(resizedData);
+bool FrameBuffer::SaveToFile(const std::string& vFilePathName,
+                             const ImageExportFormatEnum& vFormat,
+                             const bool& vFlipY,
+                             const int& vSubSamplesCount,
+                             const int& vQualityFrom0To100,
+                             const ct::ivec2& vNewSize,
+                             const int& vAttachmentId) {
+    ImageExportJob job;
+    job.filePathName = vFilePathName;
+    job.format = vFormat;
+    job.flipY = vFlipY;
+    job.subSamplesCount = vSubSamplesCount;
+    job.newSize = vNewSize;
+    job.jpgQuality = vQualityFrom0To100;
+
+    if (vFormat == ImageExportFormatEnum::IMAGE_EXPORT_HDR) {
+        // on force la creation d'un nouveau FloatBuffer
+        std::shared_ptr<FloatBuffer> bmFloatRGBA = GetFloatBufferFromColorAttachment_4_Chan(vAttachmentId, true, 0, true);
+        if (!bmFloatRGBA || !bmFloatRGBA->buf)
+            return false;
+        job.width = bmFloatRGBA->w;
+        job.height = bmFloatRGBA->h;
+        job.channels = bmFloatRGBA->bytesPerPixel;
+        job.floats.assign(bmFloatRGBA->buf, bmFloatRGBA->buf + (size_t)job.width * (size_t)job.height * (size_t)job.channels);
+    } else {
+        int bufSize = 0;
+        uint8_t* bmBytes = nullptr;
+        if (vFormat == ImageExportFormatEnum::IMAGE_EXPORT_BMP || vFormat == ImageExportFormatEnum::IMAGE_EXPORT_JPG) {
+            bmBytes = GetRGBBytesFromFrameBuffer(&job.width, &job.height, &bufSize, vAttachmentId);
+            job.channels = 3;
         } else {
-            if (vFlipY)
-                stbi_flip_vertically_on_write(1);
-            const int resWrite = stbi_write_hdr(vFilePathName.c_str(), width, height, bytesPerPixel, bmFloatRGBA->buf);
-
-            if (resWrite)
-                res = true;
+            bmBytes = GetRGBABytesFromFrameBuffer(&job.width, &job.height, &bufSize, vAttachmentId);
+            job.channels = 4;
         }
-
-        bmFloatRGBA.reset();
+        if (!bmBytes)
+            return false;
+        job.bytes.assign(bmBytes, bmBytes + bufSize);
+        SAFE_DELETE_ARRAY(bmBytes);
     }
 
-    LogVarInfo("Hdr picture file saved : %s", vFilePathName.c_str());
-
-    return res;
+    return ImageExportSystem::WriteImageFile(job);
 }
 
-bool FrameBuffer::SaveToTga(const std::string& vFilePathName, const bool& vFlipY, const int& vSubSamplesCount, const ct::ivec2& vNewSize, const int& vAttachmentId) {
-    bool res = false;
-
-    int width;
-    int height;
-    int bufSize;
-    uint8_t* bmBytesRGBA = GetRGBABytesFromFrameBuffer(&width, &height, &bufSize, vAttachmentId);
-
-    const int bytesPerPixel = 4;
-
-    const int ss = vSubSamplesCount;
-
-    // Sub Sampling
-    if (ss > 0) {
-        uint8_t* tempdata = new uint8_t[bufSize];
-        memcpy(tempdata, bmBytesRGBA, bufSize);
-
-        const unsigned indexMaxSize = width * height;
-        for (unsigned int index = 0; index < indexMaxSize; ++index) {
-            int count = 0;
-            int r = 0, g = 0, b = 0, a = 0;
-
-            for (int i = -ss; i <= ss; i += ss) {
-                for (int j = -ss; j <= ss; j += ss) {
-                    const int ssIndex = index + width * j + i;
-                    if (ssIndex > 0 && (unsigned int)ssIndex < indexMaxSize) {
-                        r += tempdata[ssIndex * bytesPerPixel + 0];
-                        g += tempdata[ssIndex * bytesPerPixel + 1];
-                        b += tempdata[ssIndex * bytesPerPixel + 2];
-                        a += tempdata[ssIndex * bytesPerPixel + 3];
-
-                        count++;
-                    }
-                }
-            }
-
-            bmBytesRGBA[index * bytesPerPixel + 0] = (uint8_t)((float)r / (float)count);
-            bmBytesRGBA[index * bytesPerPixel + 1] = (uint8_t)((float)g / (float)count);
-            bmBytesRGBA[index * bytesPerPixel + 2] = (uint8_t)((float)b / (float)count);
-            bmBytesRGBA[index * bytesPerPixel + 3] = (uint8_t)((float)a / (float)count);
-        }
+bool FrameBuffer::ExportToFileAsync(const std::string& vFilePathName,
+                                    const ImageExportFormatEnum& vFormat,
+                                    const bool& vFlipY,
+                                    const int& vSubSamplesCount,
+                                    const int& vQualityFrom0To100,
+                                    const ct::ivec2& vNewSize,
+                                    const int& vAttachmentId) {
+    if (vFilePathName.empty() || puTextures2D.size() <= (size_t)vAttachmentId)
+        return false;
 
-        SAFE_DELETE_ARRAY(tempdata);
+    auto job = std::make_shared<ImageExportJob>();
+    job->filePathName = vFilePathName;
+    job->format = vFormat;
+    job->flipY = vFlipY;
+    job->subSamplesCount = vSubSamplesCount;
+    job->newSize = vNewSize;
+    job->jpgQuality = vQualityFrom0To100;
+
+    GLenum format = GL_RGBA;
+    GLenum type = GL_UNSIGNED_BYTE;
+    if (vFormat == ImageExportFormatEnum::IMAGE_EXPORT_HDR) {
+        type = GL_FLOAT;
+    } else if (vFormat == ImageExportFormatEnum::IMAGE_EXPORT_BMP || vFormat == ImageExportFormatEnum::IMAGE_EXPORT_JPG) {
+        format = GL_RGB;
     }
 
-    // resize
-    if ((vNewSize.x != width) || (vNewSize.y != height)) {
-        // resize
-        const int newWidth = vNewSize.x;
-        const int newHeight = vNewSize.y;
-        const unsigned int newBufSize = newWidth * newHeight * bytesPerPixel;
-        uint8_t* resizedData = new uint8_t[newBufSize];
-
-        const uint8_t* resizeRes = stbir_resize_uint8_linear(  //
-            bmBytesRGBA,
-            width,
-            height,
-            width * bytesPerPixel,  //
-            resizedData,
-            newWidth,
-            newHeight,
-            newWidth * bytesPerPixel,            //
-            (stbir_pixel_layout)bytesPerPixel);  //
-
-        if (resizeRes) {
-            if (vFlipY)
-                stbi_flip_vertically_on_write(1);
-            const int resWrite = stbi_write_tga(vFilePathName.c_str(), newWidth, newHeight, bytesPerPixel, resizedData);
-
-            if (resWrite)
-                res = true;
-        }
-
-        SAFE_DELETE_ARRAY(resizedData);
-    } else {
-        if (vFlipY)
-            stbi_flip_vertically_on_write(1);
-        const int resWrite = stbi_write_tga(vFilePathName.c_str(), width, height, bytesPerPixel, bmBytesRGBA);
-
-        if (resWrite)
-            res = true;
+    if (!puAsyncReadBack) {
+        puAsyncReadBack = std::make_unique<AsyncReadBack>(puWindow);
     }
 
-    SAFE_DELETE_ARRAY(bmBytesRGBA);
-
-    LogVarInfo("Tga picture file saved : %s", vFilePathName.c_str());
+    // the job take the pixels of the read back, the encoding is done by the workers
+    puAsyncReadBack->ReadPixels(puFBOId, GL_COLOR_ATTACHMENT0 + vAttachmentId, ct::ivec4(0, 0, puSize.x, puSize.y), format, type, [job](ReadBackResultPtr vResult) {
+        if (vResult && vResult->isOk) {
+            job->width = vResult->rect.z;
+            job->height = vResult->rect.w;
+            job->channels = (vResult->format == GL_RGB) ? 3 : 4;
+            if (vResult->type == GL_FLOAT) {
+                job->floats.resize(vResult->bytes.size() / sizeof(float));
+                memcpy(job->floats.data(), vResult->bytes.data(), job->floats.size() * sizeof(float));
+            } else {
+                job->bytes = std::move(vResult->bytes);
+            }
+            ImageExportSystem::Instance()->Submit(job);
+        } else {
+            LogVarError("Fail to read the pixels for %s", job->filePathName.c_str());
+        }
+    });
 
-    return res;
+    return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -16,6 +16,7 @@
 #pragma once
 
 #include <Headers/RenderPackHeaders.h>
+#include <Buffer/AsyncReadBack.h>
 
 #include <glad/glad.h>
 #include <ctools/cTools.h>
@@ -26,6 +27,7 @@
 
 class FrameBufferAttachment;
 class FloatBuffer;
+enum class ImageExportFormatEnum : uint8_t;
 struct TextureParamsStruct;
 class FrameBuffer {
 private:
@@ -50,6 +52,7 @@ private:
     std::shared_ptr<FrameBufferAttachment> puTextures3D = nullptr;            // une seule texture 3d par fbo possible
     std::vector<std::shared_ptr<FrameBufferAttachment>> puRenderBuffers;      // tout les buffers sans les textures
     GuiBackend_Window puWindow;
+    std::unique_ptr<AsyncReadBack> puAsyncReadBack = nullptr;  // created at the first async read
 
 public:
     TextureParamsStruct puTexParams;
@@ -140,6 +143,14 @@ public:
     void GetRGBAValueAtPos(const ct::ivec2& vPos, const int& vAttachmentId = 0, ct::fvec4* vValue = nullptr);
     GLfloat GetOneChannelValueAtPos(const ct::ivec2& vPos, const int& vChannel = 0, const int& vAttachmentId = 0);  // vChannel => R/G/B/A = 0/1/2/3
 
+    // async versions, the gpu is not stalled, the result come some frames later (see AsyncReadBack)
+    // the callbacks are called from UpdateAsyncReadBacks or from the next async read, on the gl thread
+    std::future<ReadBackResultPtr> ReadRGBABytesAsync(const int& vAttachmentId, ReadBackCallback vCallback = nullptr);
+    std::future<ReadBackResultPtr> ReadRGBAValueAtPosAsync(const ct::ivec2& vPos, const int& vAttachmentId = 0, ReadBackCallback vCallback = nullptr);
+    bool ReadFloatBufferFromColorAttachment_4_Chan_Async(const int& vAttachmentId, std::function<void(std::shared_ptr<FloatBuffer>)> vCallback);
+    size_t UpdateAsyncReadBacks();
+    void FlushAsyncReadBacks();
+
     GLuint getTextureID(const size_t& i = 0);
     ctTexturePtr getTexture(const size_t& i = 0);
     GLuint getRenderBufferID(const size_t& i = 0);
@@ -157,9 +168,28 @@ public:
     bool SaveToHdr(const std::string& vFilePathName, const bool& vFlipY, const int& vSubSamplesCount, const ct::ivec2& vNewSize, const int& vAttachmentId);
     bool SaveToTga(const std::string& vFilePathName, const bool& vFlipY, const int& vSubSamplesCount, const ct::ivec2& vNewSize, const int& vAttachmentId);
 
+    // the pixels are read asynchronously then subsampled, resized, encoded and written by ImageExportSystem
+    // the rendering is not blocked, except if the queue of ImageExportSystem is full
+    bool ExportToFileAsync(const std::string& vFilePathName,
+                           const ImageExportFormatEnum& vFormat,
+                           const bool& vFlipY,
+                           const int& vSubSamplesCount,
+                           const int& vQualityFrom0To100,
+                           const ct::ivec2& vNewSize,
+                           const int& vAttachmentId);
+
     void UpdateMipMaping(const std::string& vName);
 
     void ChangeTexParameters(TextureParamsStruct* vTexParam);
     void GetTexParameters(TextureParamsStruct* vTexParam);
     bool UpdateTexParameters(const std::string& vName, TextureParamsStruct* vTexParam);
+
+private:
+    bool SaveToFile(const std::string& vFilePathName,
+                    const ImageExportFormatEnum& vFormat,
+                    const bool& vFlipY,
+                    const int& vSubSamplesCount,
+                    const int& vQualityFrom0To100,
+                    const ct::ivec2& vNewSize,
+                    const int& vAttachmentId);
 };
@@ -111,6 +111,9 @@ void CodeTree::Clear(const std::unordered_set<std::string>& vExceptions) {
 
 void CodeTree::ClearShaders() {
     CloseUniformsConfigSwitcher();
+    for (const auto& key : puShaderKeys) {
+        puIncludeGraph.RemoveKey(key.first);
+    }
     puShaderKeys.clear();
 }
 
@@ -128,6 +131,7 @@ void CodeTree::ClearShaders(const std::unordered_set<std::string>& vExceptions)
         if (!puDontSaveConfigFiles) {
             puShaderKeys[*it]->SaveRenderPackConfig(CONFIG_TYPE_Enum::CONFIG_TYPE_ALL);
         }
+        puIncludeGraph.RemoveKey(*it);
         puShaderKeys.erase(*it);
     }
 
@@ -136,6 +140,9 @@ void CodeTree::ClearShaders(const std::unordered_set<std::string>& vExceptions)
 
 void CodeTree::ClearIncludes() {
     CloseUniformsConfigSwitcher();
+    for (const auto& key : puIncludeKeys) {
+        puIncludeGraph.RemoveKey(key.first);
+    }
     puIncludeKeys.clear();
 }
 
@@ -157,6 +164,7 @@ void CodeTree::ClearIncludes(const std::unordered_set<std::string>& vExceptions)
         if (!puDontSaveConfigFiles) {
             puIncludeKeys[*it]->SaveRenderPackConfig(CONFIG_TYPE_Enum::CONFIG_TYPE_ALL);
         }
+        puIncludeGraph.RemoveKey(*it);
         puIncludeKeys.erase(*it);
     }
 
@@ -174,6 +182,7 @@ void CodeTree::RemoveKey(const std::string& vKey) {
         CloseUniformsConfigSwitcher(key);
         puIncludeKeys.erase(vKey);
     }
+    puIncludeGraph.RemoveKey(vKey);
 }
 
 ShaderKeyPtr CodeTree::LoadFromFile(const std::string& vFilePathName, KEY_TYPE_Enum vFileType) {
@@ -755,6 +764,7 @@ void CodeTree::SetUniformPointerForIncludeUniformName(ShaderKeyPtr vIncludeKey,
                 if (vUniformPointer->loc >= 0) {
                     if (vUniformPointer->loc != vIncludeKey->puUniformsDataBase[vUniformName]->loc) {
                         vIncludeKey->puUniformsDataBase[vUniformName] = vUniformPointer;
+                        ++vIncludeKey->puUniformsDataBaseGeneration;
                     }
                 }
 
@@ -766,6 +776,7 @@ void CodeTree::SetUniformPointerForIncludeUniformName(ShaderKeyPtr vIncludeKey,
                 }
             } else {
                 vIncludeKey->puUniformsDataBase[vUniformName] = vUniformPointer;
+                ++vIncludeKey->puUniformsDataBaseGeneration;
 
                 // todo : mettre un shared_ptr ici
                 UniformsMultiLoc* mloc = new UniformsMultiLoc(vUniformPointer);
@@ -1185,14 +1196,33 @@ ShaderKeyPtr CodeTree::GetParentkeyRecurs(const std::string& vKey) {
     return key;
 }
 
+std::vector<ShaderKeyPtr> CodeTree::GetAffectedShaderKeys(const std::string& vKey) {
+    std::vector<ShaderKeyPtr> res;
+
+    for (const auto& affectedKey : puIncludeGraph.GetAffectedKeys(vKey)) {
+        // the includes are not parsed alone, they are parsed in the shaders who use them
+        auto key = GetShaderKey(affectedKey);
+        if (key) {
+            res.push_back(key);
+        }
+    }
+
+    return res;
+}
+
 std::set<std::string> CodeTree::ReParseFilesIfChange(std::set<std::string> vFiles) {
-    std::set<ShaderKeyPtr> parentKeysToUpdate;
+    // each shader key is updated one time, even if many of his includes have changed
+    std::vector<ShaderKeyPtr> keysToUpdate;
+    std::unordered_set<std::string> keysToUpdateNames;
+    auto addKeyToUpdate = [&keysToUpdate, &keysToUpdateNames](const ShaderKeyPtr& vKey) {
+        if (vKey && keysToUpdateNames.emplace(vKey->puKey).second) {
+            keysToUpdate.push_back(vKey);
+        }
+    };
 
     for (const auto& file : vFiles) {
-        ShaderKeyPtr key = GetParentkeyRecurs(file);
-
-        if (key) {
-            parentKeysToUpdate.emplace(key);
+        for (const auto& key : GetAffectedShaderKeys(file)) {
+            addKeyToUpdate(key);
 
             if (!key->puBufferNames.empty()) {
                 std::string newCode = FileHelper::Instance()->LoadFileToString(key->puKey, true);
@@ -1201,10 +1231,9 @@ std::set<std::string> CodeTree::ReParseFilesIfChange(std::set<std::string> vFile
                     for (const auto& bufName : key->puBufferNames) {
                         std::string f = ps.path + "/" + ps.name + "_" + bufName + "." + ps.ext;
                         f = FileHelper::Instance()->CorrectSlashTypeForFilePathName(f);
-                        auto k = GetParentkeyRecurs(f);
-                        if (k) {
+                        for (const auto& k : GetAffectedShaderKeys(f)) {
                             k->puFileString = newCode;
-                            parentKeysToUpdate.emplace(k);
+                            addKeyToUpdate(k);
                         }
                     }
                 }
@@ -1214,18 +1243,14 @@ std::set<std::string> CodeTree::ReParseFilesIfChange(std::set<std::string> vFile
 
     std::set<std::string> res;
 
-    for (const auto& key : parentKeysToUpdate) {
-        if (key) {
-            res.emplace(key->puKey);
+    for (const auto& key : keysToUpdate) {
+        res.emplace(key->puKey);
 
-            // on met force a true, si un shader a été modifié, on doit forcement recharger son parent
-            // donc on verifie pas si le code du parent a changé il faut forcer la maj
-            key->UpdateIfChange(true, false, true);  // todo : pourquoi on a mit force a true ??
-        }
+        // on met force a true, si un shader a été modifié, on doit forcement recharger son parent
+        // donc on verifie pas si le code du parent a changé il faut forcer la maj
+        key->UpdateIfChange(true, false, true);  // todo : pourquoi on a mit force a true ??
     }
 
-    parentKeysToUpdate.clear();
-
     return res;
 }
 
@@ -2367,6 +2392,7 @@ bool CodeTree::AddOrUpdateKeyWithCode(ShaderKeyPtr vKey,
                     }
                 } else {
                     vKey->puUniformsDataBase.clear();
+                    ++vKey->puUniformsDataBaseGeneration;
                 }
 
                 res = true;
@@ -18,6 +18,7 @@
 #include <Headers/RenderPackHeaders.h>
 #include <ctools/cTools.h>
 #include <CodeTree/ShaderKey.h>
+#include <CodeTree/IncludeGraph.h>
 #include <Uniforms/UniformVariant.h>
 #include <Uniforms/UniformsMultiLoc.h>
 #include <ctools/FileHelper.h>
@@ -42,6 +43,7 @@ public:  // gizmo
 public:
     std::unordered_map<std::string, ShaderKeyPtr> puShaderKeys;
     std::unordered_map<std::string, ShaderKeyPtr> puIncludeKeys;
+    IncludeGraph puIncludeGraph;  // who include who, between puShaderKeys and puIncludeKeys
     CodeTreePtr m_This = nullptr;
 
 private:
@@ -261,6 +263,8 @@ public:  // file tracker
     void AddPathToTrack(std::string vPathToTrack, bool vCreateDirectoryIfNotExist);  // pas de const std::string& ici
     void CheckIfTheseAreSomeFileChanges();
     ShaderKeyPtr GetParentkeyRecurs(const std::string& vKey);
+    // the shader keys (not includes) who use vKey directly or not, each one time, in include order
+    std::vector<ShaderKeyPtr> GetAffectedShaderKeys(const std::string& vKey);
     std::set<std::string> ReParseFilesIfChange(std::set<std::string> vFiles);
 
 public:
@@ -0,0 +1,199 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "IncludeGraph.h"
+
+#include <list>
+
+void IncludeGraph::Clear() {
+    m_Includes.clear();
+    m_IncludedBy.clear();
+    m_ParsedKeys.clear();
+}
+
+void IncludeGraph::BeginParse(const std::string& vRootKey) {
+    m_ParsedKeys.clear();
+    m_ParsedKeys.emplace(vRootKey);
+    RemoveIncludes(vRootKey);
+}
+
+void IncludeGraph::EndParse() {
+    m_ParsedKeys.clear();
+}
+
+bool IncludeGraph::AddInclude(const std::string& vIncluderKey, const std::string& vIncludedKey) {
+    if (vIncluderKey.empty() || vIncludedKey.empty())
+        return true;
+
+    // the includes of the included key can have changed since the last parse
+    if (m_ParsedKeys.emplace(vIncludedKey).second) {
+        RemoveIncludes(vIncludedKey);
+    }
+
+    // a => b with b => .. => a, infinite loop
+    if (vIncluderKey == vIncludedKey || IsReachable(vIncludedKey, vIncluderKey))
+        return false;
+
+    m_Includes[vIncluderKey].emplace(vIncludedKey);
+    m_IncludedBy[vIncludedKey].emplace(vIncluderKey);
+
+    return true;
+}
+
+bool IncludeGraph::IsReachable(const std::string& vFromKey, const std::string& vToKey) const {
+    if (vFromKey == vToKey)
+        return true;
+
+    std::unordered_set<std::string> visited;
+    std::list<std::string> toVisit;
+    toVisit.push_back(vFromKey);
+    visited.emplace(vFromKey);
+
+    while (!toVisit.empty()) {
+        const auto key = toVisit.front();
+        toVisit.pop_front();
+
+        auto it = m_Includes.find(key);
+        if (it != m_Includes.end()) {
+            for (const auto& included : it->second) {
+                if (included == vToKey)
+                    return true;
+                if (visited.emplace(included).second) {
+                    toVisit.push_back(included);
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+void IncludeGraph::RemoveKey(const std::string& vKey) {
+    RemoveIncludes(vKey);
+
+    auto it = m_IncludedBy.find(vKey);
+    if (it != m_IncludedBy.end()) {
+        for (const auto& includer : it->second) {
+            auto itIncluder = m_Includes.find(includer);
+            if (itIncluder != m_Includes.end()) {
+                itIncluder->second.erase(vKey);
+                if (itIncluder->second.empty()) {
+                    m_Includes.erase(itIncluder);
+                }
+            }
+        }
+        m_IncludedBy.erase(it);
+    }
+}
+
+std::vector<std::string> IncludeGraph::GetAffectedKeys(const std::string& vKey) const {
+    std::vector<std::string> res;
+
+    // the includers of vKey, directly or not
+    std::unordered_set<std::string> affected;
+    std::list<std::string> toVisit;
+    toVisit.push_back(vKey);
+    affected.emplace(vKey);
+
+    while (!toVisit.empty()) {
+        const auto key = toVisit.front();
+        toVisit.pop_front();
+
+        auto it = m_IncludedBy.find(key);
+        if (it != m_IncludedBy.end()) {
+            for (const auto& includer : it->second) {
+                if (affected.emplace(includer).second) {
+                    toVisit.push_back(includer);
+                }
+            }
+        }
+    }
+
+    // kahn sort on the affected sub graph, an included key before his includers
+    std::unordered_map<std::string, size_t> countIncludes;
+    for (const auto& key : affected) {
+        size_t count = 0U;
+        auto it = m_Includes.find(key);
+        if (it != m_Includes.end()) {
+            for (const auto& included : it->second) {
+                if (affected.find(included) != affected.end()) {
+                    ++count;
+                }
+            }
+        }
+        countIncludes[key] = count;
+        if (!count) {
+            toVisit.push_back(key);
+        }
+    }
+
+    res.reserve(affected.size());
+    while (!toVisit.empty()) {
+        const auto key = toVisit.front();
+        toVisit.pop_front();
+        res.push_back(key);
+
+        auto it = m_IncludedBy.find(key);
+        if (it != m_IncludedBy.end()) {
+            for (const auto& includer : it->second) {
+                auto itCount = countIncludes.find(includer);
+                if (itCount != countIncludes.end() && itCount->second > 0U) {
+                    if (--itCount->second == 0U) {
+                        toVisit.push_back(includer);
+                    }
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
+bool IncludeGraph::IsRoot(const std::string& vKey) const {
+    return m_IncludedBy.find(vKey) == m_IncludedBy.end();
+}
+
+const std::unordered_set<std::string>* IncludeGraph::GetIncludes(const std::string& vKey) const {
+    auto it = m_Includes.find(vKey);
+    if (it != m_Includes.end())
+        return &it->second;
+    return nullptr;
+}
+
+const std::unordered_set<std::string>* IncludeGraph::GetIncluders(const std::string& vKey) const {
+    auto it = m_IncludedBy.find(vKey);
+    if (it != m_IncludedBy.end())
+        return &it->second;
+    return nullptr;
+}
+
+void IncludeGraph::RemoveIncludes(const std::string& vKey) {
+    auto it = m_Includes.find(vKey);
+    if (it != m_Includes.end()) {
+        for (const auto& included : it->second) {
+            auto itIncluded = m_IncludedBy.find(included);
+            if (itIncluded != m_IncludedBy.end()) {
+                itIncluded->second.erase(vKey);
+                if (itIncluded->second.empty()) {
+                    m_IncludedBy.erase(itIncluded);
+                }
+            }
+        }
+        m_Includes.erase(it);
+    }
+}
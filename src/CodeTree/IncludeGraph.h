@@ -0,0 +1,62 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+// graph of the #include between the keys of the CodeTree (by key name)
+// includer => included and included => includers
+// filled by the parse of the shaders, the edges of a key are rebuilt each time his code is parsed
+class IncludeGraph {
+private:
+    typedef std::unordered_map<std::string, std::unordered_set<std::string>> EdgesMap;
+    EdgesMap m_Includes;                           // key => included keys
+    EdgesMap m_IncludedBy;                         // key => includer keys
+    std::unordered_set<std::string> m_ParsedKeys;  // keys already found by the current parse
+
+public:
+    void Clear();
+
+    // the includes of vRootKey and of his included keys will be found again by the parse
+    void BeginParse(const std::string& vRootKey);
+    void EndParse();
+
+    // return false if the edge would create a cycle, in this case the edge is not added
+    // the code of vIncludedKey will be parsed after that, so his old includes are removed the first time he is found by a parse
+    bool AddInclude(const std::string& vIncluderKey, const std::string& vIncludedKey);
+
+    // true if vToKey can be reached from vFromKey by following the includes
+    bool IsReachable(const std::string& vFromKey, const std::string& vToKey) const;
+
+    void RemoveKey(const std::string& vKey);
+
+    // vKey and all the keys who include it directly or not
+    // sorted by dependency, an included key is always before his includers
+    // each key is present one time
+    std::vector<std::string> GetAffectedKeys(const std::string& vKey) const;
+
+    // the keys who are not included by another one
+    bool IsRoot(const std::string& vKey) const;
+
+    const std::unordered_set<std::string>* GetIncludes(const std::string& vKey) const;
+    const std::unordered_set<std::string>* GetIncluders(const std::string& vKey) const;
+
+private:
+    void RemoveIncludes(const std::string& vKey);
+};
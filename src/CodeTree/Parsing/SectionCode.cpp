@@ -26,8 +26,11 @@
 #include <CodeTree/ShaderKey.h>
 #include <CodeTree/Parsing/UniformParsing.h>
 
+#include <string_view>
+
 // #define VERBOSE_DEBUG
 // #define USE_UNIFORMS_BUFFER
+// #define DEBUG_SECTION_CODE_PARSE
 
 ////////////////////////////////////////////////////////////////////////
 //// pour relativiser les chemins de fichier a l'application ///////////
@@ -175,11 +178,12 @@ void SectionCode::DefineSubSection(const std::string& vNewCode, size_t vStartPos
         std::string _sectionName;
         std::vector<std::string> _inFileBufferNames;
         std::string _absoluteFile = absoluteFile;
-        size_t sl = ct::GetCountOccurenceInSection(vNewCode, 0, vStartPos, '\n');
+        size_t sl = m_Lexer.GetCountLinesBefore(vStartPos);
         size_t slSub = 0;
-        size_t el = ct::GetCountOccurenceInSection(vNewCode, 0, vEndPos, '\n');
+        size_t el = m_Lexer.GetCountLinesBefore(vEndPos);
         size_t elSub = 0;
         bool needToCreateThisSectionEvenIfCodeEmpty = false;
+        std::shared_ptr<UniformParsedStruct> _parsedUniform = nullptr;
         // Section qui ne contient pas de code
         if (vType == "PROJECT" || vType == "FRAMEBUFFER") {
             //_endLine += ct::GetCountOccurence(_extractCode, "\n");
@@ -310,7 +314,7 @@ void SectionCode::DefineSubSection(const std::string& vNewCode, size_t vStartPos
             // donc il faut parser la ligne pour recup le nom de la config. il doit y en avoir un, sinon erreur
 
             if (!_extractCode.empty() && currentType != "NOTE") {
-                auto replaceCode = m_ShaderStageParsing.ParseReplaceCode(m_This, _extractCode, sourceCodeStartLine + sl);
+                auto replaceCode = m_ShaderStageParsing.ParseReplaceCode(m_This, vNewCode, vStartPos, vEndPos, m_Lexer, sourceCodeStartLine + sl);
                 _sectionName = replaceCode.name;
                 pkeyPtr->AddReplaceCode(vParentType, replaceCode, true);
                 m_ReplaceCode = pkeyPtr->GetReplaceCodeByName(vParentType, _sectionName);
@@ -368,6 +372,7 @@ void SectionCode::DefineSubSection(const std::string& vNewCode, size_t vStartPos
 #endif
 
                 pkeyPtr->AddUniformToDataBase(m_This, uniformParsed);
+                _parsedUniform = std::make_shared<UniformParsedStruct>(uniformParsed);
             } else {
                 // format invalide
                 // formatError.uniformMsg = ShaderMsg::SHADER_MSG_ERROR;
@@ -455,6 +460,8 @@ void SectionCode::DefineSubSection(const std::string& vNewCode, size_t vStartPos
                 if (!stageName.empty())
                     _section->stageName = stageName;
 
+                _section->m_ParsedUniform = _parsedUniform;
+
                 // LogVarDebug("l:%u t|pt:%s|%s => inc:%s", (uint32_t)level, vType.c_str(), vParentType.c_str(), (vIsInclude ? "true" : "false"));
 
                 // on propage le forcedSectionName
@@ -495,24 +502,24 @@ bool SectionCode::ParseConfigs(const std::string& codeToParse, size_t& vLastBloc
     // les configs
     size_t nextPos = 0;
     while (nextPos != std::string::npos) {
-        nextPos = ShaderStageParsing::GetTagPos(codeToParse, codeTags.ConfigStartTag, nextPos, false);
+        nextPos = m_Lexer.FindNextTag(ShaderTokenEnum::TOKEN_CONFIG_START, nextPos);
         if (nextPos != std::string::npos) {
-            if (!ShaderStageParsing::IfInCommentZone(codeToParse, nextPos)) {
+            if (!m_Lexer.IsInCommentZone(nextPos)) {
                 // error on peut pas ouvir une config sans fermer la precedente
                 configStartFound = true;
                 size_t posWithoutTag = nextPos;
                 size_t pos = nextPos + codeTags.ConfigStartTag.size();
 
-                size_t sl = ct::GetCountOccurenceInSection(codeToParse, 0, vLastBlockPos, '\n');
-                size_t el = ct::GetCountOccurenceInSection(codeToParse, 0, posWithoutTag, '\n');
+                size_t sl = m_Lexer.GetCountLinesBefore(vLastBlockPos);
+                size_t el = m_Lexer.GetCountLinesBefore(posWithoutTag);
 
                 if (el > sl)  // on fait une section text que si elle fait au moin une ligne
                 {
                     DefineSubSection(codeToParse, vLastBlockPos, posWithoutTag, "TEXT", this->currentType, isInclude);
                 }
 
-                size_t nextOpenTag = ShaderStageParsing::GetTagPos(codeToParse, codeTags.ConfigStartTag, pos, false);
-                nextPos = ShaderStageParsing::GetTagPos(codeToParse, codeTags.ConfigEndTag, pos, false);
+                size_t nextOpenTag = m_Lexer.FindNextTag(ShaderTokenEnum::TOKEN_CONFIG_START, pos);
+                nextPos = m_Lexer.FindNextTag(ShaderTokenEnum::TOKEN_CONFIG_END, pos);
                 if (nextPos != std::string::npos) {
                     if (nextOpenTag != std::string::npos) {
                         if (nextOpenTag < nextPos) {
@@ -520,16 +527,16 @@ bool SectionCode::ParseConfigs(const std::string& codeToParse, size_t& vLastBloc
                                            "Config Syntax Error",
                                            true,
                                            "you must close a config flag, before open a new one",
-                                           ct::GetCountOccurenceInSection(codeToParse, 0, nextOpenTag, '\n') + this->sourceCodeStartLine);
+                                           m_Lexer.GetCountLinesBefore(nextOpenTag) + this->sourceCodeStartLine);
                         }
                     }
-                    if (!ShaderStageParsing::IfInCommentZone(codeToParse, nextPos)) {
+                    if (!m_Lexer.IsInCommentZone(nextPos)) {
                         if (pos) {
-                            sl = ct::GetCountOccurenceInSection(codeToParse, 0, pos, '\n') + this->sourceCodeStartLine;
-                            el = ct::GetCountOccurenceInSection(codeToParse, 0, nextPos, '\n') + this->sourceCodeStartLine;
+                            sl = m_Lexer.GetCountLinesBefore(pos) + this->sourceCodeStartLine;
+                            el = m_Lexer.GetCountLinesBefore(nextPos) + this->sourceCodeStartLine;
 
                             DefineSubSection(codeToParse, pos, nextPos, "CONFIG", this->currentType, isInclude);
-                            vLastBlockPos = ShaderStageParsing::GetTagPos(codeToParse, "\n", nextPos + codeTags.ConfigEndTag.size());
+                            vLastBlockPos = m_Lexer.GetNextLinePos(nextPos + codeTags.ConfigEndTag.size());
                             if (vLastBlockPos != std::string::npos)
                                 ++vLastBlockPos;
                             else
@@ -554,14 +561,16 @@ bool SectionCode::ParseIncludes(const std::string& codeToParse, size_t& vLastBlo
     // lastBlockPos = 0;
     size_t nextPos = 0;
     while (nextPos != std::string::npos) {
-        nextPos = ShaderStageParsing::GetTagPos(codeToParse, codeTags.IncludeWordTag, nextPos, false);
+        nextPos = m_Lexer.FindNextTag(ShaderTokenEnum::TOKEN_INCLUDE, nextPos);
         if (nextPos != std::string::npos) {
-            if (!ShaderStageParsing::IfInCommentZone(codeToParse, nextPos)) {
+            if (!m_Lexer.IsInCommentZone(nextPos)) {
                 includeFound = true;
 
                 size_t posWithoutTag = nextPos;
                 size_t pos = nextPos + codeTags.IncludeWordTag.size();
-                size_t firstQuote = ShaderStageParsing::GetTagPos(codeToParse, "\"", pos);  // pour l'incluison de includeFile
+                size_t firstQuote = codeToParse.find('"', pos);  // pour l'incluison de includeFile
+                if (firstQuote != std::string::npos && m_Lexer.IsInCommentZone(firstQuote))
+                    firstQuote = std::string::npos;
                 if (firstQuote != std::string::npos) {
                     // firstQuote += 1;
                     size_t endQuote = codeToParse.find_first_of("\"\n", firstQuote + 1);
@@ -571,14 +580,14 @@ bool SectionCode::ParseIncludes(const std::string& codeToParse, size_t& vLastBlo
                                            "Include Syntax Error",
                                            true,
                                            "you must quote the include file on the same line.",
-                                           ct::GetCountOccurenceInSection(codeToParse, 0, pos, '\n') + this->sourceCodeStartLine);
+                                           m_Lexer.GetCountLinesBefore(pos) + this->sourceCodeStartLine);
                         } else {
                             // le char \n => fin de ligne
                             // le char / => un commentaire
                             endQuote = codeToParse.find_first_of("/\n", endQuote + 1);
                             if (endQuote != std::string::npos) {
-                                size_t sl = ct::GetCountOccurenceInSection(codeToParse, 0, vLastBlockPos, '\n');
-                                size_t el = ct::GetCountOccurenceInSection(codeToParse, 0, posWithoutTag, '\n');
+                                size_t sl = m_Lexer.GetCountLinesBefore(vLastBlockPos);
+                                size_t el = m_Lexer.GetCountLinesBefore(posWithoutTag);
 
                                 if (el > sl)  // on fait une section text que si elle fait au moin une ligne
                                 {
@@ -587,7 +596,7 @@ bool SectionCode::ParseIncludes(const std::string& codeToParse, size_t& vLastBlo
 
                                 DefineSubSection(codeToParse, firstQuote, endQuote, "INCLUDE", this->currentType, true);
 
-                                vLastBlockPos = ShaderStageParsing::GetTagPos(codeToParse, "\n", endQuote);
+                                vLastBlockPos = m_Lexer.GetNextLinePos(endQuote);
                                 if (vLastBlockPos != std::string::npos)
                                     ++vLastBlockPos;
                                 else
@@ -600,7 +609,7 @@ bool SectionCode::ParseIncludes(const std::string& codeToParse, size_t& vLastBlo
                                    "Include Syntax Error",
                                    true,
                                    "you must quote the include file.",
-                                   ct::GetCountOccurenceInSection(codeToParse, 0, pos, '\n') + this->sourceCodeStartLine);
+                                   m_Lexer.GetCountLinesBefore(pos) + this->sourceCodeStartLine);
                 }
             }
 
@@ -618,12 +627,12 @@ bool SectionCode::ParseUniforms(const std::string& codeToParse, size_t& vLastBlo
 
     size_t nextPos = 0;
     while (nextPos != std::string::npos) {
-        nextPos = ShaderStageParsing::GetTagPos(codeToParse, codeTags.UniformWordTag, nextPos, false);
+        nextPos = m_Lexer.FindNextTag(ShaderTokenEnum::TOKEN_UNIFORM, nextPos);
         if (nextPos != std::string::npos) {
             size_t endUniformWordTagPos = nextPos + codeTags.UniformWordTag.size();
             size_t isUniformsPos = codeToParse.find_first_of("\t (\n", endUniformWordTagPos);
             if (isUniformsPos == endUniformWordTagPos) {
-                if (!ShaderStageParsing::IfInCommentZone(codeToParse, nextPos)) {
+                if (!m_Lexer.IsInCommentZone(nextPos)) {
                     uniformFound = true;
 
                     size_t coma_pos = codeToParse.find(';', nextPos);
@@ -631,8 +640,14 @@ bool SectionCode::ParseUniforms(const std::string& codeToParse, size_t& vLastBlo
                         // on test si cet uniform est layouté et bindé comme dans un compute
                         // dans ce cas on va pas l'utliser et le laisser tel quel dans le code
 
-                        size_t pos_layout = codeToParse.rfind("layout", nextPos);
-                        size_t pos_binding = codeToParse.rfind("binding", nextPos);
+                        size_t pos_layout = m_Lexer.FindPreviousTag(ShaderTokenEnum::TOKEN_LAYOUT, nextPos);
+                        size_t pos_binding = std::string::npos;
+                        if (pos_layout != std::string::npos) {
+                            // binding is only searched between the layout and the uniform
+                            size_t binding = std::string_view(codeToParse).substr(pos_layout, nextPos - pos_layout).find("binding");
+                            if (binding != std::string::npos)
+                                pos_binding = pos_layout + binding;
+                        }
                         if (pos_layout != std::string::npos && pos_binding != std::string::npos) {
                             size_t last_coma_pos = codeToParse.rfind(';', nextPos);
                             if (last_coma_pos == std::string::npos)
@@ -648,8 +663,8 @@ bool SectionCode::ParseUniforms(const std::string& codeToParse, size_t& vLastBlo
                             if (first_endline_pos != std::string::npos) {
                                 first_endline_pos += 1;
 
-                                size_t sl = ct::GetCountOccurenceInSection(codeToParse, 0, vLastBlockPos, '\n');
-                                size_t el = ct::GetCountOccurenceInSection(codeToParse, 0, nextPos, '\n');
+                                size_t sl = m_Lexer.GetCountLinesBefore(vLastBlockPos);
+                                size_t el = m_Lexer.GetCountLinesBefore(nextPos);
 
                                 if (el > sl)  // on fait une section text que si elle fait au moin une ligne
                                 {
@@ -679,25 +694,25 @@ bool SectionCode::ParseReplaceCode(const std::string& codeToParse, size_t& vLast
     // les configs
     size_t nextPos = 0;
     while (nextPos != std::string::npos) {
-        nextPos = ShaderStageParsing::GetTagPos(codeToParse, codeTags.CodeToReplaceStartTag, nextPos, false);
+        nextPos = m_Lexer.FindNextTag(ShaderTokenEnum::TOKEN_REPLACE_START, nextPos);
         if (nextPos != std::string::npos) {
-            if (!ShaderStageParsing::IfInCommentZone(codeToParse, nextPos) && stageName != "NOTE") {
+            if (!m_Lexer.IsInCommentZone(nextPos) && stageName != "NOTE") {
                 // error on peut pas ouvir un replace code sans fermer le precedent
                 replaceCodeStartFound = true;
 
                 size_t posWithoutTag = nextPos;
                 size_t pos = nextPos + codeTags.CodeToReplaceStartTag.size();
 
-                size_t sl = ct::GetCountOccurenceInSection(codeToParse, 0, vLastBlockPos, '\n');
-                size_t el = ct::GetCountOccurenceInSection(codeToParse, 0, posWithoutTag, '\n');
+                size_t sl = m_Lexer.GetCountLinesBefore(vLastBlockPos);
+                size_t el = m_Lexer.GetCountLinesBefore(posWithoutTag);
 
                 if (el > sl)  // on fait une section text que si elle fait au moin une ligne
                 {
                     DefineSubSection(codeToParse, vLastBlockPos, posWithoutTag, "TEXT", this->currentType, isInclude);
                 }
 
-                auto nextOpenTag = ShaderStageParsing::GetTagPos(codeToParse, codeTags.CodeToReplaceStartTag, pos, false);
-                nextPos = ShaderStageParsing::GetTagPos(codeToParse, codeTags.CodeToReplaceEndTag, pos, false);
+                auto nextOpenTag = m_Lexer.FindNextTag(ShaderTokenEnum::TOKEN_REPLACE_START, pos);
+                nextPos = m_Lexer.FindNextTag(ShaderTokenEnum::TOKEN_REPLACE_END, pos);
                 if (nextPos != std::string::npos) {
                     if (nextOpenTag != std::string::npos) {
                         if (nextOpenTag < nextPos) {
@@ -705,17 +720,17 @@ bool SectionCode::ParseReplaceCode(const std::string& codeToParse, size_t& vLast
                                            "Replace Code Syntax Error",
                                            true,
                                            "you must close a Replace flag, before open a new one",
-                                           ct::GetCountOccurenceInSection(codeToParse, 0, nextOpenTag, '\n') + this->sourceCodeStartLine);
+                                           m_Lexer.GetCountLinesBefore(nextOpenTag) + this->sourceCodeStartLine);
                         }
                     }
-                    if (!ShaderStageParsing::IfInCommentZone(codeToParse, nextPos)) {
+                    if (!m_Lexer.IsInCommentZone(nextPos)) {
                         if (pos) {
-                            sl = ct::GetCountOccurenceInSection(codeToParse, 0, pos, '\n') + this->sourceCodeStartLine;
-                            el = ct::GetCountOccurenceInSection(codeToParse, 0, nextPos, '\n') + this->sourceCodeStartLine;
+                            sl = m_Lexer.GetCountLinesBefore(pos) + this->sourceCodeStartLine;
+                            el = m_Lexer.GetCountLinesBefore(nextPos) + this->sourceCodeStartLine;
 
                             DefineSubSection(codeToParse, pos, nextPos, "REPLACE_CODE", this->currentType, isInclude);
 
-                            vLastBlockPos = ShaderStageParsing::GetTagPos(codeToParse, "\n", nextPos + codeTags.CodeToReplaceEndTag.size());
+                            vLastBlockPos = m_Lexer.GetNextLinePos(nextPos + codeTags.CodeToReplaceEndTag.size());
                             if (vLastBlockPos != std::string::npos)
                                 ++vLastBlockPos;
                             else
@@ -754,7 +769,9 @@ bool SectionCode::ParseFragColorLayouts(const std::string& codeToParse) {
         if (pkeyPtr.use_count()) {
             size_t nextPos = 0;
             while (nextPos != std::string::npos) {
-                nextPos = ShaderStageParsing::GetTagPos(codeToParse, codeTags.LayoutWordTag, nextPos, true);
+                nextPos = m_Lexer.FindNextTag(ShaderTokenEnum::TOKEN_LAYOUT, nextPos);
+                if (nextPos != std::string::npos && m_Lexer.IsInCommentZone(nextPos))
+                    nextPos = std::string::npos;
                 if (nextPos != std::string::npos) {
                     size_t endLinePos = codeToParse.find(';', nextPos);
                     if (endLinePos != std::string::npos) {
@@ -792,6 +809,7 @@ bool SectionCode::ParseFragColorLayouts(const std::string& codeToParse) {
                                                     auto _name = _code.substr(firstChar, endSpaceOrSemiColon - firstChar);
 
                                                     pkeyPtr->AddFragColorName(locationID, _name);
+                                                    m_FragColorNames[locationID] = _name;
                                                 }
                                             }
                                         }
@@ -812,28 +830,26 @@ bool SectionCode::ParseFragColorLayouts(const std::string& codeToParse) {
     return layoutFound;
 }
 
-inline std::map<size_t, std::string> GetSectionsFromCode(const std::string vCode, CodeTagStruct vCodeTags) {
-    std::map<size_t, std::string> sections;
-
-    size_t lastFound = 0;
-
-    while (lastFound != std::string::npos) {
-        auto tag = ShaderStageParsing::GetTagIfFound(vCode, lastFound, &lastFound, true);
-        if (!tag.empty()) {
-            sections[lastFound] = tag;
-        }
-
-        if (lastFound != std::string::npos)
-            ++lastFound;
-    }
-
-    return sections;
-}
-
 void SectionCode::Parse() {
     if (!code.empty()) {
         Clear();
 
+        m_FragColorNames.clear();
+        m_HaveSyntaxErrors = false;
+
+        // si le meme code a deja ete parse dans le meme contexte, on reprend son arbre
+        SectionCodeParseCache* parseCachePtr = nullptr;
+        uint64_t parseHash = 0U;
+        auto pkeyPtr = parentKey.lock();
+        if (pkeyPtr && pkeyPtr->puSectionCodeParseCache.IsEnabled()) {
+            parseCachePtr = &pkeyPtr->puSectionCodeParseCache;
+            parseHash = GetParseHash();
+            if (ReuseParsedSection(parseCachePtr->Take(m_This, parseHash), pkeyPtr)) {
+                StoreParsedSection(parseCachePtr);
+                return;
+            }
+        }
+
         std::string codeToParse = code;
 
         // on va remplacer les blocks CodeInsert avant le parse.
@@ -841,13 +857,18 @@ void SectionCode::Parse() {
         // pour pas changer le code qui sert dans le processus de maj
         // std::string codeToParse = parentKey->CompleteShaderCodeWithReplaceCode(code);
 
+#ifdef DEBUG_SECTION_CODE_PARSE
         FileHelper::Instance()->SaveToFile(codeToParse, "SectionCode_Parse.glsl", (int)FILE_LOCATION_Enum::FILE_LOCATION_DEBUG);
+#endif
 
         if (codeToParse == "#include \"bin\\scripts\\kifs\\ifs.glsl\":@SDF\n") {
             // CTOOL_DEBUG_BREAK;
         }
 
-        auto sections = GetSectionsFromCode(codeToParse, codeTags);
+        // one pass on the code, the parse functions will use the tag index
+        m_Lexer.Lex(codeToParse);
+
+        auto sections = m_Lexer.GetSections();
         if (!sections.empty()) {
             // pour faire une iteration de plus pour parser le dernier bloc
             sections[codeToParse.size()] = "FULL";
@@ -892,12 +913,150 @@ void SectionCode::Parse() {
             }
         }
 
+        // not needed anymore, the sub sections have their own code
+        m_Lexer.Clear();
+
         // parse sub sections
         for (auto subSection : subSections) {
             for (auto it2 : subSection.second) {
                 it2->Parse();
             }
         }
+
+        if (parseCachePtr && IsParseReusable()) {
+            parseCachePtr->Store(m_This, parseHash);
+        }
+    }
+}
+
+bool SectionCode::IsSameParseContext(const std::shared_ptr<SectionCode>& vSection) const {
+    if (!vSection)
+        return false;
+
+    return isInclude == vSection->isInclude &&                  //
+           level == vSection->level &&                          //
+           currentType == vSection->currentType &&              //
+           parentType == vSection->parentType &&                //
+           stageName == vSection->stageName &&                  //
+           name == vSection->name &&                            //
+           inFileBufferName == vSection->inFileBufferName &&    //
+           forcedSectionName == vSection->forcedSectionName &&  //
+           forcedStageName == vSection->forcedStageName &&      //
+           absoluteFile == vSection->absoluteFile &&            //
+           relativeFile == vSection->relativeFile &&            //
+           code == vSection->code;
+}
+
+// fnv-1a 64
+static inline uint64_t SectionCode_Hash(uint64_t vHash, const std::string& vStr) {
+    for (const auto& c : vStr) {
+        vHash ^= (uint64_t)(uint8_t)c;
+        vHash *= 1099511628211ULL;
+    }
+    vHash ^= 0xFFULL;
+    vHash *= 1099511628211ULL;
+    return vHash;
+}
+
+uint64_t SectionCode::GetParseHash() const {
+    uint64_t hash = 14695981039346656037ULL;
+    hash = SectionCode_Hash(hash, currentType);
+    hash = SectionCode_Hash(hash, parentType);
+    hash = SectionCode_Hash(hash, name);
+    hash = SectionCode_Hash(hash, inFileBufferName);
+    hash = SectionCode_Hash(hash, relativeFile);
+    hash = SectionCode_Hash(hash, code);
+    return hash;
+}
+
+// le parse ne doit avoir donne a la key que des choses qu'on sait rejouer
+// (stage names, uniforms et frag color names), donc pas de config, include ou replace code
+bool SectionCode::IsParseReusable() const {
+    if (m_HaveSyntaxErrors || currentType == "REPLACE_CODE")
+        return false;
+
+    for (const auto& subSection : subSections) {
+        for (const auto& sec : subSection.second) {
+            if (!sec)
+                return false;
+            if (sec->currentType != "TEXT" && sec->currentType != "UNIFORM")
+                return false;
+            if (!sec->IsParseReusable())
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool SectionCode::ReuseParsedSection(std::shared_ptr<SectionCode> vParsedSection, std::shared_ptr<ShaderKey> vKey) {
+    if (!vParsedSection || !vKey)
+        return false;
+
+    // the code can have moved in the file
+    const int64_t delta = (int64_t)sourceCodeStartLine - (int64_t)vParsedSection->sourceCodeStartLine;
+
+    subSections = std::move(vParsedSection->subSections);
+    vParsedSection->subSections.clear();
+    orphan = vParsedSection->orphan;
+    m_FragColorNames = vParsedSection->m_FragColorNames;
+
+    for (auto& subSection : subSections) {
+        for (auto& sec : subSection.second) {
+            sec->parentSection = m_This;
+            sec->ShiftSourceLines(delta);
+        }
+    }
+
+    ReplayParse(vKey);
+
+    return true;
+}
+
+void SectionCode::ReplayParse(std::shared_ptr<ShaderKey> vKey) {
+    for (const auto& fragColor : m_FragColorNames) {
+        vKey->AddFragColorName(fragColor.first, fragColor.second);
+    }
+
+    for (const auto& subSection : subSections) {
+        for (const auto& sec : subSection.second) {
+            // like in DefineSubSection
+            vKey->AddShaderStageName(sec->currentType);
+            if (sec->m_ParsedUniform) {
+                if (isInclude && vKey->puParentCodeTree) {
+                    vKey->puParentCodeTree->AddUniformNameForIncludeFile(sec->m_ParsedUniform->name, relativeFile);
+                }
+                vKey->AddUniformToDataBase(m_This, *sec->m_ParsedUniform);
+            }
+            sec->ReplayParse(vKey);
+        }
+    }
+}
+
+void SectionCode::StoreParsedSection(SectionCodeParseCache* vParseCache) {
+    if (!vParseCache)
+        return;
+
+    vParseCache->Store(m_This, GetParseHash());
+    for (const auto& subSection : subSections) {
+        for (const auto& sec : subSection.second) {
+            sec->StoreParsedSection(vParseCache);
+        }
+    }
+}
+
+void SectionCode::ShiftSourceLines(int64_t vDelta) {
+    sourceCodeStartLine = (size_t)((int64_t)sourceCodeStartLine + vDelta);
+    sourceCodeEndLine = (size_t)((int64_t)sourceCodeEndLine + vDelta);
+    finalCodeStartLine.clear();
+    finalCodeEndLine.clear();
+    if (m_ParsedUniform) {
+        m_ParsedUniform->sourceCodeLine = (size_t)((int64_t)m_ParsedUniform->sourceCodeLine + vDelta);
+    }
+    for (auto& subSection : subSections) {
+        for (auto& sec : subSection.second) {
+            sec->ShiftSourceLines(vDelta);
+        }
     }
 }
 
@@ -1099,6 +1258,7 @@ void SectionCode::SetSyntaxError(const std::string& vKey, const std::string& vEr
 }
 
 void SectionCode::SetSyntaxError(std::weak_ptr<ShaderKey> vKey, const std::string& vErrorType, bool vErrorOrWarnings, const std::string& vError, size_t vLine) {
+    m_HaveSyntaxErrors = true;  // a parse with errors is never reused
     auto vKeyPtr = vKey.lock();
     if (vKeyPtr.use_count()) {
         auto pkeyPtr = parentKey.lock();
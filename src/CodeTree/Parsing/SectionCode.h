@@ -19,10 +19,15 @@
 #include <uTypes/uTypes.h>
 #include <CodeTree/CodeTreeGlobals.h>
 #include <CodeTree/Parsing/ShaderStageParsing.h>
+#include <CodeTree/Parsing/ShaderCodeLexer.h>
+#include <CodeTree/Parsing/SectionCodeParseCache.h>
 
 #include <string>
+#include <memory>
 #include <map>
 
+struct UniformParsedStruct;
+
 struct FormatErrorStruct {
     size_t line = 0;
     std::string file;
@@ -114,6 +119,7 @@ public:
 
     ShaderSectionConfig m_ShaderSectionConfig;
     ShaderStageParsing m_ShaderStageParsing;
+    ShaderCodeLexer m_Lexer;  // tags, comment zones and lines of the code in parse
 
     std::weak_ptr<ShaderKey> parentKey;
 
@@ -146,6 +152,11 @@ public:
     std::map<std::string, size_t> finalCodeStartLine;
     std::map<std::string, size_t> finalCodeEndLine;
 
+    // garde ce que le parse a donne a la key, pour le rejouer si la section est reutilisee (voir SectionCodeParseCache)
+    std::shared_ptr<UniformParsedStruct> m_ParsedUniform = nullptr;  // only for an UNIFORM section
+    std::map<uint8_t, std::string> m_FragColorNames;                 // found by ParseFragColorLayouts
+    bool m_HaveSyntaxErrors = false;
+
 public:
     static std::shared_ptr<SectionCode> Create();
     static std::shared_ptr<SectionCode> Create(ShaderKeyPtr vParentkey,
@@ -198,7 +209,16 @@ public:
     void SetSyntaxError(const std::string& vKey, const std::string& vErrorType, bool vErrorOrWarnings, const std::string& vError, size_t vLine);
     void SetSyntaxError(std::weak_ptr<ShaderKey> vKey, const std::string& vErrorType, bool vErrorOrWarnings, const std::string& vError, size_t vLine);
 
+    // same code and same context, so same parse result
+    bool IsSameParseContext(const std::shared_ptr<SectionCode>& vSection) const;
+
 private:
+    uint64_t GetParseHash() const;
+    bool IsParseReusable() const;
+    bool ReuseParsedSection(std::shared_ptr<SectionCode> vParsedSection, std::shared_ptr<ShaderKey> vKey);
+    void ReplayParse(std::shared_ptr<ShaderKey> vKey);
+    void StoreParsedSection(SectionCodeParseCache* vParseCache);
+    void ShiftSourceLines(int64_t vDelta);
     bool ParseConfigs(const std::string& codeToParse, size_t& vLastBlockPos);
     bool ParseIncludes(const std::string& codeToParse, size_t& vLastBlockPos);
     bool ParseUniforms(const std::string& codeToParse, size_t& vLastBlockPos);
@@ -0,0 +1,76 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "SectionCodeParseCache.h"
+
+#include <CodeTree/Parsing/SectionCode.h>
+
+void SectionCodeParseCache::SetEnabled(bool vEnabled) {
+    m_Enabled = vEnabled;
+    if (!m_Enabled) {
+        Clear();
+    }
+}
+
+bool SectionCodeParseCache::IsEnabled() const {
+    return m_Enabled;
+}
+
+void SectionCodeParseCache::BeginParse() {
+    m_Previous = std::move(m_Current);
+    m_Current.clear();
+}
+
+void SectionCodeParseCache::EndParse() {
+    m_Previous.clear();
+}
+
+void SectionCodeParseCache::Clear() {
+    m_Previous.clear();
+    m_Current.clear();
+}
+
+std::shared_ptr<SectionCode> SectionCodeParseCache::Take(const std::shared_ptr<SectionCode>& vSection, uint64_t vHash) {
+    if (!m_Enabled || !vSection)
+        return nullptr;
+
+    auto it = m_Previous.find(vHash);
+    if (it != m_Previous.end()) {
+        auto& candidates = it->second;
+        for (auto itSec = candidates.begin(); itSec != candidates.end(); ++itSec) {
+            // the hash is only for the bucket, the code and the context are compared
+            if (*itSec != vSection && (*itSec)->IsSameParseContext(vSection)) {
+                auto res = *itSec;
+                candidates.erase(itSec);
+                if (candidates.empty()) {
+                    m_Previous.erase(it);
+                }
+                return res;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+void SectionCodeParseCache::Store(const std::shared_ptr<SectionCode>& vSection, uint64_t vHash) {
+    if (!m_Enabled || !vSection)
+        return;
+
+    m_Current[vHash].push_back(vSection);
+}
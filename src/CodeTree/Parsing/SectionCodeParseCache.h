@@ -0,0 +1,49 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+class SectionCode;
+
+// memo of the parsed sections of a ShaderKey, by content hash
+// the sections of the previous parse who have the same code and the same context can give their sub tree to the new one
+// only the sub trees of TEXT and UNIFORM sections are stored, the others have side effects on the key (configs, includes, replace code)
+class SectionCodeParseCache {
+private:
+    typedef std::unordered_map<uint64_t, std::vector<std::shared_ptr<SectionCode>>> SectionsByHash;
+    SectionsByHash m_Previous;  // sections of the previous parse, not yet reused
+    SectionsByHash m_Current;   // sections of the parse in progress
+    bool m_Enabled = true;
+
+public:
+    void SetEnabled(bool vEnabled);
+    bool IsEnabled() const;
+
+    // the sections of the last parse become the candidates for the new one
+    void BeginParse();
+    // the not reused sections are released
+    void EndParse();
+    void Clear();
+
+    // return a section of the previous parse with the same code and context than vSection, or nullptr
+    // a section can be taken only one time
+    std::shared_ptr<SectionCode> Take(const std::shared_ptr<SectionCode>& vSection, uint64_t vHash);
+    void Store(const std::shared_ptr<SectionCode>& vSection, uint64_t vHash);
+};
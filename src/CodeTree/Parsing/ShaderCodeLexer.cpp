@@ -0,0 +1,306 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "ShaderCodeLexer.h"
+
+#include <CodeTree/Parsing/SectionCode.h>
+
+#include <algorithm>
+
+enum class ShaderLexerStateEnum : uint8_t { LEXER_STATE_CODE = 0, LEXER_STATE_LINE_COMMENT, LEXER_STATE_BLOCK_COMMENT, LEXER_STATE_STRING };
+
+static inline bool ShaderCodeLexer_IsTagAt(const std::string& vCode, size_t vPos, const std::string& vTag) {
+    return vCode.compare(vPos, vTag.size(), vTag) == 0;
+}
+
+ShaderCodeLexer::ShaderCodeLexer(const std::string& vCode) {
+    Lex(vCode);
+}
+
+void ShaderCodeLexer::Clear() {
+    m_Tokens.clear();
+    for (auto& index : m_TagIndex) {
+        index.clear();
+    }
+    m_CommentZones.clear();
+    m_NewLines.clear();
+    m_CodeSize = 0U;
+}
+
+void ShaderCodeLexer::Lex(const std::string& vCode) {
+    Clear();
+
+    const auto& tags = SectionCode::codeTags;
+
+    m_CodeSize = vCode.size();
+
+    // section tags who are on the same line of an #include, like #include "shader.glsl":@SDF
+    std::vector<size_t> sectionsOnIncludeLine;
+    size_t lastIncludeLine = std::string::npos;
+
+    auto state = ShaderLexerStateEnum::LEXER_STATE_CODE;
+    size_t zoneStart = 0U;
+
+    size_t i = 0U;
+    while (i < m_CodeSize) {
+        const char c = vCode[i];
+        const char n = (i + 1U < m_CodeSize) ? vCode[i + 1U] : '\0';
+
+        // the tags are searched in all states, the comment state is resolved after
+        // like the old parser who was doing a find then a check of the comment zone
+        switch (c) {
+            case '@': {
+                if (ShaderCodeLexer_IsTagAt(vCode, i, tags.ConfigStartTag)) {
+                    AddToken(ShaderTokenEnum::TOKEN_CONFIG_START, i, tags.ConfigStartTag.size());
+                } else if (ShaderCodeLexer_IsTagAt(vCode, i, tags.ConfigEndTag)) {
+                    AddToken(ShaderTokenEnum::TOKEN_CONFIG_END, i, tags.ConfigEndTag.size());
+                }
+
+                // la on est sur un include, ex : #include "shader.glsl":@SDF
+                if (i > 0U && vCode[i - 1U] == ':')
+                    break;
+
+                size_t endTag = vCode.find_first_of(" \n\t\r", i + 1U);
+                if (endTag == std::string::npos)  // then end of file
+                    endTag = m_CodeSize;
+
+                if (endTag > i + 1U) {
+                    auto tag = vCode.substr(i, endTag - i);
+                    // il y a des tags qui sont speciaux et que nous devons echapper
+                    if (tag != tags.ConfigStartTag && tag != tags.ConfigEndTag &&  //
+                        tag != tags.BufferStartTag && tag != tags.BufferEndTag) {
+                        if (lastIncludeLine == m_NewLines.size()) {
+                            sectionsOnIncludeLine.push_back(i);
+                        }
+                        AddToken(ShaderTokenEnum::TOKEN_SECTION, i, tag.size(), tag.substr(1U));
+                    }
+                }
+                break;
+            }
+            case '#': {
+                if (ShaderCodeLexer_IsTagAt(vCode, i, tags.IncludeWordTag)) {
+                    AddToken(ShaderTokenEnum::TOKEN_INCLUDE, i, tags.IncludeWordTag.size());
+                    lastIncludeLine = m_NewLines.size();
+                }
+                break;
+            }
+            case 'u': {
+                if (ShaderCodeLexer_IsTagAt(vCode, i, tags.UniformWordTag)) {
+                    AddToken(ShaderTokenEnum::TOKEN_UNIFORM, i, tags.UniformWordTag.size());
+                }
+                break;
+            }
+            case 'l': {
+                if (ShaderCodeLexer_IsTagAt(vCode, i, tags.LayoutWordTag)) {
+                    AddToken(ShaderTokenEnum::TOKEN_LAYOUT, i, tags.LayoutWordTag.size());
+                }
+                break;
+            }
+            case '[': {
+                if (ShaderCodeLexer_IsTagAt(vCode, i, tags.CodeToReplaceStartTag)) {
+                    AddToken(ShaderTokenEnum::TOKEN_REPLACE_START, i, tags.CodeToReplaceStartTag.size());
+                }
+                break;
+            }
+            case ']': {
+                if (ShaderCodeLexer_IsTagAt(vCode, i, tags.CodeToReplaceEndTag)) {
+                    AddToken(ShaderTokenEnum::TOKEN_REPLACE_END, i, tags.CodeToReplaceEndTag.size());
+                }
+                break;
+            }
+            default: break;
+        }
+
+        if (c == '\n') {
+            m_NewLines.push_back(i);
+        }
+
+        switch (state) {
+            case ShaderLexerStateEnum::LEXER_STATE_CODE: {
+                if (c == '/' && n == '/') {
+                    state = ShaderLexerStateEnum::LEXER_STATE_LINE_COMMENT;
+                    zoneStart = i;
+                    i += 2U;
+                    continue;
+                } else if (c == '/' && n == '*') {
+                    state = ShaderLexerStateEnum::LEXER_STATE_BLOCK_COMMENT;
+                    zoneStart = i;
+                    i += 2U;
+                    continue;
+                } else if (c == '"') {
+                    // only in preprocessor lines, like #include "//server/shader.glsl"
+                    state = ShaderLexerStateEnum::LEXER_STATE_STRING;
+                }
+                break;
+            }
+            case ShaderLexerStateEnum::LEXER_STATE_LINE_COMMENT: {
+                if (c == '\n') {
+                    // the // himself is not in the zone
+                    m_CommentZones.emplace_back(zoneStart + 1U, i);
+                    state = ShaderLexerStateEnum::LEXER_STATE_CODE;
+                }
+                break;
+            }
+            case ShaderLexerStateEnum::LEXER_STATE_BLOCK_COMMENT: {
+                if (c == '*' && n == '/') {
+                    // the * of */ is in the zone, not the /
+                    m_CommentZones.emplace_back(zoneStart, i + 1U);
+                    state = ShaderLexerStateEnum::LEXER_STATE_CODE;
+                    i += 2U;
+                    continue;
+                }
+                break;
+            }
+            case ShaderLexerStateEnum::LEXER_STATE_STRING: {
+                if (c == '"' || c == '\n') {
+                    state = ShaderLexerStateEnum::LEXER_STATE_CODE;
+                }
+                break;
+            }
+            default: break;
+        }
+
+        ++i;
+    }
+
+    // a line comment can end the file
+    // but a not closed block comment is not a comment zone (the gpu driver will complain)
+    if (state == ShaderLexerStateEnum::LEXER_STATE_LINE_COMMENT) {
+        m_CommentZones.emplace_back(zoneStart + 1U, m_CodeSize + 1U);
+    }
+
+    // resolve the comment state, and remove the section tags who are not valid
+    std::vector<ShaderTokenStruct> tokens;
+    tokens.reserve(m_Tokens.size());
+    for (auto& token : m_Tokens) {
+        token.inComment = IsInCommentZone(token.pos);
+        if (token.type == ShaderTokenEnum::TOKEN_SECTION) {
+            // the old parser was checking after the @
+            if (IsInCommentZone(token.pos + 1U))
+                continue;
+            if (std::binary_search(sectionsOnIncludeLine.begin(), sectionsOnIncludeLine.end(), token.pos))
+                continue;
+        }
+        m_TagIndex[(size_t)token.type].push_back(token.pos);
+        tokens.push_back(std::move(token));
+    }
+    m_Tokens = std::move(tokens);
+}
+
+const std::vector<ShaderTokenStruct>& ShaderCodeLexer::GetTokens() const {
+    return m_Tokens;
+}
+
+size_t ShaderCodeLexer::FindNextTag(ShaderTokenEnum vType, size_t vStartPos) const {
+    if (vType == ShaderTokenEnum::TOKEN_Count || vStartPos == std::string::npos)
+        return std::string::npos;
+
+    const auto& index = m_TagIndex[(size_t)vType];
+    auto it = std::lower_bound(index.begin(), index.end(), vStartPos);
+    if (it != index.end())
+        return *it;
+
+    return std::string::npos;
+}
+
+size_t ShaderCodeLexer::FindPreviousTag(ShaderTokenEnum vType, size_t vPos) const {
+    if (vType == ShaderTokenEnum::TOKEN_Count)
+        return std::string::npos;
+
+    const auto& index = m_TagIndex[(size_t)vType];
+    auto it = std::upper_bound(index.begin(), index.end(), vPos);
+    if (it != index.begin())
+        return *(--it);
+
+    return std::string::npos;
+}
+
+bool ShaderCodeLexer::IsInCommentZone(size_t vPos) const {
+    // first zone starting after vPos, the previous one is the candidate
+    auto it = std::upper_bound(m_CommentZones.begin(), m_CommentZones.end(), vPos, [](size_t vValue, const std::pair<size_t, size_t>& vZone) {
+        return vValue < vZone.first;
+    });
+    if (it != m_CommentZones.begin()) {
+        --it;
+        return vPos < it->second;
+    }
+    return false;
+}
+
+size_t ShaderCodeLexer::GetNextLinePos(size_t vStartPos) const {
+    if (vStartPos == std::string::npos)
+        return std::string::npos;
+
+    auto it = std::lower_bound(m_NewLines.begin(), m_NewLines.end(), vStartPos);
+    if (it != m_NewLines.end()) {
+        if (!IsInCommentZone(*it)) {
+            return *it;
+        }
+    }
+
+    return std::string::npos;
+}
+
+size_t ShaderCodeLexer::FindNextNewLine(size_t vStartPos) const {
+    if (vStartPos == std::string::npos)
+        return std::string::npos;
+
+    auto it = std::lower_bound(m_NewLines.begin(), m_NewLines.end(), vStartPos);
+    if (it != m_NewLines.end())
+        return *it;
+
+    return std::string::npos;
+}
+
+size_t ShaderCodeLexer::GetCountLinesBefore(size_t vPos) const {
+    return (size_t)(std::lower_bound(m_NewLines.begin(), m_NewLines.end(), vPos) - m_NewLines.begin());
+}
+
+std::map<size_t, std::string> ShaderCodeLexer::GetSections() const {
+    std::map<size_t, std::string> sections;
+
+    for (const auto& token : m_Tokens) {
+        if (token.type == ShaderTokenEnum::TOKEN_SECTION) {
+            sections[token.pos] = token.word;
+        }
+    }
+
+    return sections;
+}
+
+size_t ShaderCodeLexer::FindWordTag(const std::string& vCode, const std::string& vTag, size_t vStartPos) {
+    size_t tagPos = vCode.find(vTag, vStartPos);
+    if (tagPos != std::string::npos) {
+        size_t endTag = tagPos + vTag.size();
+        if (endTag < vCode.size()) {
+            if (vCode[endTag] != ' ' && vCode[endTag] != '\n' && vCode[endTag] != '\t') {
+                tagPos = std::string::npos;
+            }
+        }
+    }
+    return tagPos;
+}
+
+void ShaderCodeLexer::AddToken(ShaderTokenEnum vType, size_t vPos, size_t vSize, const std::string& vWord) {
+    ShaderTokenStruct token;
+    token.type = vType;
+    token.pos = vPos;
+    token.size = vSize;
+    token.word = vWord;
+    m_Tokens.push_back(token);
+}
@@ -0,0 +1,89 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+enum class ShaderTokenEnum : uint8_t {
+    TOKEN_SECTION = 0,    // @FRAGMENT, @VERTEX, @UNIFORMS, etc.. (valid section tags only)
+    TOKEN_INCLUDE,        // #include
+    TOKEN_UNIFORM,        // uniform
+    TOKEN_LAYOUT,         // layout
+    TOKEN_CONFIG_START,   // @CONFIG_START
+    TOKEN_CONFIG_END,     // @CONFIG_END
+    TOKEN_REPLACE_START,  // [[
+    TOKEN_REPLACE_END,    // ]]
+    TOKEN_Count
+};
+
+struct ShaderTokenStruct {
+    ShaderTokenEnum type = ShaderTokenEnum::TOKEN_Count;
+    size_t pos = 0U;
+    size_t size = 0U;
+    std::string word;  // section name without the @, only for TOKEN_SECTION
+    bool inComment = false;
+};
+
+// one pass tokenizer of a shader code
+// give the tags of the code and the comment zones, so the parser not need to search in the code many times
+// the tags are found like a std::string::find, the comment state is given by token
+class ShaderCodeLexer {
+private:
+    std::vector<ShaderTokenStruct> m_Tokens;  // in code order
+    std::array<std::vector<size_t>, (size_t)ShaderTokenEnum::TOKEN_Count> m_TagIndex;  // sorted pos by token type
+    std::vector<std::pair<size_t, size_t>> m_CommentZones;  // sorted [start, end[
+    std::vector<size_t> m_NewLines;                         // sorted pos of \n
+    size_t m_CodeSize = 0U;
+
+public:
+    ShaderCodeLexer() = default;
+    explicit ShaderCodeLexer(const std::string& vCode);
+
+    void Lex(const std::string& vCode);
+    void Clear();
+
+    const std::vector<ShaderTokenStruct>& GetTokens() const;
+
+    // pos of the first tag starting at or after vStartPos, or npos
+    size_t FindNextTag(ShaderTokenEnum vType, size_t vStartPos) const;
+    // pos of the last tag starting at or before vPos, or npos (like rfind)
+    size_t FindPreviousTag(ShaderTokenEnum vType, size_t vPos) const;
+
+    bool IsInCommentZone(size_t vPos) const;
+
+    // pos of the first \n at or after vStartPos, npos if not found or in a comment zone
+    size_t GetNextLinePos(size_t vStartPos) const;
+
+    // pos of the first \n at or after vStartPos, npos if not found. the comment zones are not checked
+    size_t FindNextNewLine(size_t vStartPos) const;
+
+    // count of \n in [0, vPos[
+    size_t GetCountLinesBefore(size_t vPos) const;
+
+    // valid section names (without the @) by pos of their @
+    std::map<size_t, std::string> GetSections() const;
+
+    // pos of the first vTag at or after vStartPos, npos if not found or if not followed by a space, a tab or a \n
+    // not need a lex, used by the importers for the @NOTE_START or @UNIFORMS_START tags
+    static size_t FindWordTag(const std::string& vCode, const std::string& vTag, size_t vStartPos);
+
+private:
+    void AddToken(ShaderTokenEnum vType, size_t vPos, size_t vSize, const std::string& vWord = "");
+};
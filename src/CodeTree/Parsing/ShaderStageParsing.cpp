@@ -20,9 +20,11 @@
 
 #include <ctools/FileHelper.h>
 #include <CodeTree/Parsing/SectionCode.h>
+#include <CodeTree/Parsing/ShaderCodeLexer.h>
 #include <CodeTree/CodeTree.h>
 #include <CodeTree/ShaderKey.h>
 #include <ctools/Logger.h>
+#include <algorithm>
 #include <filesystem>
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -283,224 +285,6 @@ void SectionConfigStruct::CheckChangeWith(SectionConfigStruct* vConfigToCcompare
 ///// STATIC FOR PARSING //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// todo : faire le test unitaire
-size_t ShaderStageParsing::GetTagPos(const std::string& vCode, const std::string& vTag, size_t vStartPos, bool vCheckIfInCommentZone, bool vWordOnly) {
-    size_t tagPos = std::string::npos;
-
-    if (!vCode.empty()) {
-        tagPos = vCode.find(vTag, vStartPos);
-        if (tagPos != std::string::npos) {
-            if (vWordOnly) {
-                size_t endtag = tagPos + vTag.size();
-                if (endtag < vCode.size())
-                    if (vCode[endtag] != ' ' && vCode[endtag] != '\n' && vCode[endtag] != '\t')
-                        tagPos = std::string::npos;
-            }
-
-            if (tagPos != std::string::npos) {
-                if (vCheckIfInCommentZone)
-                    if (IfInCommentZone(vCode, tagPos))
-                        tagPos = std::string::npos;
-            }
-        }
-    }
-
-    return tagPos;
-}
-
-// todo : faire le test unitaire
-std::string ShaderStageParsing::GetTagIfFound(const std::string& vCode, size_t vStartPos, size_t* vApproxPos, bool vCheckIfInCommentZone) {
-    std::string tagFound;
-
-    size_t tagPos = std::string::npos;
-
-    if (!vCode.empty()) {
-        tagPos = vCode.find('@', vStartPos);
-        if (tagPos != std::string::npos) {
-            ++tagPos;
-
-            // on va juste verifier qu'on est pas attaché a un include
-            if (tagPos > 1 && vCode[tagPos - 2] == ':') {
-                // la on est sur un include
-                // int i = 0;
-            } else {
-                size_t endtag = vCode.find_first_of(" \n\t\r", tagPos);
-                if (endtag == std::string::npos)  // then end of file
-                {
-                    endtag = vCode.size();
-                }
-                if (endtag != std::string::npos) {
-                    tagFound = vCode.substr(tagPos, endtag - tagPos);
-
-                    // il y a des tags qui sont speciaux et que nous devons echapper
-                    auto tagFoundToCompare = "@" + tagFound;
-                    if (tagFoundToCompare == SectionCode::codeTags.ConfigStartTag || tagFoundToCompare == SectionCode::codeTags.ConfigEndTag ||
-                        tagFoundToCompare == SectionCode::codeTags.BufferStartTag || tagFoundToCompare == SectionCode::codeTags.BufferEndTag) {
-                        tagFound.clear();
-                    }
-                }
-
-                if (!tagFound.empty()) {
-                    if (vCheckIfInCommentZone) {
-                        if (IfInCommentZone(vCode, tagPos))  // dans un commentaire alors on echappe
-                        {
-                            tagFound.clear();
-                        }
-                    }
-
-                    // si un #include existe sur la meme ligne juste avant le @ alors on echappe
-                    // utilsié apr ex : #include "shader.glsl":@SDF
-                    if (IfOnIncludeLine(vCode, tagPos)) {
-                        tagFound.clear();
-                    }
-                }
-            }
-        }
-
-        if (vApproxPos) {
-            *vApproxPos = tagPos - 1;
-        }
-    }
-
-    return tagFound;
-}
-
-// todo : faire le test unitaire
-bool ShaderStageParsing::IsTagFound(const std::string& vCode, const std::string& vTag, size_t vStartPos, size_t* vApproxPos, bool vCheckIfInCommentZone, bool vWordOnly) {
-    bool tagFound = false;
-
-    size_t tagPos = std::string::npos;
-
-    if (!vCode.empty()) {
-        tagPos = vCode.find(vTag, vStartPos);
-
-        if (tagPos != std::string::npos) {
-            tagFound = true;
-
-            if (vWordOnly) {
-                size_t endtag = tagPos + vTag.size();
-                if (endtag < vCode.size()) {
-                    if (vCode[endtag] != ' ' && vCode[endtag] != '\n' && vCode[endtag] != '\t') {
-                        tagFound = false;
-                    }
-                }
-            }
-
-            if (tagFound) {
-                if (vCheckIfInCommentZone) {
-                    if (IfInCommentZone(vCode, tagPos)) {
-                        tagFound = false;
-                    }
-                }
-            }
-        }
-
-        if (vApproxPos) {
-            *vApproxPos = tagPos;
-        }
-    }
-
-    return tagFound;
-}
-
-// todo : faire le test unitaire
-bool ShaderStageParsing::IfInCommentZone(const std::string& vCode, size_t vPos) {
-    //// zone de commentaire => // est forcemment sur la meme ligne
-    // size_t mark_comment = vCode->rfind("//", vPos);
-    // if (mark_comment != std::string::npos)
-    //{
-    //	size_t mark_before = vCode->rfind("\n", vPos);
-    //	if (mark_before != std::string::npos)
-    //	{
-    //		if (mark_before < mark_comment) // \n//#include => ok
-    //		{
-    //			return true;
-    //		}
-    //		else if (mark_before > mark_comment) // //\n#include => nok
-    //		{
-    //			return false;
-    //		}
-    //	}
-    //	else // //#include => ok (juste ya pas de ligne avant :) )
-    //	{
-    //		return true;
-    //	}
-    // }
-    //  zone de commentaire => /* */ est entre balise
-    // size_t mark_before = vCode->rfind("/*", vPos);
-    // if (mark_before != std::string::npos)
-    //{
-    //	size_t mark_after = vCode->find("*/", vPos);
-    //	if (mark_after != std::string::npos)
-    //	{
-    //		return true; // /* #include */ => ok
-    //	}
-    // }
-    // return false;
-
-    size_t mark_comment = 0;
-
-    // zone de commentaire //
-    size_t lastLine = vCode.rfind('\n', vPos);
-    if (lastLine != std::string::npos) {
-        mark_comment = vCode.find("//", lastLine + 1);
-    } else {
-        mark_comment = vCode.rfind("//", vPos);
-    }
-    if (mark_comment != std::string::npos) {
-        if (mark_comment < vPos) {
-            return true;
-        }
-    }
-
-    size_t mark_start_before = vCode.rfind("/*", vPos);
-    if (mark_start_before != std::string::npos) {
-        // on verifie que c'est le notre
-        size_t mark_end_before = vCode.rfind("*/", vPos);
-        if (mark_end_before != std::string::npos) {
-            // zone de com deja fermee
-            if (mark_start_before < mark_end_before) {
-                return false;
-            }
-        }
-        size_t mark_end_after = vCode.find("*/", vPos);
-        if (mark_end_after != std::string::npos) {
-            // on verifie que c'est le notre
-            size_t mark_start_after = vCode.find("/*", vPos);
-            if (mark_start_after != std::string::npos) {
-                // zone de com deja fermee
-                if (mark_start_after < mark_end_after) {
-                    return false;
-                }
-            }
-
-            return true;
-        }
-    }
-
-    return false;
-}
-
-// todo : faire le test unitaire
-bool ShaderStageParsing::IfOnIncludeLine(const std::string& vCode, size_t vPos) {
-    size_t mark_include = 0;
-
-    // zone de includ //
-    size_t lastLine = vCode.rfind('\n', vPos);
-    if (lastLine != std::string::npos) {
-        mark_include = vCode.find(SectionCode::codeTags.IncludeWordTag, lastLine + 1);
-    } else {
-        mark_include = vCode.rfind(SectionCode::codeTags.IncludeWordTag, vPos);
-    }
-    if (mark_include != std::string::npos) {
-        if (mark_include < vPos) {
-            return true;
-        }
-    }
-
-    return false;
-}
-
 // todo : faire le test unitaire
 std::string ShaderStageParsing::supressCommentedCode(const std::string& vText) {
     std::string res;
@@ -547,7 +331,11 @@ std::string ShaderStageParsing::supressCommentedCode(const std::string& vText) {
 }
 
 // todo : faire le test unitaire
-bool ShaderStageParsing::FoundTagInCode(const std::string& vCode, const std::string& vTag, size_t* vPos, std::map<size_t, std::string>* vDico) {
+bool ShaderStageParsing::FoundTagInCode(const std::string& vCode,
+                                        const ShaderCodeLexer& vLexer,
+                                        const std::string& vTag,
+                                        size_t* vPos,
+                                        std::map<size_t, std::string>* vDico) {
     bool res = false;
 
     if (vPos) {
@@ -556,7 +344,7 @@ bool ShaderStageParsing::FoundTagInCode(const std::string& vCode, const std::str
                 *vPos = vCode.find(vTag, *vPos);
                 if (*vPos != std::string::npos) {
                     *vPos += vTag.size();
-                    if (!ShaderStageParsing::IfInCommentZone(vCode, *vPos)) {
+                    if (!vLexer.IsInCommentZone(*vPos)) {
                         (*vDico)[*vPos] = vTag;
                         res = true;
                     }
@@ -685,13 +473,16 @@ void ShaderParsedStruct::ParseNote(const std::string& vNote) {
     size_t userPos = 0;
     size_t soundUrlPos = 0;
 
+    // for the comment zones
+    ShaderCodeLexer lexer(vNote);
+
     while (lastFound != std::string::npos) {
-        ShaderStageParsing::FoundTagInCode(vNote, "[[NAME]]:", &namePos, &DicoposTag);             // ALL
-        ShaderStageParsing::FoundTagInCode(vNote, "[[DATE]]:", &datePos, &DicoposTag);             // ALL
-        ShaderStageParsing::FoundTagInCode(vNote, "[[URL]]:", &urlPos, &DicoposTag);               // ALL
-        ShaderStageParsing::FoundTagInCode(vNote, "[[PARENT_URL]]:", &parentUrlPos, &DicoposTag);  // SPF_VERTEXSHADERART // SPF_GLSLSANDBOX
-        ShaderStageParsing::FoundTagInCode(vNote, "[[USER]]:", &userPos, &DicoposTag);             // ALL
-        ShaderStageParsing::FoundTagInCode(vNote, "[[SOUND_URL]]:", &soundUrlPos, &DicoposTag);    // SPF_VERTEXSHADERART
+        ShaderStageParsing::FoundTagInCode(vNote, lexer, "[[NAME]]:", &namePos, &DicoposTag);             // ALL
+        ShaderStageParsing::FoundTagInCode(vNote, lexer, "[[DATE]]:", &datePos, &DicoposTag);             // ALL
+        ShaderStageParsing::FoundTagInCode(vNote, lexer, "[[URL]]:", &urlPos, &DicoposTag);               // ALL
+        ShaderStageParsing::FoundTagInCode(vNote, lexer, "[[PARENT_URL]]:", &parentUrlPos, &DicoposTag);  // SPF_VERTEXSHADERART // SPF_GLSLSANDBOX
+        ShaderStageParsing::FoundTagInCode(vNote, lexer, "[[USER]]:", &userPos, &DicoposTag);             // ALL
+        ShaderStageParsing::FoundTagInCode(vNote, lexer, "[[SOUND_URL]]:", &soundUrlPos, &DicoposTag);    // SPF_VERTEXSHADERART
 
         if (namePos == std::string::npos && datePos == std::string::npos && urlPos == std::string::npos && parentUrlPos == std::string::npos &&
             userPos == std::string::npos && soundUrlPos == std::string::npos) {
@@ -1556,7 +1347,12 @@ void ShaderStageParsing::ParseFragmentConfig(std::shared_ptr<SectionCode> vSecti
     UNUSED(vCurrentFileLine);
 }
 
-ReplaceCodeStruct ShaderStageParsing::ParseReplaceCode(std::shared_ptr<SectionCode> vSectionCode, const std::string& vExtractedCode, size_t vCurrentFileLine) {
+ReplaceCodeStruct ShaderStageParsing::ParseReplaceCode(std::shared_ptr<SectionCode> vSectionCode,
+                                                       const std::string& vCode,
+                                                       size_t vStartPos,
+                                                       size_t vEndPos,
+                                                       const ShaderCodeLexer& vLexer,
+                                                       size_t vCurrentFileLine) {
     UNUSED(vCurrentFileLine);
     UNUSED(vSectionCode);
 
@@ -1565,7 +1361,7 @@ ReplaceCodeStruct ShaderStageParsing::ParseReplaceCode(std::shared_ptr<SectionCo
      * le 1er c'est la clef : SLOT:voxelNormal:this is the map normal extraction function:
      * la suite jusqu'a ]] c'est le code par default
      * dans la clef on a type(name:help)
-     * ici vCodeLine contient le texte entre les deux [[ et ]]
+     * ici [vStartPos, vEndPos[ contient le texte entre les deux [[ et ]]
      * ca peu etre ca :
      * [[SLOT(voxelNormal:"this is the map normal extraction function")
      * vec3 voxelNormal(vec3 p, float prec)
@@ -1612,18 +1408,27 @@ ReplaceCodeStruct ShaderStageParsing::ParseReplaceCode(std::shared_ptr<SectionCo
     if (vSectionCode->stageName == "NOTE")
         return replaceCode;
 
-    size_t endLine = vExtractedCode.find_first_of("\n\r");
-    if (endLine != std::string::npos) {
-        replaceCode.key = vExtractedCode.substr(0, endLine);
+    if (vEndPos > vCode.size())
+        vEndPos = vCode.size();
+
+    // the params line is ended by the first \n of the block, given by the lexer
+    size_t newLine = vLexer.FindNextNewLine(vStartPos);
+    if (newLine != std::string::npos && newLine < vEndPos) {
+        size_t endLine = newLine;
+        if (endLine > vStartPos && vCode[endLine - 1U] == '\r')  // windows
+            --endLine;
+
+        replaceCode.key = vCode.substr(vStartPos, endLine - vStartPos);
         replaceCode.name = replaceCode.key;
-        replaceCode.defCode = vExtractedCode.substr(endLine + 1);
+        replaceCode.defCode = vCode.substr(endLine + 1U, vEndPos - endLine - 1U);
 
-        size_t startPar = vExtractedCode.find(':');
-        if (startPar != std::string::npos) {
-            replaceCode.type = vExtractedCode.substr(0, startPar);
+        auto itPar = std::find(vCode.begin() + vStartPos, vCode.begin() + vEndPos, ':');
+        if (itPar != vCode.begin() + vEndPos) {
+            size_t startPar = (size_t)(itPar - vCode.begin());
+            replaceCode.type = vCode.substr(vStartPos, startPar - vStartPos);
 
-            std::string code = vExtractedCode;
-            std::string paramCode = GetStringFromPosUntilChar(code, 0, '\n');
+            // the params line with his \n
+            std::string paramCode = vCode.substr(vStartPos, newLine - vStartPos + 1U);
             if (!paramCode.empty()) {
                 ct::uvec2 codeBlock;
                 std::string params = ShaderStageParsing::GetStringBetweenChars(':', '\n', paramCode, 0, &codeBlock);
@@ -1636,8 +1441,6 @@ ReplaceCodeStruct ShaderStageParsing::ParseReplaceCode(std::shared_ptr<SectionCo
                         replaceCode.params.push_back(s);
                     }
                 }
-                // replaceCode.key = code.substr(0, codeBlock.y + 1);
-                // replaceCode.defCode = code.substr(codeBlock.y + 1);
             }
         }
     }
@@ -1713,7 +1516,7 @@ std::weak_ptr<ShaderKey> ShaderStageParsing::ParseIncludeLine(std::shared_ptr<Se
                     key = pkeyPtr->puParentCodeTree->GetIncludeKey(_extractCode);  // .lock();
                     if (key) {
                         // infinite loop, olors on renvois rien
-                        if (CheckIfExist_InfiniteIncludeLoop(vSectionCode, key->puKey)) {
+                        if (!pkeyPtr->puParentCodeTree->puIncludeGraph.AddInclude(GetIncluderKey(vSectionCode), key->puKey)) {
                             vSectionCode->SetSyntaxError(
                                 key, "Include Error", true, "Infinite Loop detected on Inclusion of " + key->puKey + ", script ignored !", vCurrentFileLine);
 
@@ -1755,7 +1558,7 @@ std::weak_ptr<ShaderKey> ShaderStageParsing::ParseIncludeLine(std::shared_ptr<Se
                 key = pkeyPtr->puParentCodeTree->AddOrUpdateFromFileAndGetKey(validPathFile, false, false, true);  // .lock();
                 if (key) {
                     // infinite loop, olors on renvois rien
-                    if (CheckIfExist_InfiniteIncludeLoop(vSectionCode, key->puKey)) {
+                    if (!pkeyPtr->puParentCodeTree->puIncludeGraph.AddInclude(GetIncluderKey(vSectionCode), key->puKey)) {
                         vSectionCode->SetSyntaxError(
                             key, "Include Error", true, "Infinite Loop detected on Inclusion of " + key->puKey + ", script ignored !", vCurrentFileLine);
 
@@ -1782,27 +1585,21 @@ std::weak_ptr<ShaderKey> ShaderStageParsing::ParseIncludeLine(std::shared_ptr<Se
     return std::weak_ptr<ShaderKey>(key);
 }
 
-// on check tout les parents jusqu'au parent 0, pour voir si on tombe sur un parent identique au nom inclu
-// le but est de verifier 'lexistance d'une boucle infinie
-bool ShaderStageParsing::CheckIfExist_InfiniteIncludeLoop(std::shared_ptr<SectionCode> vSectionCode, const std::string& vIncludeName) {
-    auto section = vSectionCode;
-
-    while (section) {
-        if (section->isInclude) {
-            if (section->relativeFile == vIncludeName) {
-                // aie on a found le meme nom. on arrete !
-                return true;
-            } else {
-                // rien a signaler. on remonte au parent !
-                section = section->parentSection;
+// la key du fichier qui contient la ligne #include
+// le code d'un include est parse dans l'arbre de la key du shader, mais ses sections gardent le fichier de l'include
+// les boucles infinies sont detectees par CodeTree::puIncludeGraph
+std::string ShaderStageParsing::GetIncluderKey(std::shared_ptr<SectionCode> vSectionCode) {
+    auto pkeyPtr = vSectionCode->parentKey.lock();
+    if (pkeyPtr.use_count()) {
+        if (vSectionCode->isInclude && !vSectionCode->absoluteFile.empty() && pkeyPtr->puParentCodeTree) {
+            auto includerKey = pkeyPtr->puParentCodeTree->GetKey(vSectionCode->absoluteFile);
+            if (includerKey) {
+                return includerKey->puKey;
             }
-        } else {
-            section = nullptr;
         }
+        return pkeyPtr->puKey;
     }
-
-    // rien found
-    return false;
+    return "";
 }
 
 void ShaderStageParsing::ParseGeometryShaderForGetInAndOutPrimitives(std::shared_ptr<SectionCode> vSectionCode, const std::string& vCodeToParse) {
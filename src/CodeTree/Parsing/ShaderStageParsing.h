@@ -256,20 +256,15 @@ typedef std::unordered_map<std::string, ConfigTagParsedStruct> ShaderSectionConf
 
 class SectionCode;
 class ShaderKey;
+class ShaderCodeLexer;
 class ShaderStageParsing {
 public:
-    static bool IfInCommentZone(const std::string& vCode, size_t vPos);
-    static bool IfOnIncludeLine(const std::string& vCode, size_t vPos);
     static std::string supressCommentedCode(const std::string& vText);
-    static size_t GetTagPos(const std::string& vCode, const std::string& vTag, size_t vStartPos, bool vCheckIfInCommentZone = true, bool vWordOnly = false);
-    static std::string GetTagIfFound(const std::string& vCode, size_t vStartPos, size_t* vApproxPos, bool vCheckIfInCommentZone = true);
-    static bool IsTagFound(const std::string& vCode,
-                           const std::string& vTag,
-                           size_t vStartPos,
-                           size_t* vApproxPos,
-                           bool vCheckIfInCommentZone = true,
-                           bool vWordOnly = false);
-    static bool FoundTagInCode(const std::string& vCode, const std::string& vTag, size_t* vPos, std::map<size_t, std::string>* vDico);
+    static bool FoundTagInCode(const std::string& vCode,
+                               const ShaderCodeLexer& vLexer,
+                               const std::string& vTag,
+                               size_t* vPos,
+                               std::map<size_t, std::string>* vDico);
     static std::string GetStringBetweenChars(char vOpenChar, char vCloseChar, std::string& vCode, size_t vStartPos, ct::uvec2* vBlockLoc = 0);
     static size_t GetPosAtCoordInString(std::string& vCode, ct::uvec2 vCoord);
     static std::string GetStringFromPosUntilChar(const std::string& vCode, const size_t& vPos, const char& vLimitChar);
@@ -285,7 +280,13 @@ public:
                                                             std::string* vSectionNameToReturn,
                                                             std::vector<std::string>* vInFileBufferNameToReturn);
 
-    ReplaceCodeStruct ParseReplaceCode(std::shared_ptr<SectionCode> vSectionCode, const std::string& vExtractedCode, size_t vCurrentFileLine);
+    // the replace code block is [vStartPos, vEndPos[ in vCode, vLexer is the lex of vCode
+    ReplaceCodeStruct ParseReplaceCode(std::shared_ptr<SectionCode> vSectionCode,
+                                       const std::string& vCode,
+                                       size_t vStartPos,
+                                       size_t vEndPos,
+                                       const ShaderCodeLexer& vLexer,
+                                       size_t vCurrentFileLine);
     std::weak_ptr<ShaderKey> ParseIncludeLine(std::shared_ptr<SectionCode> vSectionCode, const std::string& vCodeLine, size_t vCurrentFileLine);
 
 private:
@@ -314,7 +315,7 @@ private:
                                     size_t vCurrentFileLine);
     void ParseCommonConfig(std::shared_ptr<SectionCode> vSectionCode, const std::unordered_map<std::string, ConfigTagParsedStruct>& vTags, size_t vCurrentFileLine);
     void ParseFragmentConfig(std::shared_ptr<SectionCode> vSectionCode, const std::unordered_map<std::string, ConfigTagParsedStruct>& vTags, size_t vCurrentFileLine);
-    bool CheckIfExist_InfiniteIncludeLoop(std::shared_ptr<SectionCode> vSectionCode, const std::string& vIncludeName);
+    std::string GetIncluderKey(std::shared_ptr<SectionCode> vSectionCode);
     void ParseGeometryShaderForGetInAndOutPrimitives(std::shared_ptr<SectionCode> vSectionCode, const std::string& vCodeToParse);
     std::vector<GeometryLayoutStruct> SearchForGeometryLayout(const std::string& vCodeToParse,
                                                               const std::string& vTagToSearch,
@@ -165,6 +165,7 @@ void ShaderKey::Clear() {
     puConfigNames.clear();
     puUniformParsedDataBase.clear();
     puMainSection->Clear();
+    puSectionCodeParseCache.Clear();
     puSyntaxErrors.clear();
     ClearUniforms();
 }
@@ -647,7 +648,13 @@ void ShaderKey::StartParse() {
     ClearShaderStageNames();
     ClearFragColorNames();
 
+    if (puParentCodeTree)
+        puParentCodeTree->puIncludeGraph.BeginParse(puKey);
+    puSectionCodeParseCache.BeginParse();
     puMainSection->Parse();
+    puSectionCodeParseCache.EndParse();
+    if (puParentCodeTree)
+        puParentCodeTree->puIncludeGraph.EndParse();
 
     // CheckWhatUniformIsUsedInCode();
 
@@ -702,6 +709,7 @@ void ShaderKey::DestroyUniformsWithOwner(ShaderKeyPtr vOwner) {
         if (puUniformsDataBase.find(*itLst) != puUniformsDataBase.end())  // found
         {
             puUniformsDataBase.erase(*itLst);
+            ++puUniformsDataBaseGeneration;
         }
     }
     uniToRemove.clear();
@@ -726,6 +734,7 @@ void ShaderKey::ClearUniforms(bool vExceptFinalUniforms) {
     for (auto it = uniformsToErase.begin(); it != uniformsToErase.end(); ++it) {
         puUniformsDataBase.erase(*it);
     }
+    ++puUniformsDataBaseGeneration;
     // puUniformsDataBase.clear();
 
     for (auto incFileName : puIncludeFileNames) {
@@ -809,10 +818,12 @@ void ShaderKey::AddUniform(UniformVariantPtr vUniform) {
 #endif
                 // maintenant on le remplace pas le nouveau
                 puUniformsDataBase[vUniform->name] = vUniform;
+                ++puUniformsDataBaseGeneration;
             }
         } else  // non found
         {
             puUniformsDataBase[vUniform->name] = vUniform;
+            ++puUniformsDataBaseGeneration;
         }
 
         if (!vUniform->widget.empty()) {
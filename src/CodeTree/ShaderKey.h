@@ -205,6 +205,7 @@ public:
     CodeTreePtr puParentCodeTree = nullptr;
     ShaderKeyPtr m_This = nullptr;
     std::shared_ptr<SectionCode> puMainSection = nullptr;
+    SectionCodeParseCache puSectionCodeParseCache;  // sections of the last parse, reused if the code not changed
 
     // error
     ShaderMsg puCompilationSuccess;
@@ -292,6 +293,7 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // uniform name, uniform
     std::unordered_map<std::string, UniformVariantPtr> puUniformsDataBase;
+    uint64_t puUniformsDataBaseGeneration = 0U;  // incremented at each change of puUniformsDataBase, checked by the upload plans
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     std::map<std::string,           // shader stage name
              std::map<std::string,  // uniform name
@@ -0,0 +1,96 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+// wait-free ring buffer for one producer thread and one consumer thread
+// the capacity is rounded to a power of 2, the indexs grow forever and are masked
+// when the ring is full, the new datas are dropped (the consumer is the only one who can free space)
+template <typename T>
+class SpscRingBuffer {
+private:
+    std::vector<T> m_Datas;
+    size_t m_Mask = 0U;
+    alignas(64) std::atomic<size_t> m_WriteIndex{0U};  // owned by the producer
+    alignas(64) std::atomic<size_t> m_ReadIndex{0U};   // owned by the consumer
+    alignas(64) std::atomic<size_t> m_CountDropped{0U};
+
+public:
+    explicit SpscRingBuffer(size_t vCapacity) {
+        size_t capacity = 2U;
+        while (capacity < vCapacity) {
+            capacity <<= 1U;
+        }
+        m_Datas.resize(capacity);
+        m_Mask = capacity - 1U;
+    }
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // producer side, return the count of pushed datas
+    size_t Push(const T* vDatas, size_t vCount) {
+        const size_t writeIndex = m_WriteIndex.load(std::memory_order_relaxed);
+        const size_t readIndex = m_ReadIndex.load(std::memory_order_acquire);
+        const size_t count = std::min(vCount, m_Datas.size() - (writeIndex - readIndex));
+        for (size_t i = 0U; i < count; ++i) {
+            m_Datas[(writeIndex + i) & m_Mask] = vDatas[i];
+        }
+        m_WriteIndex.store(writeIndex + count, std::memory_order_release);
+        if (count < vCount) {
+            m_CountDropped.fetch_add(vCount - count, std::memory_order_relaxed);
+        }
+        return count;
+    }
+    bool Push(const T& vData) {
+        return Push(&vData, 1U) == 1U;
+    }
+
+    // consumer side, return the count of poped datas
+    size_t Pop(T* vDatas, size_t vCount) {
+        const size_t readIndex = m_ReadIndex.load(std::memory_order_relaxed);
+        const size_t writeIndex = m_WriteIndex.load(std::memory_order_acquire);
+        const size_t count = std::min(vCount, writeIndex - readIndex);
+        for (size_t i = 0U; i < count; ++i) {
+            vDatas[i] = std::move(m_Datas[(readIndex + i) & m_Mask]);
+        }
+        m_ReadIndex.store(readIndex + count, std::memory_order_release);
+        return count;
+    }
+    bool Pop(T& vData) {
+        return Pop(&vData, 1U) == 1U;
+    }
+
+    // consumer side, the pending datas are forgotten
+    void Clear() {
+        m_ReadIndex.store(m_WriteIndex.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    size_t GetCountReadable() const {
+        return m_WriteIndex.load(std::memory_order_acquire) - m_ReadIndex.load(std::memory_order_acquire);
+    }
+    size_t GetCapacity() const {
+        return m_Datas.size();
+    }
+    // the count of datas dropped because the ring was full
+    size_t GetCountDropped() const {
+        return m_CountDropped.load(std::memory_order_relaxed);
+    }
+};
@@ -22,6 +22,7 @@
 #include <Renderer/RenderPack.h>
 #include <CodeTree/CodeTree.h>
 #include <CodeTree/Parsing/ShaderStageParsing.h>
+#include <CodeTree/Parsing/ShaderCodeLexer.h>
 #include <stb_image.h>
 #include <stb_image_write.h>
 
@@ -622,9 +623,11 @@ void ImporterFromShadertoy::AddUniformsFromCode(ShaderInfos& vOutShaderInfos,
         // size_t uniforpuelse = vCode.find("@UNIFORMS_ELSE");
         // size_t uniforpuend = vCode.find("@UNIFORMS_END");
 
+        // the lexer give the uniform words and the comment zones, he is re done after each erase
+        ShaderCodeLexer lexer(vCode);
         size_t uniforpupos = 0;
-        while ((uniforpupos = vCode.find("uniform ", uniforpupos)) != std::string::npos) {
-            if (!ShaderStageParsing::IfInCommentZone(vCode, uniforpupos)) {
+        while ((uniforpupos = lexer.FindNextTag(ShaderTokenEnum::TOKEN_UNIFORM, uniforpupos)) != std::string::npos) {
+            if (vCode.compare(uniforpupos, 8U, "uniform ") == 0 && !lexer.IsInCommentZone(uniforpupos)) {
                 size_t coma_pos = vCode.find(';', uniforpupos);
                 size_t comeback_pos = vCode.find('\n', uniforpupos);
                 if (coma_pos != std::string::npos) {
@@ -644,6 +647,7 @@ void ImporterFromShadertoy::AddUniformsFromCode(ShaderInfos& vOutShaderInfos,
                             length_to_erase = coma_pos + 1 - uniforpupos;
                         }
                         vCode.erase(uniforpupos, length_to_erase);
+                        lexer.Lex(vCode);
 
                         if (uniforpupos > 0)
                             uniforpupos--;
@@ -729,8 +733,8 @@ void ImporterFromShadertoy::AddUniformsFromCode(ShaderInfos& vOutShaderInfos,
             uniforpupos += 1;
         }
 
-        size_t note_start = ShaderStageParsing::GetTagPos(vCode, "@NOTE_START", 0, false, true);
-        size_t note_end = ShaderStageParsing::GetTagPos(vCode, "@NOTE_END", 0, false, true);
+        size_t note_start = ShaderCodeLexer::FindWordTag(vCode, "@NOTE_START", 0);
+        size_t note_end = ShaderCodeLexer::FindWordTag(vCode, "@NOTE_END", 0);
 
         if (note_start != std::string::npos) {
             if (note_end != std::string::npos) {
@@ -757,9 +761,9 @@ void ImporterFromShadertoy::AddUniformsFromCode(ShaderInfos& vOutShaderInfos,
             }
         }
 
-        size_t uniforms_start = ShaderStageParsing::GetTagPos(vCode, "@UNIFORMS_START", 0, false, true);
-        size_t uniforpuelse = ShaderStageParsing::GetTagPos(vCode, "@UNIFORMS_ELSE", 0, false, true);
-        size_t uniforpuend = ShaderStageParsing::GetTagPos(vCode, "@UNIFORMS_END", 0, false, true);
+        size_t uniforms_start = ShaderCodeLexer::FindWordTag(vCode, "@UNIFORMS_START", 0);
+        size_t uniforpuelse = ShaderCodeLexer::FindWordTag(vCode, "@UNIFORMS_ELSE", 0);
+        size_t uniforpuend = ShaderCodeLexer::FindWordTag(vCode, "@UNIFORMS_END", 0);
 
         if (uniforms_start != std::string::npos) {
             if (uniforpuelse != std::string::npos) {
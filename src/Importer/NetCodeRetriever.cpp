@@ -19,6 +19,7 @@
 #ifdef USE_NETWORK
 
 #include "NetCodeRetriever.h"
+#include "UrlFetcher.h"
 #include <stdio.h>
 #include <ctools/Logger.h>
 #include <Renderer/RenderPack.h>
@@ -217,6 +218,8 @@ bool NetCodeRetriever::drawUrl(bool* vShow, bool vHideProxySettings, bool vHideS
         ImGui::RadioButtonLabeled(ImVec2(120.0f, 0.0f), "Import in One File", "Import all Buffers In One File", &_InportInOneFile);
         NetCodeRetriever::sInportInOneFile = _InportInOneFile;
 
+        ImGui::RadioButtonLabeled(ImVec2(60.0f, 0.0f), "Refresh", "Check with the server if the cached files are outdated", &puRevalidateCache);
+
         load |= ImGui::ContrastedButton("Load");
 
         if (ImGui::ContrastedButton("Hide")) {
@@ -240,6 +243,8 @@ void NetCodeRetriever::RetrieveWithoutThread(std::function<void()> vFinishFunc)
 
     NetCodeRetriever::sWorking = true;
 
+    UrlFetcher::Instance()->SetRevalidateCache(puRevalidateCache);
+
     auto loader = std::make_unique<ShaderUrlLoader>();
     loader->puUseProxy = puUseProxy;
     NetCodeRetriever::sShaders = loader->GetShaderFromUrl(std::string(puUrl),
@@ -308,6 +313,7 @@ void NetCodeRetriever::CreateThread(std::function<void()> vFinishFunc) {
     if (!StopWorkerThread()) {
         puFinishFunc = vFinishFunc;
         NetCodeRetriever::sWorking = true;
+        UrlFetcher::Instance()->SetRevalidateCache(puRevalidateCache);
         puWorkerThread = std::thread(GetShaderCode,
                                      std::string(puUrl),
                                      std::string(puShaderToyApiKey),
@@ -366,6 +372,7 @@ std::string NetCodeRetriever::getXml(const std::string& vOffset, const std::stri
     str += vOffset + "\t<proxy_url>" + std::string(puUrl) + "</proxy_url>\n";
     str += vOffset + "\t<shadertoy_api_key>" + std::string(puShaderToyApiKey) + "</shadertoy_api_key>\n";
     str += vOffset + "\t<check_version_at_start>" + (puCheckVersionAtStart ? "true" : "false") + "</check_version_at_start>\n";
+    str += vOffset + "\t<revalidate_cache>" + (puRevalidateCache ? "true" : "false") + "</revalidate_cache>\n";
     str += vOffset + "\t<import_in_one_file>" + (NetCodeRetriever::sInportInOneFile ? "true" : "false") + "</import_in_one_file>\n";
 
     str += vOffset + "</NetCodeRetriever>\n";
@@ -406,6 +413,8 @@ bool NetCodeRetriever::setFromXml(tinyxml2::XMLElement* vElem, tinyxml2::XMLElem
             SetShaderToyApiKey(strValue);
         if (strName == "check_version_at_start")
             puCheckVersionAtStart = ct::ivariant(strValue).GetB();
+        if (strName == "revalidate_cache")
+            puRevalidateCache = ct::ivariant(strValue).GetB();
         if (strName == "import_in_one_file")
             NetCodeRetriever::sInportInOneFile = ct::ivariant(strValue).GetB();
     }
@@ -72,6 +72,7 @@ private:
     char puUrl[1000] = "";
     char puProxyPath[100] = "";
     char puUserPwd[100] = "";
+    bool puRevalidateCache = false;  // ask the server if the cached files are outdated
 
 public:
     bool puCheckVersionAtStart = false;
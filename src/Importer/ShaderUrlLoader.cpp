@@ -23,10 +23,14 @@
 #include <Renderer/RenderPack.h>
 #include <CodeTree/CodeTree.h>
 #include <CodeTree/Parsing/ShaderStageParsing.h>
+#include <CodeTree/Parsing/ShaderCodeLexer.h>
 #include <stb/stb_image.h>
 #include <stb_image_write.h>
 
+#include <fstream>
+
 #include "NetCodeRetriever.h"
+#include "UrlFetcher.h"
 #include "Format_ShaderToy.h"
 #include "Format_GlslSandbox.h"
 #include "Format_VertexShaderArt.h"
@@ -45,14 +49,31 @@ ShaderUrlLoader::ShaderUrlLoader() {
 ShaderUrlLoader::~ShaderUrlLoader() {
 }
 
-// static
-int writer(char *data, size_t size, size_t nmemb, std::string *writerData) {
-    if (writerData == nullptr)
-        return 0;
-
-    writerData->append(data, size * nmemb);
-
-    return (int)(size * nmemb);
+// the urls of the files used by the inputs of the passes
+static std::vector<std::string> ShaderUrlLoader_GetShadertoyInputsUrls(const ShaderToyFormat::ShadertoyStruct &vShaderToyStruct) {
+    std::vector<std::string> urls;
+    for (const auto &pass : vShaderToyStruct.renderpass) {
+        for (const auto &input : pass.inputs) {
+            if (input.type == "texture" || input.type == "music" || input.type == "volume") {
+                urls.push_back(input.filepath);
+            } else if (input.type == "cubemap") {
+                urls.push_back(input.filepath);
+                std::string ext = ".png";
+                size_t ext_pos = input.filepath.find(ext, 0);
+                if (ext_pos == std::string::npos) {
+                    ext = ".jpg";
+                    ext_pos = input.filepath.find(ext, 0);
+                }
+                if (ext_pos != std::string::npos) {
+                    const auto url_without_ext = input.filepath.substr(0, ext_pos);
+                    for (int face = 1; face < 6; ++face) {
+                        urls.push_back(url_without_ext + "_" + ct::toStr(face) + ext);
+                    }
+                }
+            }
+        }
+    }
+    return urls;
 }
 
 std::list<ShaderInfos> ShaderUrlLoader::GetShaderFromUrl(std::string vUrl,
@@ -67,8 +88,6 @@ std::list<ShaderInfos> ShaderUrlLoader::GetShaderFromUrl(std::string vUrl,
                                                          std::atomic<bool> &vImportInOneFile) {
     vProgress = 0.0f;
 
-    char errorBuffer[256];
-
     puUrl = vUrl;
     puShaderToyApiKey = vApiKey;
     puProxyPath = vProxyPath;
@@ -77,12 +96,6 @@ std::list<ShaderInfos> ShaderUrlLoader::GetShaderFromUrl(std::string vUrl,
     std::list<ShaderInfos> shaders;
 
     if (!puUrl.empty()) {
-        CURL *conn = nullptr;
-        CURLcode code;
-        //	std::string title;
-
-        std::string buffer;
-
         std::string id;
         std::string error;
         ShaderPlaform spf;
@@ -93,77 +106,24 @@ std::list<ShaderInfos> ShaderUrlLoader::GetShaderFromUrl(std::string vUrl,
             ShaderInfos *inf = &(*shaders.begin());
             inf->error = error;
             vUrlLoadingStatus = UrlLoadingStatus::URL_LOADING_STATUE_ERROR;
-        } else {
-            const int BufSize = 5000;
-            char url[BufSize];
-            size_t size = ct::mini<size_t>(BufSize, vUrl.length());
-            strncpy(url, vUrl.c_str(), size);
-            url[size] = '\0';
-
-            std::string errors = Curl_Init(conn, url, vTimeOutInSecond);
-            if (errors.empty()) {
-                if (vWorking) {
-                    code = curl_easy_setopt(conn, CURLOPT_WRITEFUNCTION, writer);
-                    if (code != CURLE_OK) {
-                        snprintf(errorBuffer, 256, "Failed to set writer [%s]\n", puErrorBuffer);
-                        LogVarError(errorBuffer);
-
-                        shaders.emplace_front(ShaderInfos());
-                        ShaderInfos *inf = &(*shaders.begin());
-                        inf->error = std::string(errorBuffer);
-                        vUrlLoadingStatus = UrlLoadingStatus::URL_LOADING_STATUE_ERROR;
-                        vWorking = false;
-                    } else {
-                        code = curl_easy_setopt(conn, CURLOPT_WRITEDATA, &buffer);
-                        if (code != CURLE_OK) {
-                            snprintf(errorBuffer, 256, "CURLOPT_WRITEDATA fail [%s]\n", puErrorBuffer);
-                            LogVarError(errorBuffer);
-
-                            shaders.emplace_front(ShaderInfos());
-                            ShaderInfos *inf = &(*shaders.begin());
-                            inf->error = std::string(errorBuffer);
-                            vUrlLoadingStatus = UrlLoadingStatus::URL_LOADING_STATUE_ERROR;
-                            vWorking = false;
-                        }
-                        if (vWorking) {
-                            if (code == CURLE_OK) {
-                                code = curl_easy_perform(conn);
-                                if (code != CURLE_OK) {
-                                    snprintf(errorBuffer, 256, "curl_easy_perform fail [%s]\n", puErrorBuffer);
-                                    LogVarError(errorBuffer);
-
-                                    shaders.emplace_front(ShaderInfos());
-                                    ShaderInfos *inf = &(*shaders.begin());
-                                    inf->error = std::string(errorBuffer);
-                                    vUrlLoadingStatus = UrlLoadingStatus::URL_LOADING_STATUE_ERROR;
-                                    vWorking = false;
-                                }
-                                if (vWorking) {
-                                    if (code == CURLE_OK) {
-                                        if (!buffer.empty()) {
-                                            shaders = ParseBuffer(
-                                                buffer, spf, id, std::ref(vProgress), std::ref(vWorking), std::ref(vGenerationTime), std::ref(vImportInOneFile));
-                                            vUrlLoadingStatus = UrlLoadingStatus::URL_LOADING_STATUE_OK;
-                                        }
-                                    } else {
-                                        if (code == CURLcode::CURLE_UNSUPPORTED_PROTOCOL) {
-                                            code = curl_easy_setopt(conn, CURLOPT_ERRORBUFFER, puErrorBuffer);
-
-                                            snprintf(errorBuffer, 256, "curl_easy_setopt fail [%s]\n", puErrorBuffer);
-                                            LogVarError(errorBuffer);
-
-                                            shaders.emplace_front(ShaderInfos());
-                                            ShaderInfos *inf = &(*shaders.begin());
-                                            inf->error = std::string(errorBuffer);
-                                            vUrlLoadingStatus = UrlLoadingStatus::URL_LOADING_STATUE_ERROR;
-                                            vWorking = false;
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        curl_easy_cleanup(conn);
+        } else if (vWorking) {
+            // a shader already imported is read from the cache, without network
+            auto fetcher = UrlFetcher::Instance();
+            fetcher->SetProxy(puUseProxy, puProxyPath, puUserPwd);
+            const auto result = fetcher->Fetch(vUrl, vTimeOutInSecond, &vWorking);
+            if (vWorking) {
+                if (!result.ok) {
+                    shaders.emplace_front(ShaderInfos());
+                    ShaderInfos *inf = &(*shaders.begin());
+                    inf->error = result.error + "\n";
+                    vUrlLoadingStatus = UrlLoadingStatus::URL_LOADING_STATUE_ERROR;
+                    vWorking = false;
+                } else if (!result.content.empty()) {
+                    shaders = ParseBuffer(result.content, spf, id, std::ref(vProgress), std::ref(vWorking), std::ref(vGenerationTime), std::ref(vImportInOneFile));
+                    vUrlLoadingStatus = UrlLoadingStatus::URL_LOADING_STATUE_OK;
+                    // an api error (bad key, etc..) is not kept in the cache
+                    if (!shaders.empty() && !shaders.front().error.empty()) {
+                        fetcher->Invalidate(vUrl);
                     }
                 }
             }
@@ -188,61 +148,25 @@ std::string ShaderUrlLoader::GetFileFromUrl(std::string vUrl, int vTimeOutInSeco
         (*vErrors).clear();
     }
 
-    // if (wxFile::Exists(filePathNameExt) == false)
-    {
-        CURL *conn = nullptr;
-        CURLcode code;
-        //	std::string title;
-
-        FILE *fp = nullptr;
-
-        // Ensure one argument is given
-        curl_global_init(CURL_GLOBAL_DEFAULT);
-
-        const size_t BufSize = 5000;
-        char url[BufSize];
-        const size_t size = ct::mini(BufSize, vUrl.length());
-        strncpy(url, vUrl.c_str(), size);
-        url[size] = '\0';
-
-        const std::string errors = Curl_Init(conn, url, vTimeOutInSecond);
-        if (errors.empty()) {
-            // on ouvre le canal vers un fichier
-            fp = fopen(filePathNameExt.c_str(), "wb");
-            code = curl_easy_setopt(conn, CURLOPT_WRITEDATA, fp);
-            if (code != CURLE_OK) {
-                snprintf(errorBuffer, 256, "CURLOPT_WRITEDATA fail [%s]\n", puErrorBuffer);
-                LogVarError(errorBuffer);
-                if (vErrors) {
-                    *vErrors = std::string(errorBuffer);
-                }
-            }
-            if (code == CURLE_OK) {
-                code = curl_easy_perform(conn);
-                if (code != CURLE_OK) {
-                    snprintf(errorBuffer, 256, "curl_easy_perform fail [%s]\n", puErrorBuffer);
-                    LogVarError(errorBuffer);
-                    if (vErrors) {
-                        *vErrors = std::string(errorBuffer);
-                    }
-                }
-                if (code == CURLE_OK) {
-                    fclose(fp);
-
-                    // ReSavePctureFile(filePathNameExt);
-                } else {
-                    if (code == CURLcode::CURLE_UNSUPPORTED_PROTOCOL) {
-                        code = curl_easy_setopt(conn, CURLOPT_ERRORBUFFER, puErrorBuffer);
-                        snprintf(errorBuffer, 256, "curl_easy_setopt fail [%s]\n", puErrorBuffer);
-                        LogVarError(errorBuffer);
-                        if (vErrors) {
-                            *vErrors = std::string(errorBuffer);
-                        }
-                    }
-                }
+    // the files prefetched by ParseBuffer are already in the cache
+    auto fetcher = UrlFetcher::Instance();
+    fetcher->SetProxy(puUseProxy, puProxyPath, puUserPwd);
+    const auto result = fetcher->Fetch(vUrl, vTimeOutInSecond);
+    if (!result.ok) {
+        if (vErrors) {
+            *vErrors = result.error;
+        }
+    } else if (!result.fromCache || !FileHelper::Instance()->IsFileExist(filePathNameExt, true)) {
+        // on ecrit le fichier dans les assets
+        std::ofstream file(filePathNameExt, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (file.is_open()) {
+            file.write(result.content.data(), result.content.size());
+        } else {
+            snprintf(errorBuffer, 256, "Can't write the file %s\n", filePathNameExt.c_str());
+            LogVarError(errorBuffer);
+            if (vErrors) {
+                *vErrors = std::string(errorBuffer);
             }
-
-            curl_easy_cleanup(conn);
         }
     }
 
@@ -857,6 +781,13 @@ std::list<ShaderInfos> ShaderUrlLoader::ParseBuffer(std::string vBuffer,
                             }
                         }
 
+                        // the files of the inputs are fetched at the same time, the GetFileFromUrl of the 3eme passe will use the cache
+                        if (vWorking) {
+                            auto fetcher = UrlFetcher::Instance();
+                            fetcher->SetProxy(puUseProxy, puProxyPath, puUserPwd);
+                            fetcher->FetchAll(ShaderUrlLoader_GetShadertoyInputsUrls(shStruct), 0, &vWorking);
+                        }
+
                         /////////////////////////////////////////////////////////////////////////
                         ////// 3eme passe : on fini l'association  //////////////////////////////
                         /////////////////////////////////////////////////////////////////////////
@@ -1276,9 +1207,11 @@ void ShaderUrlLoader::AddUniformsFromCode(ShaderInfos *vShaderInfos,
             // size_t uniforpuelse = vCode->find("@UNIFORMS_ELSE");
             // size_t uniforpuend = vCode->find("@UNIFORMS_END");
 
+            // the lexer give the uniform words and the comment zones, he is re done after each erase
+            ShaderCodeLexer lexer(*vCode);
             size_t uniforpupos = 0;
-            while ((uniforpupos = vCode->find("uniform ", uniforpupos)) != std::string::npos) {
-                if (!ShaderStageParsing::IfInCommentZone(*vCode, uniforpupos)) {
+            while ((uniforpupos = lexer.FindNextTag(ShaderTokenEnum::TOKEN_UNIFORM, uniforpupos)) != std::string::npos) {
+                if (vCode->compare(uniforpupos, 8U, "uniform ") == 0 && !lexer.IsInCommentZone(uniforpupos)) {
                     size_t coma_pos = vCode->find(';', uniforpupos);
                     size_t comeback_pos = vCode->find('\n', uniforpupos);
                     if (coma_pos != std::string::npos) {
@@ -1298,6 +1231,7 @@ void ShaderUrlLoader::AddUniformsFromCode(ShaderInfos *vShaderInfos,
                                 length_to_erase = coma_pos + 1 - uniforpupos;
                             }
                             vCode->erase(uniforpupos, length_to_erase);
+                            lexer.Lex(*vCode);
 
                             if (uniforpupos > 0)
                                 uniforpupos--;
@@ -1383,8 +1317,8 @@ void ShaderUrlLoader::AddUniformsFromCode(ShaderInfos *vShaderInfos,
                 uniforpupos += 1;
             }
 
-            size_t note_start = ShaderStageParsing::GetTagPos(*vCode, "@NOTE_START", 0, false, true);
-            size_t note_end = ShaderStageParsing::GetTagPos(*vCode, "@NOTE_END", 0, false, true);
+            size_t note_start = ShaderCodeLexer::FindWordTag(*vCode, "@NOTE_START", 0);
+            size_t note_end = ShaderCodeLexer::FindWordTag(*vCode, "@NOTE_END", 0);
 
             if (note_start != std::string::npos) {
                 if (note_end != std::string::npos) {
@@ -1411,9 +1345,9 @@ void ShaderUrlLoader::AddUniformsFromCode(ShaderInfos *vShaderInfos,
                 }
             }
 
-            size_t uniforms_start = ShaderStageParsing::GetTagPos(*vCode, "@UNIFORMS_START", 0, false, true);
-            size_t uniforpuelse = ShaderStageParsing::GetTagPos(*vCode, "@UNIFORMS_ELSE", 0, false, true);
-            size_t uniforpuend = ShaderStageParsing::GetTagPos(*vCode, "@UNIFORMS_END", 0, false, true);
+            size_t uniforms_start = ShaderCodeLexer::FindWordTag(*vCode, "@UNIFORMS_START", 0);
+            size_t uniforpuelse = ShaderCodeLexer::FindWordTag(*vCode, "@UNIFORMS_ELSE", 0);
+            size_t uniforpuend = ShaderCodeLexer::FindWordTag(*vCode, "@UNIFORMS_END", 0);
 
             if (uniforms_start != std::string::npos) {
                 if (uniforpuelse != std::string::npos) {
@@ -27,11 +27,16 @@
 
 #include <Importer/Format_ShaderToy.h>
 
+#include <algorithm>
+#include <unordered_map>
+
 ShadertoyBackupFileImportDlg::ShadertoyBackupFileImportDlg() {
     puShowDialog = false;
 }
 
 ShadertoyBackupFileImportDlg::~ShadertoyBackupFileImportDlg() {
+    StopImport();
+    StopIndexing();
 }
 
 void ShadertoyBackupFileImportDlg::OpenDialog(const std::string& vFilePathName) {
@@ -44,6 +49,8 @@ void ShadertoyBackupFileImportDlg::OpenDialog(const std::string& vFilePathName)
 }
 
 void ShadertoyBackupFileImportDlg::CloseDialog() {
+    StopImport();
+    StopIndexing();
     puShowDialog = false;
 }
 
@@ -51,6 +58,10 @@ bool ShadertoyBackupFileImportDlg::DrawDialog() {
     if (puShowDialog) {
         const auto res = false;
 
+        FinishIndexingIfRequired();
+        CreateParsedShaders();
+        FinishImportIfRequired();
+
         ImGui::Begin("Settings");
 
         DrawButtonsPane();
@@ -93,82 +104,147 @@ void ShadertoyBackupFileImportDlg::SetFunction_For_CreateOneFileShader(std::func
 ///// PRIVATE ///////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 
-void ShadertoyBackupFileImportDlg::ParseJsonArray(const picojson::array& vJsonArray) {
-    for (const auto& shader : vJsonArray) {
-        ShadertoyBackupFileInfo sha_info;
-
-        sha_info.shader_code = shader.serialize(false);
-
-        if (shader.contains("info")) {
-            picojson::value info = shader.get("info");
-
-            sha_info.id = info.get("id").to_str();
-            sha_info.id_for_search = ct::toLower(sha_info.id);
+void ShadertoyBackupFileImportDlg::Init(const std::string& vFilePathName) {
+    StopImport();
+    StopIndexing();
 
-            // 1668687822.067365000 => 17/11/2022 13:23:42.067365000
-            auto date = info.get("date").to_str();
-            if (date != "0") {
-                auto time = ct::ivariant(date).GetD();
-                std::time_t _epoch_time = (std::time_t)time;
-                auto tm = std::localtime(&_epoch_time);
-                sha_info.date = ct::toStr("%i/%i/%i %i:%i", tm->tm_year + 1900, tm->tm_mon, tm->tm_mday, tm->tm_hour, tm->tm_min);
-            }
+    m_FilePathName = vFilePathName;
+    m_Shaders.clear();
+    m_FilteredShaders.clear();
+    m_SearchIndex.Clear();
+    m_LastSearchPattern.clear();
 
-            sha_info.viewed = info.get("viewed").to_str();
-            sha_info.name = info.get("name").to_str();
-            sha_info.username = info.get("username").to_str();
-            sha_info.description = info.get("description").to_str();
-            sha_info.description_for_search = ct::toLower(sha_info.description);
-            sha_info.likes = info.get("likes").to_str();
-            sha_info.published = info.get("published").to_str();
-            sha_info.flags = info.get("flags").to_str();
-            sha_info.hasliked = info.get("hasliked").to_str();
-
-            if (info.get("tags").is<picojson::array>()) {
-                picojson::array tags = info.get("tags").get<picojson::array>();
-                for (const auto& tag : tags) {
-                    if (!sha_info.tags.empty())
-                        sha_info.tags += ", ";
-                    sha_info.tags += tag.to_str();
-                }
+    if (!m_FilePathName.empty()) {
+        // the file is not loaded, only scanned for the infos of the shaders
+        m_IndexingProgress = 0.0;
+        m_IndexingWorking = true;
+        m_IndexingThread = std::thread([this]() {
+            if (ShadertoyBackupFileIndexer::Index(m_FilePathName, m_IndexedShaders, &m_IndexingProgress, &m_IndexingWorking) && m_IndexingWorking) {
+                m_IndexedSearchIndex.Build(m_IndexedShaders);
             }
-            sha_info.tags_for_search = ct::toLower(sha_info.tags);
-        }
+            m_IndexingWorking = false;
+        });
+    }
+}
 
-        if (shader.get("renderpass").is<picojson::array>()) {
-            sha_info.count_renderpasses = shader.get("renderpass").get<picojson::array>().size();
-        }
+void ShadertoyBackupFileImportDlg::StopIndexing() {
+    if (m_IndexingThread.joinable()) {
+        m_IndexingWorking = false;
+        m_IndexingThread.join();
+    }
+    m_IndexedShaders.clear();
+    m_IndexedSearchIndex.Clear();
+}
 
-        m_Shaders.push_back(sha_info);
+bool ShadertoyBackupFileImportDlg::FinishIndexingIfRequired() {
+    if (m_IndexingThread.joinable() && !m_IndexingWorking) {
+        m_IndexingThread.join();
+        m_Shaders = std::move(m_IndexedShaders);
+        m_IndexedShaders.clear();
+        m_SearchIndex = std::move(m_IndexedSearchIndex);
+        m_IndexedSearchIndex.Clear();
+        m_LastSearchPattern.clear();
+        prApplyFiltering(m_SearchBuffer);
+        return true;
     }
+    return false;
+}
 
-    prApplyFiltering(m_SearchBuffer);
+bool ShadertoyBackupFileImportDlg::IsImporting() const {
+    return !m_ImportThreads.empty();
 }
 
-void ShadertoyBackupFileImportDlg::Init(const std::string& vFilePathName) {
-    m_FilePathName = vFilePathName;
+// the workers waiting for space in the queue are woken
+void ShadertoyBackupFileImportDlg::AbortImport() {
+    {
+        std::lock_guard<std::mutex> lock(m_ImportParsedShadersMutex);
+        m_ImportWorking = false;
+    }
+    m_ImportSpaceCondition.notify_all();
+}
 
-    if (!m_FilePathName.empty()) {
-        m_Shaders.clear();
+void ShadertoyBackupFileImportDlg::StopImport() {
+    AbortImport();
+    for (auto& thread : m_ImportThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    m_ImportThreads.clear();
+    m_ImportJobs.clear();
+    std::lock_guard<std::mutex> lock(m_ImportParsedShadersMutex);
+    m_ImportParsedShaders.clear();
+}
+
+bool ShadertoyBackupFileImportDlg::FinishImportIfRequired() {
+    if (IsImporting() && !m_ImportCountRunningWorkers) {
+        const bool aborted = !m_ImportWorking;
+        if (!aborted) {
+            CreateParsedShaders();  // the last ones
+        }
+        StopImport();
+        LogVarInfo("%u shaders imported in %s%s", (uint32_t)m_ImportCountImported, m_ImportPath.c_str(), aborted ? " (aborted)" : "");
+        return true;
+    }
+    return false;
+}
 
-        auto file_string = FileHelper::Instance()->LoadFileToString(m_FilePathName);
+// the create functions write the files and can touch the ui, so they are called by the main thread
+void ShadertoyBackupFileImportDlg::CreateParsedShaders() {
+    std::list<std::list<ShaderInfos>> parsedShaders;
+    {
+        std::lock_guard<std::mutex> lock(m_ImportParsedShadersMutex);
+        parsedShaders.swap(m_ImportParsedShaders);
+    }
+    m_ImportSpaceCondition.notify_all();
 
-        picojson::value _jsonParser;
-        picojson::parse(_jsonParser, file_string);
+    for (const auto& shader_list : parsedShaders) {
+        if (!m_ImportWorking)
+            break;
+        if (m_CreateOneFileShader && m_CreateOneFileShaderFunc) {
+            m_CreateOneFileShaderFunc(m_ImportPath, shader_list);
+        } else if (m_CreateManyFilesShaderFunc) {
+            m_CreateManyFilesShaderFunc(m_ImportPath, shader_list);
+        }
+        ++m_ImportCountImported;
+    }
+}
 
-        const std::string& err = picojson::get_last_error();
-        if (!err.empty()) {
-            LogVarError("%s", err.c_str());
-        } else if (_jsonParser.is<picojson::object>()) {
-            if (_jsonParser.contains("shaders")) {
-                if (_jsonParser.get("shaders").is<picojson::array>()) {
-                    ParseJsonArray(_jsonParser.get("shaders").get<picojson::array>());
+// each worker have his file stream and take the next job until the end or the abort
+void ShadertoyBackupFileImportDlg::ImportWorker() {
+    std::ifstream file(m_FilePathName, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        LogVarError("Can't open the file %s", m_FilePathName.c_str());
+    } else {
+        std::string shader_code;
+        while (m_ImportWorking) {
+            const size_t jobIdx = m_ImportNextJob++;
+            if (jobIdx >= m_ImportJobs.size())
+                break;
+
+            const auto& shader = m_ImportJobs[jobIdx];
+
+            // the json of the shader is read and parsed only now
+            if (ShadertoyBackupFileIndexer::LoadShaderCode(file, shader, shader_code)) {
+                ImporterFromShadertoy _importer;
+                auto shader_list = _importer.ParseBuffer(shader_code, shader.id);
+                if (!shader_list.empty()) {
+                    // backpressure : the parsed shaders are kept in memory until created by the main thread
+                    std::unique_lock<std::mutex> lock(m_ImportParsedShadersMutex);
+                    m_ImportSpaceCondition.wait(lock, [this]() { return m_ImportParsedShaders.size() < m_ImportMaxParsedShaders || !m_ImportWorking; });
+                    if (!m_ImportWorking)
+                        break;
+                    m_ImportParsedShaders.push_back(std::move(shader_list));
                 }
+            } else {
+                LogVarError("Can't read the shader %s in the file %s", shader.id.c_str(), m_FilePathName.c_str());
             }
-        } else if (_jsonParser.is<picojson::array>()) {
-            ParseJsonArray(_jsonParser.get<picojson::array>());
+
+            ++m_ImportCountDone;
         }
     }
+
+    --m_ImportCountRunningWorkers;
 }
 
 void ShadertoyBackupFileImportDlg::DrawContentPane() {
@@ -206,7 +282,7 @@ void ShadertoyBackupFileImportDlg::DrawContentPane() {
                 if (i < 0)
                     continue;
 
-                auto& infos = m_FilteredShaders.at((size_t)i);
+                auto& infos = m_Shaders.at(m_FilteredShaders.at((size_t)i));
 
                 ImGui::TableNextRow();
 
@@ -313,26 +389,44 @@ void ShadertoyBackupFileImportDlg::DrawButtonsPane() {
 
     ImGui::SameLine();
 
-    if (ImGui::ContrastedButton("Import Selected Shaders")) {
-        IGFD::FileDialogConfig config;
-        config.path = ".";
-        config.countSelectionMax = 1;
-        config.flags = ImGuiFileDialogFlags_Modal;
-        ImGuiFileDialog::Instance()->OpenDialog("ImportSelectedShaders", "Where create shader files (if exsiting files will be overwritten)", nullptr, config);
-    }
+    if (IsImporting()) {
+        const auto countJobs = (uint32_t)m_ImportJobs.size();
+        const auto countDone = (uint32_t)std::min<size_t>(m_ImportCountDone, m_ImportJobs.size());
+        const auto progressText = ct::toStr("Importing %u / %u", countDone, countJobs);
+        ImGui::ProgressBar(countJobs ? (float)countDone / (float)countJobs : 0.0f, ImVec2(200.0f, 0.0f), progressText.c_str());
 
-    ImGui::SameLine();
+        ImGui::SameLine();
+
+        if (ImGui::ContrastedButton("Abort##ShadertoyBackupFileImportDlg")) {
+            AbortImport();
+        }
+    } else {
+        if (ImGui::ContrastedButton("Import Selected Shaders")) {
+            IGFD::FileDialogConfig config;
+            config.path = ".";
+            config.countSelectionMax = 1;
+            config.flags = ImGuiFileDialogFlags_Modal;
+            ImGuiFileDialog::Instance()->OpenDialog("ImportSelectedShaders", "Where create shader files (if exsiting files will be overwritten)", nullptr, config);
+        }
+
+        ImGui::SameLine();
 
-    if (ImGui::ContrastedButton("Import All Shaders")) {
-        IGFD::FileDialogConfig config;
-        config.path = ".";
-        config.countSelectionMax = 1;
-        config.flags = ImGuiFileDialogFlags_Modal;
-        ImGuiFileDialog::Instance()->OpenDialog("ImportAllShaders", "Where create shader files (if exsiting files will be overwritten)", nullptr, config);
+        if (ImGui::ContrastedButton("Import All Shaders")) {
+            IGFD::FileDialogConfig config;
+            config.path = ".";
+            config.countSelectionMax = 1;
+            config.flags = ImGuiFileDialogFlags_Modal;
+            ImGuiFileDialog::Instance()->OpenDialog("ImportAllShaders", "Where create shader files (if exsiting files will be overwritten)", nullptr, config);
+        }
     }
 
     ImGui::SeparatorEx(ImGuiSeparatorFlags_Vertical);
 
+    if (m_IndexingThread.joinable()) {
+        ImGui::ProgressBar((float)m_IndexingProgress, ImVec2(150.0f, 0.0f), "Indexing");
+        ImGui::SameLine();
+    }
+
     ImGui::Text("Search : ");
 
     ImGui::SameLine();
@@ -381,74 +475,70 @@ bool ShadertoyBackupFileImportDlg::setFromXml(tinyxml2::XMLElement* vElem, tinyx
     return false;
 }
 
-void ShadertoyBackupFileImportDlg::prImportSelectedShaders(const std::string& vPath) {
+void ShadertoyBackupFileImportDlg::prImportShaders(const std::string& vPath, const bool& vOnlySelected) {
+    if (IsImporting())
+        return;
+
     if (m_CreateOneFileShader) {
         LogAssert(m_CreateOneFileShaderFunc != nullptr, "m_CreateOneFileShaderFunc is null");
     } else {
         LogAssert(m_CreateManyFilesShaderFunc != nullptr, "m_CreateManyFilesShaderFunc is null");
     }
 
-    std::unordered_map<std::string, std::list<ShaderInfos>> _shaders;
-
-    for (const auto& shader : m_FilteredShaders) {
-        if (shader.selected) {
-            ImporterFromShadertoy _importer;
-            auto shader_list = _importer.ParseBuffer(shader.shader_code, shader.id);
-            if (!shader_list.empty()) {
-                _shaders[shader.id] = shader_list;
+    // a shader can be many times in the backup, he is imported one time, the last one win
+    std::unordered_map<std::string, size_t> jobIdxById;
+    m_ImportJobs.clear();
+    for (const auto& idx : m_FilteredShaders) {
+        const auto& shader = m_Shaders.at(idx);
+        if (!vOnlySelected || shader.selected) {
+            auto it = jobIdxById.find(shader.id);
+            if (it != jobIdxById.end()) {
+                m_ImportJobs[it->second] = shader;
+            } else {
+                jobIdxById[shader.id] = m_ImportJobs.size();
+                m_ImportJobs.push_back(shader);
             }
         }
     }
 
-    for (const auto& shader : _shaders) {
-        if (m_CreateOneFileShader && m_CreateOneFileShaderFunc) {
-            m_CreateOneFileShaderFunc(vPath, shader.second);
-        } else if (m_CreateManyFilesShaderFunc) {
-            m_CreateManyFilesShaderFunc(vPath, shader.second);
-        }
-    }
-}
+    if (m_ImportJobs.empty())
+        return;
 
-void ShadertoyBackupFileImportDlg::prImportAllShaders(const std::string& vPath) {
-    if (m_CreateOneFileShader) {
-        LogAssert(m_CreateOneFileShaderFunc != nullptr, "m_CreateOneFileShaderFunc is null");
-    } else {
-        LogAssert(m_CreateManyFilesShaderFunc != nullptr, "m_CreateManyFilesShaderFunc is null");
+    m_ImportPath = vPath;
+    m_ImportNextJob = 0U;
+    m_ImportCountDone = 0U;
+    m_ImportCountImported = 0U;
+    m_ImportWorking = true;
+
+    // one thread is kept for the rendering
+    const size_t countThreads = std::max<size_t>(2U, std::thread::hardware_concurrency());
+    const size_t countWorkers = std::min<size_t>(std::min<size_t>(countThreads - 1U, 8U), m_ImportJobs.size());
+    m_ImportCountRunningWorkers = countWorkers;
+    m_ImportMaxParsedShaders = countWorkers * 2U;
+    for (size_t i = 0U; i < countWorkers; ++i) {
+        m_ImportThreads.emplace_back(&ShadertoyBackupFileImportDlg::ImportWorker, this);
     }
+}
 
-    std::unordered_map<std::string, std::list<ShaderInfos>> _shaders;
-
-    for (const auto& shader : m_FilteredShaders) {
-        ImporterFromShadertoy _importer;
-        auto shader_list = _importer.ParseBuffer(shader.shader_code, shader.id);
-        if (!shader_list.empty()) {
-            _shaders[shader.id] = shader_list;
-        }
-    }
+void ShadertoyBackupFileImportDlg::prImportSelectedShaders(const std::string& vPath) {
+    prImportShaders(vPath, true);
+}
 
-    for (const auto& shader : _shaders) {
-        if (m_CreateOneFileShader && m_CreateOneFileShaderFunc) {
-            m_CreateOneFileShaderFunc(vPath, shader.second);
-        } else if (m_CreateManyFilesShaderFunc) {
-            m_CreateManyFilesShaderFunc(vPath, shader.second);
-        }
-    }
+void ShadertoyBackupFileImportDlg::prImportAllShaders(const std::string& vPath) {
+    prImportShaders(vPath, false);
 }
 
 void ShadertoyBackupFileImportDlg::prApplyFiltering(const std::string& vSearchPattern) {
-    m_FilteredShaders.clear();
-
-    if (vSearchPattern.empty()) {
-        m_FilteredShaders = m_Shaders;
-        return;
-    }
-
     const auto pattern = ct::toLower(vSearchPattern);
 
-    for (const auto& shader : m_Shaders) {
-        if (shader.description_for_search.find(pattern) != std::string::npos || shader.tags_for_search.find(pattern) != std::string::npos ||
-            shader.id_for_search.find(pattern) != std::string::npos) {
-            m_FilteredShaders.push_back(shader);
-        }
+    // a completed pattern can only match the shaders who match the previous pattern
+    if (!m_LastSearchPattern.empty() && pattern.size() > m_LastSearchPattern.size() && pattern.find(m_LastSearchPattern) != std::string::npos) {
+        std::vector<size_t> refined;
+        m_SearchIndex.Refine(pattern, m_FilteredShaders, refined);
+        m_FilteredShaders.swap(refined);
+    } else {
+        m_SearchIndex.Search(pattern, m_FilteredShaders);
     }
-}
\ No newline at end of file
+
+    m_LastSearchPattern = pattern;
+}
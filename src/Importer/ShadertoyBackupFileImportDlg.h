@@ -20,33 +20,17 @@
 #include <vector>
 #include <string>
 #include <future>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <functional>
 #include <imgui.h>
-#include <picojson.h>
 #include <tinyxml2.h>
 #include <ctools/ConfigAbstract.h>
 #include <Importer/ImporterFromShadertoy.h>
-
-class ShadertoyBackupFileInfo {
-public:
-    bool selected = false;
-    std::string id;
-    std::string id_for_search;  // lower case for search
-    std::string date;
-    std::string viewed;
-    std::string name;
-    std::string username;
-    std::string description;
-    std::string description_for_search;  // lower case for search
-    std::string likes;
-    std::string published;
-    std::string flags;
-    std::string tags;
-    std::string tags_for_search;  // lower case for search
-    size_t count_renderpasses;
-    std::string hasliked;
-    std::string shader_code;
-};
+#include <Importer/ShadertoyBackupFileIndexer.h>
+#include <Importer/ShadertoyBackupFileSearchIndex.h>
 
 class ShadertoyBackupFileImportDlg : public conf::ConfigAbstract {
 private:
@@ -54,7 +38,31 @@ private:
     bool m_CreateOneFileShader = true;
     std::string m_FilePathName;
     std::vector<ShadertoyBackupFileInfo> m_Shaders;
-    std::vector<ShadertoyBackupFileInfo> m_FilteredShaders;
+    std::vector<size_t> m_FilteredShaders;  // index in m_Shaders
+    ShadertoyBackupFileSearchIndex m_SearchIndex;
+    std::string m_LastSearchPattern;  // for refine m_FilteredShaders when the pattern is completed
+
+    // the backup file is indexed in a thread
+    std::thread m_IndexingThread;
+    std::vector<ShadertoyBackupFileInfo> m_IndexedShaders;  // owned by the thread until the join
+    ShadertoyBackupFileSearchIndex m_IndexedSearchIndex;     // owned by the thread until the join
+    std::atomic<double> m_IndexingProgress{0.0};
+    std::atomic<bool> m_IndexingWorking{false};
+
+    // the shaders are parsed by a pool of threads, and created by the main thread
+    std::vector<std::thread> m_ImportThreads;
+    std::vector<ShadertoyBackupFileInfo> m_ImportJobs;  // one job by shader id
+    std::string m_ImportPath;
+    std::atomic<size_t> m_ImportNextJob{0U};
+    std::atomic<size_t> m_ImportCountDone{0U};
+    std::atomic<size_t> m_ImportCountImported{0U};
+    std::atomic<size_t> m_ImportCountRunningWorkers{0U};
+    std::atomic<bool> m_ImportWorking{false};
+    std::list<std::list<ShaderInfos>> m_ImportParsedShaders;  // filled by the workers, emptied by the main thread
+    std::mutex m_ImportParsedShadersMutex;
+    std::condition_variable m_ImportSpaceCondition;  // the main thread have emptied the queue, for the workers
+    size_t m_ImportMaxParsedShaders = 0U;           // the workers wait when the queue is full
+
     ImGuiListClipper m_VirtualClipper;
     std::function<std::string(std::string, std::list<ShaderInfos>)> m_CreateManyFilesShaderFunc = nullptr;
     std::function<std::string(std::string, std::list<ShaderInfos>)> m_CreateOneFileShaderFunc = nullptr;
@@ -70,6 +78,14 @@ public:
 
 private:
     void Init(const std::string& vFilePathName);
+    void StopIndexing();
+    bool FinishIndexingIfRequired();
+    bool IsImporting() const;
+    void AbortImport();
+    void StopImport();
+    bool FinishImportIfRequired();
+    void CreateParsedShaders();
+    void ImportWorker();
     void DrawContentPane();
     void DrawButtonsPane();
 
@@ -78,7 +94,7 @@ public:
     bool setFromXml(tinyxml2::XMLElement* vElem, tinyxml2::XMLElement* vParent, const std::string& vUserDatas = "") override;
 
 private:
-    void ParseJsonArray(const picojson::array& vJsonArray);
+    void prImportShaders(const std::string& vPath, const bool& vOnlySelected);
     void prImportSelectedShaders(const std::string& vPath);
     void prImportAllShaders(const std::string& vPath);
     void prApplyFiltering(const std::string& vSearchPattern);
@@ -0,0 +1,396 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "ShadertoyBackupFileIndexer.h"
+
+#include <ctools/cTools.h>
+#include <ctools/Logger.h>
+
+#include <ctime>
+
+#define SHADERTOY_BACKUP_READ_CHUNK_SIZE (1U << 20U)  // 1 Mo
+
+// buffered read of the file, with the absolute position of the next char
+struct ShadertoyBackupFileIndexer_Reader {
+    std::ifstream file;
+    std::vector<char> buffer;
+    size_t pos = 0U;
+    size_t len = 0U;
+    uint64_t bufferOffset = 0U;
+    uint64_t fileSize = 0U;
+    std::atomic<double>* progress = nullptr;
+    std::atomic<bool>* working = nullptr;
+    bool aborted = false;
+
+    bool Fill() {
+        if (working && !(*working)) {
+            aborted = true;
+            return false;
+        }
+        bufferOffset += len;
+        pos = 0U;
+        file.read(buffer.data(), buffer.size());
+        len = (size_t)file.gcount();
+        if (progress && fileSize) {
+            *progress = (double)bufferOffset / (double)fileSize;
+        }
+        return len > 0U;
+    }
+    bool Peek(char& vChar) {
+        if (pos >= len && !Fill())
+            return false;
+        vChar = buffer[pos];
+        return true;
+    }
+    bool Get(char& vChar) {
+        if (!Peek(vChar))
+            return false;
+        ++pos;
+        return true;
+    }
+    uint64_t Tell() const {
+        return bufferOffset + pos;
+    }
+};
+
+struct ShadertoyBackupFileIndexer_Container {
+    bool isObject = false;
+    bool expectKey = false;
+    std::string key;        // key of the current value, for an object
+    std::string parentKey;  // key of this container in his parent
+    size_t countItems = 0U;
+};
+
+typedef std::vector<ShadertoyBackupFileIndexer_Container> ShadertoyBackupFileIndexer_Stack;
+
+static void ShadertoyBackupFileIndexer_AppendUtf8(std::string& vStr, uint32_t vCode) {
+    if (vCode < 0x80U) {
+        vStr += (char)vCode;
+    } else if (vCode < 0x800U) {
+        vStr += (char)(0xC0U | (vCode >> 6U));
+        vStr += (char)(0x80U | (vCode & 0x3FU));
+    } else if (vCode < 0x10000U) {
+        vStr += (char)(0xE0U | (vCode >> 12U));
+        vStr += (char)(0x80U | ((vCode >> 6U) & 0x3FU));
+        vStr += (char)(0x80U | (vCode & 0x3FU));
+    } else {
+        vStr += (char)(0xF0U | (vCode >> 18U));
+        vStr += (char)(0x80U | ((vCode >> 12U) & 0x3FU));
+        vStr += (char)(0x80U | ((vCode >> 6U) & 0x3FU));
+        vStr += (char)(0x80U | (vCode & 0x3FU));
+    }
+}
+
+static bool ShadertoyBackupFileIndexer_ReadHex4(ShadertoyBackupFileIndexer_Reader& vReader, uint32_t& vOutCode) {
+    vOutCode = 0U;
+    char c = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (!vReader.Get(c))
+            return false;
+        vOutCode <<= 4U;
+        if (c >= '0' && c <= '9') {
+            vOutCode |= (uint32_t)(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            vOutCode |= (uint32_t)(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            vOutCode |= (uint32_t)(c - 'A' + 10);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the opening quote is already read, vOutStr can be null for skip the string (the shader codes)
+static bool ShadertoyBackupFileIndexer_ReadString(ShadertoyBackupFileIndexer_Reader& vReader, std::string* vOutStr) {
+    if (vOutStr)
+        vOutStr->clear();
+
+    char c = 0;
+    while (vReader.Get(c)) {
+        if (c == '"')
+            return true;
+        if (c == '\\') {
+            if (!vReader.Get(c))
+                return false;
+            if (!vOutStr) {
+                continue;
+            }
+            switch (c) {
+                case 'b': *vOutStr += '\b'; break;
+                case 'f': *vOutStr += '\f'; break;
+                case 'n': *vOutStr += '\n'; break;
+                case 'r': *vOutStr += '\r'; break;
+                case 't': *vOutStr += '\t'; break;
+                case 'u': {
+                    uint32_t code = 0U;
+                    if (!ShadertoyBackupFileIndexer_ReadHex4(vReader, code))
+                        return false;
+                    // surrogate pair
+                    if (code >= 0xD800U && code <= 0xDBFFU) {
+                        char e = 0;
+                        uint32_t low = 0U;
+                        if (!vReader.Get(c) || !vReader.Get(e) || c != '\\' || e != 'u' || !ShadertoyBackupFileIndexer_ReadHex4(vReader, low))
+                            return false;
+                        code = 0x10000U + ((code - 0xD800U) << 10U) + (low - 0xDC00U);
+                    }
+                    ShadertoyBackupFileIndexer_AppendUtf8(*vOutStr, code);
+                    break;
+                }
+                default: *vOutStr += c; break;  // " \ /
+            }
+        } else if (vOutStr) {
+            *vOutStr += c;
+        }
+    }
+
+    return false;
+}
+
+// a new value in the current container, return the key of the value if the container is an object
+static std::string ShadertoyBackupFileIndexer_BeginValue(ShadertoyBackupFileIndexer_Stack& vStack) {
+    if (!vStack.empty()) {
+        auto& cont = vStack.back();
+        ++cont.countItems;
+        if (cont.isObject)
+            return cont.key;
+    }
+    return "";
+}
+
+// the field of the info who must receive the current value, nullptr if the value is not needed
+static std::string* ShadertoyBackupFileIndexer_GetInfoField(ShadertoyBackupFileInfo& vInfo,
+                                                           const ShadertoyBackupFileIndexer_Stack& vStack,
+                                                           const size_t& vShadersDepth,
+                                                           bool* vIsTag) {
+    *vIsTag = false;
+
+    if (!vShadersDepth || vStack.empty())
+        return nullptr;
+
+    const auto& cont = vStack.back();
+
+    // shaders[n].info.key
+    if (vStack.size() == vShadersDepth + 2U && cont.isObject && cont.parentKey == "info") {
+        const auto& key = cont.key;
+        if (key == "id")
+            return &vInfo.id;
+        if (key == "date")
+            return &vInfo.date;
+        if (key == "viewed")
+            return &vInfo.viewed;
+        if (key == "name")
+            return &vInfo.name;
+        if (key == "username")
+            return &vInfo.username;
+        if (key == "description")
+            return &vInfo.description;
+        if (key == "likes")
+            return &vInfo.likes;
+        if (key == "published")
+            return &vInfo.published;
+        if (key == "flags")
+            return &vInfo.flags;
+        if (key == "hasliked")
+            return &vInfo.hasliked;
+    }
+
+    // shaders[n].info.tags[m]
+    if (vStack.size() == vShadersDepth + 3U && !cont.isObject && cont.parentKey == "tags" && vStack[vStack.size() - 2U].parentKey == "info") {
+        *vIsTag = true;
+        return &vInfo.tags;
+    }
+
+    return nullptr;
+}
+
+static void ShadertoyBackupFileIndexer_SetValue(std::string* vField, const bool& vIsTag, const std::string& vValue) {
+    if (vField) {
+        if (vIsTag) {
+            if (!vField->empty())
+                *vField += ", ";
+            *vField += vValue;
+        } else {
+            *vField = vValue;
+        }
+    }
+}
+
+static void ShadertoyBackupFileIndexer_CompleteInfo(ShadertoyBackupFileInfo& vInfo) {
+    // 1668687822.067365000 => 17/11/2022 13:23:42.067365000
+    const auto date = vInfo.date;
+    vInfo.date.clear();
+    if (!date.empty() && date != "0") {
+        auto time = ct::ivariant(date).GetD();
+        std::time_t _epoch_time = (std::time_t)time;
+        auto tm = std::localtime(&_epoch_time);
+        if (tm) {
+            vInfo.date = ct::toStr("%i/%i/%i %i:%i", tm->tm_year + 1900, tm->tm_mon, tm->tm_mday, tm->tm_hour, tm->tm_min);
+        }
+    }
+}
+
+bool ShadertoyBackupFileIndexer::Index(const std::string& vFilePathName,
+                                       std::vector<ShadertoyBackupFileInfo>& vOutShaders,
+                                       std::atomic<double>* vProgress,
+                                       std::atomic<bool>* vWorking) {
+    vOutShaders.clear();
+
+    ShadertoyBackupFileIndexer_Reader reader;
+    reader.file.open(vFilePathName, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!reader.file.is_open()) {
+        LogVarError("Can't open the file %s", vFilePathName.c_str());
+        return false;
+    }
+    reader.fileSize = (uint64_t)reader.file.tellg();
+    reader.file.seekg(0, std::ios::beg);
+    reader.buffer.resize(SHADERTOY_BACKUP_READ_CHUNK_SIZE);
+    reader.progress = vProgress;
+    reader.working = vWorking;
+
+    ShadertoyBackupFileIndexer_Stack stack;
+    size_t shadersDepth = 0U;  // size of the stack in the shaders array, 0 until found
+    ShadertoyBackupFileInfo info;
+    std::string value;
+    bool isTag = false;
+    bool ok = true;
+    bool done = false;
+
+    char c = 0;
+    while (ok && !done && reader.Get(c)) {
+        switch (c) {
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+            case ':': break;
+            case ',': {
+                if (!stack.empty() && stack.back().isObject)
+                    stack.back().expectKey = true;
+                break;
+            }
+            case '{':
+            case '[': {
+                ShadertoyBackupFileIndexer_Container cont;
+                cont.isObject = (c == '{');
+                cont.expectKey = cont.isObject;
+                cont.parentKey = ShadertoyBackupFileIndexer_BeginValue(stack);
+                stack.push_back(cont);
+
+                // the root array, or the array of the key "shaders" of the root object
+                if (!shadersDepth && !cont.isObject) {
+                    if (stack.size() == 1U || (stack.size() == 2U && stack[0].isObject && cont.parentKey == "shaders")) {
+                        shadersDepth = stack.size();
+                    }
+                }
+
+                // a new shader
+                if (shadersDepth && cont.isObject && stack.size() == shadersDepth + 1U) {
+                    info = ShadertoyBackupFileInfo();
+                    info.json_offset = reader.Tell() - 1U;
+                }
+                break;
+            }
+            case '}':
+            case ']': {
+                if (stack.empty() || stack.back().isObject != (c == '}')) {
+                    ok = false;
+                    break;
+                }
+
+                const auto cont = std::move(stack.back());
+                stack.pop_back();
+
+                if (shadersDepth) {
+                    if (stack.size() == shadersDepth && cont.isObject) {
+                        info.json_size = reader.Tell() - info.json_offset;
+                        ShadertoyBackupFileIndexer_CompleteInfo(info);
+                        vOutShaders.push_back(std::move(info));
+                        info = ShadertoyBackupFileInfo();
+                    } else if (stack.size() == shadersDepth + 1U && !cont.isObject && cont.parentKey == "renderpass") {
+                        info.count_renderpasses = cont.countItems;
+                    } else if (stack.size() + 1U == shadersDepth) {
+                        done = true;  // the rest of the file is not needed
+                    }
+                }
+                break;
+            }
+            case '"': {
+                if (!stack.empty() && stack.back().isObject && stack.back().expectKey) {
+                    ok = ShadertoyBackupFileIndexer_ReadString(reader, &stack.back().key);
+                    stack.back().expectKey = false;
+                } else {
+                    auto fieldPtr = ShadertoyBackupFileIndexer_GetInfoField(info, stack, shadersDepth, &isTag);
+                    ShadertoyBackupFileIndexer_BeginValue(stack);
+                    if (fieldPtr) {
+                        ok = ShadertoyBackupFileIndexer_ReadString(reader, &value);
+                        ShadertoyBackupFileIndexer_SetValue(fieldPtr, isTag, value);
+                    } else {
+                        ok = ShadertoyBackupFileIndexer_ReadString(reader, nullptr);
+                    }
+                }
+                break;
+            }
+            default: {  // number, true, false, null
+                value = c;
+                while (reader.Peek(c) && c != ',' && c != '}' && c != ']' && c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                    value += c;
+                    reader.Get(c);
+                }
+                auto fieldPtr = ShadertoyBackupFileIndexer_GetInfoField(info, stack, shadersDepth, &isTag);
+                ShadertoyBackupFileIndexer_BeginValue(stack);
+                ShadertoyBackupFileIndexer_SetValue(fieldPtr, isTag, value);
+                break;
+            }
+        }
+    }
+
+    if (reader.aborted) {
+        vOutShaders.clear();
+        return false;
+    }
+
+    if (!ok || (!done && !stack.empty())) {
+        LogVarError("Bad json syntax in %s near the offset %llu", vFilePathName.c_str(), (unsigned long long)reader.Tell());
+        return false;
+    }
+
+    if (vProgress) {
+        *vProgress = 1.0;
+    }
+
+    return true;
+}
+
+bool ShadertoyBackupFileIndexer::LoadShaderCode(std::ifstream& vFile, const ShadertoyBackupFileInfo& vInfo, std::string& vOutCode) {
+    vOutCode.clear();
+
+    if (!vFile.is_open() || !vInfo.json_size)
+        return false;
+
+    vOutCode.resize((size_t)vInfo.json_size);
+    vFile.clear();
+    vFile.seekg((std::streamoff)vInfo.json_offset, std::ios::beg);
+    vFile.read(&vOutCode[0], (std::streamsize)vInfo.json_size);
+    if ((uint64_t)vFile.gcount() != vInfo.json_size) {
+        vOutCode.clear();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,56 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+class ShadertoyBackupFileInfo {
+public:
+    bool selected = false;
+    std::string id;
+    std::string date;
+    std::string viewed;
+    std::string name;
+    std::string username;
+    std::string description;
+    std::string likes;
+    std::string published;
+    std::string flags;
+    std::string tags;
+    size_t count_renderpasses = 0U;
+    std::string hasliked;
+    // the json of the shader in the backup file, loaded only for the import
+    uint64_t json_offset = 0U;
+    uint64_t json_size = 0U;
+};
+
+// streaming scan of a shadertoy backup file (an array of shaders, or an object with a "shaders" array)
+// the file is read by chunks and never parsed in a dom, only the infos of each shader are kept
+// with the position of his json in the file, so the shader code is read and parsed only when imported
+class ShadertoyBackupFileIndexer {
+public:
+    // vProgress in [0:1], the scan stop if vWorking become false
+    static bool Index(const std::string& vFilePathName,
+                      std::vector<ShadertoyBackupFileInfo>& vOutShaders,
+                      std::atomic<double>* vProgress = nullptr,
+                      std::atomic<bool>* vWorking = nullptr);
+    // the json of the shader, like the picojson serialize of the shader object
+    static bool LoadShaderCode(std::ifstream& vFile, const ShadertoyBackupFileInfo& vInfo, std::string& vOutCode);
+};
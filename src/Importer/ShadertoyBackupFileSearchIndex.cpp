@@ -0,0 +1,127 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "ShadertoyBackupFileSearchIndex.h"
+
+#include <Importer/ShadertoyBackupFileIndexer.h>
+#include <ctools/cTools.h>
+
+#include <iterator>
+#include <algorithm>
+
+static uint32_t ShadertoyBackupFileSearchIndex_GetTrigram(const std::string& vStr, const size_t& vPos) {
+    return ((uint32_t)(uint8_t)vStr[vPos] << 16U) | ((uint32_t)(uint8_t)vStr[vPos + 1U] << 8U) | (uint32_t)(uint8_t)vStr[vPos + 2U];
+}
+
+void ShadertoyBackupFileSearchIndex::Clear() {
+    m_Texts.clear();
+    m_Postings.clear();
+}
+
+void ShadertoyBackupFileSearchIndex::Build(const std::vector<ShadertoyBackupFileInfo>& vShaders) {
+    Clear();
+
+    m_Texts.reserve(vShaders.size());
+    for (size_t idx = 0U; idx < vShaders.size(); ++idx) {
+        const auto& shader = vShaders[idx];
+
+        // the fields are separated by a \n, so a trigram can't be on two fields
+        auto text = ct::toLower(shader.id + "\n" + shader.name + "\n" + shader.username + "\n" + shader.description + "\n" + shader.tags);
+
+        if (text.size() >= 3U) {
+            for (size_t pos = 0U; pos + 2U < text.size(); ++pos) {
+                auto& posting = m_Postings[ShadertoyBackupFileSearchIndex_GetTrigram(text, pos)];
+                // the shaders are added in order, a shader is only one time in a posting
+                if (posting.empty() || posting.back() != (uint32_t)idx) {
+                    posting.push_back((uint32_t)idx);
+                }
+            }
+        }
+
+        m_Texts.push_back(std::move(text));
+    }
+}
+
+size_t ShadertoyBackupFileSearchIndex::size() const {
+    return m_Texts.size();
+}
+
+void ShadertoyBackupFileSearchIndex::Search(const std::string& vPattern, std::vector<size_t>& vOutIndexs) const {
+    vOutIndexs.clear();
+
+    const auto pattern = ct::toLower(vPattern);
+
+    if (pattern.empty()) {
+        vOutIndexs.resize(m_Texts.size());
+        for (size_t idx = 0U; idx < m_Texts.size(); ++idx) {
+            vOutIndexs[idx] = idx;
+        }
+        return;
+    }
+
+    // too short for a trigram
+    if (pattern.size() < 3U) {
+        for (size_t idx = 0U; idx < m_Texts.size(); ++idx) {
+            if (m_Texts[idx].find(pattern) != std::string::npos) {
+                vOutIndexs.push_back(idx);
+            }
+        }
+        return;
+    }
+
+    // the postings of the trigrams of the pattern, the smallest first
+    std::vector<const std::vector<uint32_t>*> postings;
+    for (size_t pos = 0U; pos + 2U < pattern.size(); ++pos) {
+        auto it = m_Postings.find(ShadertoyBackupFileSearchIndex_GetTrigram(pattern, pos));
+        if (it == m_Postings.end())
+            return;  // a trigram is in no shader
+        postings.push_back(&it->second);
+    }
+    std::sort(postings.begin(), postings.end());
+    postings.erase(std::unique(postings.begin(), postings.end()), postings.end());
+    std::sort(postings.begin(), postings.end(), [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) {
+        return a->size() < b->size();
+    });
+
+    std::vector<uint32_t> candidates = *postings[0];
+    std::vector<uint32_t> tmp;
+    for (size_t i = 1U; i < postings.size() && !candidates.empty(); ++i) {
+        tmp.clear();
+        std::set_intersection(candidates.begin(), candidates.end(), postings[i]->begin(), postings[i]->end(), std::back_inserter(tmp));
+        candidates.swap(tmp);
+    }
+
+    // the trigrams can be in another order, the pattern is checked
+    for (const auto& idx : candidates) {
+        if (m_Texts[idx].find(pattern) != std::string::npos) {
+            vOutIndexs.push_back(idx);
+        }
+    }
+}
+
+void ShadertoyBackupFileSearchIndex::Refine(const std::string& vPattern, const std::vector<size_t>& vCandidates, std::vector<size_t>& vOutIndexs) const {
+    vOutIndexs.clear();
+
+    const auto pattern = ct::toLower(vPattern);
+
+    for (const auto& idx : vCandidates) {
+        if (idx < m_Texts.size() && m_Texts[idx].find(pattern) != std::string::npos) {
+            vOutIndexs.push_back(idx);
+        }
+    }
+}
@@ -0,0 +1,41 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+class ShadertoyBackupFileInfo;
+
+// trigram inverted index on the lower case id, name, author, description and tags of the shaders
+// a pattern of 3 chars or more only checks the shaders who have all his trigrams
+class ShadertoyBackupFileSearchIndex {
+private:
+    std::vector<std::string> m_Texts;                               // lower case searchable text, by shader
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_Postings;  // trigram => sorted shader indexs
+
+public:
+    void Clear();
+    void Build(const std::vector<ShadertoyBackupFileInfo>& vShaders);
+    size_t size() const;
+
+    // the indexs of the shaders who contain vPattern, sorted
+    void Search(const std::string& vPattern, std::vector<size_t>& vOutIndexs) const;
+    // same but only in vCandidates, for a pattern who contain the pattern of vCandidates
+    void Refine(const std::string& vPattern, const std::vector<size_t>& vCandidates, std::vector<size_t>& vOutIndexs) const;
+};
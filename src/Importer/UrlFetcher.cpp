@@ -0,0 +1,446 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#ifdef USE_NETWORK
+#include "UrlFetcher.h"
+
+#include <ctools/cTools.h>
+#include <ctools/Logger.h>
+#include <ctools/FileHelper.h>
+#include <Headers/RenderPackHeaders.h>
+
+#include <filesystem>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+
+#define URL_FETCHER_DATA_EXT ".data"
+#define URL_FETCHER_META_EXT ".meta"
+
+struct UrlFetcher_Transfer {
+    size_t resultIdx = 0U;
+    CURL* handle = nullptr;
+    curl_slist* headers = nullptr;
+    std::string body;
+    std::string etag;
+    std::string lastModified;
+    bool hasCache = false;
+    char errorBuffer[CURL_ERROR_SIZE] = "";
+};
+
+// fnv-1a 64
+static uint64_t UrlFetcher_Hash(const std::string& vStr) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const auto& c : vStr) {
+        hash ^= (uint64_t)(uint8_t)c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static size_t UrlFetcher_WriteCallback(char* vData, size_t vSize, size_t vCount, void* vUserData) {
+    auto transfer = static_cast<UrlFetcher_Transfer*>(vUserData);
+    transfer->body.append(vData, vSize * vCount);
+    return vSize * vCount;
+}
+
+static size_t UrlFetcher_HeaderCallback(char* vData, size_t vSize, size_t vCount, void* vUserData) {
+    auto transfer = static_cast<UrlFetcher_Transfer*>(vUserData);
+    const size_t len = vSize * vCount;
+    const std::string line(vData, len);
+    if (line.compare(0U, 5U, "HTTP/") == 0) {
+        // a new response (redirection), only the headers of the last one are kept
+        transfer->etag.clear();
+        transfer->lastModified.clear();
+    } else {
+        const auto colon = line.find(':');
+        if (colon != std::string::npos) {
+            const auto name = ct::toLower(line.substr(0U, colon));
+            auto value = line.substr(colon + 1U);
+            const auto first = value.find_first_not_of(" \t");
+            const auto last = value.find_last_not_of(" \t\r\n");
+            value = (first == std::string::npos) ? std::string() : value.substr(first, last - first + 1U);
+            if (name == "etag") {
+                transfer->etag = value;
+            } else if (name == "last-modified") {
+                transfer->lastModified = value;
+            }
+        }
+    }
+    return len;
+}
+
+UrlFetcher::~UrlFetcher() {
+    Release();
+}
+
+void UrlFetcher::SetCacheDirectory(const std::string& vDirectory) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_CacheDirectory = vDirectory;
+    m_Initialized = false;
+}
+
+void UrlFetcher::SetMaxConcurrency(size_t vMaxConcurrency) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_MaxConcurrency = std::max<size_t>(1U, vMaxConcurrency);
+    if (m_Multi) {
+        curl_multi_setopt(m_Multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)m_MaxConcurrency);
+    }
+}
+
+void UrlFetcher::SetRevalidateCache(bool vRevalidateCache) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_RevalidateCache = vRevalidateCache;
+}
+
+void UrlFetcher::SetProxy(bool vUseProxy, const std::string& vProxyPath, const std::string& vProxyUserPwd) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_UseProxy = vUseProxy;
+    m_ProxyPath = vProxyPath;
+    m_ProxyUserPwd = vProxyUserPwd;
+}
+
+bool UrlFetcher::IsCached(const std::string& vUrl) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Init();
+    return LoadFromCache(vUrl, nullptr, nullptr);
+}
+
+void UrlFetcher::Invalidate(const std::string& vUrl) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Init();
+    std::error_code ec;
+    std::filesystem::remove(GetCacheFilePathName(vUrl, URL_FETCHER_META_EXT), ec);
+    std::filesystem::remove(GetCacheFilePathName(vUrl, URL_FETCHER_DATA_EXT), ec);
+}
+
+UrlFetchResult UrlFetcher::Fetch(const std::string& vUrl, int vTimeOutInSecond, std::atomic<bool>* vWorking) {
+    auto results = FetchAll({vUrl}, vTimeOutInSecond, vWorking);
+    return results.front();
+}
+
+std::vector<UrlFetchResult> UrlFetcher::FetchAll(const std::vector<std::string>& vUrls, int vTimeOutInSecond, std::atomic<bool>* vWorking) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    Init();
+
+    std::vector<UrlFetchResult> results(vUrls.size());
+    std::vector<std::unique_ptr<UrlFetcher_Transfer>> pendings;
+
+    for (size_t idx = 0U; idx < vUrls.size(); ++idx) {
+        auto& result = results[idx];
+        result.url = vUrls[idx];
+
+        // the same url is fetched one time
+        const auto it = std::find(vUrls.begin(), vUrls.begin() + idx, vUrls[idx]);
+        if (it != vUrls.begin() + idx) {
+            continue;
+        }
+
+        CacheEntryStruct entry;
+        const bool hasCache = LoadFromCache(result.url, &result.content, &entry);
+        if (hasCache && !m_RevalidateCache) {
+            result.fromCache = true;
+            result.ok = true;
+            continue;
+        }
+
+        auto transfer = std::make_unique<UrlFetcher_Transfer>();
+        transfer->resultIdx = idx;
+        transfer->hasCache = hasCache;
+        if (hasCache) {
+            if (!entry.etag.empty()) {
+                transfer->headers = curl_slist_append(transfer->headers, ("If-None-Match: " + entry.etag).c_str());
+            }
+            if (!entry.lastModified.empty()) {
+                transfer->headers = curl_slist_append(transfer->headers, ("If-Modified-Since: " + entry.lastModified).c_str());
+            }
+        }
+        pendings.push_back(std::move(transfer));
+    }
+
+    std::vector<UrlFetcher_Transfer*> actives;
+    size_t nextPending = 0U;
+    bool aborted = false;
+
+    if (!m_Multi) {
+        for (auto& transfer : pendings) {
+            results[transfer->resultIdx].error = "no CURL multi handle";
+        }
+        nextPending = pendings.size();
+    }
+
+    while (nextPending < pendings.size() || !actives.empty()) {
+        if (vWorking && !(*vWorking)) {
+            aborted = true;
+            break;
+        }
+
+        // bounded concurrency
+        while (actives.size() < m_MaxConcurrency && nextPending < pendings.size()) {
+            auto transfer = pendings[nextPending++].get();
+            auto& result = results[transfer->resultIdx];
+            transfer->handle = AcquireHandle();
+            if (!transfer->handle) {
+                result.error = "Failed to create CURL connection";
+                continue;
+            }
+            SetHandleOptions(transfer->handle, result.url, vTimeOutInSecond);
+            curl_easy_setopt(transfer->handle, CURLOPT_ERRORBUFFER, transfer->errorBuffer);
+            curl_easy_setopt(transfer->handle, CURLOPT_WRITEFUNCTION, UrlFetcher_WriteCallback);
+            curl_easy_setopt(transfer->handle, CURLOPT_WRITEDATA, transfer);
+            curl_easy_setopt(transfer->handle, CURLOPT_HEADERFUNCTION, UrlFetcher_HeaderCallback);
+            curl_easy_setopt(transfer->handle, CURLOPT_HEADERDATA, transfer);
+            curl_easy_setopt(transfer->handle, CURLOPT_PRIVATE, transfer);
+            if (transfer->headers) {
+                curl_easy_setopt(transfer->handle, CURLOPT_HTTPHEADER, transfer->headers);
+            }
+            curl_multi_add_handle(m_Multi, transfer->handle);
+            actives.push_back(transfer);
+        }
+
+        int countRunning = 0;
+        curl_multi_perform(m_Multi, &countRunning);
+
+        int countMessages = 0;
+        while (CURLMsg* msg = curl_multi_info_read(m_Multi, &countMessages)) {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+
+            char* priv = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &priv);
+            auto transfer = reinterpret_cast<UrlFetcher_Transfer*>(priv);
+            if (!transfer)
+                continue;
+
+            auto& result = results[transfer->resultIdx];
+            curl_easy_getinfo(transfer->handle, CURLINFO_RESPONSE_CODE, &result.httpCode);
+
+            const auto code = msg->data.result;
+            if (code != CURLE_OK) {
+                result.error = ct::toStr("fetch of %s fail [%s]", result.url.c_str(), transfer->errorBuffer[0] ? transfer->errorBuffer : curl_easy_strerror(code));
+            } else if (result.httpCode == 304 && transfer->hasCache) {
+                result.fromCache = true;
+                result.ok = true;
+            } else if (result.httpCode == 0 || (result.httpCode >= 200 && result.httpCode < 300)) {
+                result.content = std::move(transfer->body);
+                result.ok = true;
+                CacheEntryStruct entry;
+                entry.url = result.url;
+                entry.etag = transfer->etag;
+                entry.lastModified = transfer->lastModified;
+                SaveToCache(result.content, entry);
+            } else {
+                result.error = ct::toStr("fetch of %s fail [http code %i]", result.url.c_str(), (int)result.httpCode);
+            }
+
+            if (!result.ok) {
+                if (transfer->hasCache) {
+                    // the server is not reachable, the cached content is used
+                    LogVarInfo("%s, the cached content is used", result.error.c_str());
+                    result.fromCache = true;
+                    result.ok = true;
+                } else {
+                    LogVarError("%s", result.error.c_str());
+                    result.content.clear();
+                }
+            }
+
+            curl_multi_remove_handle(m_Multi, transfer->handle);
+            m_FreeHandles.push_back(transfer->handle);
+            transfer->handle = nullptr;
+            actives.erase(std::find(actives.begin(), actives.end(), transfer));
+        }
+
+        if (!actives.empty()) {
+            curl_multi_poll(m_Multi, nullptr, 0, 100, nullptr);
+        }
+    }
+
+    if (aborted) {
+        for (auto transfer : actives) {
+            curl_multi_remove_handle(m_Multi, transfer->handle);
+            m_FreeHandles.push_back(transfer->handle);
+            transfer->handle = nullptr;
+        }
+        for (auto& transfer : pendings) {
+            auto& result = results[transfer->resultIdx];
+            if (!result.ok && result.error.empty()) {
+                result.error = "aborted";
+                result.content.clear();
+            }
+        }
+    }
+
+    for (auto& transfer : pendings) {
+        curl_slist_free_all(transfer->headers);
+    }
+
+    // the duplicated urls
+    for (size_t idx = 0U; idx < vUrls.size(); ++idx) {
+        const auto it = std::find(vUrls.begin(), vUrls.begin() + idx, vUrls[idx]);
+        if (it != vUrls.begin() + idx) {
+            results[idx] = results[(size_t)(it - vUrls.begin())];
+        }
+    }
+
+    return results;
+}
+
+void UrlFetcher::Release() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (auto handle : m_FreeHandles) {
+        curl_easy_cleanup(handle);
+    }
+    m_FreeHandles.clear();
+    if (m_Multi) {
+        curl_multi_cleanup(m_Multi);
+        m_Multi = nullptr;
+    }
+}
+
+/////////////////////////////////////////////////////////////
+///// PRIVATE ///////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+void UrlFetcher::Init() {
+    if (!m_Multi) {
+        m_Multi = curl_multi_init();
+        if (m_Multi) {
+            curl_multi_setopt(m_Multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)m_MaxConcurrency);
+            curl_multi_setopt(m_Multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        } else {
+            LogVarError("Failed to create CURL multi handle");
+        }
+    }
+
+    if (!m_Initialized) {
+        if (m_CacheDirectory.empty()) {
+            m_CacheDirectory = FileHelper::Instance()->GetAbsolutePathForFileLocation("url_cache", (int)FILE_LOCATION_Enum::FILE_LOCATION_CONF);
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(m_CacheDirectory, ec);
+        if (!std::filesystem::is_directory(m_CacheDirectory, ec)) {
+            LogVarError("Url cache : cant create the directory %s", m_CacheDirectory.c_str());
+        }
+        m_Initialized = true;
+    }
+}
+
+// a reused handle keep his connection, dns and ssl session caches
+CURL* UrlFetcher::AcquireHandle() {
+    CURL* handle = nullptr;
+    if (!m_FreeHandles.empty()) {
+        handle = m_FreeHandles.back();
+        m_FreeHandles.pop_back();
+        curl_easy_reset(handle);
+    } else {
+        handle = curl_easy_init();
+    }
+    return handle;
+}
+
+void UrlFetcher::SetHandleOptions(CURL* vHandle, const std::string& vUrl, int vTimeOutInSecond) {
+    curl_easy_setopt(vHandle, CURLOPT_URL, vUrl.c_str());
+    if (vTimeOutInSecond > 0) {
+        curl_easy_setopt(vHandle, CURLOPT_TIMEOUT, (long)vTimeOutInSecond);
+    }
+    curl_easy_setopt(vHandle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(vHandle, CURLOPT_ACCEPT_ENCODING, "");  // all the encodings supported by curl
+    curl_easy_setopt(vHandle, CURLOPT_NOSIGNAL, 1L);
+
+    // on veut juste lire donc pas grave si pas securise
+    curl_easy_setopt(vHandle, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(vHandle, CURLOPT_SSL_VERIFYHOST, 0L);
+
+    if (m_UseProxy) {
+        curl_easy_setopt(vHandle, CURLOPT_PROXY, m_ProxyPath.c_str());
+        curl_easy_setopt(vHandle, CURLOPT_PROXYUSERPWD, m_ProxyUserPwd.c_str());
+    }
+}
+
+std::string UrlFetcher::GetCacheFilePathName(const std::string& vUrl, const char* vExt) const {
+    char buffer[32] = {};
+    snprintf(buffer, 32, "%016llx", (unsigned long long)UrlFetcher_Hash(vUrl));
+    return (std::filesystem::path(m_CacheDirectory) / (std::string(buffer) + vExt)).string();
+}
+
+// the meta file contain the url (for the hash collisions), the etag and the last modified date, one by line
+bool UrlFetcher::LoadFromCache(const std::string& vUrl, std::string* vOutContent, CacheEntryStruct* vOutEntry) {
+    std::ifstream metaFile(GetCacheFilePathName(vUrl, URL_FETCHER_META_EXT), std::ios::in | std::ios::binary);
+    if (!metaFile.is_open())
+        return false;
+
+    CacheEntryStruct entry;
+    std::getline(metaFile, entry.url);
+    std::getline(metaFile, entry.etag);
+    std::getline(metaFile, entry.lastModified);
+    if (entry.url != vUrl)
+        return false;
+
+    std::ifstream dataFile(GetCacheFilePathName(vUrl, URL_FETCHER_DATA_EXT), std::ios::in | std::ios::binary);
+    if (!dataFile.is_open())
+        return false;
+
+    if (vOutContent) {
+        dataFile.seekg(0, std::ios::end);
+        const auto size = (size_t)dataFile.tellg();
+        dataFile.seekg(0, std::ios::beg);
+        vOutContent->resize(size);
+        if (size && !dataFile.read(&(*vOutContent)[0], size)) {
+            vOutContent->clear();
+            return false;
+        }
+    }
+
+    if (vOutEntry) {
+        *vOutEntry = entry;
+    }
+
+    return true;
+}
+
+// the files are written in temporary files and renamed, a broken write is never seen as cached
+void UrlFetcher::SaveToCache(const std::string& vContent, const CacheEntryStruct& vEntry) {
+    const auto dataFilePathName = GetCacheFilePathName(vEntry.url, URL_FETCHER_DATA_EXT);
+    const auto metaFilePathName = GetCacheFilePathName(vEntry.url, URL_FETCHER_META_EXT);
+
+    std::error_code ec;
+    std::filesystem::remove(metaFilePathName, ec);
+
+    {
+        std::ofstream dataFile(dataFilePathName + ".tmp", std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!dataFile.is_open() || !dataFile.write(vContent.data(), vContent.size())) {
+            LogVarError("Url cache : cant write the file %s", dataFilePathName.c_str());
+            return;
+        }
+    }
+    std::filesystem::rename(dataFilePathName + ".tmp", dataFilePathName, ec);
+
+    {
+        std::ofstream metaFile(metaFilePathName + ".tmp", std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!metaFile.is_open()) {
+            LogVarError("Url cache : cant write the file %s", metaFilePathName.c_str());
+            return;
+        }
+        metaFile << vEntry.url << "\n" << vEntry.etag << "\n" << vEntry.lastModified << "\n";
+    }
+    std::filesystem::rename(metaFilePathName + ".tmp", metaFilePathName, ec);
+}
+
+#endif  // #ifdef USE_NETWORK
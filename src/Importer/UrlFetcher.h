@@ -0,0 +1,101 @@
+#ifdef USE_NETWORK
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <curl/curl.h>
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct UrlFetchResult {
+    std::string url;
+    std::string content;
+    std::string error;
+    long httpCode = 0;
+    bool fromCache = false;
+    bool ok = false;
+};
+
+// concurrent http fetcher on a curl multi handle, with an on disk cache of the contents keyed by url
+// the multi handle and the easy handles are kept between the fetchs, so the connections are reused
+// a cached url is returned without touching the network, unless the revalidation is enabled,
+// then the server is asked with If-None-Match / If-Modified-Since and a 304 return the cached content
+class UrlFetcher {
+private:
+    struct CacheEntryStruct {
+        std::string url;
+        std::string etag;
+        std::string lastModified;
+    };
+
+private:
+    std::mutex m_Mutex;  // the multi handle is used by one fetch at a time
+    CURLM* m_Multi = nullptr;
+    std::vector<CURL*> m_FreeHandles;
+    std::string m_CacheDirectory;
+    size_t m_MaxConcurrency = 6U;
+    bool m_RevalidateCache = false;
+    bool m_UseProxy = false;
+    std::string m_ProxyPath;
+    std::string m_ProxyUserPwd;
+    bool m_Initialized = false;
+
+public:
+    static UrlFetcher* Instance() {
+        static UrlFetcher _instance;
+        return &_instance;
+    }
+
+protected:
+    UrlFetcher() = default;                        // Prevent construction
+    UrlFetcher(const UrlFetcher&) = delete;        // Prevent construction by copying
+    UrlFetcher& operator=(const UrlFetcher&) {
+        return *this;
+    };              // Prevent assignment
+    ~UrlFetcher();  // Prevent unwanted destruction
+
+public:
+    // if not called, the cache is created in the conf directory
+    void SetCacheDirectory(const std::string& vDirectory);
+    void SetMaxConcurrency(size_t vMaxConcurrency);
+    void SetRevalidateCache(bool vRevalidateCache);
+    void SetProxy(bool vUseProxy, const std::string& vProxyPath, const std::string& vProxyUserPwd);
+
+    bool IsCached(const std::string& vUrl);
+    void Invalidate(const std::string& vUrl);
+
+    // the fetch is aborted if vWorking become false
+    UrlFetchResult Fetch(const std::string& vUrl, int vTimeOutInSecond, std::atomic<bool>* vWorking = nullptr);
+    // the results are in the order of vUrls, at most m_MaxConcurrency transfers at the same time
+    std::vector<UrlFetchResult> FetchAll(const std::vector<std::string>& vUrls, int vTimeOutInSecond, std::atomic<bool>* vWorking = nullptr);
+
+    // close the connections
+    void Release();
+
+private:
+    void Init();
+    CURL* AcquireHandle();
+    void SetHandleOptions(CURL* vHandle, const std::string& vUrl, int vTimeOutInSecond);
+    std::string GetCacheFilePathName(const std::string& vUrl, const char* vExt) const;
+    bool LoadFromCache(const std::string& vUrl, std::string* vOutContent, CacheEntryStruct* vOutEntry);
+    void SaveToCache(const std::string& vContent, const CacheEntryStruct& vEntry);
+};
+
+#endif  // #ifdef USE_NETWORK
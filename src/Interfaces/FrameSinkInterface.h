@@ -0,0 +1,35 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+// a file who receive the rendered frames one by one, in order
+// the frames are RGBA 8 bits, top to bottom, or bottom to top if vFlipY (like glReadPixels)
+class FrameSinkInterface {
+public:
+    virtual ~FrameSinkInterface() = default;
+
+    virtual bool Open(const std::string& vFilePathName, const int& vWidth, const int& vHeight, const int& vFrameRate) = 0;
+    virtual bool WriteFrame(const uint8_t* vRGBA, const int& vWidth, const int& vHeight, const bool& vFlipY) = 0;
+    virtual bool Close() = 0;
+    virtual bool IsOpened() = 0;
+    virtual std::string GetFileExtension() = 0;
+};
+typedef std::shared_ptr<FrameSinkInterface> FrameSinkPtr;
@@ -60,6 +60,28 @@ bool GuiModel::DrawGui(RenderPackWeak vParent, BaseModelWeak vBaseModelWeak, boo
             if (meshPtr) {
                 ImGui::TextWrapped("Sub meshs count : %u", meshPtr->GetMeshCount());
 
+                bool compact = meshPtr->IsCompactVertexFormat();
+                if (ImGui::Checkbox("Compact vertices", &compact)) {
+                    meshPtr->SetCompactVertexFormat(compact);
+                    meshPtr->ReLoadModel();
+                    change = true;
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("44 bytes instead of 72 per vertex and 16 bits indices when possible\nthe vertex colors are clamped to [0:1]");
+                }
+
+                if (PNTBTCModel::IsMergedGeometrySupported()) {
+                    bool merged = meshPtr->IsMergedGeometry();
+                    if (ImGui::Checkbox("Merged sub meshs", &merged)) {
+                        meshPtr->SetMergedGeometry(merged);
+                        meshPtr->ReLoadModel();
+                        change = true;
+                    }
+                    if (ImGui::IsItemHovered()) {
+                        ImGui::SetTooltip("all the sub meshs in one buffer, drawn with one glMultiDrawElementsIndirect");
+                    }
+                }
+
                 int32_t meshsCount = meshPtr->GetMeshCount();
                 if (meshsCount) {
                     auto meshs = meshPtr->GetMeshs();
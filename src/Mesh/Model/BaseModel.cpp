@@ -89,6 +89,11 @@ void BaseModel::SetVertexRangeToShow(uint64_t vFirst, uint64_t vLast) {
     }
 }
 
+void BaseModel::SetBoundingBox(const ct::fvec3& vLowerBound, const ct::fvec3& vUpperBound) {
+    m_BoundingBox.lowerBound = vLowerBound;
+    m_BoundingBox.upperBound = vUpperBound;
+}
+
 void BaseModel::SetFilePathName(const std::string& vFilePathName) {
     m_FilePathName = vFilePathName;
 }
@@ -37,7 +37,22 @@ public:
     const GLsizei verticeSize = sizeof(T);
     const GLsizei indiceSize = sizeof(VertexStruct::I1);
 
+    // type des indices envoyes au gpu, GL_UNSIGNED_SHORT quand les vertices le permettent
+    GLenum m_IndiceType = GL_UNSIGNED_INT;
+
 public:
+    // fill the bound GL_ELEMENT_ARRAY_BUFFER, in 16 bits if asked and if all the vertices can be indexed with it
+    void BufferIndices(bool vAllowShortIndices, GLenum vUsage) {
+        if (vAllowShortIndices && m_Vertices.size() < 65536U) {
+            std::vector<VertexStruct::I2> shortIndices(m_Indices.begin(), m_Indices.end());
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(VertexStruct::I2) * shortIndices.size(), shortIndices.data(), vUsage);
+            m_IndiceType = GL_UNSIGNED_SHORT;
+        } else {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indiceSize * m_Indices.size(), m_Indices.data(), vUsage);
+            m_IndiceType = GL_UNSIGNED_INT;
+        }
+    }
+
     uint32_t GetVaoID() {
         return m_Vbo;
     }
@@ -50,7 +65,11 @@ public:
 
     void Clear(const GuiBackend_Window& vWin) {
         GuiBackend::MakeContextCurrent(vWin);
+        ClearBuffers();
+    }
 
+    // the context must be current
+    void ClearBuffers() {
         SAFE_DELETE_GL_BUFFER(m_Vbo);
         // LogGlError();
 
@@ -133,6 +152,7 @@ public:
     void SetInstancesCount(uint64_t vInstanceCount);
     void SetPatchVerticesCount(uint64_t vPatchVerticesCount);
     void SetVertexRangeToShow(uint64_t vFirst, uint64_t vLast);
+    void SetBoundingBox(const ct::fvec3& vLowerBound, const ct::fvec3& vUpperBound);
 
     virtual bool ReLoadModel();
     virtual void DrawModel(const std::string& vName, const GLenum& vRenderMode = GL_TRIANGLES, const bool& vUseTesselation = false);
@@ -25,6 +25,8 @@
 #include <Profiler/TracyProfiler.h>
 #include <Mesh/Utils/VertexStruct.h>
 
+#include <cstddef>
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// STATIC ////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -41,9 +43,10 @@ PNTBTCMeshPtr PNTBTCMesh::Create(const GuiBackend_Window& vWin) {
     return res;
 }
 
-PNTBTCMeshPtr PNTBTCMesh::Create(const GuiBackend_Window& vWin, const VerticeArray& vVerticeArray, const IndiceArray& vIndiceArray) {
+PNTBTCMeshPtr PNTBTCMesh::Create(const GuiBackend_Window& vWin, const VerticeArray& vVerticeArray, const IndiceArray& vIndiceArray, const bool& vCompactVertexFormat) {
     PNTBTCMeshPtr res = std::make_shared<PNTBTCMesh>(vWin, vVerticeArray, vIndiceArray);
     res->m_This = res;
+    res->SetCompactVertexFormat(vCompactVertexFormat);
     if (!res->Init())
         res.reset();
     return res;
@@ -82,6 +85,11 @@ void PNTBTCMesh::Unit() {
     m_IsLoaded = false;
 }
 
+void PNTBTCMesh::ReleaseBuffers() {
+    m_MeshDatas.ClearBuffers();
+    m_IsLoaded = false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// TESTS /////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -158,6 +166,14 @@ void PNTBTCMesh::HaveIndices() {
     m_HaveIndices = true;
 }
 
+void PNTBTCMesh::SetCompactVertexFormat(bool vFlag) {
+    m_CompactVertexFormat = vFlag;
+}
+
+bool PNTBTCMesh::IsCompactVertexFormat() {
+    return m_CompactVertexFormat;
+}
+
 void PNTBTCMesh::SetCanWeRender(bool vFlag) {
     m_CanWeRender = vFlag;
 }
@@ -201,12 +217,12 @@ void PNTBTCMesh::DrawModel(const std::string& vName,
                 if (vInstanceCount > 1U) {
                     glDrawElementsInstanced(vRenderMode,
                                             (GLsizei)vIndicesCountToShow,
-                                            GL_UNSIGNED_INT,
+                                            m_MeshDatas.m_IndiceType,
                                             nullptr,
                                             (GLsizei)vInstanceCount);  // draw first object 6 => decalage 3 coord * 2 (float)
                     LogGlError();
                 } else {
-                    glDrawElements(vRenderMode, (GLsizei)vIndicesCountToShow, GL_UNSIGNED_INT, nullptr);
+                    glDrawElements(vRenderMode, (GLsizei)vIndicesCountToShow, m_MeshDatas.m_IndiceType, nullptr);
                     LogGlError();
                 }
 
@@ -252,7 +268,8 @@ bool PNTBTCMesh::PreparePNTBTC(bool vUpdate) {
     TracyGpuZone("PNTBTCModel::PreparePNTBTC");
 
     if (!m_MeshDatas.m_Vertices.empty()) {
-        if (vUpdate) {
+        // the vao must be rebuilt if the vertex format changed
+        if (vUpdate && m_GpuCompactVertexFormat == m_CompactVertexFormat) {
             m_VerticesCount = m_MeshDatas.m_Vertices.size();
 
             glBindVertexArray(m_MeshDatas.m_Vao);
@@ -261,8 +278,7 @@ bool PNTBTCMesh::PreparePNTBTC(bool vUpdate) {
             glBindBuffer(GL_ARRAY_BUFFER, m_MeshDatas.m_Vbo);
             LogGlError();
 
-            glBufferData(GL_ARRAY_BUFFER, m_MeshDatas.verticeSize * m_MeshDatas.m_Vertices.size(), m_MeshDatas.m_Vertices.data(), GL_DYNAMIC_DRAW);
-            LogGlError();
+            BufferVertices();
 
             if (!m_MeshDatas.m_Indices.empty()) {
                 m_IndicesCount = m_MeshDatas.m_Indices.size();
@@ -270,7 +286,7 @@ bool PNTBTCMesh::PreparePNTBTC(bool vUpdate) {
                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_MeshDatas.m_Ibo);
                 LogGlError();
 
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_MeshDatas.indiceSize * m_MeshDatas.m_Indices.size(), m_MeshDatas.m_Indices.data(), GL_DYNAMIC_DRAW);
+                m_MeshDatas.BufferIndices(m_CompactVertexFormat, GL_STATIC_DRAW);
                 LogGlError();
             }
 
@@ -314,56 +330,10 @@ bool PNTBTCMesh::PreparePNTBTC(bool vUpdate) {
             glBindBuffer(GL_ARRAY_BUFFER, m_MeshDatas.m_Vbo);
             LogGlError();
 
-            glBufferData(GL_ARRAY_BUFFER, m_MeshDatas.verticeSize * m_MeshDatas.m_Vertices.size(), m_MeshDatas.m_Vertices.data(), GL_DYNAMIC_DRAW);
-            LogGlError();
-
-            // pos
-            glEnableVertexAttribArray(0);
-            LogGlError();
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, m_MeshDatas.verticeSize, (void*)nullptr);
-            LogGlError();
-            glDisableVertexAttribArray(0);
-            LogGlError();
+            BufferVertices();
 
-            // nor
-            glEnableVertexAttribArray(1);
-            LogGlError();
-            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, m_MeshDatas.verticeSize, (void*)(sizeof(float) * 3));
-            LogGlError();
-            glDisableVertexAttribArray(1);
-            LogGlError();
-
-            // tangent
-            glEnableVertexAttribArray(2);
-            LogGlError();
-            glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, m_MeshDatas.verticeSize, (void*)(sizeof(float) * 6));
-            LogGlError();
-            glDisableVertexAttribArray(2);
-            LogGlError();
-
-            // bi tangent
-            glEnableVertexAttribArray(3);
-            LogGlError();
-            glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, m_MeshDatas.verticeSize, (void*)(sizeof(float) * 9));
-            LogGlError();
-            glDisableVertexAttribArray(3);
-            LogGlError();
-
-            // tex
-            glEnableVertexAttribArray(4);
-            LogGlError();
-            glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, m_MeshDatas.verticeSize, (void*)(sizeof(float) * 12));
-            LogGlError();
-            glDisableVertexAttribArray(4);
-            LogGlError();
-
-            // col
-            glEnableVertexAttribArray(5);
-            LogGlError();
-            glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, m_MeshDatas.verticeSize, (void*)(sizeof(float) * 14));
-            LogGlError();
-            glDisableVertexAttribArray(5);
-            LogGlError();
+            m_GpuCompactVertexFormat = m_CompactVertexFormat;
+            SetupAttributes(m_CompactVertexFormat);
 
             if (!m_MeshDatas.m_Indices.empty()) {
                 m_IndicesCount = m_MeshDatas.m_Indices.size();
@@ -371,7 +341,7 @@ bool PNTBTCMesh::PreparePNTBTC(bool vUpdate) {
                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_MeshDatas.m_Ibo);
                 LogGlError();
 
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_MeshDatas.indiceSize * m_MeshDatas.m_Indices.size(), m_MeshDatas.m_Indices.data(), GL_DYNAMIC_DRAW);
+                m_MeshDatas.BufferIndices(m_CompactVertexFormat, GL_STATIC_DRAW);
                 LogGlError();
             }
 
@@ -391,3 +361,120 @@ bool PNTBTCMesh::PreparePNTBTC(bool vUpdate) {
 
     return true;
 }
+
+void PNTBTCMesh::BufferVertices() {
+    if (m_CompactVertexFormat) {
+        std::vector<VertexStruct::P3_N3_TA3_BTA3_T2_C4_Compact> compactVertices(m_MeshDatas.m_Vertices.begin(), m_MeshDatas.m_Vertices.end());
+        glBufferData(GL_ARRAY_BUFFER, sizeof(VertexStruct::P3_N3_TA3_BTA3_T2_C4_Compact) * compactVertices.size(), compactVertices.data(), GL_STATIC_DRAW);
+        LogGlError();
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, m_MeshDatas.verticeSize * m_MeshDatas.m_Vertices.size(), m_MeshDatas.m_Vertices.data(), GL_STATIC_DRAW);
+        LogGlError();
+    }
+}
+
+// the vao and the vbo must be bound
+void PNTBTCMesh::SetupAttributes(bool vCompactVertexFormat) {
+    if (vCompactVertexFormat) {
+        typedef VertexStruct::P3_N3_TA3_BTA3_T2_C4_Compact CompactVertex;
+        const GLsizei stride = (GLsizei)sizeof(CompactVertex);
+
+        // pos
+        glEnableVertexAttribArray(0);
+        LogGlError();
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(CompactVertex, p));
+        LogGlError();
+        glDisableVertexAttribArray(0);
+        LogGlError();
+
+        // nor
+        glEnableVertexAttribArray(1);
+        LogGlError();
+        glVertexAttribPointer(1, 3, GL_SHORT, GL_TRUE, stride, (void*)offsetof(CompactVertex, n));
+        LogGlError();
+        glDisableVertexAttribArray(1);
+        LogGlError();
+
+        // tangent
+        glEnableVertexAttribArray(2);
+        LogGlError();
+        glVertexAttribPointer(2, 3, GL_SHORT, GL_TRUE, stride, (void*)offsetof(CompactVertex, tan));
+        LogGlError();
+        glDisableVertexAttribArray(2);
+        LogGlError();
+
+        // bi tangent
+        glEnableVertexAttribArray(3);
+        LogGlError();
+        glVertexAttribPointer(3, 3, GL_SHORT, GL_TRUE, stride, (void*)offsetof(CompactVertex, btan));
+        LogGlError();
+        glDisableVertexAttribArray(3);
+        LogGlError();
+
+        // tex
+        glEnableVertexAttribArray(4);
+        LogGlError();
+        glVertexAttribPointer(4, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(CompactVertex, t));
+        LogGlError();
+        glDisableVertexAttribArray(4);
+        LogGlError();
+
+        // col
+        glEnableVertexAttribArray(5);
+        LogGlError();
+        glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(CompactVertex, c));
+        LogGlError();
+        glDisableVertexAttribArray(5);
+        LogGlError();
+    } else {
+        const GLsizei stride = (GLsizei)sizeof(VertexStruct::P3_N3_TA3_BTA3_T2_C4);
+
+        // pos
+        glEnableVertexAttribArray(0);
+        LogGlError();
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)nullptr);
+        LogGlError();
+        glDisableVertexAttribArray(0);
+        LogGlError();
+
+        // nor
+        glEnableVertexAttribArray(1);
+        LogGlError();
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 3));
+        LogGlError();
+        glDisableVertexAttribArray(1);
+        LogGlError();
+
+        // tangent
+        glEnableVertexAttribArray(2);
+        LogGlError();
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 6));
+        LogGlError();
+        glDisableVertexAttribArray(2);
+        LogGlError();
+
+        // bi tangent
+        glEnableVertexAttribArray(3);
+        LogGlError();
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 9));
+        LogGlError();
+        glDisableVertexAttribArray(3);
+        LogGlError();
+
+        // tex
+        glEnableVertexAttribArray(4);
+        LogGlError();
+        glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 12));
+        LogGlError();
+        glDisableVertexAttribArray(4);
+        LogGlError();
+
+        // col
+        glEnableVertexAttribArray(5);
+        LogGlError();
+        glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 14));
+        LogGlError();
+        glDisableVertexAttribArray(5);
+        LogGlError();
+    }
+}
@@ -42,11 +42,14 @@ public:
     uint64_t m_IndicesCount = 0;
     bool m_IsLoaded = false;
     bool m_CanWeRender = true;
+    bool m_CompactVertexFormat = false;     // P3_N3_TA3_BTA3_T2_C4_Compact and 16 bits indices if possible
+    bool m_GpuCompactVertexFormat = false;  // format of the current vao
 
 public:
     static PNTBTCMeshPtr Create();
     static PNTBTCMeshPtr Create(const GuiBackend_Window& vWin);
-    static PNTBTCMeshPtr Create(const GuiBackend_Window& vWin, const VerticeArray& vVerticeArray, const IndiceArray& vIndiceArray);
+    // the vertex format is set before the Init, so the datas are uploaded one time
+    static PNTBTCMeshPtr Create(const GuiBackend_Window& vWin, const VerticeArray& vVerticeArray, const IndiceArray& vIndiceArray, const bool& vCompactVertexFormat = false);
 
 public:
     PNTBTCMesh();
@@ -56,6 +59,8 @@ public:
 
     bool Init();
     void Unit();
+    // like Unit, but in the current context
+    void ReleaseBuffers();
 
     bool empty();
     bool HasNormals();
@@ -80,6 +85,10 @@ public:
 
     void SetCanWeRender(bool vFlag);
 
+    // applied at the next Init
+    void SetCompactVertexFormat(bool vFlag);
+    bool IsCompactVertexFormat();
+
     void DrawModel(const std::string& vName,
                    const uint32_t& vIdx,
                    const GuiBackend_Window& vWin,
@@ -93,6 +102,10 @@ public:
     uint32_t GetVboID();
     uint32_t GetIboID();
 
+    // the vao and the vbo must be bound
+    static void SetupAttributes(bool vCompactVertexFormat);
+
 private:
     bool PreparePNTBTC(bool vUpdate);
+    void BufferVertices();
 };
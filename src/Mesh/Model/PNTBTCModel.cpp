@@ -39,10 +39,16 @@ PNTBTCModel::PNTBTCModel(const GuiBackend_Window& vWin) : BaseModel(vWin) {
 
 PNTBTCModel::~PNTBTCModel() {
     Clear();
+    if (m_MergedDatas.m_Vbo || m_MergedDatas.m_Ibo || m_MergedDatas.m_Vao || m_MergedCommandsBuffer) {
+        GuiBackend::MakeContextCurrent(m_Window);
+        UnitMergedGeometry();
+    }
 }
 
 void PNTBTCModel::Clear() {
     m_Meshs.clear();
+    // can be called from the mesh loader thread, the gl buffers are released at the next ReLoadModel
+    m_MergedGeometryLoaded = false;
     BaseModel::Clear();
 }
 
@@ -58,6 +64,11 @@ void PNTBTCModel::DrawModel(const std::string& vName, const GLenum& vRenderMode,
 
         TracyGpuZone("PNTBTCModel::DrawModel");
 
+        if (m_MergedGeometryLoaded && m_MergedCommands.size() == m_Meshs.size()) {
+            DrawMergedGeometry(vName, vRenderMode, vUseTesselation);
+            return;
+        }
+
         // uint64_t indices_to_show = m_IndicesCountToShow;
         uint32_t idx = 0U;
         for (auto meshPtr : m_Meshs) {
@@ -74,6 +85,9 @@ void PNTBTCModel::DrawModel(const std::string& vName, const GLenum& vRenderMode,
 }
 
 uint32_t PNTBTCModel::GetVaoID(uint32_t vMeshID) {
+    if (m_MergedGeometryLoaded) {
+        return m_MergedDatas.m_Vao;
+    }
     if (m_Meshs.size() > vMeshID) {
         if (m_Meshs.at(vMeshID)) {
             return m_Meshs[vMeshID]->GetVaoID();
@@ -83,6 +97,9 @@ uint32_t PNTBTCModel::GetVaoID(uint32_t vMeshID) {
 }
 
 uint32_t PNTBTCModel::GetVboID(uint32_t vMeshID) {
+    if (m_MergedGeometryLoaded) {
+        return m_MergedDatas.m_Vbo;
+    }
     if (m_Meshs.size() > vMeshID) {
         if (m_Meshs.at(vMeshID)) {
             return m_Meshs[vMeshID]->GetVboID();
@@ -92,6 +109,9 @@ uint32_t PNTBTCModel::GetVboID(uint32_t vMeshID) {
 }
 
 uint32_t PNTBTCModel::GetIboID(uint32_t vMeshID) {
+    if (m_MergedGeometryLoaded) {
+        return m_MergedDatas.m_Ibo;
+    }
     if (m_Meshs.size() > vMeshID) {
         if (m_Meshs.at(vMeshID)) {
             return m_Meshs[vMeshID]->GetIboID();
@@ -105,7 +125,7 @@ uint32_t PNTBTCModel::GetMeshCount() {
 }
 
 PNTBTCMeshPtr PNTBTCModel::AddMesh(const PNTBTCMesh::VerticeArray& vVerticeArray, const PNTBTCMesh::IndiceArray& vIndiceArray) {
-    PNTBTCMeshPtr res = PNTBTCMesh::Create(m_Window, vVerticeArray, vIndiceArray);
+    PNTBTCMeshPtr res = PNTBTCMesh::Create(m_Window, vVerticeArray, vIndiceArray, m_CompactVertexFormat);
     m_IndicesCountToShow += res->GetIndicesCount();
     m_Meshs.push_back(res);
     return res;
@@ -113,6 +133,7 @@ PNTBTCMeshPtr PNTBTCModel::AddMesh(const PNTBTCMesh::VerticeArray& vVerticeArray
 
 PNTBTCMeshPtr PNTBTCModel::AddMesh() {
     PNTBTCMeshPtr res = PNTBTCMesh::Create(m_Window);
+    res->SetCompactVertexFormat(m_CompactVertexFormat);
     m_IndicesCountToShow += res->GetIndicesCount();
     m_Meshs.push_back(res);
     return res;
@@ -120,6 +141,7 @@ PNTBTCMeshPtr PNTBTCModel::AddMesh() {
 
 void PNTBTCModel::AddMesh(PNTBTCMeshPtr vMeshPtr) {
     if (vMeshPtr) {
+        vMeshPtr->SetCompactVertexFormat(m_CompactVertexFormat);
         m_Meshs.push_back(vMeshPtr);
         m_IndicesCountToShow += vMeshPtr->GetIndicesCount();
     }
@@ -128,7 +150,22 @@ void PNTBTCModel::AddMesh(PNTBTCMeshPtr vMeshPtr) {
 bool PNTBTCModel::ReLoadModel() {
     m_IsLoaded = false;
 
+    UnitMergedGeometry();
+
     if (!m_Meshs.empty()) {
+        if (m_MergedGeometry && IsMergedGeometrySupported()) {
+            m_IsLoaded = PrepareMergedGeometry();
+            if (m_IsLoaded) {
+                // the buffers of the sub meshs are not needed
+                for (auto meshPtr : m_Meshs) {
+                    if (meshPtr) {
+                        meshPtr->ReleaseBuffers();
+                    }
+                }
+                return m_IsLoaded;
+            }
+        }
+
         m_IsLoaded = true;
 
         for (auto meshPtr : m_Meshs) {
@@ -141,6 +178,239 @@ bool PNTBTCModel::ReLoadModel() {
     return m_IsLoaded;
 }
 
+void PNTBTCModel::SetCompactVertexFormat(bool vFlag) {
+    m_CompactVertexFormat = vFlag;
+    for (auto meshPtr : m_Meshs) {
+        if (meshPtr) {
+            meshPtr->SetCompactVertexFormat(vFlag);
+        }
+    }
+}
+
+bool PNTBTCModel::IsCompactVertexFormat() {
+    return m_CompactVertexFormat;
+}
+
+void PNTBTCModel::SetMergedGeometry(bool vFlag) {
+    m_MergedGeometry = vFlag;
+}
+
+bool PNTBTCModel::IsMergedGeometry() {
+    return m_MergedGeometry;
+}
+
+bool PNTBTCModel::IsMergedGeometrySupported() {
+    return glBufferStorage && glMultiDrawElementsIndirect;
+}
+
 std::vector<PNTBTCMeshPtr>* PNTBTCModel::GetMeshs() {
     return &m_Meshs;
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PRIVATE ///////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// the indices of a sub mesh stay relative to his first vertex (baseVertex)
+// so they can be in 16 bits if each sub mesh have less than 65536 vertices
+bool PNTBTCModel::PrepareMergedGeometry() {
+    TracyGpuZone("PNTBTCModel::PrepareMergedGeometry");
+
+    size_t countVertices = 0U;
+    size_t countIndices = 0U;
+    bool shortIndices = m_CompactVertexFormat;
+    m_MergedCommands.clear();
+    m_MergedCommands.reserve(m_Meshs.size());
+    for (auto meshPtr : m_Meshs) {
+        DrawElementsIndirectCommand command;
+        if (meshPtr) {
+            command.count = (GLuint)meshPtr->GetIndicesCount();
+            command.firstIndex = (GLuint)countIndices;
+            command.baseVertex = (GLint)countVertices;
+            countVertices += (size_t)meshPtr->GetVerticesCount();
+            countIndices += (size_t)meshPtr->GetIndicesCount();
+            shortIndices &= (meshPtr->GetVerticesCount() < 65536U);
+        }
+        m_MergedCommands.push_back(command);
+    }
+
+    if (!countVertices || !countIndices) {
+        m_MergedCommands.clear();
+        return false;
+    }
+
+    glGenVertexArrays(1, &m_MergedDatas.m_Vao);
+    LogGlError();
+    glGenBuffers(1, &m_MergedDatas.m_Vbo);
+    LogGlError();
+    glGenBuffers(1, &m_MergedDatas.m_Ibo);
+    LogGlError();
+    glGenBuffers(1, &m_MergedCommandsBuffer);
+    LogGlError();
+
+    glBindVertexArray(m_MergedDatas.m_Vao);
+    LogGlError();
+    glBindBuffer(GL_ARRAY_BUFFER, m_MergedDatas.m_Vbo);
+    LogGlError();
+
+    // immutable storage, the datas are given at the creation
+    if (m_CompactVertexFormat) {
+        std::vector<VertexStruct::P3_N3_TA3_BTA3_T2_C4_Compact> vertices;
+        vertices.reserve(countVertices);
+        for (auto meshPtr : m_Meshs) {
+            if (meshPtr) {
+                vertices.insert(vertices.end(), meshPtr->GetVertices()->begin(), meshPtr->GetVertices()->end());
+            }
+        }
+        glBufferStorage(GL_ARRAY_BUFFER, sizeof(VertexStruct::P3_N3_TA3_BTA3_T2_C4_Compact) * vertices.size(), vertices.data(), 0);
+        LogGlError();
+    } else {
+        std::vector<VertexStruct::P3_N3_TA3_BTA3_T2_C4> vertices;
+        vertices.reserve(countVertices);
+        for (auto meshPtr : m_Meshs) {
+            if (meshPtr) {
+                vertices.insert(vertices.end(), meshPtr->GetVertices()->begin(), meshPtr->GetVertices()->end());
+            }
+        }
+        glBufferStorage(GL_ARRAY_BUFFER, sizeof(VertexStruct::P3_N3_TA3_BTA3_T2_C4) * vertices.size(), vertices.data(), 0);
+        LogGlError();
+    }
+
+    PNTBTCMesh::SetupAttributes(m_CompactVertexFormat);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_MergedDatas.m_Ibo);
+    LogGlError();
+
+    if (shortIndices) {
+        std::vector<VertexStruct::I2> indices;
+        indices.reserve(countIndices);
+        for (auto meshPtr : m_Meshs) {
+            if (meshPtr) {
+                indices.insert(indices.end(), meshPtr->GetIndices()->begin(), meshPtr->GetIndices()->end());
+            }
+        }
+        glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, sizeof(VertexStruct::I2) * indices.size(), indices.data(), 0);
+        LogGlError();
+        m_MergedDatas.m_IndiceType = GL_UNSIGNED_SHORT;
+    } else {
+        std::vector<VertexStruct::I1> indices;
+        indices.reserve(countIndices);
+        for (auto meshPtr : m_Meshs) {
+            if (meshPtr) {
+                indices.insert(indices.end(), meshPtr->GetIndices()->begin(), meshPtr->GetIndices()->end());
+            }
+        }
+        glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, sizeof(VertexStruct::I1) * indices.size(), indices.data(), 0);
+        LogGlError();
+        m_MergedDatas.m_IndiceType = GL_UNSIGNED_INT;
+    }
+
+    glBindVertexArray(0);
+    LogGlError();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);  // bien unbind les buffer apres le vao sinon le contexte est verole
+    LogGlError();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    LogGlError();
+
+    // the commands change with the visibility of the sub meshs and the instances count
+    m_MergedCommandsUploaded = m_MergedCommands;
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_MergedCommandsBuffer);
+    LogGlError();
+    glBufferStorage(GL_DRAW_INDIRECT_BUFFER,
+                    sizeof(DrawElementsIndirectCommand) * m_MergedCommandsUploaded.size(),
+                    m_MergedCommandsUploaded.data(),
+                    GL_DYNAMIC_STORAGE_BIT);
+    LogGlError();
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    LogGlError();
+
+    m_VerticesCount = countVertices;
+    m_IndicesCount = countIndices;
+    m_MergedGeometryLoaded = true;
+
+    return true;
+}
+
+// the context must be current
+void PNTBTCModel::UnitMergedGeometry() {
+    m_MergedDatas.ClearBuffers();
+    SAFE_DELETE_GL_BUFFER(m_MergedCommandsBuffer);
+    m_MergedCommands.clear();
+    m_MergedCommandsUploaded.clear();
+    m_MergedGeometryLoaded = false;
+}
+
+// a hidden sub mesh is a command without instance
+void PNTBTCModel::UpdateMergedCommands() {
+    bool change = false;
+    const GLuint instanceCount = (GLuint)ct::maxi(m_InstanceCount, (uint64_t)1U);
+    for (size_t i = 0U; i < m_MergedCommands.size(); ++i) {
+        const auto& meshPtr = m_Meshs[i];
+        const GLuint count = (meshPtr && meshPtr->m_CanWeRender) ? instanceCount : 0U;
+        if (m_MergedCommandsUploaded[i].instanceCount != count) {
+            m_MergedCommandsUploaded[i].instanceCount = count;
+            change = true;
+        }
+    }
+
+    if (change) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_MergedCommandsBuffer);
+        LogGlError();
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(DrawElementsIndirectCommand) * m_MergedCommandsUploaded.size(), m_MergedCommandsUploaded.data());
+        LogGlError();
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        LogGlError();
+    }
+}
+
+void PNTBTCModel::DrawMergedGeometry(const std::string& vName, const GLenum& vRenderMode, const bool& vUseTesselation) {
+    AIGPScoped(vName, "Merged Sub Meshs");
+
+    TracyGpuZone("PNTBTCModel::DrawMergedGeometry");
+
+    UpdateMergedCommands();
+
+    if (glIsVertexArray(m_MergedDatas.m_Vao) == GL_TRUE) {
+        // bind
+        glBindVertexArray(m_MergedDatas.m_Vao);
+        LogGlError();
+        glEnableVertexAttribArray(0);  // pos
+        LogGlError();
+        glEnableVertexAttribArray(1);  // nor
+        LogGlError();
+        glEnableVertexAttribArray(2);  // tan
+        LogGlError();
+        glEnableVertexAttribArray(3);  // btan
+        LogGlError();
+        glEnableVertexAttribArray(4);  // tex
+        LogGlError();
+        glEnableVertexAttribArray(5);  // col
+        LogGlError();
+
+        if (vUseTesselation && m_PatchVerticesCount && glPatchParameteri)
+            glPatchParameteri(GL_PATCH_VERTICES, (GLint)m_PatchVerticesCount);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_MergedCommandsBuffer);
+        LogGlError();
+        glMultiDrawElementsIndirect(vRenderMode, m_MergedDatas.m_IndiceType, nullptr, (GLsizei)m_MergedCommandsUploaded.size(), 0);
+        LogGlError();
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        LogGlError();
+
+        // unbind
+        glDisableVertexAttribArray(5);  // col
+        LogGlError();
+        glDisableVertexAttribArray(4);  // tex
+        LogGlError();
+        glDisableVertexAttribArray(3);  // btan
+        LogGlError();
+        glDisableVertexAttribArray(2);  // tan
+        LogGlError();
+        glDisableVertexAttribArray(1);  // nor
+        LogGlError();
+        glDisableVertexAttribArray(0);  // pos
+        LogGlError();
+        glBindVertexArray(0);
+        LogGlError();
+    }
+}
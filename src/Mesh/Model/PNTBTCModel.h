@@ -24,8 +24,27 @@ typedef std::shared_ptr<PNTBTCModel> PNTBTCModelPtr;
 typedef std::weak_ptr<PNTBTCModel> PNTBTCModelWeak;
 
 class PNTBTCModel : public BaseModel {
+private:
+    // layout of the commands of glMultiDrawElementsIndirect
+    struct DrawElementsIndirectCommand {
+        GLuint count = 0U;
+        GLuint instanceCount = 0U;
+        GLuint firstIndex = 0U;
+        GLint baseVertex = 0;
+        GLuint baseInstance = 0U;
+    };
+
 private:
     std::vector<PNTBTCMeshPtr> m_Meshs;
+    bool m_CompactVertexFormat = false;
+
+    // merged geometry : all the sub meshs in one immutable vbo/ibo, drawn with one glMultiDrawElementsIndirect
+    bool m_MergedGeometry = false;
+    bool m_MergedGeometryLoaded = false;
+    BaseMeshDatas<VertexStruct::P3_N3_TA3_BTA3_T2_C4> m_MergedDatas;  // only the gl buffers, the vertices stay in the sub meshs
+    uint32_t m_MergedCommandsBuffer = 0U;
+    std::vector<DrawElementsIndirectCommand> m_MergedCommands;          // one per sub mesh, instanceCount is set at draw
+    std::vector<DrawElementsIndirectCommand> m_MergedCommandsUploaded;  // content of m_MergedCommandsBuffer
 
 public:
     static PNTBTCModelPtr Create(const GuiBackend_Window& vWin);
@@ -70,5 +89,21 @@ public:
 
     bool ReLoadModel();
 
+    // compact vertices and 16 bits indices on the gpu, applied by ReLoadModel
+    void SetCompactVertexFormat(bool vFlag);
+    bool IsCompactVertexFormat();
+
+    // need glBufferStorage and glMultiDrawElementsIndirect (gl 4.4), else the sub meshs are drawn one by one
+    // applied by ReLoadModel
+    void SetMergedGeometry(bool vFlag);
+    bool IsMergedGeometry();
+    static bool IsMergedGeometrySupported();
+
     std::vector<PNTBTCMeshPtr>* GetMeshs();
+
+private:
+    bool PrepareMergedGeometry();
+    void UnitMergedGeometry();
+    void UpdateMergedCommands();
+    void DrawMergedGeometry(const std::string& vName, const GLenum& vRenderMode, const bool& vUseTesselation);
 };
\ No newline at end of file
@@ -0,0 +1,432 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "MeshCache.h"
+
+#include <ctools/Logger.h>
+#include <ctools/FileHelper.h>
+#include <Headers/RenderPackHeaders.h>
+#include <Profiler/TracyProfiler.h>
+
+#include <filesystem>
+#include <algorithm>
+#include <fstream>
+#include <cstddef>
+
+#define MESH_CACHE_MAGIC 0x484D504EU  // NPMH
+#define MESH_CACHE_VERSION 1U
+#define MESH_CACHE_EXT ".npmesh"
+
+enum MeshCacheAttributeFlags : uint32_t {
+    MESH_CACHE_NORMALS = (1U << 0U),
+    MESH_CACHE_TANGENTS = (1U << 1U),
+    MESH_CACHE_BITANGENTS = (1U << 2U),
+    MESH_CACHE_TEXCOORDS = (1U << 3U),
+    MESH_CACHE_COLORS = (1U << 4U),
+    MESH_CACHE_INDICES = (1U << 5U),
+};
+
+// the file is : header, submeshs, then the vertices and the indices of each submesh
+struct MeshCacheHeader {
+    uint32_t magic = MESH_CACHE_MAGIC;
+    uint32_t version = MESH_CACHE_VERSION;
+    uint32_t vertexSize = (uint32_t)sizeof(VertexStruct::P3_N3_TA3_BTA3_T2_C4);
+    uint32_t indexSize = (uint32_t)sizeof(VertexStruct::I1);
+    uint64_t sourceSize = 0U;
+    int64_t sourceTime = 0;
+    uint64_t sourceHash = 0U;
+    uint64_t subMeshCount = 0U;
+    float boundsMin[3] = {};
+    float boundsMax[3] = {};
+};
+
+struct MeshCacheSubMesh {
+    uint64_t verticesCount = 0U;
+    uint64_t indicesCount = 0U;
+    uint32_t attributes = 0U;
+    float boundsMin[3] = {};
+    float boundsMax[3] = {};
+};
+
+// fnv-1a 64
+static uint64_t MeshCache_Hash(uint64_t vHash, const char* vDatas, size_t vSize) {
+    for (size_t i = 0U; i < vSize; ++i) {
+        vHash ^= (uint64_t)(uint8_t)vDatas[i];
+        vHash *= 1099511628211ULL;
+    }
+    return vHash;
+}
+
+static bool MeshCache_HashFile(const std::string& vFilePathName, uint64_t* vOutHash) {
+    std::ifstream file(vFilePathName, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return false;
+    uint64_t hash = 14695981039346656037ULL;
+    std::vector<char> buffer(1U << 20U);  // 1 Mo
+    while (file) {
+        file.read(buffer.data(), buffer.size());
+        hash = MeshCache_Hash(hash, buffer.data(), (size_t)file.gcount());
+    }
+    *vOutHash = hash;
+    return true;
+}
+
+static bool MeshCache_GetSourceInfos(const std::string& vFilePathName, uint64_t* vOutSize, int64_t* vOutTime) {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(vFilePathName, ec);
+    if (ec)
+        return false;
+    const auto time = std::filesystem::last_write_time(vFilePathName, ec);
+    if (ec)
+        return false;
+    *vOutSize = (uint64_t)size;
+    *vOutTime = (int64_t)time.time_since_epoch().count();
+    return true;
+}
+
+static void MeshCache_ComputeBounds(const PNTBTCMesh::VerticeArray& vVertices, float* vOutMin, float* vOutMax) {
+    if (vVertices.empty()) {
+        return;
+    }
+    ct::fvec3 mini = vVertices[0].p;
+    ct::fvec3 maxi = vVertices[0].p;
+    for (const auto& v : vVertices) {
+        mini.x = std::min(mini.x, v.p.x);
+        mini.y = std::min(mini.y, v.p.y);
+        mini.z = std::min(mini.z, v.p.z);
+        maxi.x = std::max(maxi.x, v.p.x);
+        maxi.y = std::max(maxi.y, v.p.y);
+        maxi.z = std::max(maxi.z, v.p.z);
+    }
+    vOutMin[0] = mini.x;
+    vOutMin[1] = mini.y;
+    vOutMin[2] = mini.z;
+    vOutMax[0] = maxi.x;
+    vOutMax[1] = maxi.y;
+    vOutMax[2] = maxi.z;
+}
+
+void MeshCache::SetCacheDirectory(const std::string& vDirectory) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_CacheDirectory = vDirectory;
+    m_Initialized = false;
+}
+
+void MeshCache::SetMaxSize(uint64_t vMaxSizeInBytes) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_MaxSize = vMaxSizeInBytes;
+}
+
+void MeshCache::SetEnabled(bool vEnabled) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Enabled = vEnabled;
+}
+
+bool MeshCache::Load(const std::string& vFilePathName,
+                     std::vector<PNTBTCMeshPtr>& vOutMeshs,
+                     ct::fvec3* vOutBoundsMin,
+                     ct::fvec3* vOutBoundsMax,
+                     std::atomic<bool>* vWorking) {
+    ZoneScoped;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    vOutMeshs.clear();
+
+    if (!m_Enabled || vFilePathName.empty())
+        return false;
+
+    Init();
+
+    uint64_t sourceSize = 0U;
+    int64_t sourceTime = 0;
+    if (!MeshCache_GetSourceInfos(vFilePathName, &sourceSize, &sourceTime))
+        return false;
+
+    const auto cacheFilePathName = GetCacheFilePathName(vFilePathName);
+    std::ifstream file(cacheFilePathName, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    MeshCacheHeader header;
+    file.read((char*)&header, sizeof(MeshCacheHeader));
+    if (!file.good() ||                                                              //
+        header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION ||  //
+        header.vertexSize != (uint32_t)sizeof(VertexStruct::P3_N3_TA3_BTA3_T2_C4) ||    //
+        header.indexSize != (uint32_t)sizeof(VertexStruct::I1) ||                       //
+        header.sourceSize != sourceSize) {
+        return false;
+    }
+
+    bool needSourceTimeUpdate = false;
+    if (header.sourceTime != sourceTime) {
+        // the file is touched or copied, but maybe not modified
+        uint64_t sourceHash = 0U;
+        if (!MeshCache_HashFile(vFilePathName, &sourceHash) || sourceHash != header.sourceHash) {
+            return false;
+        }
+        needSourceTimeUpdate = true;
+    }
+
+    std::vector<MeshCacheSubMesh> subMeshs((size_t)header.subMeshCount);
+    if (!subMeshs.empty()) {
+        file.read((char*)subMeshs.data(), sizeof(MeshCacheSubMesh) * subMeshs.size());
+        if (!file.good())
+            return false;
+    }
+
+    // the datas are read directly in the arrays of the meshs
+    for (const auto& subMesh : subMeshs) {
+        if (vWorking && !(*vWorking)) {
+            vOutMeshs.clear();
+            return false;
+        }
+
+        auto meshPtr = PNTBTCMesh::Create();
+        meshPtr->GetVertices()->resize((size_t)subMesh.verticesCount);
+        meshPtr->GetIndices()->resize((size_t)subMesh.indicesCount);
+        if (subMesh.verticesCount) {
+            file.read((char*)meshPtr->GetVertices()->data(), sizeof(VertexStruct::P3_N3_TA3_BTA3_T2_C4) * (size_t)subMesh.verticesCount);
+        }
+        if (subMesh.indicesCount) {
+            file.read((char*)meshPtr->GetIndices()->data(), sizeof(VertexStruct::I1) * (size_t)subMesh.indicesCount);
+        }
+        if (!file.good()) {
+            LogVarError("Mesh cache : the file %s is corrupted", cacheFilePathName.c_str());
+            vOutMeshs.clear();
+            return false;
+        }
+
+        if (subMesh.attributes & MESH_CACHE_NORMALS)
+            meshPtr->HaveNormals();
+        if (subMesh.attributes & MESH_CACHE_TANGENTS)
+            meshPtr->HaveTangeants();
+        if (subMesh.attributes & MESH_CACHE_BITANGENTS)
+            meshPtr->HaveBiTangeants();
+        if (subMesh.attributes & MESH_CACHE_TEXCOORDS)
+            meshPtr->HaveTextureCoords();
+        if (subMesh.attributes & MESH_CACHE_COLORS)
+            meshPtr->HaveVertexColors();
+        if (subMesh.attributes & MESH_CACHE_INDICES)
+            meshPtr->HaveIndices();
+
+        vOutMeshs.push_back(meshPtr);
+    }
+
+    file.close();
+
+    // the content is the same, the new mtime is written in the header,
+    // so the next loads will not hash the source file again
+    if (needSourceTimeUpdate) {
+        std::fstream headerFile(cacheFilePathName, std::ios::in | std::ios::out | std::ios::binary);
+        if (headerFile.is_open()) {
+            headerFile.seekp((std::streamoff)offsetof(MeshCacheHeader, sourceTime));
+            headerFile.write((const char*)&sourceTime, sizeof(sourceTime));
+        }
+        if (!headerFile.good()) {
+            LogVarError("Mesh cache : cant update the file %s", cacheFilePathName.c_str());
+        }
+    }
+
+    if (vOutBoundsMin)
+        *vOutBoundsMin = ct::fvec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    if (vOutBoundsMax)
+        *vOutBoundsMax = ct::fvec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+
+    // for the eviction, the oldest used files are removed first
+    std::error_code ec;
+    std::filesystem::last_write_time(cacheFilePathName, std::filesystem::file_time_type::clock::now(), ec);
+
+    return true;
+}
+
+bool MeshCache::Save(const std::string& vFilePathName, const std::vector<PNTBTCMeshPtr>& vMeshs) {
+    ZoneScoped;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (!m_Enabled || vFilePathName.empty() || vMeshs.empty())
+        return false;
+
+    Init();
+
+    MeshCacheHeader header;
+    if (!MeshCache_GetSourceInfos(vFilePathName, &header.sourceSize, &header.sourceTime) ||  //
+        !MeshCache_HashFile(vFilePathName, &header.sourceHash)) {
+        return false;
+    }
+
+    std::vector<MeshCacheSubMesh> subMeshs;
+    subMeshs.reserve(vMeshs.size());
+    bool firstBounds = true;
+    for (const auto& meshPtr : vMeshs) {
+        if (!meshPtr)
+            continue;
+        MeshCacheSubMesh subMesh;
+        subMesh.verticesCount = meshPtr->GetVerticesCount();
+        subMesh.indicesCount = meshPtr->GetIndicesCount();
+        subMesh.attributes |= meshPtr->HasNormals() ? MESH_CACHE_NORMALS : 0U;
+        subMesh.attributes |= meshPtr->HasTangeants() ? MESH_CACHE_TANGENTS : 0U;
+        subMesh.attributes |= meshPtr->HasBiTangeants() ? MESH_CACHE_BITANGENTS : 0U;
+        subMesh.attributes |= meshPtr->HasTextureCoords() ? MESH_CACHE_TEXCOORDS : 0U;
+        subMesh.attributes |= meshPtr->HasVertexColors() ? MESH_CACHE_COLORS : 0U;
+        subMesh.attributes |= meshPtr->HasIndices() ? MESH_CACHE_INDICES : 0U;
+        MeshCache_ComputeBounds(*meshPtr->GetVertices(), subMesh.boundsMin, subMesh.boundsMax);
+        if (subMesh.verticesCount) {
+            for (int i = 0; i < 3; ++i) {
+                header.boundsMin[i] = firstBounds ? subMesh.boundsMin[i] : std::min(header.boundsMin[i], subMesh.boundsMin[i]);
+                header.boundsMax[i] = firstBounds ? subMesh.boundsMax[i] : std::max(header.boundsMax[i], subMesh.boundsMax[i]);
+            }
+            firstBounds = false;
+        }
+        subMeshs.push_back(subMesh);
+    }
+    header.subMeshCount = (uint64_t)subMeshs.size();
+
+    // written in a temporary file and renamed, a broken write is never loaded
+    const auto cacheFilePathName = GetCacheFilePathName(vFilePathName);
+    const auto tmpFilePathName = cacheFilePathName + ".tmp";
+    bool ok = false;
+    {
+        std::ofstream file(tmpFilePathName, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (file.is_open()) {
+            file.write((const char*)&header, sizeof(MeshCacheHeader));
+            file.write((const char*)subMeshs.data(), sizeof(MeshCacheSubMesh) * subMeshs.size());
+            for (const auto& meshPtr : vMeshs) {
+                if (!meshPtr)
+                    continue;
+                file.write((const char*)meshPtr->GetVertices()->data(), sizeof(VertexStruct::P3_N3_TA3_BTA3_T2_C4) * meshPtr->GetVertices()->size());
+                file.write((const char*)meshPtr->GetIndices()->data(), sizeof(VertexStruct::I1) * meshPtr->GetIndices()->size());
+            }
+            ok = file.good();
+        }
+    }
+
+    std::error_code ec;
+    if (ok) {
+        std::filesystem::rename(tmpFilePathName, cacheFilePathName, ec);
+        ok = !ec;
+    }
+    if (!ok) {
+        LogVarError("Mesh cache : cant write the file %s", cacheFilePathName.c_str());
+        std::filesystem::remove(tmpFilePathName, ec);
+        return false;
+    }
+
+    Evict();
+
+    return true;
+}
+
+void MeshCache::Clear() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Init();
+    std::error_code ec;
+    for (const auto& file : std::filesystem::directory_iterator(m_CacheDirectory, ec)) {
+        if (file.is_regular_file(ec) && file.path().extension().string() == MESH_CACHE_EXT) {
+            std::filesystem::remove(file.path(), ec);
+        }
+    }
+}
+
+bool MeshCache::ComputeBounds(const std::vector<PNTBTCMeshPtr>& vMeshs, ct::fvec3* vOutBoundsMin, ct::fvec3* vOutBoundsMax) {
+    bool found = false;
+    float mini[3] = {};
+    float maxi[3] = {};
+    for (const auto& meshPtr : vMeshs) {
+        if (meshPtr && !meshPtr->GetVertices()->empty()) {
+            float meshMin[3] = {};
+            float meshMax[3] = {};
+            MeshCache_ComputeBounds(*meshPtr->GetVertices(), meshMin, meshMax);
+            for (int i = 0; i < 3; ++i) {
+                mini[i] = found ? std::min(mini[i], meshMin[i]) : meshMin[i];
+                maxi[i] = found ? std::max(maxi[i], meshMax[i]) : meshMax[i];
+            }
+            found = true;
+        }
+    }
+    if (found) {
+        if (vOutBoundsMin)
+            *vOutBoundsMin = ct::fvec3(mini[0], mini[1], mini[2]);
+        if (vOutBoundsMax)
+            *vOutBoundsMax = ct::fvec3(maxi[0], maxi[1], maxi[2]);
+    }
+    return found;
+}
+
+/////////////////////////////////////////////////////////////
+///// PRIVATE ///////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+void MeshCache::Init() {
+    if (m_Initialized)
+        return;
+
+    if (m_CacheDirectory.empty()) {
+        m_CacheDirectory = FileHelper::Instance()->GetAbsolutePathForFileLocation("mesh_cache", (int)FILE_LOCATION_Enum::FILE_LOCATION_CONF);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_CacheDirectory, ec);
+    if (!std::filesystem::is_directory(m_CacheDirectory, ec)) {
+        LogVarError("Mesh cache : cant create the directory %s", m_CacheDirectory.c_str());
+    }
+
+    m_Initialized = true;
+}
+
+// the least recently used files are removed until the max size
+void MeshCache::Evict() {
+    struct CacheFileStruct {
+        std::filesystem::path path;
+        uint64_t size = 0U;
+        std::filesystem::file_time_type time;
+    };
+
+    std::error_code ec;
+    std::vector<CacheFileStruct> files;
+    uint64_t totalSize = 0U;
+    for (const auto& file : std::filesystem::directory_iterator(m_CacheDirectory, ec)) {
+        if (file.is_regular_file(ec) && file.path().extension().string() == MESH_CACHE_EXT) {
+            CacheFileStruct entry;
+            entry.path = file.path();
+            entry.size = (uint64_t)file.file_size(ec);
+            entry.time = file.last_write_time(ec);
+            totalSize += entry.size;
+            files.push_back(entry);
+        }
+    }
+
+    std::sort(files.begin(), files.end(), [](const CacheFileStruct& a, const CacheFileStruct& b) { return a.time < b.time; });
+
+    // the last file is the one just written, he is kept
+    for (size_t i = 0U; totalSize > m_MaxSize && i + 1U < files.size(); ++i) {
+        std::filesystem::remove(files[i].path, ec);
+        totalSize -= files[i].size;
+    }
+}
+
+std::string MeshCache::GetCacheFilePathName(const std::string& vFilePathName) const {
+    std::error_code ec;
+    auto absolutePath = std::filesystem::absolute(vFilePathName, ec).lexically_normal().string();
+    if (ec)
+        absolutePath = vFilePathName;
+    char buffer[32] = {};
+    snprintf(buffer, 32, "%016llx", (unsigned long long)MeshCache_Hash(14695981039346656037ULL, absolutePath.data(), absolutePath.size()));
+    return (std::filesystem::path(m_CacheDirectory) / (std::string(buffer) + MESH_CACHE_EXT)).string();
+}
@@ -0,0 +1,74 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <Mesh/Model/PNTBTCMesh.h>
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// on disk cache of the meshs loaded by assimp, in the final interleaved vertex and index arrays
+// a cache file is found by the path of the source file, and is valid for the same size and mtime,
+// or if the mtime changed, for the same content hash. so a reload skip assimp and the vertex conversion
+class MeshCache {
+private:
+    std::mutex m_Mutex;
+    std::string m_CacheDirectory;
+    uint64_t m_MaxSize = 2048ULL * 1024ULL * 1024ULL;  // 2 GB
+    bool m_Enabled = true;
+    bool m_Initialized = false;
+
+public:
+    static MeshCache* Instance() {
+        static MeshCache _instance;
+        return &_instance;
+    }
+
+protected:
+    MeshCache() = default;                  // Prevent construction
+    MeshCache(const MeshCache&) = delete;   // Prevent construction by copying
+    MeshCache& operator=(const MeshCache&) {
+        return *this;
+    };                       // Prevent assignment
+    ~MeshCache() = default;  // Prevent unwanted destruction
+
+public:
+    // if not called, the cache is created in the conf directory
+    void SetCacheDirectory(const std::string& vDirectory);
+    void SetMaxSize(uint64_t vMaxSizeInBytes);
+    void SetEnabled(bool vEnabled);
+
+    // the meshs are not uploaded, vOutBounds is a min and a max
+    bool Load(const std::string& vFilePathName,
+              std::vector<PNTBTCMeshPtr>& vOutMeshs,
+              ct::fvec3* vOutBoundsMin,
+              ct::fvec3* vOutBoundsMax,
+              std::atomic<bool>* vWorking = nullptr);
+    bool Save(const std::string& vFilePathName, const std::vector<PNTBTCMeshPtr>& vMeshs);
+
+    void Clear();
+
+    // min and max of the positions of the meshs
+    static bool ComputeBounds(const std::vector<PNTBTCMeshPtr>& vMeshs, ct::fvec3* vOutBoundsMin, ct::fvec3* vOutBoundsMax);
+
+private:
+    void Init();
+    void Evict();
+    std::string GetCacheFilePathName(const std::string& vFilePathName) const;
+};
@@ -33,10 +33,13 @@
 #include <Gui/CustomGuiWidgets.h>
 #include <Mesh/Model/PNTBTCMesh.h>
 #include <Mesh/Model/PNTBTCModel.h>
+#include <Mesh/Operations/MeshCache.h>
 #include <ImGuiPack.h>
 
 #include <imgui_internal.h>
 
+#include <algorithm>
+
 /////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////
@@ -64,6 +67,165 @@ public:
 /////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////
 
+// the layouts are deduced from the attributes of the meshs
+static void MeshLoader_FillLayouts(const std::vector<PNTBTCMeshPtr>& vMeshs, std::vector<std::string>& vLayouts) {
+    for (const auto& meshPtr : vMeshs) {
+        if (meshPtr->GetVerticesCount())
+            vLayouts[0] = "Vertex (v3)";
+        if (meshPtr->HasNormals())
+            vLayouts[1] = "Normal (v3)";
+        if (meshPtr->HasTangeants())
+            vLayouts[2] = "Tangent (v3)";
+        if (meshPtr->HasBiTangeants())
+            vLayouts[3] = "Bi-Tangent (v3)";
+        if (meshPtr->HasTextureCoords())
+            vLayouts[4] = "Tex Coord (v2)";
+        if (meshPtr->HasVertexColors())
+            vLayouts[5] = "Color (v4)";
+    }
+}
+
+#define MESH_LOADER_ITEMS_PER_JOB 65536U
+
+// a range of vertices or of faces of a submesh
+struct MeshLoaderConvertJob {
+    size_t meshIndex = 0U;
+    size_t first = 0U;
+    size_t last = 0U;
+    size_t indexOffset = 0U;
+    bool faces = false;
+};
+
+struct MeshLoaderConvertContext {
+    const std::vector<const aiMesh*>* sceneMeshs = nullptr;
+    const std::vector<PNTBTCMeshPtr>* loadedMeshs = nullptr;
+    const std::vector<MeshLoaderConvertJob>* jobs = nullptr;
+    std::atomic<size_t>* nextJob = nullptr;
+    std::atomic<size_t>* countDoneItems = nullptr;
+    size_t countItems = 0U;
+    std::atomic<double>* progress = nullptr;
+    std::atomic<bool>* working = nullptr;
+};
+
+static bool MeshLoader_HaveTextureCoords(const aiMesh* vMesh) {
+    return vMesh->mTextureCoords[0] != nullptr && vMesh->mNumUVComponents[0] == 2U;
+}
+
+// set the attributes and resize the arrays to their final size
+static void MeshLoader_PrepareMesh(const aiMesh* vMesh, PNTBTCMeshPtr vMeshPtr) {
+    if (vMesh->mNormals)
+        vMeshPtr->HaveNormals();
+    if (vMesh->mTangents)
+        vMeshPtr->HaveTangeants();
+    if (vMesh->mBitangents)
+        vMeshPtr->HaveBiTangeants();
+    if (MeshLoader_HaveTextureCoords(vMesh))
+        vMeshPtr->HaveTextureCoords();
+    if (vMesh->mColors[0])
+        vMeshPtr->HaveVertexColors();
+
+    size_t countIndices = 0U;
+    for (size_t i = 0; i != vMesh->mNumFaces; ++i) {
+        countIndices += vMesh->mFaces[i].mNumIndices;
+    }
+    if (vMesh->mNumFaces)
+        vMeshPtr->HaveIndices();
+
+    vMeshPtr->GetVertices()->resize(vMesh->mNumVertices);
+    vMeshPtr->GetIndices()->resize(countIndices);
+}
+
+// the faces can be cut in ranges only if they have all 3 indices
+static void MeshLoader_AddJobs(const aiMesh* vMesh, size_t vMeshIndex, std::vector<MeshLoaderConvertJob>& vJobs) {
+    MeshLoaderConvertJob job;
+    job.meshIndex = vMeshIndex;
+    for (size_t first = 0U; first < vMesh->mNumVertices; first += MESH_LOADER_ITEMS_PER_JOB) {
+        job.first = first;
+        job.last = std::min<size_t>(first + MESH_LOADER_ITEMS_PER_JOB, vMesh->mNumVertices);
+        vJobs.push_back(job);
+    }
+    job.faces = true;
+    if (vMesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE) {
+        for (size_t first = 0U; first < vMesh->mNumFaces; first += MESH_LOADER_ITEMS_PER_JOB) {
+            job.first = first;
+            job.last = std::min<size_t>(first + MESH_LOADER_ITEMS_PER_JOB, vMesh->mNumFaces);
+            job.indexOffset = first * 3U;
+            vJobs.push_back(job);
+        }
+    } else if (vMesh->mNumFaces) {
+        job.first = 0U;
+        job.last = vMesh->mNumFaces;
+        job.indexOffset = 0U;
+        vJobs.push_back(job);
+    }
+}
+
+static void MeshLoader_ConvertVertices(const aiMesh* vMesh, PNTBTCMesh::VerticeArray& vVertices, size_t vFirst, size_t vLast) {
+    const bool haveTextureCoords = MeshLoader_HaveTextureCoords(vMesh);
+    for (size_t i = vFirst; i != vLast; ++i) {
+        auto& v = vVertices[i];
+
+        const auto& vert = vMesh->mVertices[i];
+        v.p = ct::fvec3(vert.x, vert.y, vert.z);
+
+        if (vMesh->mNormals) {
+            const auto& norm = vMesh->mNormals[i];
+            v.n = ct::fvec3(norm.x, norm.y, norm.z);
+        }
+
+        if (vMesh->mTangents) {
+            const auto& tang = vMesh->mTangents[i];
+            v.tan = ct::fvec3(tang.x, tang.y, tang.z);
+        }
+
+        if (vMesh->mBitangents) {
+            const auto& btan = vMesh->mBitangents[i];
+            v.btan = ct::fvec3(btan.x, btan.y, btan.z);
+        }
+
+        if (haveTextureCoords) {
+            const auto& coor = vMesh->mTextureCoords[0][i];
+            v.t = ct::fvec2(coor.x, coor.y);
+        }
+
+        if (vMesh->mColors[0]) {
+            const auto& colo = vMesh->mColors[0][i];
+            v.c = ct::fvec4(colo.r, colo.g, colo.b, colo.a);
+        }
+    }
+}
+
+static void MeshLoader_ConvertFaces(const aiMesh* vMesh, PNTBTCMesh::IndiceArray& vIndices, size_t vFirst, size_t vLast, size_t vIndexOffset) {
+    auto* indices = vIndices.data() + vIndexOffset;
+    for (size_t i = vFirst; i != vLast; ++i) {
+        const aiFace& face = vMesh->mFaces[i];
+        indices = std::copy(face.mIndices, face.mIndices + face.mNumIndices, indices);
+    }
+}
+
+// no lock, each job write in his own range. the progress is given by job
+static void MeshLoader_ConvertWorker(MeshLoaderConvertContext* vContext) {
+    while (*vContext->working) {
+        const size_t jobIndex = vContext->nextJob->fetch_add(1U);
+        if (jobIndex >= vContext->jobs->size())
+            break;
+
+        const auto& job = vContext->jobs->at(jobIndex);
+        const aiMesh* mesh = vContext->sceneMeshs->at(job.meshIndex);
+        const auto& meshPtr = vContext->loadedMeshs->at(job.meshIndex);
+        if (job.faces) {
+            MeshLoader_ConvertFaces(mesh, *meshPtr->GetIndices(), job.first, job.last, job.indexOffset);
+        } else {
+            MeshLoader_ConvertVertices(mesh, *meshPtr->GetVertices(), job.first, job.last);
+        }
+
+        const size_t countDoneItems = vContext->countDoneItems->fetch_add(job.last - job.first) + (job.last - job.first);
+        if (vContext->countItems) {
+            *vContext->progress = (double)countDoneItems / (double)vContext->countItems;
+        }
+    }
+}
+
 inline static void sLoadMesh(std::atomic<double>& vProgress, std::atomic<bool>& vWorking, std::atomic<double>& vGenerationTime) {
     vProgress = 0.0;
 
@@ -90,6 +252,34 @@ inline static void sLoadMesh(std::atomic<double>& vProgress, std::atomic<bool>&
         meshPtr->SetFilePathName(filePathName);
         MeshLoader::workerThread_Mutex.unlock();
 
+        // a mesh already loaded is read from the cache, without assimp
+        {
+            const int64_t firstTimeMark = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+            std::vector<PNTBTCMeshPtr> cachedMeshs;
+            ct::fvec3 boundsMin, boundsMax;
+            if (MeshCache::Instance()->Load(filePathName, cachedMeshs, &boundsMin, &boundsMax, &vWorking)) {
+                MeshLoader_FillLayouts(cachedMeshs, layouts);
+
+                MeshLoader::workerThread_Mutex.lock();
+                MeshLoader::Instance()->puLayouts = layouts;
+                MeshLoader::Instance()->subMeshCount = (uint32_t)cachedMeshs.size();
+                for (const auto& cachedMeshPtr : cachedMeshs) {
+                    meshPtr->AddMesh(cachedMeshPtr);
+                }
+                meshPtr->SetLayouts(layouts);
+                meshPtr->SetBoundingBox(boundsMin, boundsMax);
+                MeshLoader::workerThread_Mutex.unlock();
+
+                const int64_t secondTimeMark = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+                vGenerationTime = vGenerationTime + (double)(secondTimeMark - firstTimeMark) / 1000.0;
+                vProgress = 1.0;
+                vWorking = false;
+                return;
+            }
+        }
+
         try {
             uint32_t assimpFlags = aiProcess_CalcTangentSpace |
                 // aiProcess_SortByPType |
@@ -118,158 +308,75 @@ inline static void sLoadMesh(std::atomic<double>& vProgress, std::atomic<bool>&
                 imp->SetProgressHandler(nullptr);
 
                 if (scene->HasMeshes()) {
-                    // size_t _last_index_offset = 0U;
-
-                    MeshLoader::workerThread_Mutex.lock();
-                    MeshLoader::Instance()->puLayouts = layouts;
-                    MeshLoader::Instance()->subMeshCount = scene->mNumMeshes;
-                    MeshLoader::workerThread_Mutex.unlock();
-
-                    const double progressSteps = 1.0 / (double)scene->mNumMeshes;
+                    const int64_t _firstTimeMark = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 
+                    // the arrays are created at their final size, then filled in parallel by ranges
+                    std::vector<const aiMesh*> sceneMeshs;
+                    std::vector<PNTBTCMeshPtr> loadedMeshs;
+                    std::vector<MeshLoaderConvertJob> jobs;
+                    size_t countItems = 0U;
                     for (size_t k = 0; k != scene->mNumMeshes; ++k) {
                         const aiMesh* mesh = scene->mMeshes[k];
-
-                        if (!vWorking)
-                            break;
-
                         if (mesh) {
                             auto sceneMeshPtr = PNTBTCMesh::Create();
                             if (sceneMeshPtr) {
-                                sceneMeshPtr->GetVertices()->reserve(mesh->mNumVertices);
-
-                                if (mesh->mVertices) {
-                                    layouts[0] = "Vertex (v3)";
-                                }
-
-                                if (mesh->mNormals) {
-                                    layouts[1] = "Normal (v3)";
-                                    sceneMeshPtr->HaveNormals();
-                                }
-                                if (mesh->mTangents) {
-                                    layouts[2] = "Tangent (v3)";
-                                    sceneMeshPtr->HaveTangeants();
-                                }
-                                if (mesh->mBitangents) {
-                                    layouts[3] = "Bi-Tangent (v3)";
-                                    sceneMeshPtr->HaveBiTangeants();
-                                }
-                                if (mesh->mTextureCoords) {
-                                    if (mesh->mNumUVComponents[0] == 2U) {
-                                        if (mesh->mTextureCoords[0]) {
-                                            layouts[4] = "Tex Coord (v2)";
-                                            sceneMeshPtr->HaveTextureCoords();
-                                        }
-                                    }
-                                }
-                                if (mesh->mColors) {
-                                    if (mesh->mColors[0]) {
-                                        layouts[5] = "Color (v4)";
-                                        sceneMeshPtr->HaveVertexColors();
-                                    }
-                                }
-
-                                VertexStruct::P3_N3_TA3_BTA3_T2_C4 v;
-
-                                const double progressVerts = 1.0 / (double)mesh->mNumVertices;
-
-                                for (size_t i = 0; i != mesh->mNumVertices; ++i) {
-                                    const int64_t _firstTimeMark =
-                                        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-
-                                    if (!vWorking)
-                                        break;
-
-                                    v = VertexStruct::P3_N3_TA3_BTA3_T2_C4();
-
-                                    const auto& vert = mesh->mVertices[i];
-                                    v.p = ct::fvec3(vert.x, vert.y, vert.z);
-
-                                    if (mesh->mNormals) {
-                                        const auto& norm = mesh->mNormals[i];
-                                        v.n = ct::fvec3(norm.x, norm.y, norm.z);
-                                    }
-
-                                    if (mesh->mTangents) {
-                                        const auto& tang = mesh->mTangents[i];
-                                        v.tan = ct::fvec3(tang.x, tang.y, tang.z);
-                                    }
-
-                                    if (mesh->mBitangents) {
-                                        const auto& btan = mesh->mBitangents[i];
-                                        v.btan = ct::fvec3(btan.x, btan.y, btan.z);
-                                    }
-
-                                    if (mesh->mTextureCoords) {
-                                        if (mesh->mNumUVComponents[0] == 2U) {
-                                            if (mesh->mTextureCoords[0]) {
-                                                const auto& coor = mesh->mTextureCoords[0][i];
-                                                v.t = ct::fvec2(coor.x, coor.y);
-                                            }
-                                        }
-                                    }
-
-                                    if (mesh->mColors) {
-                                        if (mesh->mColors[0]) {
-                                            const auto& colo = mesh->mColors[0][i];
-                                            v.c = ct::fvec4(colo.r, colo.g, colo.b, colo.a);
-                                        }
-                                    }
-
-                                    sceneMeshPtr->GetVertices()->push_back(v);
-
-                                    vProgress = vProgress + progressVerts;
-
-                                    const int64_t _secondTimeMark =
-                                        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-
-                                    vGenerationTime = vGenerationTime + (double)(_secondTimeMark - _firstTimeMark) / 1000.0;
-                                }
-
-                                sceneMeshPtr->GetIndices()->reserve(mesh->mNumFaces * 3U);
-                                if (mesh->mNumFaces)
-                                    sceneMeshPtr->HaveIndices();
-                                for (size_t i = 0; i != mesh->mNumFaces; ++i) {
-                                    if (!vWorking)
-                                        break;
-
-                                    const int64_t _firstTimeMark =
-                                        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-
-                                    const aiFace& face = mesh->mFaces[i];
-                                    for (size_t j = 0; j != face.mNumIndices; ++j) {
-                                        if (!vWorking)
-                                            break;
-
-                                        sceneMeshPtr->GetIndices()->push_back(face.mIndices[j]);
-                                    }
-
-                                    const int64_t _secondTimeMark =
-                                        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-
-                                    vGenerationTime = vGenerationTime + (double)(_secondTimeMark - _firstTimeMark) / 1000.0;
-                                }
-
-                                // if (sceneMeshPtr->Init())
-                                {
-                                    MeshLoader::workerThread_Mutex.lock();
-                                    meshPtr->AddMesh(sceneMeshPtr);
-                                    MeshLoader::workerThread_Mutex.unlock();
-                                }
-                                /*else
-                                {
-                                    sceneMeshPtr.reset();
-                                    LogVarError("Failed to build the mesh %u VBO/IBO for %s", (uint32_t)k, filePathName.c_str());
-                                }*/
+                                MeshLoader_PrepareMesh(mesh, sceneMeshPtr);
+                                MeshLoader_AddJobs(mesh, sceneMeshs.size(), jobs);
+                                countItems += (size_t)mesh->mNumVertices + (size_t)mesh->mNumFaces;
+                                sceneMeshs.push_back(mesh);
+                                loadedMeshs.push_back(sceneMeshPtr);
                             }
-
-                            vProgress = vProgress + progressSteps;
                         }
                     }
 
-                    MeshLoader::workerThread_Mutex.lock();
-                    meshPtr->SetLayouts(layouts);
-                    MeshLoader::workerThread_Mutex.unlock();
+                    std::atomic<size_t> nextJob{0U};
+                    std::atomic<size_t> countDoneItems{0U};
+                    MeshLoaderConvertContext context;
+                    context.sceneMeshs = &sceneMeshs;
+                    context.loadedMeshs = &loadedMeshs;
+                    context.jobs = &jobs;
+                    context.nextJob = &nextJob;
+                    context.countDoneItems = &countDoneItems;
+                    context.countItems = countItems;
+                    context.progress = &vProgress;
+                    context.working = &vWorking;
+
+                    // one thread is kept for the rendering, the loader thread is also a worker
+                    const size_t countThreads = std::max<size_t>(2U, std::thread::hardware_concurrency());
+                    const size_t countWorkers = std::max<size_t>(1U, std::min<size_t>(std::min<size_t>(countThreads - 1U, 8U), jobs.size()));
+                    std::vector<std::thread> threads;
+                    threads.reserve(countWorkers - 1U);
+                    for (size_t i = 1U; i < countWorkers; ++i) {
+                        threads.emplace_back(MeshLoader_ConvertWorker, &context);
+                    }
+                    MeshLoader_ConvertWorker(&context);
+                    for (auto& thread : threads) {
+                        thread.join();
+                    }
+
+                    const int64_t _secondTimeMark = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+                    vGenerationTime = vGenerationTime + (double)(_secondTimeMark - _firstTimeMark) / 1000.0;
+
+                    // an aborted load is not published, the meshs are incomplete
+                    if (vWorking) {
+                        MeshLoader_FillLayouts(loadedMeshs, layouts);
+
+                        ct::fvec3 boundsMin, boundsMax;
+                        MeshCache::ComputeBounds(loadedMeshs, &boundsMin, &boundsMax);
+
+                        MeshLoader::workerThread_Mutex.lock();
+                        MeshLoader::Instance()->puLayouts = layouts;
+                        MeshLoader::Instance()->subMeshCount = scene->mNumMeshes;
+                        for (const auto& loadedMeshPtr : loadedMeshs) {
+                            meshPtr->AddMesh(loadedMeshPtr);
+                        }
+                        meshPtr->SetLayouts(layouts);
+                        meshPtr->SetBoundingBox(boundsMin, boundsMax);
+                        MeshLoader::workerThread_Mutex.unlock();
+
+                        MeshCache::Instance()->Save(filePathName, loadedMeshs);
+                    }
                 }
 
                 aiReleaseImport(scene);
@@ -21,6 +21,15 @@
 #include <Gui/CustomGuiWidgets.h>
 #include <Renderer/RenderPack.h>
 #include <ImGuiPack.h>
+#include <ctools/Logger.h>
+
+#include <filesystem>
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
 
 using namespace std::placeholders;
 
@@ -45,6 +54,7 @@ std::atomic<bool> MeshSaver::exportNormals(true);
 std::atomic<bool> MeshSaver::exportTexCoords(true);
 std::atomic<bool> MeshSaver::exportVertexColor(true);
 std::atomic<bool> MeshSaver::exportFaces(true);
+std::atomic<bool> MeshSaver::exportBinary(true);
 
 std::atomic<int> MeshSaver::countVectorX(0);
 std::atomic<int> MeshSaver::countVectorY(0);
@@ -248,322 +258,361 @@ void AddTriangleWithNormalsAndTexCoords(
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 
-int MeshPlySaver(std::string vFilePathName,
-                 std::atomic<double>& vProgress,
-                 std::atomic<bool>& vWorking,
-                 std::atomic<double>& vGenerationTime,
-                 std::atomic<bool>& vExportNormals,
-                 std::atomic<bool>& vExportTexCoords,
-                 std::atomic<bool>& vExportVertexColor,
-                 std::atomic<bool>& vExportFaces) {
-    vWorking = true;
-
-    vGenerationTime = 0.0;
-
-    if (!vFilePathName.empty()) {
-        std::vector<VertexStruct::P3_N3_T2_C4> vertexs;
-        size_t countVertexs = 0;
-        std::vector<VertexStruct::I1> indices;
-        size_t countIndices = 0;
-
-        MeshSaver::workerThread_Mutex.lock();
-
-        vertexs = MeshSaver::Instance()->vertices;
-        countVertexs = vertexs.size();
-        indices = MeshSaver::Instance()->indices;
-        countIndices = indices.size();
-
-        MeshSaver::workerThread_Mutex.unlock();
+// the vertexs and the indices are serialized by blocks, from a bounded snapshot of the shared arrays
+// so the mutex is only taken for the copy of the next blocks, and the memory stay bounded
+#define PLY_BLOCK_SIZE 65536U
+
+// the threads of the ascii serialization, created one time by export and used by all the batchs
+// the calling thread run jobs too, so with 0 worker the jobs are done on the calling thread
+class MeshSaverPlyWorkers {
+private:
+    std::vector<std::thread> m_Workers;
+    std::mutex m_JobsMutex;
+    std::condition_variable m_JobsCondition;  // a batch of jobs is available for the workers
+    std::condition_variable m_DoneCondition;  // a job is finished, for the calling thread
+    std::function<void(size_t)> m_Job;
+    size_t m_CountJobs = 0U;
+    size_t m_NextJob = 0U;
+    size_t m_CountDoneJobs = 0U;
+    bool m_Working = true;
+
+public:
+    explicit MeshSaverPlyWorkers(size_t vCountWorkers) {
+        m_Workers.reserve(vCountWorkers);
+        for (size_t i = 0U; i < vCountWorkers; ++i) {
+            m_Workers.emplace_back(&MeshSaverPlyWorkers::WorkerLoop, this);
+        }
+    }
+    ~MeshSaverPlyWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(m_JobsMutex);
+            m_Working = false;
+        }
+        m_JobsCondition.notify_all();
+        for (auto& worker : m_Workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+    MeshSaverPlyWorkers(const MeshSaverPlyWorkers&) = delete;
+    MeshSaverPlyWorkers& operator=(const MeshSaverPlyWorkers&) = delete;
 
-        std::string headerStr;
-        std::string vertexsStr;
-        // std::string normalsStr;
-        std::string facesStr;
+    // the workers and the calling thread
+    size_t GetCountThreads() const {
+        return m_Workers.size() + 1U;
+    }
 
-        char vertBuffer[1024];
-        // char norBuffer[1024];
-        char FaceBuffer[1024];
+    // call vJob(0) to vJob(vCountJobs - 1), return when all are finished
+    void Run(size_t vCountJobs, std::function<void(size_t)> vJob) {
+        {
+            std::lock_guard<std::mutex> lock(m_JobsMutex);
+            m_Job = std::move(vJob);
+            m_CountJobs = vCountJobs;
+            m_NextJob = 0U;
+            m_CountDoneJobs = 0U;
+        }
+        m_JobsCondition.notify_all();
 
-        // int faceId = 0;
-        // int vertexId = 0;
-        int n = 0;
+        while (RunNextJob()) {
+        }
 
-        headerStr += "ply\n";
-        headerStr += "format ascii 1.0\n";
-        headerStr += "comment Created NoodlesPlate 1.0\n";
-        headerStr += "element vertex " + ct::toStr(countVertexs) + "\n";
-        headerStr += "property float x\n";
-        headerStr += "property float y\n";
-        headerStr += "property float z\n";
+        std::unique_lock<std::mutex> lock(m_JobsMutex);
+        m_DoneCondition.wait(lock, [this]() { return m_CountDoneJobs == m_CountJobs; });
+        m_Job = nullptr;
+    }
 
-        if (vExportNormals) {
-            headerStr += "property float nx\n";
-            headerStr += "property float ny\n";
-            headerStr += "property float nz\n";
+private:
+    // return false if there is no more job to take
+    bool RunNextJob() {
+        size_t jobIdx = 0U;
+        {
+            std::lock_guard<std::mutex> lock(m_JobsMutex);
+            if (m_NextJob >= m_CountJobs)
+                return false;
+            jobIdx = m_NextJob++;
         }
 
-        if (vExportTexCoords) {
-            headerStr += "property float s\n";
-            headerStr += "property float t\n";
-        }
+        m_Job(jobIdx);
 
-        if (vExportVertexColor) {
-            headerStr += "property uchar red\n";
-            headerStr += "property uchar green\n";
-            headerStr += "property uchar blue\n";
-            headerStr += "property uchar alpha\n";
+        {
+            std::lock_guard<std::mutex> lock(m_JobsMutex);
+            ++m_CountDoneJobs;
         }
+        m_DoneCondition.notify_all();
+        return true;
+    }
 
-        if (vExportFaces) {
-            if (countIndices > 0) {
-                headerStr += "element face " + ct::toStr(countIndices / 3) + "\n";
-            } else {
-                headerStr += "element face " + ct::toStr(countVertexs / 3) + "\n";
+    void WorkerLoop() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_JobsMutex);
+                m_JobsCondition.wait(lock, [this]() { return m_NextJob < m_CountJobs || !m_Working; });
+                if (!m_Working)
+                    break;
             }
-
-            headerStr += "property list uchar uint vertex_indices\n";
+            RunNextJob();
         }
+    }
+};
+
+struct MeshSaverPlyParams {
+    bool binary = true;
+    bool normals = true;
+    bool texCoords = true;
+    bool vertexColor = true;
+    bool faces = true;
+};
+
+static std::string MeshSaver_GetPlyHeader(const MeshSaverPlyParams& vParams, size_t vCountVertexs, size_t vCountFaces) {
+    std::string headerStr;
+    headerStr += "ply\n";
+    headerStr += vParams.binary ? "format binary_little_endian 1.0\n" : "format ascii 1.0\n";
+    headerStr += "comment Created NoodlesPlate 1.0\n";
+    headerStr += "element vertex " + ct::toStr(vCountVertexs) + "\n";
+    headerStr += "property float x\n";
+    headerStr += "property float y\n";
+    headerStr += "property float z\n";
+
+    if (vParams.normals) {
+        headerStr += "property float nx\n";
+        headerStr += "property float ny\n";
+        headerStr += "property float nz\n";
+    }
 
-        headerStr += "end_header\n";
+    if (vParams.texCoords) {
+        headerStr += "property float s\n";
+        headerStr += "property float t\n";
+    }
 
-        if (countIndices > 0) {
-            for (size_t i = 0; i < countVertexs; i++) {
-                vProgress = (double)i / (double)(countVertexs - 1) * 0.5;
+    if (vParams.vertexColor) {
+        headerStr += "property uchar red\n";
+        headerStr += "property uchar green\n";
+        headerStr += "property uchar blue\n";
+        headerStr += "property uchar alpha\n";
+    }
 
-                if (!(vWorking != NULL))
-                    break;
+    if (vParams.faces) {
+        headerStr += "element face " + ct::toStr(vCountFaces) + "\n";
+        headerStr += "property list uchar uint vertex_indices\n";
+    }
 
-                int64_t firstTimeMark = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-
-                VertexStruct::P3_N3_T2_C4* vn = &vertexs.data()[i];
-
-                // clamp color :
-                vn->c = ct::clamp<ct::fvec4>(vn->c, 0.0f, 1.0f);
-
-                if (vExportTexCoords) {
-                    if (vExportNormals) {
-                        if (vExportVertexColor) {
-                            n = snprintf(vertBuffer,
-                                         512,
-                                         "%.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f %i %i %i %i\n",
-                                         vn->p.x,
-                                         vn->p.y,
-                                         vn->p.z,
-                                         vn->n.x,
-                                         vn->n.y,
-                                         vn->n.z,
-                                         vn->t.x,
-                                         vn->t.y,
-                                         (int)(vn->c.x * 255),
-                                         (int)(vn->c.y * 255),
-                                         (int)(vn->c.z * 255),
-                                         (int)(vn->c.w * 255));
-                        } else {
-                            n = snprintf(
-                                vertBuffer, 256, "%.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f\n", vn->p.x, vn->p.y, vn->p.z, vn->n.x, vn->n.y, vn->n.z, vn->t.x, vn->t.y);
-                        }
-                    } else {
-                        if (vExportVertexColor) {
-                            n = snprintf(vertBuffer,
-                                         512,
-                                         "%.5f %.5f %.5f %.5f %.5f %i %i %i %i\n",
-                                         vn->p.x,
-                                         vn->p.y,
-                                         vn->p.z,
-                                         vn->t.x,
-                                         vn->t.y,
-                                         (int)(vn->c.x * 255),
-                                         (int)(vn->c.y * 255),
-                                         (int)(vn->c.z * 255),
-                                         (int)(vn->c.w * 255));
-                        } else {
-                            n = snprintf(vertBuffer, 256, "%.5f %.5f %.5f %.5f %.5f\n", vn->p.x, vn->p.y, vn->p.z, vn->t.x, vn->t.y);
-                        }
-                    }
-                } else {
-                    if (vExportNormals) {
-                        if (vExportVertexColor) {
-                            n = snprintf(vertBuffer,
-                                         512,
-                                         "%.5f %.5f %.5f %.5f %.5f %.5f %i %i %i %i\n",
-                                         vn->p.x,
-                                         vn->p.y,
-                                         vn->p.z,
-                                         vn->n.x,
-                                         vn->n.y,
-                                         vn->n.z,
-                                         (int)(vn->c.x * 255),
-                                         (int)(vn->c.y * 255),
-                                         (int)(vn->c.z * 255),
-                                         (int)(vn->c.w * 255));
-                        } else {
-                            n = snprintf(vertBuffer, 256, "%.5f %.5f %.5f %.5f %.5f %.5f\n", vn->p.x, vn->p.y, vn->p.z, vn->n.x, vn->n.y, vn->n.z);
-                        }
-                    } else {
-                        if (vExportVertexColor) {
-                            n = snprintf(vertBuffer,
-                                         512,
-                                         "%.5f %.5f %.5f %i %i %i %i\n",
-                                         vn->p.x,
-                                         vn->p.y,
-                                         vn->p.z,
-                                         (int)(vn->c.x * 255),
-                                         (int)(vn->c.y * 255),
-                                         (int)(vn->c.z * 255),
-                                         (int)(vn->c.w * 255));
-                        } else {
-                            n = snprintf(vertBuffer, 256, "%.5f %.5f %.5f\n", vn->p.x, vn->p.y, vn->p.z);
-                        }
-                    }
-                }
+    headerStr += "end_header\n";
+    return headerStr;
+}
 
-                vertexsStr += vertBuffer;
+// the binary format is little endian, like all our targets
+static void MeshSaver_AppendPlyBinary(std::string& vOut, const void* vDatas, size_t vSize) {
+    vOut.append((const char*)vDatas, vSize);
+}
 
-                int64_t secondTimeMark = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+static void MeshSaver_SerializePlyVertexs(const MeshSaverPlyParams& vParams, const VertexStruct::P3_N3_T2_C4* vVertexs, size_t vCount, std::string& vOut) {
+    vOut.clear();
+    char vertBuffer[512];
+    for (size_t i = 0; i < vCount; ++i) {
+        const auto& v = vVertexs[i];
+
+        // clamp color :
+        const ct::fvec4 c = ct::clamp<ct::fvec4>(v.c, 0.0f, 1.0f);
+        const uint8_t col[4] = {(uint8_t)(c.x * 255), (uint8_t)(c.y * 255), (uint8_t)(c.z * 255), (uint8_t)(c.w * 255)};
+
+        if (vParams.binary) {
+            MeshSaver_AppendPlyBinary(vOut, &v.p, sizeof(float) * 3U);
+            if (vParams.normals)
+                MeshSaver_AppendPlyBinary(vOut, &v.n, sizeof(float) * 3U);
+            if (vParams.texCoords)
+                MeshSaver_AppendPlyBinary(vOut, &v.t, sizeof(float) * 2U);
+            if (vParams.vertexColor)
+                MeshSaver_AppendPlyBinary(vOut, col, 4U);
+        } else {
+            int n = snprintf(vertBuffer, 512, "%.5f %.5f %.5f", v.p.x, v.p.y, v.p.z);
+            if (vParams.normals)
+                n += snprintf(vertBuffer + n, 512 - n, " %.5f %.5f %.5f", v.n.x, v.n.y, v.n.z);
+            if (vParams.texCoords)
+                n += snprintf(vertBuffer + n, 512 - n, " %.5f %.5f", v.t.x, v.t.y);
+            if (vParams.vertexColor)
+                n += snprintf(vertBuffer + n, 512 - n, " %i %i %i %i", (int)col[0], (int)col[1], (int)col[2], (int)col[3]);
+            vertBuffer[n++] = '\n';
+            vOut.append(vertBuffer, n);
+        }
+    }
+}
 
-                vGenerationTime = vGenerationTime + (double)(secondTimeMark - firstTimeMark) / 1000.0;
-            }
+// if vIndices is null, the faces are the vertexs 3 by 3
+static void MeshSaver_SerializePlyFaces(const MeshSaverPlyParams& vParams, const VertexStruct::I1* vIndices, size_t vFirstFace, size_t vCount, std::string& vOut) {
+    vOut.clear();
+    char faceBuffer[128];
+    for (size_t i = 0; i < vCount; ++i) {
+        uint32_t face[3];
+        for (size_t k = 0; k < 3U; ++k) {
+            face[k] = vIndices ? vIndices[i * 3U + k] : (uint32_t)((vFirstFace + i) * 3U + k);
+        }
 
-            if (vWorking) {
-                if (vExportFaces && countIndices > 0) {
-                    for (size_t i = 0; i < countIndices; i += 3) {
-                        vProgress = (double)i / (double)(countIndices - 1) * 0.5 + 0.5;
+        if (vParams.binary) {
+            const uint8_t countIndices = 3U;
+            MeshSaver_AppendPlyBinary(vOut, &countIndices, 1U);
+            MeshSaver_AppendPlyBinary(vOut, face, sizeof(uint32_t) * 3U);
+        } else {
+            const int n = snprintf(faceBuffer, 128, "3 %u %u %u\n", face[0], face[1], face[2]);
+            vOut.append(faceBuffer, n);
+        }
+    }
+}
 
-                        if (!(vWorking != NULL))
-                            break;
+// the blocks of a batch are serialized in parallel, then written in order
+template <typename T>
+static bool MeshSaver_WritePlyElements(std::ofstream& vFileWriter,
+                                       const MeshSaverPlyParams& vParams,
+                                       const std::vector<T>& vSource,
+                                       size_t vCountElements,
+                                       size_t vItemsPerElement,
+                                       MeshSaverPlyWorkers& vWorkers,
+                                       std::atomic<double>& vProgress,
+                                       double vProgressOffset,
+                                       double vProgressScale,
+                                       std::atomic<bool>& vWorking,
+                                       std::atomic<double>& vGenerationTime,
+                                       std::function<void(const T*, size_t, size_t, std::string&)> vSerializeFunc) {
+    const size_t countElements = vCountElements;
+    const size_t elementsPerBlock = PLY_BLOCK_SIZE;
+    const size_t elementsPerBatch = elementsPerBlock * vWorkers.GetCountThreads();
+    std::vector<T> snapshot;
+    std::vector<std::string> blocks(vWorkers.GetCountThreads());
+    for (size_t first = 0U; first < countElements; first += elementsPerBatch) {
+        if (!vWorking)
+            return false;
+
+        const int64_t firstTimeMark = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+        const size_t count = std::min(elementsPerBatch, countElements - first);
+
+        // no source for the generated faces
+        const T* datas = nullptr;
+        if (vItemsPerElement) {
+            MeshSaver::workerThread_Mutex.lock();
+            if (vSource.size() < (first + count) * vItemsPerElement) {
+                MeshSaver::workerThread_Mutex.unlock();
+                LogVarError("the datas to export have changed during the export");
+                return false;
+            }
+            snapshot.assign(vSource.begin() + first * vItemsPerElement, vSource.begin() + (first + count) * vItemsPerElement);
+            MeshSaver::workerThread_Mutex.unlock();
+            datas = snapshot.data();
+        }
 
-                        int64_t firstTimeMark = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        const size_t countBlocks = (count + elementsPerBlock - 1U) / elementsPerBlock;
+        vWorkers.Run(countBlocks, [&](size_t b) {
+            const size_t blockFirst = b * elementsPerBlock;
+            const size_t blockCount = std::min(elementsPerBlock, count - blockFirst);
+            const T* blockDatas = datas ? datas + blockFirst * vItemsPerElement : nullptr;
+            vSerializeFunc(blockDatas, first + blockFirst, blockCount, blocks[b]);
+        });
 
-                        n = snprintf(FaceBuffer, 256, "3 %i %i %i\n", indices[i + 0 + 0], indices[i + 0 + 1], indices[i + 0 + 2]);
+        for (size_t b = 0U; b < countBlocks; ++b) {
+            vFileWriter.write(blocks[b].data(), blocks[b].size());
+        }
+        if (!vFileWriter.good()) {
+            LogVarError("Cant write the ply file");
+            return false;
+        }
 
-                        facesStr += FaceBuffer;
+        vProgress = vProgressOffset + vProgressScale * (double)(first + count) / (double)countElements;
 
-                        int64_t secondTimeMark = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        const int64_t secondTimeMark = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 
-                        vGenerationTime = vGenerationTime + (secondTimeMark - firstTimeMark) / 1000.0f;
-                    }
-                }
-            }
-        } else {
-            for (size_t i = 0; i < countVertexs; i += 3) {
-                vProgress = (double)i / (double)(countVertexs - 1);
+        vGenerationTime = vGenerationTime + (double)(secondTimeMark - firstTimeMark) / 1000.0;
+    }
 
-                if (!(vWorking != NULL))
-                    break;
+    return true;
+}
 
-                int64_t firstTimeMark = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-
-                for (int k = 0; k < 3; k++) {
-                    VertexStruct::P3_N3_T2_C4* vn = &vertexs.data()[i + k];
-
-                    // clamp color :
-                    vn->c = ct::clamp<ct::fvec4>(vn->c, 0.0f, 1.0f);
-
-                    if (vExportTexCoords) {
-                        if (vExportNormals) {
-                            if (vExportVertexColor) {
-                                n = snprintf(vertBuffer,
-                                             512,
-                                             "%.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f %i %i %i %i\n",
-                                             vn->p.x,
-                                             vn->p.y,
-                                             vn->p.z,
-                                             vn->n.x,
-                                             vn->n.y,
-                                             vn->n.z,
-                                             vn->t.x,
-                                             vn->t.y,
-                                             (int)(vn->c.x * 255),
-                                             (int)(vn->c.y * 255),
-                                             (int)(vn->c.z * 255),
-                                             (int)(vn->c.w * 255));
-                            } else {
-                                n = snprintf(
-                                    vertBuffer, 256, "%.5f %.5f %.5f %.5f %.5f %.5f %.5f %.5f\n", vn->p.x, vn->p.y, vn->p.z, vn->n.x, vn->n.y, vn->n.z, vn->t.x, vn->t.y);
-                            }
-                        } else {
-                            if (vExportVertexColor) {
-                                n = snprintf(vertBuffer,
-                                             512,
-                                             "%.5f %.5f %.5f %.5f %.5f %i %i %i %i\n",
-                                             vn->p.x,
-                                             vn->p.y,
-                                             vn->p.z,
-                                             vn->t.x,
-                                             vn->t.y,
-                                             (int)(vn->c.x * 255),
-                                             (int)(vn->c.y * 255),
-                                             (int)(vn->c.z * 255),
-                                             (int)(vn->c.w * 255));
-                            } else {
-                                n = snprintf(vertBuffer, 256, "%.5f %.5f %.5f %.5f %.5f\n", vn->p.x, vn->p.y, vn->p.z, vn->t.x, vn->t.y);
-                            }
-                        }
-                    } else {
-                        if (vExportNormals) {
-                            if (vExportVertexColor) {
-                                n = snprintf(vertBuffer,
-                                             512,
-                                             "%.5f %.5f %.5f %.5f %.5f %.5f %i %i %i %i\n",
-                                             vn->p.x,
-                                             vn->p.y,
-                                             vn->p.z,
-                                             vn->n.x,
-                                             vn->n.y,
-                                             vn->n.z,
-                                             (int)(vn->c.x * 255),
-                                             (int)(vn->c.y * 255),
-                                             (int)(vn->c.z * 255),
-                                             (int)(vn->c.w * 255));
-                            } else {
-                                n = snprintf(vertBuffer, 256, "%.5f %.5f %.5f %.5f %.5f %.5f\n", vn->p.x, vn->p.y, vn->p.z, vn->n.x, vn->n.y, vn->n.z);
-                            }
-                        } else {
-                            if (vExportVertexColor) {
-                                n = snprintf(vertBuffer,
-                                             512,
-                                             "%.5f %.5f %.5f %i %i %i %i\n",
-                                             vn->p.x,
-                                             vn->p.y,
-                                             vn->p.z,
-                                             (int)(vn->c.x * 255),
-                                             (int)(vn->c.y * 255),
-                                             (int)(vn->c.z * 255),
-                                             (int)(vn->c.w * 255));
-                            } else {
-                                n = snprintf(vertBuffer, 256, "%.5f %.5f %.5f\n", vn->p.x, vn->p.y, vn->p.z);
-                            }
-                        }
-                    }
+int MeshPlySaver(std::string vFilePathName,
+                 std::atomic<double>& vProgress,
+                 std::atomic<bool>& vWorking,
+                 std::atomic<double>& vGenerationTime,
+                 std::atomic<bool>& vExportNormals,
+                 std::atomic<bool>& vExportTexCoords,
+                 std::atomic<bool>& vExportVertexColor,
+                 std::atomic<bool>& vExportFaces,
+                 std::atomic<bool>& vExportBinary) {
+    vWorking = true;
 
-                    vertexsStr += vertBuffer;
-                }
+    vGenerationTime = 0.0;
 
-                if (vExportFaces) {
-                    n = snprintf(FaceBuffer, 256, "3 %zi %zi %zi\n", i + 0 + 0, i + 0 + 1, i + 0 + 2);
+    if (!vFilePathName.empty()) {
+        MeshSaverPlyParams params;
+        params.binary = vExportBinary;
+        params.normals = vExportNormals;
+        params.texCoords = vExportTexCoords;
+        params.vertexColor = vExportVertexColor;
+        params.faces = vExportFaces;
 
-                    facesStr += FaceBuffer;
-                }
+        MeshSaver::workerThread_Mutex.lock();
+        const size_t countVertexs = MeshSaver::Instance()->vertices.size();
+        const size_t countIndices = MeshSaver::Instance()->indices.size();
+        MeshSaver::workerThread_Mutex.unlock();
 
-                int64_t secondTimeMark = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        // without indices, the faces are the vertexs 3 by 3
+        const size_t countFaces = (countIndices > 0) ? countIndices / 3 : countVertexs / 3;
 
-                vGenerationTime = vGenerationTime + (double)(secondTimeMark - firstTimeMark) / 1000.0;
-            }
+        // the binary serialization is only copies, the export thread is enough
+        size_t countWorkers = 0U;
+        if (!params.binary) {
+            // one thread is kept for the rendering, the export thread is one of the others
+            countWorkers = std::min<size_t>(std::max<size_t>(2U, std::thread::hardware_concurrency()) - 1U, 8U) - 1U;
         }
+        MeshSaverPlyWorkers workers(countWorkers);
 
-        if (vWorking) {
-            std::ofstream fileWriter(vFilePathName, std::ios::out);
-
-            if (fileWriter.bad() == false) {
-                fileWriter << headerStr;
-                fileWriter << vertexsStr;
-
-                if (vExportFaces) {
-                    fileWriter << facesStr;
+        bool ok = false;
+        {
+            std::ofstream fileWriter(vFilePathName, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (fileWriter.is_open()) {
+                fileWriter << MeshSaver_GetPlyHeader(params, countVertexs, countFaces);
+
+                const double vertexsPart = params.faces ? 0.5 : 1.0;
+
+                ok = MeshSaver_WritePlyElements<VertexStruct::P3_N3_T2_C4>(
+                    fileWriter,
+                    params,
+                    MeshSaver::Instance()->vertices,
+                    countVertexs,
+                    1U,
+                    workers,
+                    vProgress,
+                    0.0,
+                    vertexsPart,
+                    vWorking,
+                    vGenerationTime,
+                    [&params](const VertexStruct::P3_N3_T2_C4* vDatas, size_t /*vFirst*/, size_t vCount, std::string& vOut) {
+                        MeshSaver_SerializePlyVertexs(params, vDatas, vCount, vOut);
+                    });
+
+                if (ok && params.faces) {
+                    ok = MeshSaver_WritePlyElements<VertexStruct::I1>(
+                        fileWriter,
+                        params,
+                        MeshSaver::Instance()->indices,
+                        countFaces,
+                        (countIndices > 0) ? 3U : 0U,
+                        workers,
+                        vProgress,
+                        vertexsPart,
+                        1.0 - vertexsPart,
+                        vWorking,
+                        vGenerationTime,
+                        [&params](const VertexStruct::I1* vDatas, size_t vFirst, size_t vCount, std::string& vOut) {
+                            MeshSaver_SerializePlyFaces(params, vDatas, vFirst, vCount, vOut);
+                        });
                 }
+            } else {
+                LogVarError("Cant open the file %s", vFilePathName.c_str());
             }
+        }
 
-            fileWriter.close();
+        // a partial file is not kept
+        if (!ok) {
+            std::error_code ec;
+            std::filesystem::remove(vFilePathName, ec);
         }
     }
 
@@ -701,6 +750,10 @@ inline void InfosPane(std::string vFilter, IGFDUserDatas /*vUserDatas*/, bool* v
         if (ImGui::Checkbox("Export Faces", &val)) {
             MeshSaver::exportFaces = val;
         }
+        val = MeshSaver::exportBinary;
+        if (ImGui::Checkbox("Binary File", &val)) {
+            MeshSaver::exportBinary = val;
+        }
         if (vCantContinue)
             *vCantContinue = true;
     } else if (vFilter == ".fga")  // fga
@@ -878,7 +931,8 @@ void MeshSaver::CreateThread(/*std::function<void()> vFinishFunc, */ MeshFormatE
                                          std::ref(MeshSaver::exportNormals),
                                          std::ref(MeshSaver::exportTexCoords),
                                          std::ref(MeshSaver::exportVertexColor),
-                                         std::ref(MeshSaver::exportFaces));
+                                         std::ref(MeshSaver::exportFaces),
+                                         std::ref(MeshSaver::exportBinary));
         } else if (vMeshFormat == MeshFormatEnum::MESH_FORMAT_FGA) {
             // puFinishFunc = vFinishFunc;
             MeshSaver::Working = true;
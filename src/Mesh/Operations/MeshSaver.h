@@ -46,6 +46,7 @@ public:  // PLY
     static std::atomic<bool> exportTexCoords;
     static std::atomic<bool> exportVertexColor;
     static std::atomic<bool> exportFaces;
+    static std::atomic<bool> exportBinary;  // binary_little_endian, else ascii
 
 public:  // FGA
     static std::atomic<int> countVectorX;
@@ -63,7 +64,7 @@ private:
     float puGenerationTime = 0.0f;
     std::function<void()> puFinishFunc;
 
-public:
+public:  // the export thread read them by blocks, under workerThread_Mutex
     std::vector<VertexStruct::P3_N3_T2_C4> vertices;
     std::vector<VertexStruct::I1> indices;
     std::vector<std::string> puLayouts;
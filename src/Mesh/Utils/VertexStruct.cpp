@@ -18,6 +18,78 @@
 
 #include "VertexStruct.h"
 
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+int16_t VertexStruct::ToSnorm16(float vValue) {
+    return (int16_t)std::lround(std::clamp(vValue, -1.0f, 1.0f) * 32767.0f);
+}
+
+uint8_t VertexStruct::ToUnorm8(float vValue) {
+    return (uint8_t)std::lround(std::clamp(vValue, 0.0f, 1.0f) * 255.0f);
+}
+
+// round to nearest, the too big values become inf, the too small become 0
+uint16_t VertexStruct::ToHalf(float vValue) {
+    uint32_t bits = 0U;
+    memcpy(&bits, &vValue, sizeof(float));
+    const uint16_t sign = (uint16_t)((bits >> 16U) & 0x8000U);
+    const uint32_t absBits = bits & 0x7FFFFFFFU;
+    if (absBits >= 0x7F800000U) {  // inf or nan
+        return (uint16_t)(sign | 0x7C00U | ((absBits > 0x7F800000U) ? 0x200U : 0U));
+    }
+    if (absBits >= 0x477FF000U) {  // >= 65520, overflow
+        return (uint16_t)(sign | 0x7C00U);
+    }
+    if (absBits < 0x38800000U) {  // < 2^-14, denormal or zero
+        if (absBits < 0x33000000U) {
+            return sign;
+        }
+        const uint32_t mantissa = (absBits & 0x7FFFFFU) | 0x800000U;
+        const uint32_t shift = 126U - (absBits >> 23U);
+        uint32_t half = mantissa >> shift;
+        const uint32_t rest = mantissa & ((1U << shift) - 1U);
+        const uint32_t middle = 1U << (shift - 1U);
+        if (rest > middle || (rest == middle && (half & 1U))) {
+            ++half;
+        }
+        return (uint16_t)(sign | half);
+    }
+    uint32_t half = ((absBits - 0x38000000U) >> 13U);
+    const uint32_t rest = absBits & 0x1FFFU;
+    if (rest > 0x1000U || (rest == 0x1000U && (half & 1U))) {
+        ++half;
+    }
+    return (uint16_t)(sign | half);
+}
+
+float VertexStruct::FromHalf(uint16_t vValue) {
+    const uint32_t sign = (uint32_t)(vValue & 0x8000U) << 16U;
+    const uint32_t exponent = (vValue >> 10U) & 0x1FU;
+    uint32_t mantissa = vValue & 0x3FFU;
+    uint32_t bits = 0U;
+    if (exponent == 0U) {
+        if (mantissa == 0U) {
+            bits = sign;
+        } else {  // denormal
+            uint32_t e = 113U;
+            while (!(mantissa & 0x400U)) {
+                mantissa <<= 1U;
+                --e;
+            }
+            bits = sign | (e << 23U) | ((mantissa & 0x3FFU) << 13U);
+        }
+    } else if (exponent == 0x1FU) {  // inf or nan
+        bits = sign | 0x7F800000U | (mantissa << 13U);
+    } else {
+        bits = sign | ((exponent + 112U) << 23U) | (mantissa << 13U);
+    }
+    float res = 0.0f;
+    memcpy(&res, &bits, sizeof(float));
+    return res;
+}
+
 VertexStruct::P2::P2() {
 }
 VertexStruct::P2::P2(ct::fvec2 vp) {
@@ -140,4 +212,25 @@ VertexStruct::P3_N3_TA3_BTA3_T2_C4::P3_N3_TA3_BTA3_T2_C4(ct::fvec3 vp, ct::fvec3
     btan = vbtan;
     t = vt;
     c = vc;
-}
\ No newline at end of file
+}
+
+VertexStruct::P3_N3_TA3_BTA3_T2_C4_Compact::P3_N3_TA3_BTA3_T2_C4_Compact() {
+}
+VertexStruct::P3_N3_TA3_BTA3_T2_C4_Compact::P3_N3_TA3_BTA3_T2_C4_Compact(const P3_N3_TA3_BTA3_T2_C4& vVertex) {
+    p = vVertex.p;
+    n[0] = ToSnorm16(vVertex.n.x);
+    n[1] = ToSnorm16(vVertex.n.y);
+    n[2] = ToSnorm16(vVertex.n.z);
+    tan[0] = ToSnorm16(vVertex.tan.x);
+    tan[1] = ToSnorm16(vVertex.tan.y);
+    tan[2] = ToSnorm16(vVertex.tan.z);
+    btan[0] = ToSnorm16(vVertex.btan.x);
+    btan[1] = ToSnorm16(vVertex.btan.y);
+    btan[2] = ToSnorm16(vVertex.btan.z);
+    t[0] = ToHalf(vVertex.t.x);
+    t[1] = ToHalf(vVertex.t.y);
+    c[0] = ToUnorm8(vVertex.c.x);
+    c[1] = ToUnorm8(vVertex.c.y);
+    c[2] = ToUnorm8(vVertex.c.z);
+    c[3] = ToUnorm8(vVertex.c.w);
+}
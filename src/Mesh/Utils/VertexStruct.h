@@ -26,6 +26,14 @@ namespace VertexStruct {
 // vulkan, il semeble que uint64 verole les indes dans le gpu, est ce uniquement du au binaire x86 ?
 // a tester sur x64. vk::DeviceSize est un uint64_t curieusement, mais peut etre que un indexBuffer ne peut supporter ce format
 typedef uint32_t I1;
+// indices des sous mesh de moins de 65536 vertices
+typedef uint16_t I2;
+
+// conversions for the compact formats
+int16_t ToSnorm16(float vValue);   // [-1:1] => [-32767:32767]
+uint8_t ToUnorm8(float vValue);    // [0:1] => [0:255]
+uint16_t ToHalf(float vValue);     // float 32 => float 16
+float FromHalf(uint16_t vValue);  // float 16 => float 32
 
 struct P2 {
     ct::fvec2 p;  // pos
@@ -107,4 +115,19 @@ struct P3_N3_TA3_BTA3_T2_C4 {
     P3_N3_TA3_BTA3_T2_C4(ct::fvec3 vp, ct::fvec3 vn, ct::fvec3 vtan, ct::fvec3 vbtan, ct::fvec2 vt);
     P3_N3_TA3_BTA3_T2_C4(ct::fvec3 vp, ct::fvec3 vn, ct::fvec3 vtan, ct::fvec3 vbtan, ct::fvec2 vt, ct::fvec4 vc);
 };
+
+// compact version of P3_N3_TA3_BTA3_T2_C4 for the gpu, 44 bytes instead of 72
+// normals and tangents in snorm16 (the 4th is a padding), tex coords in half float, colors in unorm8
+// bound as normalized attributes, the shaders get the same vec3/vec2/vec4 than the full float format
+struct P3_N3_TA3_BTA3_T2_C4_Compact {
+    ct::fvec3 p;            // pos
+    int16_t n[4] = {};      // normal
+    int16_t tan[4] = {};    // tangent
+    int16_t btan[4] = {};   // bitangent
+    uint16_t t[2] = {};     // tex coord
+    uint8_t c[4] = {};      // color, clamped to [0:1]
+
+    P3_N3_TA3_BTA3_T2_C4_Compact();
+    P3_N3_TA3_BTA3_T2_C4_Compact(const P3_N3_TA3_BTA3_T2_C4& vVertex);
+};
 }  // namespace VertexStruct
@@ -39,6 +39,8 @@
 #include <Texture/TextureSound.h>
 #include <Profiler/TracyProfiler.h>
 #include <Uniforms/UniformHelper.h>
+#include <Uniforms/UniformUploadPlan.h>
+#include <Renderer/ShaderCompiler.h>
 #include <CodeTree/Parsing/UniformParsing.h>
 #include <VR/Backend/VRBackend.h>
 #include <Res/CustomFont.h>
@@ -54,6 +56,7 @@
 
 #include <chrono>
 #include <ctime>
+#include <cstring>  // memcpy
 // typedef std::chrono::high_resolution_clock Clock;
 typedef std::chrono::system_clock Clock;
 
@@ -964,6 +967,12 @@ bool RenderPack::RenderNode(GLenum* vRenderMode,
 {
     bool res = false;
 
+    // swap the program compiled by the worker if ready
+    FinishAsyncShaderCompilation();
+
+    // the finished read backs of the last frames, ex : the async exports to files
+    UpdateAsyncReadBacks();
+
     if (puCanWeRender && puShaderKey) {
         prCountIterations = ct::maxi((uint32_t)puShaderKey->puShaderGlobalSettings.countIterations, 1U);
         prCountFramesToJump = ct::maxi((uint32_t)puShaderKey->puShaderGlobalSettings.countFramesToJump, 0U) + 1U;
@@ -1021,6 +1030,13 @@ bool RenderPack::RenderNode(GLenum* vRenderMode,
             }
 
             m_CommandBuffer.End();
+
+            // the final frame of the key of the timeline, for his video and gif renderings
+            if (res && !vDontUseAnyFBO &&                                     //
+                puShaderKey == TimeLineSystem::Instance()->GetActiveKey() &&  //
+                (!puMainRenderPack || puMainRenderPack == m_This.lock())) {
+                TimeLineSystem::Instance()->WriteCurrentFrameToSink(m_This);
+            }
         } else {
             puFrameIdx++;
         }
@@ -1103,77 +1119,46 @@ void RenderPack::UploadUniforms() {
 
         const bool isCompute = (puRenderPackType == RenderPack_Type::RENDERPACK_TYPE_COMPUTE);
 
+        // the plan is compiled once per link, then only the changed or dynamic uniforms are uploaded
+        if (!m_UniformUploadPlan.IsValidFor(puShaderKey)) {
+            m_UniformUploadPlan.Compile(puShaderKey);
+        }
+
         int textureSlotId = 0;
-        for (auto it = puShaderKey->puUniformsDataBase.begin(); it != puShaderKey->puUniformsDataBase.end(); ++it) {
-            UniformVariantPtr v = it->second;
+        for (auto& entry : m_UniformUploadPlan.GetEntries()) {
+            UniformVariantPtr v = entry.uniform;
 
-            RenderPackWeak otherBuffer;
+            RenderPackPtr otherPtr = nullptr;
 
             // on choisi le buffer associé
-            if (puMainRenderPack && (v->widget == "buffer" || v->widget == "compute")) {
-                if (!v->bufferShaderName.empty()) {
-                    otherBuffer = puMainRenderPack->puBuffers.get(v->bufferShaderName);
-                } else if (!v->computeShaderName.empty()) {
-                    otherBuffer = puMainRenderPack->puBuffers.get(v->computeShaderName);
+            if (entry.source == UniformUploadSourceEnum::UPLOAD_SOURCE_BUFFER_OTHER ||  //
+                entry.source == UniformUploadSourceEnum::UPLOAD_SOURCE_COMPUTE_OTHER) {
+                otherPtr = entry.otherBuffer.lock();
+                if (!otherPtr && puMainRenderPack) {
+                    entry.otherBuffer = puMainRenderPack->puBuffers.get(entry.otherBufferName);
+                    otherPtr = entry.otherBuffer.lock();
                 }
             }
 
             // on demarre le binding des uniforms avec leur valeurs
-            if (v->widget == "deltatime") {
-                v->x = puLastRenderTime;
-            } else if (v->widget == "frame") {
-                v->ix = puFrameIdx;
-            } else if (v->widget == "record") {
-                v->record = puRecordBuffer;
-            } else if (v->widget == "depth" && puFrameBuffer) {
-                v->uSampler2D = puFrameBuffer->getBackDepthTextureID();
-            } else if (v->widget == "buffer") {
-                if (v->bufferShaderName.empty()) {
-                    v->pipe = puFrameBuffer;
-
-                    /*if (v->glslType == uType::uTypeEnum::U_SAMPLER2D)
-                    {
-                        LogVarLightInfo("%i : B %s B%uT%u -> F %s B%uT%u",
-                            (intptr_t)v->pipe,
-                            puName.c_str(),
-                            v->pipe->getBackFboID(),
-                            v->pipe->getBackBuffer()->getTextureID(0),
-                            puName.c_str(),
-                            puFrameBuffer->getFrontFboID(),
-                            puFrameBuffer->getFrontBuffer()->getTextureID(0));
-                    }*/
-                } else {
-                    if (!otherBuffer.expired()) {
-                        auto otherPtr = otherBuffer.lock();
-                        if (otherPtr) {
-                            v->pipe = otherPtr->GetPipe();
-
-                            /*if (v->glslType == uType::uTypeEnum::U_SAMPLER2D)
-                            {
-                                LogVarLightInfo("%i : B %s B%uT%u -> F %s B%uT%u",
-                                    (intptr_t)v->pipe,
-                                    otherBuffer->puName.c_str(),
-                                    v->pipe->getBackFboID(),
-                                    v->pipe->getBackBuffer()->getTextureID(0),
-                                    puName.c_str(),
-                                    puFrameBuffer->getFrontFboID(),
-                                    puFrameBuffer->getFrontBuffer()->getTextureID(0));
-                            }*/
-                        }
+            switch (entry.source) {
+                case UniformUploadSourceEnum::UPLOAD_SOURCE_DELTATIME: v->x = puLastRenderTime; break;
+                case UniformUploadSourceEnum::UPLOAD_SOURCE_FRAME: v->ix = puFrameIdx; break;
+                case UniformUploadSourceEnum::UPLOAD_SOURCE_RECORD: v->record = puRecordBuffer; break;
+                case UniformUploadSourceEnum::UPLOAD_SOURCE_DEPTH: {
+                    if (puFrameBuffer) {
+                        v->uSampler2D = puFrameBuffer->getBackDepthTextureID();
+                    }
+                } break;
+                case UniformUploadSourceEnum::UPLOAD_SOURCE_BUFFER: v->pipe = puFrameBuffer; break;
+                case UniformUploadSourceEnum::UPLOAD_SOURCE_BUFFER_OTHER: {
+                    if (otherPtr) {
+                        v->pipe = otherPtr->GetPipe();
                     } else {
                         v->pipe = nullptr;
                     }
-                }
-            } else if (v->widget == "compute") {
-                /*if (isCompute)
-                {
-                    if (v->texture_ptr)
-                        v->texture_ptr->Swap();
-                    if (v->volume_ptr)
-                        v->volume_ptr->Swap();
-                }*/
-
-                if (v->computeShaderName.empty()) {
+                } break;
+                case UniformUploadSourceEnum::UPLOAD_SOURCE_COMPUTE: {
                     if (v->glslType == uType::uTypeEnum::U_VEC3) {
                         v->x = (float)puSectionConfig.computeConfig.size.x;
                         v->y = (float)puSectionConfig.computeConfig.size.y;
@@ -1182,45 +1167,45 @@ void RenderPack::UploadUniforms() {
                         v->x = (float)puSectionConfig.computeConfig.size.x;
                         v->y = (float)puSectionConfig.computeConfig.size.y;
                     }
-                } else {
-                    if (!otherBuffer.expired()) {
-                        auto otherPtr = otherBuffer.lock();
-                        if (otherPtr) {
-                            if (v->glslType == uType::uTypeEnum::U_VEC3) {
-                                v->x = (float)otherPtr->puSectionConfig.computeConfig.size.x;
-                                v->y = (float)otherPtr->puSectionConfig.computeConfig.size.y;
-                                v->z = (float)otherPtr->puSectionConfig.computeConfig.size.z;
-                            } else if (v->glslType == uType::uTypeEnum::U_VEC2) {
-                                v->x = (float)otherPtr->puSectionConfig.computeConfig.size.x;
-                                v->y = (float)otherPtr->puSectionConfig.computeConfig.size.y;
-                            } else if (v->glslType == uType::uTypeEnum::U_SAMPLER2D) {
-                                if (otherPtr->GetShaderKey() && !v->target.empty()) {
-                                    auto uni = otherPtr->GetShaderKey()->GetUniformByName(v->target);
-                                    if (uni) {
-                                        // vUniform->volume_ptr = uni->volume;
-                                        // vUniform->ownVolume = false;
-                                        if (uni->texture_ptr)
-                                            v->uSampler2D = uni->texture_ptr->getBack()->glTex;
-                                    }
+                } break;
+                case UniformUploadSourceEnum::UPLOAD_SOURCE_COMPUTE_OTHER: {
+                    if (otherPtr) {
+                        if (v->glslType == uType::uTypeEnum::U_VEC3) {
+                            v->x = (float)otherPtr->puSectionConfig.computeConfig.size.x;
+                            v->y = (float)otherPtr->puSectionConfig.computeConfig.size.y;
+                            v->z = (float)otherPtr->puSectionConfig.computeConfig.size.z;
+                        } else if (v->glslType == uType::uTypeEnum::U_VEC2) {
+                            v->x = (float)otherPtr->puSectionConfig.computeConfig.size.x;
+                            v->y = (float)otherPtr->puSectionConfig.computeConfig.size.y;
+                        } else if (v->glslType == uType::uTypeEnum::U_SAMPLER2D) {
+                            if (otherPtr->GetShaderKey() && !v->target.empty()) {
+                                auto uni = otherPtr->GetShaderKey()->GetUniformByName(v->target);
+                                if (uni) {
+                                    if (uni->texture_ptr)
+                                        v->uSampler2D = uni->texture_ptr->getBack()->glTex;
                                 }
-                            } else if (v->glslType == uType::uTypeEnum::U_SAMPLER3D) {
-                                if (otherPtr->GetShaderKey() && !v->target.empty()) {
-                                    auto uni = otherPtr->GetShaderKey()->GetUniformByName(v->target);
-                                    if (uni) {
-                                        // vUniform->volume_ptr = uni->volume;
-                                        // vUniform->ownVolume = false;
-                                        if (uni->volume_ptr)
-                                            v->uSampler3D = uni->volume_ptr->getBack()->glTex;
-                                    }
+                            }
+                        } else if (v->glslType == uType::uTypeEnum::U_SAMPLER3D) {
+                            if (otherPtr->GetShaderKey() && !v->target.empty()) {
+                                auto uni = otherPtr->GetShaderKey()->GetUniformByName(v->target);
+                                if (uni) {
+                                    if (uni->volume_ptr)
+                                        v->uSampler3D = uni->volume_ptr->getBack()->glTex;
                                 }
                             }
                         }
                     }
-                }
+                } break;
+                case UniformUploadSourceEnum::UPLOAD_SOURCE_VALUE:
+                default: break;
             }
 
-            textureSlotId = UniformHelper::UploadUniformForGlslType(puWindow, v, textureSlotId, isCompute);
-            textureSlotId = SoundSystem::Instance()->UploadUniformForGlslType(puWindow, v, textureSlotId, isCompute);
+            if (UniformUploadPlan::NeedUpload(entry)) {
+                textureSlotId = UniformHelper::UploadUniformForGlslType(puWindow, v, textureSlotId, isCompute);
+                if (entry.sound) {
+                    textureSlotId = SoundSystem::Instance()->UploadUniformForGlslType(puWindow, v, textureSlotId, isCompute);
+                }
+            }
         }
     }
 }
@@ -1855,6 +1840,52 @@ bool RenderPack::GetFBOValuesAtPixelPos(ct::ivec2 vPos, ct::fvec4* vArr, int vAt
     return res;
 }
 
+bool RenderPack::GetFBOValuesAtPixelPosAsync(ct::ivec2 vPos, ct::fvec4* vArr, int vAttachmentCount, bool vIfPosChanged) {
+    ZoneScoped;
+
+    bool res = false;
+
+    if (puFrameBuffer) {
+        if (vArr && !vPos.emptyAND()) {
+            // the requests can be on the front or the back buffer, since the pipe switch his buffers
+            if (!puFBOValuesReadBacks.empty()) {
+                UpdateAsyncReadBacks();
+
+                bool ready = true;
+                for (const auto& readBack : puFBOValuesReadBacks) {
+                    ready &= (readBack.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+                }
+
+                if (ready) {
+                    const int count = ct::mini<int>(vAttachmentCount, (int)puFBOValuesReadBacks.size());
+                    for (int i = 0; i < count; i++) {
+                        auto result = puFBOValuesReadBacks[i].get();
+                        if (result && result->isOk && result->bytes.size() >= sizeof(ct::fvec4)) {
+                            memcpy(&vArr[i], result->bytes.data(), sizeof(ct::fvec4));
+                        }
+                    }
+                    puFBOValuesReadBacks.clear();
+
+                    res = true;
+                }
+            }
+
+            if (puFBOValuesReadBacks.empty()) {
+                if (!vIfPosChanged || (vIfPosChanged && puLastFBOValuePosReadAsync != vPos)) {
+                    vAttachmentCount = ct::mini<int>(vAttachmentCount, puZeroBasedMaxSliceBufferId + 1);
+                    for (int i = 0; i < vAttachmentCount; i++) {
+                        puFBOValuesReadBacks.push_back(puFrameBuffer->getBackBuffer()->ReadRGBAValueAtPosAsync(vPos, i));
+                    }
+
+                    puLastFBOValuePosReadAsync = vPos;
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
 bool RenderPack::GetFBOValuesAtNormalizedPos(ct::fvec2 vPos, ct::fvec4* vArr, int vAttachmentCount, bool vIfPosChanged) {
     ZoneScoped;
 
@@ -1918,10 +1949,15 @@ void RenderPack::Finish(bool vSaveConfig) {
         }
     }
 
+    ShaderCompiler::Instance()->Cancel(m_PendingShaderCompileJob, puWindow);
+
     puShaderKey = nullptr;
 
     ClearBuffers(vSaveConfig);
 
+    // the pending async exports are given to the ImageExportSystem before the destruction of the fbos
+    FlushAsyncReadBacks();
+
     puModel_Render.reset();
     puShader.reset();
     puFrameBuffer.reset();
@@ -1939,8 +1975,6 @@ bool RenderPack::ParseAndCompilShader(const std::string& vInFileBufferName, cons
 
     TracyGpuZone("RenderPack::ParseAndCompilShader");
 
-    bool res = false;
-
     if (puShaderKey) {
         if (!vInFileBufferName.empty())
             puShaderKey->puInFileBufferName = vInFileBufferName;
@@ -1978,9 +2012,77 @@ bool RenderPack::ParseAndCompilShader(const std::string& vInFileBufferName, cons
             shaderName = pPath.name;
         }
 
+        // a newer compilation make the pending one obsolete
+        ShaderCompiler::Instance()->Cancel(m_PendingShaderCompileJob, puWindow);
+
+        // when a program is already there, we keep rendering it until the new one is compiled by the worker
+        if (puShader && window.win == puWindow.win && ShaderCompiler::Instance()->IsAsyncAvailable()) {
+            m_PendingShaderCompileJob = ShaderCompiler::Instance()->Submit(shaderName, isCompute, puLastShaderCode);
+            if (m_PendingShaderCompileJob) {
+                // erreurs ou pas on met a false, sinon le thread va valoir tester non stop
+                puNewCompilationNeeded = false;
+                return false;
+            }
+        }
+
         ShaderPtr newPossibleShader = Shader::Create(window, shaderName);
+        newPossibleShader->InitAndLinkShaderProgram(isCompute, puLastShaderCode, "", "4.3");
+
+        return FinalizeShaderCompilation(newPossibleShader);
+    }
+
+    // erreurs ou pas on met a false, sinon le thread va valoir tester non stop
+    puNewCompilationNeeded = false;
 
-        ProgramMsg shaderResultMsg = newPossibleShader->InitAndLinkShaderProgram(isCompute, puLastShaderCode, "", "4.3");
+    return false;
+}
+
+bool RenderPack::FinishAsyncShaderCompilation() {
+    if (m_PendingShaderCompileJob) {
+        auto newShader = ShaderCompiler::Instance()->TakeIfReady(m_PendingShaderCompileJob, puWindow);
+        if (newShader) {
+            GuiBackend::Instance()->MakeContextCurrent(puWindow);
+            return FinalizeShaderCompilation(newShader);
+        }
+    }
+
+    return false;
+}
+
+size_t RenderPack::UpdateAsyncReadBacks() {
+    size_t res = 0U;
+
+    if (puFrameBuffer) {
+        // the requests can be on the front or the back buffer, since the pipe switch his buffers
+        if (puFrameBuffer->getFrontBuffer()) {
+            res += puFrameBuffer->getFrontBuffer()->UpdateAsyncReadBacks();
+        }
+        if (puFrameBuffer->getBackBuffer()) {
+            res += puFrameBuffer->getBackBuffer()->UpdateAsyncReadBacks();
+        }
+    }
+
+    return res;
+}
+
+void RenderPack::FlushAsyncReadBacks() {
+    if (puFrameBuffer) {
+        if (puFrameBuffer->getFrontBuffer()) {
+            puFrameBuffer->getFrontBuffer()->FlushAsyncReadBacks();
+        }
+        if (puFrameBuffer->getBackBuffer()) {
+            puFrameBuffer->getBackBuffer()->FlushAsyncReadBacks();
+        }
+    }
+}
+
+bool RenderPack::FinalizeShaderCompilation(ShaderPtr vNewShader) {
+    TracyGpuZone("RenderPack::FinalizeShaderCompilation");
+
+    bool res = false;
+
+    if (puShaderKey && vNewShader) {
+        ShaderPtr newPossibleShader = vNewShader;
 
         puShaderKey->puSyntaxErrors.puParentKeyName = puShaderKey->puKey;
         puShaderKey->puSyntaxErrors.CompleteWithShader(puShaderKey, newPossibleShader);
@@ -2058,6 +2160,7 @@ bool RenderPack::ParseAndCompilShader(const std::string& vInFileBufferName, cons
 
             puShader.reset();
             puShader = newPossibleShader;
+            m_UniformUploadPlan.Invalidate();
             puLastCompiledShaderName = puCurrentShaderName;
             puShaderKey->LoadRenderPackConfig(CONFIG_TYPE_Enum::CONFIG_TYPE_UNIFORM);
             // puShaderKey->PrepareConfigsComboBox();
@@ -3488,6 +3591,7 @@ bool RenderPack::DrawDialogsAndPopups(ct::ivec2 vScreenSize) {
 
     MeshLoader::Instance()->ShowDialog(vScreenSize);
     MeshSaver::Instance()->ShowDialog(vScreenSize);
+    SoundSystem::Instance()->ShowDialog(vScreenSize);
 
     if (puShaderKey) {
         change |= puShaderKey->puParentCodeTree->DrawPopups(m_This);
@@ -3634,6 +3738,25 @@ bool RenderPack::SaveFBOToTga(const std::string& vFilePathName, bool vFlipY, int
     return false;
 }
 
+bool RenderPack::ExportFBOToFileAsync(const std::string& vFilePathName,
+                                      ImageExportFormatEnum vFormat,
+                                      bool vFlipY,
+                                      int vSubSamplesCount,
+                                      int vQualityFrom0To100,
+                                      ct::ivec2 vNewSize,
+                                      int vAttachmentId) {
+    ZoneScoped;
+
+    if (puFrameBuffer) {
+        if (vNewSize.emptyOR()) {
+            vNewSize = puFrameBuffer->size.xy();
+        }
+        return puFrameBuffer->getBackBuffer()->ExportToFileAsync(vFilePathName, vFormat, vFlipY, vSubSamplesCount, vQualityFrom0To100, vNewSize, vAttachmentId);
+    }
+
+    return false;
+}
+
 void RenderPack::InitCountPatchVertices() {
     ZoneScoped;
 
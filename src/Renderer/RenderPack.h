@@ -23,7 +23,10 @@
 #include <ctools/ConfigAbstract.h>
 #include <Buffer/ExportBuffer.h>
 #include <Buffer/FrameBuffersPipeLine.h>
+#include <Buffer/AsyncReadBack.h>
+#include <Systems/ImageExportSystem.h>
 #include <Renderer/CommandBuffer.h>
+#include <Uniforms/UniformUploadPlan.h>
 #include <Buffer/FloatBuffer.h>
 
 #include <Mesh/Gui/GuiModel.h>
@@ -38,6 +41,8 @@
 #include <atomic>
 #include <unordered_map>
 
+struct ShaderCompileJob;
+
 // #define CONFIG_MARK_START "[[["
 // #define CONFIG_MARK_END "]]]"
 
@@ -98,6 +103,8 @@ private:
     std::shared_ptr<RecordBuffer> puRecordBuffer = nullptr;
 
     CommandBuffer m_CommandBuffer;
+    UniformUploadPlan m_UniformUploadPlan;
+    std::shared_ptr<ShaderCompileJob> m_PendingShaderCompileJob = nullptr;
 
     RenderPack_Type puRenderPackType = RenderPack_Type::RENDERPACK_TYPE_BUFFER;
 
@@ -225,6 +232,8 @@ public:
     GLenum puBlendEquation = 0;
 
     ct::ivec2 puLastFBOValuePosRead;
+    ct::ivec2 puLastFBOValuePosReadAsync;
+    std::vector<std::future<ReadBackResultPtr>> puFBOValuesReadBacks;  // one per attachment, in flight
 
     uint32_t prCurrentIteration = 0U;
     uint32_t prCountIterations = 1U;
@@ -374,6 +383,9 @@ public:
 
     void UpdateSectionConfig(const std::string& vInFileBufferName = "");
     bool ParseAndCompilShader(const std::string& vInFileBufferName = "", const GuiBackend_Window& vWin = GuiBackend_Window());
+    bool FinishAsyncShaderCompilation();  // swap the program compiled by the ShaderCompiler worker if ready
+    size_t UpdateAsyncReadBacks();        // give the finished async reads of the fbos, each frame from RenderNode
+    void FlushAsyncReadBacks();           // wait and give all the pending async reads, before the fbos destruction
     bool UpdateShaderChanges(bool vForceUpdate, std::string vForceUpdateIfReplaceCodeKeyIsPresent = "");
 
     // Buffer
@@ -398,6 +410,15 @@ public:
     bool SaveFBOToHdr(const std::string& vFilePathName, bool vFlipY, int vSubSamplesCount, ct::ivec2 vNewSize, int vAttachmentId);
     bool SaveFBOToJpg(const std::string& vFilePathName, bool vFlipY, int vSubSamplesCount, int vQualityFrom0To100, ct::ivec2 vNewSize, int vAttachmentId);
     bool SaveFBOToTga(const std::string& vFilePathName, bool vFlipY, int vSubSamplesCount, ct::ivec2 vNewSize, int vAttachmentId);
+    // the rendering continue during the read back and the writing of the file
+    // the pixels go to the ImageExportSystem when the read back is finished, in UpdateAsyncReadBacks
+    bool ExportFBOToFileAsync(const std::string& vFilePathName,
+                              ImageExportFormatEnum vFormat,
+                              bool vFlipY,
+                              int vSubSamplesCount,
+                              int vQualityFrom0To100,
+                              ct::ivec2 vNewSize,
+                              int vAttachmentId);
 
     // tesselation
     void InitCountPatchVertices();
@@ -487,6 +508,8 @@ public:
     void Finish(bool vSaveConfig = true);
 
     bool GetFBOValuesAtPixelPos(ct::ivec2 vPos, ct::fvec4* vArr, int vAttachmentCount, bool vIfPosChanged = true);
+    // the values are read asynchronously, the function return true when the values of a previous request are put in vArr
+    bool GetFBOValuesAtPixelPosAsync(ct::ivec2 vPos, ct::fvec4* vArr, int vAttachmentCount, bool vIfPosChanged = true);
     bool GetFBOValuesAtNormalizedPos(ct::fvec2 vPos, ct::fvec4* vArr, int vAttachmentCount, bool vIfPosChanged = true);
 
     // bool GetFBOValuesUnderLineWithPos(ct::fvec2 vStartPos, ct::fvec2 vEndPos, ct::fvec4 *vArr, int vArrCount, int vAttachment);
@@ -498,6 +521,7 @@ public:
 
 private:
     void ReloadModelIfNeeded(bool vNeedUpdate);
+    bool FinalizeShaderCompilation(ShaderPtr vNewShader);
 
     bool InitComputeWithFile(const GuiBackend_Window& vWin, const std::string& vName, ct::ivec3 vSize, ShaderKeyPtr vShaderKey);
     bool InitBufferWithFile(const GuiBackend_Window& vWin,
@@ -18,6 +18,7 @@
 
 #include <Renderer/Shader.h>
 #include <Renderer/RenderPack.h>
+#include <Renderer/ShaderBinaryCache.h>
 #include <ctools/Logger.h>
 #include <ctools/GLVersionChecker.h>
 #include <Profiler/TracyProfiler.h>
@@ -52,6 +53,23 @@ ProgramMsg Shader::InitAndLinkShaderProgram(bool vIsCompute, ShaderParsedStruct
 
     // clear arrays
 
+    // try the program binary cache first
+    m_BinaryCacheKey = 0U;
+    if (ShaderBinaryCache::Instance()->IsAvailable()) {
+        m_BinaryCacheKey = ShaderBinaryCache::Instance()->ComputeKey(vIsCompute, shaderCode);
+        const GLuint program = ShaderBinaryCache::Instance()->LoadProgram(m_BinaryCacheKey);
+        if (program > 0) {
+            puuProgram = program;
+            linked = 1;
+            puError.clear();
+            puWarnings.clear();
+            puState.linkMsg = ShaderMsg::SHADER_MSG_OK;
+            LogToOutput(ShaderTypeEnum::LINK_SPECIAL_TYPE, "PROGRAM LOADED FROM BINARY CACHE => OK", false, ShaderMsg::SHADER_MSG_OK);
+            _isValid = true;
+            return puState;
+        }
+    }
+
     if (!vIsCompute) {
         // Load the vertex/fragment shaders
         const GLuint vertexShader = LoadFromString(ShaderTypeEnum::SHADER_TYPE_VERTEX, shaderCode.GetSection("VERTEX"), version);
@@ -154,6 +172,19 @@ ProgramMsg Shader::InitAndLinkShaderProgram(bool vIsCompute, ShaderParsedStruct
     if (!puWarnings[ShaderTypeEnum::SHADER_TYPE_COMPUTE].empty() && GLVersionChecker::Instance()->m_ComputeShaderSupported)
         puState.computeMsg = ShaderMsg::SHADER_MSG_WARNING;
 
+    // only the programs without errors and warnings are cached,
+    // so a program loaded from the cache give the same messages than a compilation from source
+    if (m_BinaryCacheKey && _isValid) {
+        bool someMessages = false;
+        for (const auto& err : puError)
+            someMessages |= !err.second.empty();
+        for (const auto& warn : puWarnings)
+            someMessages |= !warn.second.empty();
+        if (!someMessages) {
+            ShaderBinaryCache::Instance()->SaveProgram(m_BinaryCacheKey, puuProgram);
+        }
+    }
+
     return puState;
 }
 
@@ -339,6 +370,11 @@ ShaderMsg Shader::LinkShaderProgram() {
     if (!puuProgram)
         return ShaderMsg::SHADER_MSG_ERROR;
 
+    if (m_BinaryCacheKey) {
+        glProgramParameteri(puuProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        LogGlError();
+    }
+
     // Link the program
     glLinkProgram(puuProgram);
     LogGlError();
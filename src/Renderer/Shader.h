@@ -39,6 +39,7 @@ private:
     GLenum err = 0;
     bool _isValid = false;
     GuiBackend_Window puWindow;
+    uint64_t m_BinaryCacheKey = 0U;  // 0 if the binary cache is not used
 
 public:
     GLuint puuProgram = 0;
@@ -53,6 +54,11 @@ public:
 
     bool IsValid();
 
+    // for give the shader compiled on an other shared context to the render context
+    void SetWindow(const GuiBackend_Window& vWin) {
+        puWindow = vWin;
+    }
+
     ProgramMsg InitAndLinkShaderProgram(bool vIsCompute, ShaderParsedStruct shaderCode, std::string geomLayoutParams, std::string version);
     ShaderMsg LinkShaderProgram();
 
@@ -0,0 +1,326 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "ShaderBinaryCache.h"
+
+#include <ctools/cTools.h>
+#include <ctools/Logger.h>
+#include <ctools/FileHelper.h>
+#include <Headers/RenderPackHeaders.h>
+#include <Profiler/TracyProfiler.h>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#define SHADER_BINARY_CACHE_MAGIC 0x42504753U  // SGPB
+#define SHADER_BINARY_CACHE_VERSION 1U
+#define SHADER_BINARY_CACHE_EXT ".glbin"
+
+struct ShaderBinaryCacheHeader {
+    uint32_t magic = SHADER_BINARY_CACHE_MAGIC;
+    uint32_t version = SHADER_BINARY_CACHE_VERSION;
+    uint64_t key = 0U;
+    uint32_t binaryFormat = 0U;
+    uint32_t binarySize = 0U;
+};
+
+// fnv-1a 64
+static inline uint64_t ShaderBinaryCache_Hash(uint64_t vHash, const std::string& vStr) {
+    for (const auto& c : vStr) {
+        vHash ^= (uint64_t)(uint8_t)c;
+        vHash *= 1099511628211ULL;
+    }
+    // separator, for not have the same hash for "ab"+"c" and "a"+"bc"
+    vHash ^= 0xFFULL;
+    vHash *= 1099511628211ULL;
+    return vHash;
+}
+
+static inline int64_t ShaderBinaryCache_Now() {
+    return (int64_t)std::filesystem::file_time_type::clock::now().time_since_epoch().count();
+}
+
+void ShaderBinaryCache::SetCacheDirectory(const std::string& vDirectory) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_CacheDirectory = vDirectory;
+    m_Initialized = false;
+}
+
+void ShaderBinaryCache::SetMaxSize(uint64_t vMaxSizeInBytes) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_MaxSize = vMaxSizeInBytes;
+    if (m_Initialized) {
+        Evict();
+    }
+}
+
+void ShaderBinaryCache::SetEnabled(bool vEnabled) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Enabled = vEnabled;
+}
+
+bool ShaderBinaryCache::IsAvailable() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_Enabled)
+        return false;
+    if (!m_Initialized)
+        Init();
+    return m_Supported;
+}
+
+uint64_t ShaderBinaryCache::ComputeKey(bool vIsCompute, ShaderParsedStruct& vShaderCode) {
+    ZoneScoped;
+
+    std::string driverSignature;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        driverSignature = m_DriverSignature;
+    }
+
+    uint64_t hash = 14695981039346656037ULL;
+
+    hash = ShaderBinaryCache_Hash(hash, driverSignature);
+    hash = ShaderBinaryCache_Hash(hash, vIsCompute ? "COMPUTE_PROGRAM" : "GRAPHIC_PROGRAM");
+
+    // the stage set is given by the non empty stages
+    static const char* s_Stages[] = {"VERTEX", "GEOMETRY", "TESSCONTROL", "TESSEVAL", "FRAGMENT", "COMPUTE"};
+    for (const auto& stage : s_Stages) {
+        const auto code = vShaderCode.GetSection(stage).GetCode();
+        if (!code.empty()) {
+            hash = ShaderBinaryCache_Hash(hash, stage);
+            hash = ShaderBinaryCache_Hash(hash, code);
+        }
+    }
+
+    if (hash == 0U)
+        hash = 1U;
+
+    return hash;
+}
+
+GLuint ShaderBinaryCache::LoadProgram(uint64_t vKey) {
+    ZoneScoped;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (!m_Supported || !vKey)
+        return 0;
+
+    auto it = m_Files.find(vKey);
+    if (it == m_Files.end())
+        return 0;
+
+    const auto filePathName = GetFilePathName(vKey);
+
+    ShaderBinaryCacheHeader header;
+    std::vector<uint8_t> binary;
+
+    std::ifstream fileReader(filePathName, std::ios::in | std::ios::binary);
+    if (fileReader.is_open()) {
+        fileReader.read((char*)&header, sizeof(ShaderBinaryCacheHeader));
+        if (fileReader.good() &&                                   //
+            header.magic == SHADER_BINARY_CACHE_MAGIC &&           //
+            header.version == SHADER_BINARY_CACHE_VERSION &&       //
+            header.key == vKey && header.binarySize > 0U) {
+            binary.resize(header.binarySize);
+            fileReader.read((char*)binary.data(), header.binarySize);
+            if (!fileReader.good()) {
+                binary.clear();
+            }
+        }
+        fileReader.close();
+    }
+
+    GLuint program = 0;
+
+    if (!binary.empty()) {
+        program = glCreateProgram();
+        LogGlError();
+
+        glProgramBinary(program, (GLenum)header.binaryFormat, binary.data(), (GLsizei)binary.size());
+        // no LogGlError here, GL_INVALID_ENUM is expected if the format is not supported anymore
+        glGetError();
+
+        GLint linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        LogGlError();
+
+        if (!linked) {
+            glDeleteProgram(program);
+            LogGlError();
+            program = 0;
+        }
+    }
+
+    std::error_code ec;
+    if (program) {
+        it->second.lastAccess = ShaderBinaryCache_Now();
+        std::filesystem::last_write_time(filePathName, std::filesystem::file_time_type(std::filesystem::file_time_type::duration(it->second.lastAccess)), ec);
+    } else {
+        // rejected by the driver or corrupted, the caller will compile from source and save a new one
+        LogVarDebugInfo("Shader binary cache : binary %s rejected, fallback to source compilation", filePathName.c_str());
+        std::filesystem::remove(filePathName, ec);
+        m_TotalSize -= it->second.size;
+        m_Files.erase(it);
+    }
+
+    return program;
+}
+
+bool ShaderBinaryCache::SaveProgram(uint64_t vKey, GLuint vProgram) {
+    ZoneScoped;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (!m_Supported || !vKey || !vProgram)
+        return false;
+
+    GLint binarySize = 0;
+    glGetProgramiv(vProgram, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+    LogGlError();
+
+    if (binarySize <= 0)
+        return false;
+
+    ShaderBinaryCacheHeader header;
+    header.key = vKey;
+
+    std::vector<uint8_t> binary(binarySize);
+    GLsizei writtenSize = 0;
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(vProgram, binarySize, &writtenSize, &binaryFormat, binary.data());
+    LogGlError();
+
+    if (writtenSize <= 0)
+        return false;
+
+    header.binaryFormat = (uint32_t)binaryFormat;
+    header.binarySize = (uint32_t)writtenSize;
+
+    const auto filePathName = GetFilePathName(vKey);
+    std::ofstream fileWriter(filePathName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (fileWriter.is_open()) {
+        fileWriter.write((const char*)&header, sizeof(ShaderBinaryCacheHeader));
+        fileWriter.write((const char*)binary.data(), header.binarySize);
+        const bool ok = fileWriter.good();
+        fileWriter.close();
+
+        if (ok) {
+            auto& file = m_Files[vKey];
+            m_TotalSize -= file.size;
+            file.size = sizeof(ShaderBinaryCacheHeader) + header.binarySize;
+            file.lastAccess = ShaderBinaryCache_Now();
+            m_TotalSize += file.size;
+            Evict();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ShaderBinaryCache::Clear() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::error_code ec;
+    for (const auto& file : m_Files) {
+        std::filesystem::remove(GetFilePathName(file.first), ec);
+    }
+    m_Files.clear();
+    m_TotalSize = 0U;
+}
+
+void ShaderBinaryCache::Init() {
+    ZoneScoped;
+
+    m_Initialized = true;
+    m_Supported = false;
+    m_Files.clear();
+    m_TotalSize = 0U;
+
+    GLint countFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &countFormats);
+    LogGlError();
+
+    if (countFormats <= 0) {
+        LogVarDebugInfo("Shader binary cache : no program binary format supported by the driver, cache disabled");
+        return;
+    }
+
+    // the signature of the driver is part of the key, a driver update will invalidate the cache
+    const auto vendor = (const char*)glGetString(GL_VENDOR);
+    const auto renderer = (const char*)glGetString(GL_RENDERER);
+    const auto version = (const char*)glGetString(GL_VERSION);
+    m_DriverSignature.clear();
+    if (vendor)
+        m_DriverSignature += vendor;
+    m_DriverSignature += "|";
+    if (renderer)
+        m_DriverSignature += renderer;
+    m_DriverSignature += "|";
+    if (version)
+        m_DriverSignature += version;
+
+    if (m_CacheDirectory.empty()) {
+        m_CacheDirectory = FileHelper::Instance()->GetAbsolutePathForFileLocation("shader_cache", (int)FILE_LOCATION_Enum::FILE_LOCATION_CONF);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_CacheDirectory, ec);
+    if (!std::filesystem::is_directory(m_CacheDirectory, ec)) {
+        LogVarError("Shader binary cache : cant create the directory %s, cache disabled", m_CacheDirectory.c_str());
+        return;
+    }
+
+    for (const auto& file : std::filesystem::directory_iterator(m_CacheDirectory, ec)) {
+        if (file.is_regular_file(ec) && file.path().extension().string() == SHADER_BINARY_CACHE_EXT) {
+            const auto key = (uint64_t)std::strtoull(file.path().stem().string().c_str(), nullptr, 16);
+            if (key) {
+                auto& entry = m_Files[key];
+                entry.size = (uint64_t)file.file_size(ec);
+                entry.lastAccess = (int64_t)file.last_write_time(ec).time_since_epoch().count();
+                m_TotalSize += entry.size;
+            }
+        }
+    }
+
+    m_Supported = true;
+
+    Evict();
+}
+
+void ShaderBinaryCache::Evict() {
+    std::error_code ec;
+    while (m_TotalSize > m_MaxSize && !m_Files.empty()) {
+        auto oldest = m_Files.begin();
+        for (auto it = m_Files.begin(); it != m_Files.end(); ++it) {
+            if (it->second.lastAccess < oldest->second.lastAccess) {
+                oldest = it;
+            }
+        }
+        std::filesystem::remove(GetFilePathName(oldest->first), ec);
+        m_TotalSize -= oldest->second.size;
+        m_Files.erase(oldest);
+    }
+}
+
+std::string ShaderBinaryCache::GetFilePathName(uint64_t vKey) const {
+    char buffer[32] = {};
+    snprintf(buffer, 32, "%016llx", (unsigned long long)vKey);
+    return (std::filesystem::path(m_CacheDirectory) / (std::string(buffer) + SHADER_BINARY_CACHE_EXT)).string();
+}
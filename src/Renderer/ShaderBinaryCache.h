@@ -0,0 +1,87 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <glad/glad.h>
+#include <CodeTree/Parsing/SectionCode.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+// on disk cache of linked programs (glGetProgramBinary / glProgramBinary)
+// a program is keyed by the hash of the final code of each stage + the GL vendor/renderer/version strings
+// if the driver reject a binary (driver update, etc..), the file is removed and the caller must compile from source
+class ShaderBinaryCache {
+private:
+    struct CacheFileStruct {
+        uint64_t size = 0U;
+        int64_t lastAccess = 0;  // used for the LRU eviction
+    };
+
+private:
+    std::mutex m_Mutex;
+    std::string m_CacheDirectory;
+    std::string m_DriverSignature;
+    std::map<uint64_t, CacheFileStruct> m_Files;
+    uint64_t m_TotalSize = 0U;
+    uint64_t m_MaxSize = 256U * 1024U * 1024U;  // 256 MB
+    int64_t m_AccessCounter = 0;
+    bool m_Enabled = true;
+    bool m_Initialized = false;
+    bool m_Supported = false;
+
+public:
+    static ShaderBinaryCache* Instance() {
+        static ShaderBinaryCache _instance;
+        return &_instance;
+    }
+
+protected:
+    ShaderBinaryCache() = default;                                     // Prevent construction
+    ShaderBinaryCache(const ShaderBinaryCache&) = default;             // Prevent construction by copying
+    ShaderBinaryCache& operator=(const ShaderBinaryCache&) {
+        return *this;
+    };                                // Prevent assignment
+    ~ShaderBinaryCache() = default;  // Prevent unwanted destruction
+
+public:
+    // must be called before the first compilation for use a custom directory
+    // if not called, the cache is created in the conf directory
+    void SetCacheDirectory(const std::string& vDirectory);
+    void SetMaxSize(uint64_t vMaxSizeInBytes);
+    void SetEnabled(bool vEnabled);
+
+    // need a current GL context
+    bool IsAvailable();
+
+    // 0 is an invalid key
+    uint64_t ComputeKey(bool vIsCompute, ShaderParsedStruct& vShaderCode);
+
+    // return a linked program or 0 if not found / rejected by the driver
+    GLuint LoadProgram(uint64_t vKey);
+
+    // the program must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    bool SaveProgram(uint64_t vKey, GLuint vProgram);
+
+    void Clear();
+
+private:
+    void Init();
+    void Evict();
+    std::string GetFilePathName(uint64_t vKey) const;
+};
@@ -0,0 +1,167 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "ShaderCompiler.h"
+
+#include <Renderer/Shader.h>
+#include <ctools/Logger.h>
+#include <Profiler/TracyProfiler.h>
+
+ShaderCompiler::ShaderCompiler(const GuiBackend_Window& vRootWindow) {
+    if (vRootWindow.win) {
+        puShaderCompilerThread = GuiBackend::Instance()->CreateGuiBackendWindow_Hidden(1, 1, "ShaderCompiler", vRootWindow);
+        // the creation of the hidden window change the current context
+        GuiBackend::MakeContextCurrent(vRootWindow);
+    } else {
+        puShaderCompilerThread = GuiBackend_Window();
+    }
+
+    if (puShaderCompilerThread.win) {
+        StartWorkerThread();
+    }
+}
+
+ShaderCompiler::~ShaderCompiler() {
+    StopWorkerThread();
+}
+
+bool ShaderCompiler::IsAsyncAvailable() {
+    return m_AsyncMode && m_Working && puShaderCompilerThread.win;
+}
+
+void ShaderCompiler::SetAsyncMode(bool vAsyncMode) {
+    m_AsyncMode = vAsyncMode;
+}
+
+ShaderCompileJobPtr ShaderCompiler::Submit(const std::string& vShaderName, bool vIsCompute, const ShaderParsedStruct& vShaderCode) {
+    ZoneScoped;
+
+    if (!IsAsyncAvailable())
+        return nullptr;
+
+    auto job = std::make_shared<ShaderCompileJob>();
+    job->shader = Shader::Create(puShaderCompilerThread, vShaderName);
+    job->isCompute = vIsCompute;
+    job->code = vShaderCode;
+
+    {
+        std::lock_guard<std::mutex> lock(m_JobsMutex);
+        m_Jobs.push_back(job);
+    }
+    m_JobsCondition.notify_one();
+
+    return job;
+}
+
+ShaderPtr ShaderCompiler::TakeIfReady(ShaderCompileJobPtr& vJob, const GuiBackend_Window& vWin) {
+    ShaderPtr res = nullptr;
+
+    if (vJob && vJob->state == ShaderCompileJobStateEnum::COMPILE_JOB_READY) {
+        res = std::move(vJob->shader);
+        vJob.reset();
+        if (res) {
+            // from now the shader is used by the render thread
+            res->SetWindow(vWin);
+        }
+    }
+
+    return res;
+}
+
+void ShaderCompiler::Cancel(ShaderCompileJobPtr& vJob, const GuiBackend_Window& vWin) {
+    if (vJob) {
+        auto expected = ShaderCompileJobStateEnum::COMPILE_JOB_PENDING;
+        if (!vJob->state.compare_exchange_strong(expected, ShaderCompileJobStateEnum::COMPILE_JOB_CANCELED)) {
+            // already ready, so the worker will not touch it anymore, we destroy it on the render context
+            auto shader = std::move(vJob->shader);
+            if (shader) {
+                shader->SetWindow(vWin);
+            }
+        }
+        vJob.reset();
+    }
+}
+
+void ShaderCompiler::StartWorkerThread() {
+    if (!puWorkerThread.joinable()) {
+        m_Working = true;
+        puWorkerThread = std::thread(&ShaderCompiler::WorkerLoop, this);
+    }
+}
+
+void ShaderCompiler::StopWorkerThread() {
+    if (puWorkerThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_JobsMutex);
+            m_Working = false;
+        }
+        m_JobsCondition.notify_all();
+        puWorkerThread.join();
+    }
+}
+
+void ShaderCompiler::WorkerLoop() {
+    GuiBackend::MakeContextCurrent(puShaderCompilerThread);
+
+#ifdef GL_KHR_parallel_shader_compile
+    // let the driver use its own threads for compile the stages
+    if (GLAD_GL_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        LogGlError();
+    }
+#endif
+
+    while (m_Working) {
+        ShaderCompileJobPtr job = nullptr;
+
+        {
+            std::unique_lock<std::mutex> lock(m_JobsMutex);
+            m_JobsCondition.wait(lock, [this]() { return !m_Jobs.empty() || !m_Working; });
+            if (!m_Working)
+                break;
+            job = m_Jobs.front();
+            m_Jobs.pop_front();
+        }
+
+        if (job->state == ShaderCompileJobStateEnum::COMPILE_JOB_CANCELED) {
+            job->shader.reset();  // destroyed on the worker context
+            continue;
+        }
+
+        job->msg = job->shader->InitAndLinkShaderProgram(job->isCompute, job->code, "", "4.3");
+
+        // the program must be complete before beeing used by an other context
+        glFinish();
+
+        auto expected = ShaderCompileJobStateEnum::COMPILE_JOB_PENDING;
+        if (!job->state.compare_exchange_strong(expected, ShaderCompileJobStateEnum::COMPILE_JOB_READY)) {
+            job->shader.reset();  // canceled during the compilation
+        }
+    }
+
+    // the remaining jobs are destroyed on the worker context
+    {
+        std::lock_guard<std::mutex> lock(m_JobsMutex);
+        for (auto& job : m_Jobs) {
+            job->shader.reset();
+        }
+        m_Jobs.clear();
+    }
+
+    GuiBackend::MakeContextCurrent(GuiBackend_Window());
+}
@@ -0,0 +1,89 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <Headers/RenderPackHeaders.h>
+#include <CodeTree/Parsing/SectionCode.h>
+
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <list>
+
+enum class ShaderCompileJobStateEnum : int { COMPILE_JOB_PENDING = 0, COMPILE_JOB_READY, COMPILE_JOB_CANCELED };
+
+// a program compiled and linked by the worker
+// the shader is owned by the worker context until the job is ready
+struct ShaderCompileJob {
+    ShaderPtr shader = nullptr;
+    bool isCompute = false;
+    ShaderParsedStruct code;
+    ProgramMsg msg;
+    std::atomic<ShaderCompileJobStateEnum> state{ShaderCompileJobStateEnum::COMPILE_JOB_PENDING};
+};
+typedef std::shared_ptr<ShaderCompileJob> ShaderCompileJobPtr;
+
+// compile and link the programs off-thread on an hidden context shared with the root window
+// the renderpacks keep rendering the old program and swap when the job is ready
+class ShaderCompiler {
+public:
+    GuiBackend_Window puShaderCompilerThread;
+
+private:
+    std::thread puWorkerThread;
+    std::mutex m_JobsMutex;
+    std::condition_variable m_JobsCondition;
+    std::list<ShaderCompileJobPtr> m_Jobs;
+    std::atomic<bool> m_Working{false};
+    bool m_AsyncMode = true;
+
+public:
+    // true if the worker context exist and the async mode is enabled
+    bool IsAsyncAvailable();
+    void SetAsyncMode(bool vAsyncMode);
+
+    // the shader is created on the worker context
+    ShaderCompileJobPtr Submit(const std::string& vShaderName, bool vIsCompute, const ShaderParsedStruct& vShaderCode);
+
+    // return the shader of the job if ready, rebased on vWin, or nullptr if not ready
+    // the job is released after that
+    ShaderPtr TakeIfReady(ShaderCompileJobPtr& vJob, const GuiBackend_Window& vWin);
+
+    // the worker will destroy the shader on its own context
+    void Cancel(ShaderCompileJobPtr& vJob, const GuiBackend_Window& vWin);
+
+private:
+    void StartWorkerThread();
+    void StopWorkerThread();
+    void WorkerLoop();
+
+public:
+    static ShaderCompiler* Instance(const GuiBackend_Window& vRootWindow = GuiBackend_Window()) {
+        static ShaderCompiler _instance(vRootWindow);
+        return &_instance;
+    }
+
+protected:
+    ShaderCompiler(const GuiBackend_Window& vRootWindow);  // Prevent construction
+    ShaderCompiler(const ShaderCompiler&){};               // Prevent construction by copying
+    ShaderCompiler& operator=(const ShaderCompiler&) {
+        return *this;
+    };                  // Prevent assignment
+    ~ShaderCompiler();  // Prevent unwanted destruction
+};
@@ -0,0 +1,363 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "FFTAnalyzer.h"
+
+#include <ctools/cTools.h>
+#include <Profiler/TracyProfiler.h>
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FFT_ANALYZER_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+#define FFT_ANALYZER_MIN_HOP_SIZE 32U
+
+// https://webaudio.github.io/web-audio-api/#current-time-domain-data
+double FFTAnalyzer::BlackmanWindow(const size_t& n, const size_t& vSize) {
+    const double N_coef = 1.0 / (double)(vSize - 1U);  // Longueur du filtre
+    static const double& pi = 3.14159265358979323846;
+    static const double& a = 0.16;
+    static const double& a0 = (1.0 - a) * 0.5;
+    static const double& a1 = 0.5;
+    static const double& a2 = a * 0.5;
+    return a0 - a1 * cos(2.0 * pi * n * N_coef) + a2 * cos(4.0 * pi * n * N_coef);
+}
+
+bool FFTAnalyzer::IsValidFFTSize(const size_t& vFFTSize) {
+    return vFFTSize >= scMinFFTSize && vFFTSize <= scMaxFFTSize && (vFFTSize & (vFFTSize - 1U)) == 0U;
+}
+
+FFTAnalyzer::FFTAnalyzer() = default;
+
+FFTAnalyzer::~FFTAnalyzer() {
+    Unit();
+}
+
+bool FFTAnalyzer::Init(const size_t& vFFTSize, const size_t& vHopSize) {
+    if (!IsValidFFTSize(vFFTSize))
+        return false;
+
+    Unit();
+
+    m_FFTSize = vFFTSize;
+    m_HopSize = ct::clamp<size_t>(vHopSize, FFT_ANALYZER_MIN_HOP_SIZE, m_FFTSize);
+    m_FFTConfig = kiss_fftr_alloc((int)m_FFTSize, 0, nullptr, nullptr);
+    if (!m_FFTConfig)
+        return false;
+
+    const size_t countBins = m_FFTSize / 2U;
+    m_History.resize(m_FFTSize * 2U);
+    m_FFTInput.resize(m_FFTSize);
+    m_FFTOutput.resize(countBins + 1U);  // N / 2 + 1
+    m_Magnitudes.resize(countBins);
+    m_AverageSums.resize(countBins);
+    m_Smoothed.resize(countBins);
+    m_Output.resize(countBins);
+
+    Reset();
+
+    return true;
+}
+
+void FFTAnalyzer::Unit() {
+    if (m_FFTConfig) {
+        kiss_fft_free(m_FFTConfig);
+        m_FFTConfig = nullptr;
+    }
+}
+
+void FFTAnalyzer::Reset() {
+    std::fill(m_History.begin(), m_History.end(), 0.0f);
+    m_HistoryPos = 0U;
+    m_CountSamplesSinceLastFFT = 0U;
+    std::fill(m_Magnitudes.begin(), m_Magnitudes.end(), 0.0f);
+    std::fill(m_Output.begin(), m_Output.end(), 0.0f);
+    ResetSmoothing();
+}
+
+void FFTAnalyzer::Reset(const uint64_t& vCountSamples, const uint64_t& vCountFFTs) {
+    Reset();
+    m_HistoryPos = (size_t)(vCountSamples & (uint64_t)(m_FFTSize - 1U));
+    m_CountSamplesSinceLastFFT = (size_t)(vCountSamples % (uint64_t)m_HopSize);
+    m_AverageLastIndex = (size_t)(vCountFFTs % (uint64_t)m_AverageSize);
+}
+
+size_t FFTAnalyzer::PushSamples(const float* vSamples, const size_t& vCount) {
+    ZoneScoped;
+
+    if (!m_FFTConfig || !vSamples || !vCount)
+        return 0U;
+
+    // if the caller was late, the oldest hops are only added to the history
+    const size_t countHops = (m_CountSamplesSinceLastFFT + vCount) / m_HopSize;
+    size_t countHopsToSkip = (countHops > scMaxFFTsByPush) ? (countHops - scMaxFFTsByPush) : 0U;
+
+    size_t countFFTs = 0U;
+    size_t sampleIndex = 0U;
+    while (sampleIndex < vCount) {
+        size_t countToWrite = std::min(vCount - sampleIndex, m_HopSize - m_CountSamplesSinceLastFFT);
+        sampleIndex += countToWrite;
+        m_CountSamplesSinceLastFFT += countToWrite;
+
+        const float* src = vSamples + sampleIndex - countToWrite;
+        while (countToWrite) {
+            const size_t count = std::min(countToWrite, m_FFTSize - m_HistoryPos);
+            memcpy(m_History.data() + m_HistoryPos, src, sizeof(float) * count);
+            memcpy(m_History.data() + m_HistoryPos + m_FFTSize, src, sizeof(float) * count);
+            m_HistoryPos = (m_HistoryPos + count) & (m_FFTSize - 1U);
+            src += count;
+            countToWrite -= count;
+        }
+
+        if (m_CountSamplesSinceLastFFT == m_HopSize) {
+            m_CountSamplesSinceLastFFT = 0U;
+            if (countHopsToSkip) {
+                --countHopsToSkip;
+            } else {
+                ComputeFFT();
+                ++countFFTs;
+            }
+        }
+    }
+
+    return countFFTs;
+}
+
+const float* FFTAnalyzer::GetSpectrum() const {
+    return m_LogScale ? m_Output.data() : m_Smoothed.data();
+}
+
+size_t FFTAnalyzer::GetCountBins() const {
+    return m_Smoothed.size();
+}
+
+void FFTAnalyzer::CopyBins(float* vDst, const size_t& vCountBins) const {
+    if (vDst) {
+        const size_t count = std::min(vCountBins, GetCountBins());
+        if (count) {
+            memcpy(vDst, GetSpectrum(), sizeof(float) * count);
+        }
+        if (count < vCountBins) {
+            memset(vDst + count, 0, sizeof(float) * (vCountBins - count));
+        }
+    }
+}
+
+bool FFTAnalyzer::SetFFTSize(const size_t& vFFTSize) {
+    if (vFFTSize == m_FFTSize && m_FFTConfig)
+        return true;
+    return Init(vFFTSize, m_HopSize);
+}
+
+size_t FFTAnalyzer::GetFFTSize() const {
+    return m_FFTSize;
+}
+
+void FFTAnalyzer::SetHopSize(const size_t& vHopSize) {
+    m_HopSize = ct::clamp<size_t>(vHopSize, FFT_ANALYZER_MIN_HOP_SIZE, m_FFTSize);
+    m_CountSamplesSinceLastFFT = std::min(m_CountSamplesSinceLastFFT, m_HopSize - 1U);
+}
+
+size_t FFTAnalyzer::GetHopSize() const {
+    return m_HopSize;
+}
+
+void FFTAnalyzer::SetSmoothingMode(const FFTSmoothingModeEnum& vMode) {
+    if (vMode < FFTSmoothingModeEnum::FFT_SMOOTHING_Count && vMode != m_SmoothingMode) {
+        m_SmoothingMode = vMode;
+        ResetSmoothing();
+    }
+}
+
+FFTSmoothingModeEnum FFTAnalyzer::GetSmoothingMode() const {
+    return m_SmoothingMode;
+}
+
+void FFTAnalyzer::SetAverageSize(const size_t& vAverageSize) {
+    const auto averageSize = ct::clamp<size_t>(vAverageSize, 1U, scMaxAverageSize);
+    if (averageSize != m_AverageSize) {
+        m_AverageSize = averageSize;
+        ResetSmoothing();
+    }
+}
+
+size_t FFTAnalyzer::GetAverageSize() const {
+    return m_AverageSize;
+}
+
+void FFTAnalyzer::SetSmoothingFactor(const float& vFactor) {
+    m_SmoothingFactor = ct::clamp(vFactor, 0.0f, 0.99f);
+}
+
+float FFTAnalyzer::GetSmoothingFactor() const {
+    return m_SmoothingFactor;
+}
+
+void FFTAnalyzer::SetLogScale(const bool& vLogScale, const float& vMinDecibels, const float& vMaxDecibels) {
+    m_LogScale = vLogScale;
+    m_MinDecibels = vMinDecibels;
+    m_MaxDecibels = ct::maxi(vMaxDecibels, vMinDecibels + 1.0f);
+    if (m_LogScale) {
+        ComputeLogScale();
+    }
+}
+
+bool FFTAnalyzer::IsLogScale() const {
+    return m_LogScale;
+}
+
+float FFTAnalyzer::GetMinDecibels() const {
+    return m_MinDecibels;
+}
+
+float FFTAnalyzer::GetMaxDecibels() const {
+    return m_MaxDecibels;
+}
+
+void FFTAnalyzer::SetAmplification(const float& vAmplification) {
+    m_Amplification = vAmplification;
+}
+
+float FFTAnalyzer::GetAmplification() const {
+    return m_Amplification;
+}
+
+const std::vector<float>& FFTAnalyzer::GetWindowTable(const size_t& vSize) {
+    auto& table = m_WindowTables[vSize];
+    if (table.size() != vSize) {
+        table.resize(vSize);
+        for (size_t i = 0U; i < vSize; ++i) {
+            table[i] = (float)BlackmanWindow(i, vSize);
+        }
+    }
+    return table;
+}
+
+void FFTAnalyzer::ComputeFFT() {
+    ZoneScoped;
+
+    // the oldest sample of the history is at m_HistoryPos
+    const float* src = m_History.data() + m_HistoryPos;
+    const float* window = GetWindowTable(m_FFTSize).data();
+    const float amplification = m_Amplification;
+    for (size_t i = 0U; i < m_FFTSize; ++i) {
+        m_FFTInput[i] = src[i] * amplification * window[i];
+    }
+
+    kiss_fftr(m_FFTConfig, m_FFTInput.data(), m_FFTOutput.data());
+
+    ComputeMagnitudes();
+    Smooth();
+    if (m_LogScale) {
+        ComputeLogScale();
+    }
+}
+
+void FFTAnalyzer::ComputeMagnitudes() {
+    const size_t countBins = m_Magnitudes.size();
+    const float scaling = 1.0f / (float)countBins;
+    float* dst = m_Magnitudes.data();
+
+    size_t i = 0U;
+#ifdef FFT_ANALYZER_USE_SSE
+    static_assert(sizeof(kiss_fft_cpx) == sizeof(float) * 2U, "kiss_fft_scalar must be a float");
+    // 4 bins by loop, the complexs are r, i, r, i..
+    const float* src = (const float*)m_FFTOutput.data();
+    const __m128 scaling4 = _mm_set1_ps(scaling);
+    for (; i + 4U <= countBins; i += 4U) {
+        const __m128 a = _mm_loadu_ps(src + i * 2U);
+        const __m128 b = _mm_loadu_ps(src + i * 2U + 4U);
+        const __m128 a2 = _mm_mul_ps(a, a);
+        const __m128 b2 = _mm_mul_ps(b, b);
+        const __m128 re2 = _mm_shuffle_ps(a2, b2, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 im2 = _mm_shuffle_ps(a2, b2, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(re2, im2)), scaling4));
+    }
+#endif
+    for (; i < countBins; ++i) {
+        const auto& v = m_FFTOutput[i];
+        dst[i] = sqrtf((float)(v.r * v.r + v.i * v.i)) * scaling;
+    }
+}
+
+void FFTAnalyzer::Smooth() {
+    const size_t countBins = m_Magnitudes.size();
+    const float* mag = m_Magnitudes.data();
+    float* smoothed = m_Smoothed.data();
+
+    if (m_SmoothingMode == FFTSmoothingModeEnum::FFT_SMOOTHING_EXPONENTIAL) {
+        const float k = m_SmoothingFactor;
+        const float ik = 1.0f - k;
+        for (size_t i = 0U; i < countBins; ++i) {
+            smoothed[i] = smoothed[i] * k + mag[i] * ik;
+        }
+    } else {
+        // the oldest spectrum is replaced, the sum is updated with the difference
+        float* sums = m_AverageSums.data();
+        float* oldest = m_AverageDatas.data() + m_AverageLastIndex * countBins;
+        for (size_t i = 0U; i < countBins; ++i) {
+            sums[i] += mag[i] - oldest[i];
+            oldest[i] = mag[i];
+        }
+
+        m_AverageLastIndex = (m_AverageLastIndex + 1U) % m_AverageSize;
+
+        // one time by turn, the sum is done again, so the float errors are not accumulated
+        if (m_AverageLastIndex == 0U) {
+            memcpy(sums, m_AverageDatas.data(), sizeof(float) * countBins);
+            for (size_t j = 1U; j < m_AverageSize; ++j) {
+                const float* spectrum = m_AverageDatas.data() + j * countBins;
+                for (size_t i = 0U; i < countBins; ++i) {
+                    sums[i] += spectrum[i];
+                }
+            }
+        }
+
+        const float invCount = 1.0f / (float)m_AverageSize;
+        for (size_t i = 0U; i < countBins; ++i) {
+            smoothed[i] = sums[i] * invCount;
+        }
+    }
+}
+
+void FFTAnalyzer::ComputeLogScale() {
+    // like getFloatFrequencyData then getByteFrequencyData of web audio, but in [0:1]
+    const size_t countBins = m_Smoothed.size();
+    const float* smoothed = m_Smoothed.data();
+    float* dst = m_Output.data();
+    const float minDb = m_MinDecibels;
+    const float invRange = 1.0f / (m_MaxDecibels - m_MinDecibels);
+    for (size_t i = 0U; i < countBins; ++i) {
+        const float db = 20.0f * log10f(std::max(smoothed[i], 1e-12f));
+        dst[i] = std::min(std::max((db - minDb) * invRange, 0.0f), 1.0f);
+    }
+}
+
+void FFTAnalyzer::ResetSmoothing() {
+    const size_t countBins = m_Smoothed.size();
+    m_AverageDatas.assign(countBins * m_AverageSize, 0.0f);
+    m_AverageLastIndex = 0U;
+    std::fill(m_AverageSums.begin(), m_AverageSums.end(), 0.0f);
+    std::fill(m_Smoothed.begin(), m_Smoothed.end(), 0.0f);
+}
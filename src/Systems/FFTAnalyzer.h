@@ -0,0 +1,127 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <kiss_fftr.h>
+
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+enum class FFTSmoothingModeEnum : uint8_t {
+    FFT_SMOOTHING_MEAN = 0,     // mean of the last N spectrums, running sum
+    FFT_SMOOTHING_EXPONENTIAL,  // like the smoothingTimeConstant of web audio
+    FFT_SMOOTHING_Count
+};
+
+// spectrum analysis of a mono stream of samples
+// the samples are pushed in a sliding history, a fft is done each hop size samples
+// the fft input size is a power of 2 from scMinFFTSize to scMaxFFTSize, the spectrum have fft size / 2 bins
+// not thread safe, one thread push and read the spectrum
+class FFTAnalyzer {
+public:
+    static constexpr size_t scMinFFTSize = 256U;
+    static constexpr size_t scMaxFFTSize = 8192U;
+    static constexpr size_t scMaxAverageSize = 50U;
+    static constexpr size_t scMaxFFTsByPush = 8U;  // when late, only the last hops are analysed
+
+private:
+    size_t m_FFTSize = 1024U;
+    size_t m_HopSize = 1024U;
+    kiss_fftr_cfg m_FFTConfig = nullptr;
+
+    // the history is written two times, so the last m_FFTSize samples are always contiguous
+    std::vector<float> m_History;
+    size_t m_HistoryPos = 0U;
+    size_t m_CountSamplesSinceLastFFT = 0U;
+
+    std::vector<kiss_fft_scalar> m_FFTInput;
+    std::vector<kiss_fft_cpx> m_FFTOutput;
+    std::vector<float> m_Magnitudes;
+    std::map<size_t, std::vector<float>> m_WindowTables;  // by fft size, computed one time
+
+    // smoothing
+    FFTSmoothingModeEnum m_SmoothingMode = FFTSmoothingModeEnum::FFT_SMOOTHING_MEAN;
+    size_t m_AverageSize = 10U;
+    float m_SmoothingFactor = 0.8f;
+    std::vector<float> m_AverageDatas;  // m_AverageSize spectrums
+    size_t m_AverageLastIndex = 0U;
+    std::vector<float> m_AverageSums;
+    std::vector<float> m_Smoothed;
+
+    // log scale, in [0:1] between the min and max db
+    bool m_LogScale = false;
+    float m_MinDecibels = -100.0f;
+    float m_MaxDecibels = -30.0f;
+    std::vector<float> m_Output;
+
+    float m_Amplification = 1.0f;
+
+public:
+    static double BlackmanWindow(const size_t& n, const size_t& vSize);
+    static bool IsValidFFTSize(const size_t& vFFTSize);
+
+public:
+    FFTAnalyzer();
+    ~FFTAnalyzer();
+    FFTAnalyzer(const FFTAnalyzer&) = delete;
+    FFTAnalyzer& operator=(const FFTAnalyzer&) = delete;
+
+    bool Init(const size_t& vFFTSize, const size_t& vHopSize);
+    void Unit();
+
+    // the history and the smoothing are cleared
+    void Reset();
+    // like Reset, but the history position, the hop phase and the smoothing slot are the ones
+    // after vCountSamples samples and vCountFFTs fft, to restart an analysis in the middle of a stream
+    void Reset(const uint64_t& vCountSamples, const uint64_t& vCountFFTs);
+
+    // return the count of fft done
+    size_t PushSamples(const float* vSamples, const size_t& vCount);
+
+    // the smoothed spectrum, log scaled if enabled
+    const float* GetSpectrum() const;
+    size_t GetCountBins() const;
+    // copy the vCountBins first bins, filled with zeros if the spectrum is smaller
+    void CopyBins(float* vDst, const size_t& vCountBins) const;
+
+    bool SetFFTSize(const size_t& vFFTSize);
+    size_t GetFFTSize() const;
+    void SetHopSize(const size_t& vHopSize);
+    size_t GetHopSize() const;
+    void SetSmoothingMode(const FFTSmoothingModeEnum& vMode);
+    FFTSmoothingModeEnum GetSmoothingMode() const;
+    void SetAverageSize(const size_t& vAverageSize);
+    size_t GetAverageSize() const;
+    void SetSmoothingFactor(const float& vFactor);
+    float GetSmoothingFactor() const;
+    void SetLogScale(const bool& vLogScale, const float& vMinDecibels, const float& vMaxDecibels);
+    bool IsLogScale() const;
+    float GetMinDecibels() const;
+    float GetMaxDecibels() const;
+    void SetAmplification(const float& vAmplification);
+    float GetAmplification() const;
+
+private:
+    const std::vector<float>& GetWindowTable(const size_t& vSize);
+    void ComputeFFT();
+    void ComputeMagnitudes();
+    void Smooth();
+    void ComputeLogScale();
+    void ResetSmoothing();
+};
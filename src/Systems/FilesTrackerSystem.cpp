@@ -33,6 +33,14 @@ FilesTrackerSystem::~FilesTrackerSystem() {
     for (auto wid : m_WatchIDs)
         m_FilesTracker->removeWatch(wid);
     m_FilesTracker.reset();
+
+    // the watcher thread is stopped, the not consumed events can be released
+    auto node = m_EventsHead.exchange(nullptr, std::memory_order_acquire);
+    while (node) {
+        auto next = node->next;
+        delete node;
+        node = next;
+    }
 }
 
 void FilesTrackerSystem::addWatch(const std::string& vPath) {
@@ -45,23 +53,100 @@ void FilesTrackerSystem::addWatch(const std::string& vPath) {
 
 void FilesTrackerSystem::update() {
     m_FilesTracker->watch();
+
+    DrainFileEvents();
+    FlushStableFiles();
+}
+
+void FilesTrackerSystem::SetDebounceDelay(uint32_t vDelayInMs) {
+    m_DebounceDelayInMs.store(vDelayInMs, std::memory_order_relaxed);
 }
 
+uint32_t FilesTrackerSystem::GetDebounceDelay() const {
+    return m_DebounceDelayInMs.load(std::memory_order_relaxed);
+}
+
+// called from the efsw watcher thread
 void FilesTrackerSystem::handleFileAction(efsw::WatchID vWatchid, const std::string& vDir, const std::string& vFileName, efsw::Action vAction, std::string vOldFilename) {
     UNUSED(vWatchid);
     switch (vAction) {
         case efsw::Actions::Modified: {
             LogVarDebugInfo("DIR (%s) FILE (%s) has been Modified", vDir.c_str(), vFileName.c_str());
-            auto ps = FileHelper::Instance()->ParsePathFileName(vDir + vFileName);
-            if (ps.isOk) {
-                files.emplace(ps.GetFPNE());
-                Changes = true;
-            }
+            PushFileEvent(vDir, vFileName);
+            break;
+        }
+        case efsw::Actions::Add: {
+            LogVarDebugInfo("DIR (%s) FILE (%s) has been Added", vDir.c_str(), vFileName.c_str());
+            PushFileEvent(vDir, vFileName);
+            break;
+        }
+        case efsw::Actions::Delete: {
+            LogVarDebugInfo("DIR (%s) FILE (%s) has been Deleted", vDir.c_str(), vFileName.c_str());
+            PushFileEvent(vDir, vFileName);
+            break;
+        }
+        case efsw::Actions::Moved: {
+            // save by rename, ex : shader.glsl.tmp => shader.glsl
+            LogVarDebugInfo("DIR (%s) FILE (%s) has been Moved to (%s)", vDir.c_str(), vOldFilename.c_str(), vFileName.c_str());
+            PushFileEvent(vDir, vOldFilename);
+            PushFileEvent(vDir, vFileName);
             break;
         }
-        case efsw::Actions::Add:
-        case efsw::Actions::Delete:
-        case efsw::Actions::Moved:
         default: break;
     }
-}
\ No newline at end of file
+}
+
+void FilesTrackerSystem::PushFileEvent(const std::string& vDir, const std::string& vFileName) {
+    if (vFileName.empty())
+        return;
+
+    auto ps = FileHelper::Instance()->ParsePathFileName(vDir + vFileName);
+    if (ps.isOk) {
+        auto node = new FileEventNode();
+        node->filePathName = ps.GetFPNE();
+        node->time = ClockType::now();
+        node->next = m_EventsHead.load(std::memory_order_relaxed);
+        while (!m_EventsHead.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+void FilesTrackerSystem::DrainFileEvents() {
+    auto node = m_EventsHead.exchange(nullptr, std::memory_order_acquire);
+
+    // the stack is in reverse order, but only the last time of each file is kept
+    while (node) {
+        auto it = m_PendingFiles.find(node->filePathName);
+        if (it == m_PendingFiles.end()) {
+            m_PendingFiles.emplace(std::move(node->filePathName), node->time);
+        } else if (it->second < node->time) {
+            it->second = node->time;
+        }
+
+        auto next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+void FilesTrackerSystem::FlushStableFiles() {
+    if (m_PendingFiles.empty())
+        return;
+
+    const auto now = ClockType::now();
+    const auto delay = std::chrono::milliseconds(GetDebounceDelay());
+
+    for (auto it = m_PendingFiles.begin(); it != m_PendingFiles.end();) {
+        if (now - it->second >= delay) {
+            // a deleted file who is not back after the delay have no content to reload
+            // a temporary file of an editor is in this case too
+            if (FileHelper::Instance()->IsFileExist(it->first, true)) {
+                files.emplace(it->first);
+                Changes = true;
+            }
+            it = m_PendingFiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -20,9 +20,25 @@
 #include <list>
 #include <string>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
 
 class FilesTrackerSystem : public efsw::FileWatchListener {
+private:
+    typedef std::chrono::steady_clock ClockType;
+
+    // event pushed by the efsw watcher thread
+    // all the actions (add, delete, move, modify) are a content change of the file
+    struct FileEventNode {
+        std::string filePathName;
+        ClockType::time_point time;
+        FileEventNode* next = nullptr;
+    };
+
 public:
+    // only read / written by the thread who call update()
     bool Changes = false;
     std::set<std::string> files;
 
@@ -30,6 +46,16 @@ private:
     std::unique_ptr<efsw::FileWatcher> m_FilesTracker = nullptr;
     std::set<efsw::WatchID> m_WatchIDs;
 
+    // lock free mpsc stack, the watcher threads push, update() take all
+    std::atomic<FileEventNode*> m_EventsHead{nullptr};
+
+    // files changed but not yet stable, file => time of the last event
+    std::unordered_map<std::string, ClockType::time_point> m_PendingFiles;
+
+    // a file is reported when no event was received for him since this delay
+    // the editors who save by rename or many times in burst will give one change
+    std::atomic<uint32_t> m_DebounceDelayInMs{150U};
+
 public:
     static FilesTrackerSystem* Instance() {
         static FilesTrackerSystem _instance;
@@ -40,7 +66,7 @@ protected:
     void handleFileAction(efsw::WatchID watchid, const std::string& dir, const std::string& filename, efsw::Action action, std::string oldFilename = "") override;
 
     FilesTrackerSystem();                                     // Prevent construction
-    FilesTrackerSystem(const FilesTrackerSystem&) = default;  // Prevent construction by copying
+    FilesTrackerSystem(const FilesTrackerSystem&) = delete;   // Prevent construction by copying
     FilesTrackerSystem& operator=(const FilesTrackerSystem&) {
         return *this;
     };                      // Prevent assignment
@@ -49,4 +75,12 @@ protected:
 public:
     void addWatch(const std::string& vPath);
     void update();
+
+    void SetDebounceDelay(uint32_t vDelayInMs);
+    uint32_t GetDebounceDelay() const;
+
+private:
+    void PushFileEvent(const std::string& vDir, const std::string& vFileName);
+    void DrainFileEvents();
+    void FlushStableFiles();
 };
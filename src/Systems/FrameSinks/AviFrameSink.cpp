@@ -0,0 +1,243 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "AviFrameSink.h"
+
+#include <ctools/Logger.h>
+#include <Profiler/TracyProfiler.h>
+
+// the positions of the fields patched at the close
+#define AVI_RIFF_SIZE_POS 4
+#define AVI_AVIH_TOTAL_FRAMES_POS 48
+#define AVI_STRH_LENGTH_POS 140
+#define AVI_HEADER_SIZE 224  // RIFF + hdrl LIST + movi LIST header
+#define AVI_MAX_FILE_SIZE 0x7FF00000U  // AVI 1.0 readers and ftell are limited to 2 Go
+
+static void AviFrameSink_WriteU32(FILE* vFile, uint32_t vValue) {
+    const uint8_t bytes[4] = {(uint8_t)(vValue & 0xFF), (uint8_t)((vValue >> 8) & 0xFF), (uint8_t)((vValue >> 16) & 0xFF), (uint8_t)((vValue >> 24) & 0xFF)};
+    fwrite(bytes, 1U, 4U, vFile);
+}
+
+static void AviFrameSink_WriteU16(FILE* vFile, uint16_t vValue) {
+    const uint8_t bytes[2] = {(uint8_t)(vValue & 0xFF), (uint8_t)((vValue >> 8) & 0xFF)};
+    fwrite(bytes, 1U, 2U, vFile);
+}
+
+static void AviFrameSink_WriteFourCC(FILE* vFile, const char* vFourCC) {
+    fwrite(vFourCC, 1U, 4U, vFile);
+}
+
+FrameSinkPtr AviFrameSink::Create() {
+    return std::make_shared<AviFrameSink>();
+}
+
+AviFrameSink::~AviFrameSink() {
+    Close();
+}
+
+bool AviFrameSink::Open(const std::string& vFilePathName, const int& vWidth, const int& vHeight, const int& vFrameRate) {
+    Close();
+
+    if (vWidth <= 0 || vHeight <= 0 || vFrameRate <= 0)
+        return false;
+
+    m_File = fopen(vFilePathName.c_str(), "wb");
+    if (!m_File) {
+        LogVarError("Fail to open %s for writing", vFilePathName.c_str());
+        return false;
+    }
+
+    m_Width = vWidth;
+    m_Height = vHeight;
+    m_CountFrames = 0U;
+    m_FrameOffsets.clear();
+
+    const uint32_t rowSize = ((uint32_t)m_Width * 3U + 3U) & ~3U;  // rows aligned on 4 bytes
+    m_FrameSize = rowSize * (uint32_t)m_Height;
+    m_FrameBytes.resize(m_FrameSize);
+
+    FILE* f = m_File;
+
+    AviFrameSink_WriteFourCC(f, "RIFF");
+    AviFrameSink_WriteU32(f, 0U);  // patched
+    AviFrameSink_WriteFourCC(f, "AVI ");
+
+    AviFrameSink_WriteFourCC(f, "LIST");
+    AviFrameSink_WriteU32(f, 192U);  // hdrl size
+    AviFrameSink_WriteFourCC(f, "hdrl");
+
+    // main header
+    AviFrameSink_WriteFourCC(f, "avih");
+    AviFrameSink_WriteU32(f, 56U);
+    AviFrameSink_WriteU32(f, 1000000U / (uint32_t)vFrameRate);  // micro sec per frame
+    AviFrameSink_WriteU32(f, m_FrameSize * (uint32_t)vFrameRate);  // max bytes per sec
+    AviFrameSink_WriteU32(f, 0U);                                 // padding granularity
+    AviFrameSink_WriteU32(f, 0x10U);                              // AVIF_HASINDEX
+    AviFrameSink_WriteU32(f, 0U);                                 // total frames, patched
+    AviFrameSink_WriteU32(f, 0U);                                 // initial frames
+    AviFrameSink_WriteU32(f, 1U);                                 // streams
+    AviFrameSink_WriteU32(f, m_FrameSize + 8U);                   // suggested buffer size
+    AviFrameSink_WriteU32(f, (uint32_t)m_Width);
+    AviFrameSink_WriteU32(f, (uint32_t)m_Height);
+    for (int i = 0; i < 4; ++i) {
+        AviFrameSink_WriteU32(f, 0U);  // reserved
+    }
+
+    AviFrameSink_WriteFourCC(f, "LIST");
+    AviFrameSink_WriteU32(f, 116U);  // strl size
+    AviFrameSink_WriteFourCC(f, "strl");
+
+    // stream header
+    AviFrameSink_WriteFourCC(f, "strh");
+    AviFrameSink_WriteU32(f, 56U);
+    AviFrameSink_WriteFourCC(f, "vids");
+    AviFrameSink_WriteFourCC(f, "DIB ");
+    AviFrameSink_WriteU32(f, 0U);  // flags
+    AviFrameSink_WriteU16(f, 0U);  // priority
+    AviFrameSink_WriteU16(f, 0U);  // language
+    AviFrameSink_WriteU32(f, 0U);  // initial frames
+    AviFrameSink_WriteU32(f, 1U);  // scale
+    AviFrameSink_WriteU32(f, (uint32_t)vFrameRate);  // rate
+    AviFrameSink_WriteU32(f, 0U);                    // start
+    AviFrameSink_WriteU32(f, 0U);                    // length, patched
+    AviFrameSink_WriteU32(f, m_FrameSize + 8U);      // suggested buffer size
+    AviFrameSink_WriteU32(f, 0xFFFFFFFFU);           // quality
+    AviFrameSink_WriteU32(f, 0U);                    // sample size
+    AviFrameSink_WriteU16(f, 0U);                    // frame rect
+    AviFrameSink_WriteU16(f, 0U);
+    AviFrameSink_WriteU16(f, (uint16_t)m_Width);
+    AviFrameSink_WriteU16(f, (uint16_t)m_Height);
+
+    // stream format, BITMAPINFOHEADER
+    AviFrameSink_WriteFourCC(f, "strf");
+    AviFrameSink_WriteU32(f, 40U);
+    AviFrameSink_WriteU32(f, 40U);
+    AviFrameSink_WriteU32(f, (uint32_t)m_Width);
+    AviFrameSink_WriteU32(f, (uint32_t)m_Height);  // positive, so bottom up
+    AviFrameSink_WriteU16(f, 1U);                   // planes
+    AviFrameSink_WriteU16(f, 24U);                  // bit count
+    AviFrameSink_WriteU32(f, 0U);                   // BI_RGB
+    AviFrameSink_WriteU32(f, m_FrameSize);
+    AviFrameSink_WriteU32(f, 0U);
+    AviFrameSink_WriteU32(f, 0U);
+    AviFrameSink_WriteU32(f, 0U);
+    AviFrameSink_WriteU32(f, 0U);
+
+    AviFrameSink_WriteFourCC(f, "LIST");
+    m_MoviListPos = ftell(f);
+    AviFrameSink_WriteU32(f, 0U);  // patched
+    AviFrameSink_WriteFourCC(f, "movi");
+
+    if (ftell(f) != AVI_HEADER_SIZE) {
+        LogVarError("Bad avi header size");
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool AviFrameSink::WriteFrame(const uint8_t* vRGBA, const int& vWidth, const int& vHeight, const bool& vFlipY) {
+    ZoneScoped;
+
+    if (!m_File || !vRGBA)
+        return false;
+
+    if (vWidth != m_Width || vHeight != m_Height) {
+        LogVarError("The frame size %ix%i is not the stream size %ix%i", vWidth, vHeight, m_Width, m_Height);
+        return false;
+    }
+
+    const uint64_t nextFileSize = (uint64_t)AVI_HEADER_SIZE + (uint64_t)(m_CountFrames + 1U) * (uint64_t)(m_FrameSize + 8U + 16U);
+    if (nextFileSize > AVI_MAX_FILE_SIZE) {
+        LogVarError("The avi file is full (2 Go), the frame %u is not written", m_CountFrames);
+        return false;
+    }
+
+    // the dib is bottom up, like glReadPixels, so the flip is inverted
+    const uint32_t rowSize = m_FrameSize / (uint32_t)m_Height;
+    for (int y = 0; y < m_Height; ++y) {
+        const int srcY = vFlipY ? y : (m_Height - 1 - y);
+        const uint8_t* src = vRGBA + (size_t)srcY * (size_t)m_Width * 4U;
+        uint8_t* dst = m_FrameBytes.data() + (size_t)y * rowSize;
+        for (int x = 0; x < m_Width; ++x) {
+            dst[x * 3 + 0] = src[x * 4 + 2];
+            dst[x * 3 + 1] = src[x * 4 + 1];
+            dst[x * 3 + 2] = src[x * 4 + 0];
+        }
+    }
+
+    m_FrameOffsets.push_back((uint32_t)(ftell(m_File) - (m_MoviListPos + 4)));
+
+    AviFrameSink_WriteFourCC(m_File, "00db");
+    AviFrameSink_WriteU32(m_File, m_FrameSize);
+    if (fwrite(m_FrameBytes.data(), 1U, m_FrameSize, m_File) != m_FrameSize) {
+        LogVarError("Fail to write the avi frame %u", m_CountFrames);
+        return false;
+    }
+
+    ++m_CountFrames;
+
+    return true;
+}
+
+bool AviFrameSink::Close() {
+    if (!m_File)
+        return false;
+
+    FILE* f = m_File;
+
+    const long moviEnd = ftell(f);
+
+    // index
+    AviFrameSink_WriteFourCC(f, "idx1");
+    AviFrameSink_WriteU32(f, m_CountFrames * 16U);
+    for (const auto& offset : m_FrameOffsets) {
+        AviFrameSink_WriteFourCC(f, "00db");
+        AviFrameSink_WriteU32(f, 0x10U);  // AVIIF_KEYFRAME
+        AviFrameSink_WriteU32(f, offset);
+        AviFrameSink_WriteU32(f, m_FrameSize);
+    }
+
+    const long fileEnd = ftell(f);
+
+    fseek(f, AVI_RIFF_SIZE_POS, SEEK_SET);
+    AviFrameSink_WriteU32(f, (uint32_t)(fileEnd - 8));
+    fseek(f, AVI_AVIH_TOTAL_FRAMES_POS, SEEK_SET);
+    AviFrameSink_WriteU32(f, m_CountFrames);
+    fseek(f, AVI_STRH_LENGTH_POS, SEEK_SET);
+    AviFrameSink_WriteU32(f, m_CountFrames);
+    fseek(f, m_MoviListPos, SEEK_SET);
+    AviFrameSink_WriteU32(f, (uint32_t)(moviEnd - m_MoviListPos - 4));
+
+    fclose(f);
+    m_File = nullptr;
+    m_FrameOffsets.clear();
+    m_FrameBytes.clear();
+
+    return true;
+}
+
+bool AviFrameSink::IsOpened() {
+    return (m_File != nullptr);
+}
+
+std::string AviFrameSink::GetFileExtension() {
+    return ".avi";
+}
@@ -0,0 +1,368 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "GifFrameSink.h"
+
+#include <ctools/Logger.h>
+#include <Profiler/TracyProfiler.h>
+
+#include <algorithm>
+
+#define GIF_HISTOGRAM_SIZE 32768U  // 5 bits by channel
+#define GIF_LZW_HASH_SIZE 8192U    // for max 4096 codes
+#define GIF_LZW_MAX_CODE 4096U
+
+static void GifFrameSink_WriteU16(FILE* vFile, uint16_t vValue) {
+    fputc(vValue & 0xFF, vFile);
+    fputc((vValue >> 8) & 0xFF, vFile);
+}
+
+static inline uint32_t GifFrameSink_GetColorKey(const uint8_t* vPixel) {
+    return ((uint32_t)(vPixel[0] >> 3) << 10) | ((uint32_t)(vPixel[1] >> 3) << 5) | (uint32_t)(vPixel[2] >> 3);
+}
+
+// a box of the median cut, the colors are the keys of the histogram
+struct GifColorBox {
+    std::vector<uint32_t> keys;
+    uint64_t countPixels = 0U;
+    int minChannel[3] = {31, 31, 31};
+    int maxChannel[3] = {0, 0, 0};
+
+    void Update(const std::vector<uint32_t>& vHistogram) {
+        countPixels = 0U;
+        for (int c = 0; c < 3; ++c) {
+            minChannel[c] = 31;
+            maxChannel[c] = 0;
+        }
+        for (const auto& key : keys) {
+            countPixels += vHistogram[key];
+            const int channels[3] = {(int)((key >> 10) & 31U), (int)((key >> 5) & 31U), (int)(key & 31U)};
+            for (int c = 0; c < 3; ++c) {
+                minChannel[c] = std::min(minChannel[c], channels[c]);
+                maxChannel[c] = std::max(maxChannel[c], channels[c]);
+            }
+        }
+    }
+
+    int GetLongestChannel() const {
+        int res = 0;
+        for (int c = 1; c < 3; ++c) {
+            if (maxChannel[c] - minChannel[c] > maxChannel[res] - minChannel[res]) {
+                res = c;
+            }
+        }
+        return res;
+    }
+
+    int GetLongestLength() const {
+        const int c = GetLongestChannel();
+        return maxChannel[c] - minChannel[c];
+    }
+};
+
+FrameSinkPtr GifFrameSink::Create() {
+    return std::make_shared<GifFrameSink>();
+}
+
+GifFrameSink::~GifFrameSink() {
+    Close();
+}
+
+bool GifFrameSink::Open(const std::string& vFilePathName, const int& vWidth, const int& vHeight, const int& vFrameRate) {
+    Close();
+
+    if (vWidth <= 0 || vHeight <= 0 || vWidth > 65535 || vHeight > 65535 || vFrameRate <= 0)
+        return false;
+
+    m_File = fopen(vFilePathName.c_str(), "wb");
+    if (!m_File) {
+        LogVarError("Fail to open %s for writing", vFilePathName.c_str());
+        return false;
+    }
+
+    m_Width = vWidth;
+    m_Height = vHeight;
+    m_FrameRate = vFrameRate;
+    m_CountFrames = 0U;
+
+    m_ColorToPaletteIndex.resize(GIF_HISTOGRAM_SIZE);
+    m_Histogram.resize(GIF_HISTOGRAM_SIZE);
+    m_Indices.resize((size_t)m_Width * (size_t)m_Height);
+    m_LzwKeys.resize(GIF_LZW_HASH_SIZE);
+    m_LzwCodes.resize(GIF_LZW_HASH_SIZE);
+
+    fwrite("GIF89a", 1U, 6U, m_File);
+
+    // logical screen, no global color table
+    GifFrameSink_WriteU16(m_File, (uint16_t)m_Width);
+    GifFrameSink_WriteU16(m_File, (uint16_t)m_Height);
+    fputc(0x00, m_File);  // packed
+    fputc(0x00, m_File);  // background color
+    fputc(0x00, m_File);  // aspect
+
+    // loop forever
+    fputc(0x21, m_File);
+    fputc(0xFF, m_File);
+    fputc(0x0B, m_File);
+    fwrite("NETSCAPE2.0", 1U, 11U, m_File);
+    fputc(0x03, m_File);
+    fputc(0x01, m_File);
+    GifFrameSink_WriteU16(m_File, 0U);
+    fputc(0x00, m_File);
+
+    return true;
+}
+
+bool GifFrameSink::WriteFrame(const uint8_t* vRGBA, const int& vWidth, const int& vHeight, const bool& vFlipY) {
+    ZoneScoped;
+
+    if (!m_File || !vRGBA)
+        return false;
+
+    if (vWidth != m_Width || vHeight != m_Height) {
+        LogVarError("The frame size %ix%i is not the stream size %ix%i", vWidth, vHeight, m_Width, m_Height);
+        return false;
+    }
+
+    QuantizeFrame(vRGBA, vFlipY);
+
+    // graphic control extension
+    fputc(0x21, m_File);
+    fputc(0xF9, m_File);
+    fputc(0x04, m_File);
+    fputc(0x04, m_File);  // disposal : do not dispose
+    GifFrameSink_WriteU16(m_File, GetFrameDelay());
+    fputc(0x00, m_File);  // transparent color index
+    fputc(0x00, m_File);
+
+    // image descriptor with a local color table of 256 colors
+    fputc(0x2C, m_File);
+    GifFrameSink_WriteU16(m_File, 0U);
+    GifFrameSink_WriteU16(m_File, 0U);
+    GifFrameSink_WriteU16(m_File, (uint16_t)m_Width);
+    GifFrameSink_WriteU16(m_File, (uint16_t)m_Height);
+    fputc(0x80 | 0x07, m_File);
+    fwrite(m_Palette.data(), 1U, m_Palette.size(), m_File);
+
+    CompressFrame();
+
+    fputc(8, m_File);  // lzw min code size
+    for (size_t pos = 0U; pos < m_CodeBytes.size(); pos += 255U) {
+        const size_t blockSize = std::min<size_t>(255U, m_CodeBytes.size() - pos);
+        fputc((int)blockSize, m_File);
+        fwrite(m_CodeBytes.data() + pos, 1U, blockSize, m_File);
+    }
+    fputc(0x00, m_File);
+
+    ++m_CountFrames;
+
+    return (ferror(m_File) == 0);
+}
+
+bool GifFrameSink::Close() {
+    if (m_File) {
+        fputc(0x3B, m_File);  // trailer
+        fclose(m_File);
+        m_File = nullptr;
+        m_Indices.clear();
+        m_CodeBytes.clear();
+        return true;
+    }
+    return false;
+}
+
+bool GifFrameSink::IsOpened() {
+    return (m_File != nullptr);
+}
+
+std::string GifFrameSink::GetFileExtension() {
+    return ".gif";
+}
+
+void GifFrameSink::QuantizeFrame(const uint8_t* vRGBA, const bool& vFlipY) {
+    ZoneScoped;
+
+    const size_t countPixels = (size_t)m_Width * (size_t)m_Height;
+
+    std::fill(m_Histogram.begin(), m_Histogram.end(), 0U);
+    for (size_t i = 0U; i < countPixels; ++i) {
+        ++m_Histogram[GifFrameSink_GetColorKey(vRGBA + i * 4U)];
+    }
+
+    // median cut
+    std::vector<GifColorBox> boxes(1U);
+    for (uint32_t key = 0U; key < GIF_HISTOGRAM_SIZE; ++key) {
+        if (m_Histogram[key]) {
+            boxes[0].keys.push_back(key);
+        }
+    }
+    boxes[0].Update(m_Histogram);
+
+    while (boxes.size() < 256U) {
+        // the most populated box who can be cut
+        size_t boxToCut = boxes.size();
+        uint64_t bestScore = 0U;
+        for (size_t i = 0U; i < boxes.size(); ++i) {
+            const auto& box = boxes[i];
+            if (box.keys.size() > 1U) {
+                const uint64_t score = box.countPixels * (uint64_t)(box.GetLongestLength() + 1);
+                if (score > bestScore) {
+                    bestScore = score;
+                    boxToCut = i;
+                }
+            }
+        }
+        if (boxToCut == boxes.size())
+            break;
+
+        auto& box = boxes[boxToCut];
+        const int channel = box.GetLongestChannel();
+        const int shift = (2 - channel) * 5;
+        std::sort(box.keys.begin(), box.keys.end(), [shift](uint32_t a, uint32_t b) { return ((a >> shift) & 31U) < ((b >> shift) & 31U); });
+
+        // median by pixels count
+        uint64_t count = 0U;
+        size_t cut = 1U;
+        for (; cut < box.keys.size(); ++cut) {
+            count += m_Histogram[box.keys[cut - 1U]];
+            if (count * 2U >= box.countPixels)
+                break;
+        }
+        cut = std::min(cut, box.keys.size() - 1U);
+
+        GifColorBox newBox;
+        newBox.keys.assign(box.keys.begin() + (std::ptrdiff_t)cut, box.keys.end());
+        box.keys.resize(cut);
+        box.Update(m_Histogram);
+        newBox.Update(m_Histogram);
+        boxes.push_back(std::move(newBox));
+    }
+
+    // palette, mean color of each box
+    m_Palette.fill(0U);
+    for (size_t i = 0U; i < boxes.size(); ++i) {
+        uint64_t r = 0U, g = 0U, b = 0U;
+        const auto& box = boxes[i];
+        for (const auto& key : box.keys) {
+            const uint64_t weight = m_Histogram[key];
+            r += weight * ((((key >> 10) & 31U) << 3) | 4U);
+            g += weight * ((((key >> 5) & 31U) << 3) | 4U);
+            b += weight * (((key & 31U) << 3) | 4U);
+            m_ColorToPaletteIndex[key] = (uint16_t)i;
+        }
+        if (box.countPixels) {
+            m_Palette[i * 3U + 0U] = (uint8_t)(r / box.countPixels);
+            m_Palette[i * 3U + 1U] = (uint8_t)(g / box.countPixels);
+            m_Palette[i * 3U + 2U] = (uint8_t)(b / box.countPixels);
+        }
+    }
+
+    // the gif rows are top to bottom
+    for (int y = 0; y < m_Height; ++y) {
+        const int srcY = vFlipY ? (m_Height - 1 - y) : y;
+        const uint8_t* src = vRGBA + (size_t)srcY * (size_t)m_Width * 4U;
+        uint8_t* dst = m_Indices.data() + (size_t)y * (size_t)m_Width;
+        for (int x = 0; x < m_Width; ++x) {
+            dst[x] = (uint8_t)m_ColorToPaletteIndex[GifFrameSink_GetColorKey(src + x * 4)];
+        }
+    }
+}
+
+void GifFrameSink::CompressFrame() {
+    ZoneScoped;
+
+    const uint32_t clearCode = 256U;
+    const uint32_t endCode = 257U;
+
+    m_CodeBytes.clear();
+
+    uint32_t bitBuffer = 0U;
+    uint32_t bitCount = 0U;
+    uint32_t codeSize = 9U;
+    uint32_t nextCode = 258U;
+
+    auto emit = [&](uint32_t vCode) {
+        bitBuffer |= vCode << bitCount;
+        bitCount += codeSize;
+        while (bitCount >= 8U) {
+            m_CodeBytes.push_back((uint8_t)(bitBuffer & 0xFF));
+            bitBuffer >>= 8;
+            bitCount -= 8U;
+        }
+    };
+
+    auto clearDictionary = [&]() {
+        std::fill(m_LzwKeys.begin(), m_LzwKeys.end(), -1);
+        codeSize = 9U;
+        nextCode = 258U;
+    };
+
+    clearDictionary();
+    emit(clearCode);
+
+    if (m_Indices.empty()) {
+        emit(endCode);
+    } else {
+        uint32_t prefix = m_Indices[0];
+        for (size_t i = 1U; i < m_Indices.size(); ++i) {
+            const uint32_t c = m_Indices[i];
+            const int32_t key = (int32_t)((prefix << 8) | c);
+
+            uint32_t slot = ((uint32_t)key * 2654435761U) >> 19;  // 13 bits
+            while (m_LzwKeys[slot] != -1 && m_LzwKeys[slot] != key) {
+                slot = (slot + 1U) & (GIF_LZW_HASH_SIZE - 1U);
+            }
+
+            if (m_LzwKeys[slot] == key) {
+                prefix = m_LzwCodes[slot];
+                continue;
+            }
+
+            emit(prefix);
+
+            if (nextCode < GIF_LZW_MAX_CODE) {
+                m_LzwKeys[slot] = key;
+                m_LzwCodes[slot] = (uint16_t)nextCode;
+                if (nextCode == (1U << codeSize)) {
+                    ++codeSize;
+                }
+                ++nextCode;
+            } else {
+                emit(clearCode);
+                clearDictionary();
+            }
+
+            prefix = c;
+        }
+
+        emit(prefix);
+        emit(endCode);
+    }
+
+    if (bitCount > 0U) {
+        m_CodeBytes.push_back((uint8_t)(bitBuffer & 0xFF));
+    }
+}
+
+uint16_t GifFrameSink::GetFrameDelay() {
+    // the error of the rounding is not accumulated, ex : 30 fps => 3, 3, 4, 3, 3, 4..
+    const uint32_t start = (m_CountFrames * 100U + (uint32_t)m_FrameRate / 2U) / (uint32_t)m_FrameRate;
+    const uint32_t end = ((m_CountFrames + 1U) * 100U + (uint32_t)m_FrameRate / 2U) / (uint32_t)m_FrameRate;
+    return (uint16_t)std::max<uint32_t>(end - start, 1U);
+}
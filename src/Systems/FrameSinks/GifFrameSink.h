@@ -0,0 +1,60 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <Interfaces/FrameSinkInterface.h>
+
+#include <cstdio>
+#include <vector>
+#include <array>
+
+// animated gif, each frame have his own palette of 256 colors (median cut)
+// the frames are lzw compressed and written as they come, the gif loop forever
+class GifFrameSink : public FrameSinkInterface {
+private:
+    FILE* m_File = nullptr;
+    int m_Width = 0;
+    int m_Height = 0;
+    int m_FrameRate = 30;
+    uint32_t m_CountFrames = 0U;
+    std::array<uint8_t, 256U * 3U> m_Palette{};
+    std::vector<uint16_t> m_ColorToPaletteIndex;  // 5 bits by channel => palette index
+    std::vector<uint32_t> m_Histogram;            // 5 bits by channel
+    std::vector<uint8_t> m_Indices;               // the frame as palette indices
+    std::vector<uint8_t> m_CodeBytes;             // lzw output
+
+    // lzw dictionary, open addressing, key = prefix code << 8 | byte
+    std::vector<int32_t> m_LzwKeys;
+    std::vector<uint16_t> m_LzwCodes;
+
+public:
+    static FrameSinkPtr Create();
+
+public:
+    ~GifFrameSink() override;
+
+    bool Open(const std::string& vFilePathName, const int& vWidth, const int& vHeight, const int& vFrameRate) override;
+    bool WriteFrame(const uint8_t* vRGBA, const int& vWidth, const int& vHeight, const bool& vFlipY) override;
+    bool Close() override;
+    bool IsOpened() override;
+    std::string GetFileExtension() override;
+
+private:
+    void QuantizeFrame(const uint8_t* vRGBA, const bool& vFlipY);
+    void CompressFrame();
+    uint16_t GetFrameDelay();  // in 1/100 s
+};
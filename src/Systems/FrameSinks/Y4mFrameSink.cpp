@@ -0,0 +1,134 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "Y4mFrameSink.h"
+
+#include <ctools/Logger.h>
+#include <Profiler/TracyProfiler.h>
+
+#include <algorithm>
+
+FrameSinkPtr Y4mFrameSink::Create() {
+    return std::make_shared<Y4mFrameSink>();
+}
+
+Y4mFrameSink::~Y4mFrameSink() {
+    Close();
+}
+
+bool Y4mFrameSink::Open(const std::string& vFilePathName, const int& vWidth, const int& vHeight, const int& vFrameRate) {
+    Close();
+
+    if (vWidth <= 0 || vHeight <= 0 || vFrameRate <= 0)
+        return false;
+
+    m_File = fopen(vFilePathName.c_str(), "wb");
+    if (!m_File) {
+        LogVarError("Fail to open %s for writing", vFilePathName.c_str());
+        return false;
+    }
+
+    m_Width = vWidth;
+    m_Height = vHeight;
+
+    const size_t lumaSize = (size_t)m_Width * (size_t)m_Height;
+    const size_t chromaSize = (size_t)((m_Width + 1) / 2) * (size_t)((m_Height + 1) / 2);
+    m_Planes.resize(lumaSize + chromaSize * 2U);
+
+    fprintf(m_File, "YUV4MPEG2 W%i H%i F%i:1 Ip A1:1 C420jpeg\n", m_Width, m_Height, vFrameRate);
+
+    return true;
+}
+
+bool Y4mFrameSink::WriteFrame(const uint8_t* vRGBA, const int& vWidth, const int& vHeight, const bool& vFlipY) {
+    ZoneScoped;
+
+    if (!m_File || !vRGBA)
+        return false;
+
+    if (vWidth != m_Width || vHeight != m_Height) {
+        LogVarError("The frame size %ix%i is not the stream size %ix%i", vWidth, vHeight, m_Width, m_Height);
+        return false;
+    }
+
+    const int chromaWidth = (m_Width + 1) / 2;
+    const int chromaHeight = (m_Height + 1) / 2;
+    uint8_t* planeY = m_Planes.data();
+    uint8_t* planeCb = planeY + (size_t)m_Width * (size_t)m_Height;
+    uint8_t* planeCr = planeCb + (size_t)chromaWidth * (size_t)chromaHeight;
+
+    // BT.601 full range
+    for (int y = 0; y < m_Height; ++y) {
+        const int srcY = vFlipY ? (m_Height - 1 - y) : y;
+        const uint8_t* src = vRGBA + (size_t)srcY * (size_t)m_Width * 4U;
+        uint8_t* dst = planeY + (size_t)y * (size_t)m_Width;
+        for (int x = 0; x < m_Width; ++x) {
+            const int r = src[x * 4 + 0];
+            const int g = src[x * 4 + 1];
+            const int b = src[x * 4 + 2];
+            dst[x] = (uint8_t)((19595 * r + 38470 * g + 7471 * b + 32768) >> 16);
+        }
+    }
+
+    // chroma, mean of the 2x2 block
+    for (int cy = 0; cy < chromaHeight; ++cy) {
+        for (int cx = 0; cx < chromaWidth; ++cx) {
+            int r = 0, g = 0, b = 0, count = 0;
+            for (int dy = 0; dy < 2; ++dy) {
+                const int y = std::min(cy * 2 + dy, m_Height - 1);
+                const int srcY = vFlipY ? (m_Height - 1 - y) : y;
+                for (int dx = 0; dx < 2; ++dx) {
+                    const int x = std::min(cx * 2 + dx, m_Width - 1);
+                    const uint8_t* px = vRGBA + ((size_t)srcY * (size_t)m_Width + (size_t)x) * 4U;
+                    r += px[0];
+                    g += px[1];
+                    b += px[2];
+                    ++count;
+                }
+            }
+            r /= count;
+            g /= count;
+            b /= count;
+            const size_t idx = (size_t)cy * (size_t)chromaWidth + (size_t)cx;
+            planeCb[idx] = (uint8_t)std::clamp((-11059 * r - 21709 * g + 32768 * b + 8388608 + 32768) >> 16, 0, 255);
+            planeCr[idx] = (uint8_t)std::clamp((32768 * r - 27439 * g - 5329 * b + 8388608 + 32768) >> 16, 0, 255);
+        }
+    }
+
+    fputs("FRAME\n", m_File);
+    return (fwrite(m_Planes.data(), 1U, m_Planes.size(), m_File) == m_Planes.size());
+}
+
+bool Y4mFrameSink::Close() {
+    if (m_File) {
+        fclose(m_File);
+        m_File = nullptr;
+        m_Planes.clear();
+        return true;
+    }
+    return false;
+}
+
+bool Y4mFrameSink::IsOpened() {
+    return (m_File != nullptr);
+}
+
+std::string Y4mFrameSink::GetFileExtension() {
+    return ".y4m";
+}
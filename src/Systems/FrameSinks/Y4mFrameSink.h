@@ -0,0 +1,44 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <Interfaces/FrameSinkInterface.h>
+
+#include <cstdio>
+#include <vector>
+
+// raw YUV4MPEG2 stream, 4:2:0 full range (C420jpeg)
+// no compression, readable by ffmpeg, mpv, vlc.. and without size limit
+class Y4mFrameSink : public FrameSinkInterface {
+private:
+    FILE* m_File = nullptr;
+    int m_Width = 0;
+    int m_Height = 0;
+    std::vector<uint8_t> m_Planes;  // Y, then Cb, then Cr
+
+public:
+    static FrameSinkPtr Create();
+
+public:
+    ~Y4mFrameSink() override;
+
+    bool Open(const std::string& vFilePathName, const int& vWidth, const int& vHeight, const int& vFrameRate) override;
+    bool WriteFrame(const uint8_t* vRGBA, const int& vWidth, const int& vHeight, const bool& vFlipY) override;
+    bool Close() override;
+    bool IsOpened() override;
+    std::string GetFileExtension() override;
+};
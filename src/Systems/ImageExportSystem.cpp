@@ -0,0 +1,417 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "ImageExportSystem.h"
+
+#include <ctools/Logger.h>
+#include <Profiler/TracyProfiler.h>
+
+// the implementations are in ScreenGrabber.cpp
+#include <stb_image_write.h>
+#include <stb_image_resize2.h>
+
+#include <algorithm>
+#include <cstring>  // memcpy
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///// STATIC //////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// mean of the 9 pixels at -ss, 0, +ss around each pixel, for the rows [vRowStart, vRowEnd)
+// the pixels are accumulated row by row for let the compiler vectorize the inner loops
+template <typename T, typename TAcc>
+static void ImageExport_SubSampleRows(const T* vSrc, T* vDst, int vWidth, int vHeight, int vChannels, int vSS, int vRowStart, int vRowEnd) {
+    const size_t rowSize = (size_t)vWidth * (size_t)vChannels;
+    std::vector<TAcc> acc(rowSize);
+    std::vector<int> counts((size_t)vWidth);
+
+    for (int y = vRowStart; y < vRowEnd; ++y) {
+        std::fill(acc.begin(), acc.end(), (TAcc)0);
+        std::fill(counts.begin(), counts.end(), 0);
+
+        for (int j = -vSS; j <= vSS; j += vSS) {
+            const int sy = y + j;
+            if (sy < 0 || sy >= vHeight)
+                continue;
+
+            const T* srcRow = vSrc + (size_t)sy * rowSize;
+            for (int i = -vSS; i <= vSS; i += vSS) {
+                const int xStart = std::max(0, -i);
+                const int xEnd = std::min(vWidth, vWidth - i);
+                if (xEnd <= xStart)
+                    continue;
+
+                TAcc* accPtr = acc.data() + (size_t)xStart * (size_t)vChannels;
+                const T* srcPtr = srcRow + (size_t)(xStart + i) * (size_t)vChannels;
+                const size_t count = (size_t)(xEnd - xStart) * (size_t)vChannels;
+                for (size_t k = 0U; k < count; ++k) {
+                    accPtr[k] += (TAcc)srcPtr[k];
+                }
+                for (int x = xStart; x < xEnd; ++x) {
+                    ++counts[(size_t)x];
+                }
+            }
+        }
+
+        T* dstRow = vDst + (size_t)y * rowSize;
+        for (int x = 0; x < vWidth; ++x) {
+            const TAcc count = (TAcc)std::max(counts[(size_t)x], 1);
+            const size_t offset = (size_t)x * (size_t)vChannels;
+            for (int c = 0; c < vChannels; ++c) {
+                dstRow[offset + c] = (T)(acc[offset + c] / count);
+            }
+        }
+    }
+}
+
+template <typename T, typename TAcc>
+static void ImageExport_SubSample(std::vector<T>& vPixels, int vWidth, int vHeight, int vChannels, int vSS, size_t vCountThreads) {
+    ZoneScoped;
+
+    const std::vector<T> src = vPixels;
+
+    // row bands, each thread have his own rows
+    const size_t countBands = std::max<size_t>(1U, std::min<size_t>(vCountThreads, (size_t)vHeight / 64U));
+    if (countBands > 1U) {
+        std::vector<std::thread> threads;
+        threads.reserve(countBands - 1U);
+        const int rowsPerBand = (int)(((size_t)vHeight + countBands - 1U) / countBands);
+        for (size_t band = 1U; band < countBands; ++band) {
+            const int rowStart = (int)band * rowsPerBand;
+            const int rowEnd = std::min(vHeight, rowStart + rowsPerBand);
+            threads.emplace_back(ImageExport_SubSampleRows<T, TAcc>, src.data(), vPixels.data(), vWidth, vHeight, vChannels, vSS, rowStart, rowEnd);
+        }
+        ImageExport_SubSampleRows<T, TAcc>(src.data(), vPixels.data(), vWidth, vHeight, vChannels, vSS, 0, std::min(vHeight, rowsPerBand));
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    } else {
+        ImageExport_SubSampleRows<T, TAcc>(src.data(), vPixels.data(), vWidth, vHeight, vChannels, vSS, 0, vHeight);
+    }
+}
+
+template <typename T>
+static void ImageExport_FlipY(std::vector<T>& vPixels, int vWidth, int vHeight, int vChannels) {
+    const size_t rowSize = (size_t)vWidth * (size_t)vChannels;
+    for (int y = 0; y < vHeight / 2; ++y) {
+        std::swap_ranges(vPixels.begin() + (size_t)y * rowSize,  //
+                         vPixels.begin() + (size_t)(y + 1) * rowSize,
+                         vPixels.begin() + (size_t)(vHeight - 1 - y) * rowSize);
+    }
+}
+
+// bmp and jpg have no alpha
+static void ImageExport_ConvertChannels(ImageExportJob& vJob, int vChannels) {
+    if (vJob.channels == vChannels || vJob.bytes.empty())
+        return;
+
+    const size_t countPixels = (size_t)vJob.width * (size_t)vJob.height;
+    const int minChannels = std::min(vJob.channels, vChannels);
+    std::vector<uint8_t> res(countPixels * (size_t)vChannels, 255U);
+    for (size_t p = 0U; p < countPixels; ++p) {
+        for (int c = 0; c < minChannels; ++c) {
+            res[p * vChannels + c] = vJob.bytes[p * vJob.channels + c];
+        }
+    }
+    vJob.bytes = std::move(res);
+    vJob.channels = vChannels;
+}
+
+static bool ImageExport_Resize(ImageExportJob& vJob) {
+    ZoneScoped;
+
+    const int newWidth = vJob.newSize.x;
+    const int newHeight = vJob.newSize.y;
+    const size_t newBufSize = (size_t)newWidth * (size_t)newHeight * (size_t)vJob.channels;
+
+    if (vJob.format == ImageExportFormatEnum::IMAGE_EXPORT_HDR) {
+        std::vector<float> resizedData(newBufSize);
+        const float* resizeRes = stbir_resize_float_linear(  //
+            vJob.floats.data(),
+            vJob.width,
+            vJob.height,
+            vJob.width * vJob.channels * (int)sizeof(float),  //
+            resizedData.data(),
+            newWidth,
+            newHeight,
+            newWidth * vJob.channels * (int)sizeof(float),  //
+            (stbir_pixel_layout)vJob.channels);             //
+        if (!resizeRes)
+            return false;
+        vJob.floats = std::move(resizedData);
+    } else {
+        std::vector<uint8_t> resizedData(newBufSize);
+        const uint8_t* resizeRes = stbir_resize_uint8_linear(  //
+            vJob.bytes.data(),
+            vJob.width,
+            vJob.height,
+            vJob.width * vJob.channels,  //
+            resizedData.data(),
+            newWidth,
+            newHeight,
+            newWidth * vJob.channels,             //
+            (stbir_pixel_layout)vJob.channels);  //
+        if (!resizeRes)
+            return false;
+        vJob.bytes = std::move(resizedData);
+    }
+
+    vJob.width = newWidth;
+    vJob.height = newHeight;
+
+    return true;
+}
+
+const char* ImageExportSystem::GetFormatName(ImageExportFormatEnum vFormat) {
+    switch (vFormat) {
+        case ImageExportFormatEnum::IMAGE_EXPORT_PNG: return "Png";
+        case ImageExportFormatEnum::IMAGE_EXPORT_BMP: return "Bmp";
+        case ImageExportFormatEnum::IMAGE_EXPORT_JPG: return "Jpg";
+        case ImageExportFormatEnum::IMAGE_EXPORT_TGA: return "Tga";
+        case ImageExportFormatEnum::IMAGE_EXPORT_HDR: return "Hdr";
+        default: break;
+    }
+    return "";
+}
+
+bool ImageExportSystem::WriteImageFile(ImageExportJob& vJob, size_t vCountThreads) {
+    ZoneScoped;
+
+    const bool isHdr = (vJob.format == ImageExportFormatEnum::IMAGE_EXPORT_HDR);
+    const size_t countValues = (size_t)vJob.width * (size_t)vJob.height * (size_t)vJob.channels;
+    if (vJob.filePathName.empty() || !countValues || vJob.channels < 1 || vJob.channels > 4 ||  //
+        (isHdr ? vJob.floats.size() : vJob.bytes.size()) < countValues) {
+        LogVarError("Bad picture for %s : %ix%i, %i channels", vJob.filePathName.c_str(), vJob.width, vJob.height, vJob.channels);
+        return false;
+    }
+
+    if (!vCountThreads) {
+        vCountThreads = std::max<size_t>(1U, std::thread::hardware_concurrency());
+    }
+
+    if (vJob.format == ImageExportFormatEnum::IMAGE_EXPORT_BMP || vJob.format == ImageExportFormatEnum::IMAGE_EXPORT_JPG) {
+        ImageExport_ConvertChannels(vJob, 3);
+    }
+
+    // Sub Sampling
+    if (vJob.subSamplesCount > 0) {
+        if (isHdr) {
+            ImageExport_SubSample<float, float>(vJob.floats, vJob.width, vJob.height, vJob.channels, vJob.subSamplesCount, vCountThreads);
+        } else {
+            ImageExport_SubSample<uint8_t, int>(vJob.bytes, vJob.width, vJob.height, vJob.channels, vJob.subSamplesCount, vCountThreads);
+        }
+    }
+
+    // resize
+    if (!vJob.newSize.emptyOR() && (vJob.newSize.x != vJob.width || vJob.newSize.y != vJob.height)) {
+        if (!ImageExport_Resize(vJob)) {
+            LogVarError("Fail to resize the picture %s", vJob.filePathName.c_str());
+            return false;
+        }
+    }
+
+    // stbi_flip_vertically_on_write is global to stb, so not usable from many threads
+    if (vJob.flipY) {
+        if (isHdr) {
+            ImageExport_FlipY(vJob.floats, vJob.width, vJob.height, vJob.channels);
+        } else {
+            ImageExport_FlipY(vJob.bytes, vJob.width, vJob.height, vJob.channels);
+        }
+    }
+
+    int resWrite = 0;
+    const auto* path = vJob.filePathName.c_str();
+    switch (vJob.format) {
+        case ImageExportFormatEnum::IMAGE_EXPORT_PNG:
+            resWrite = stbi_write_png(path, vJob.width, vJob.height, vJob.channels, vJob.bytes.data(), vJob.width * vJob.channels);
+            break;
+        case ImageExportFormatEnum::IMAGE_EXPORT_BMP: resWrite = stbi_write_bmp(path, vJob.width, vJob.height, vJob.channels, vJob.bytes.data()); break;
+        case ImageExportFormatEnum::IMAGE_EXPORT_JPG:
+            resWrite = stbi_write_jpg(path, vJob.width, vJob.height, vJob.channels, vJob.bytes.data(), vJob.jpgQuality);
+            break;
+        case ImageExportFormatEnum::IMAGE_EXPORT_TGA: resWrite = stbi_write_tga(path, vJob.width, vJob.height, vJob.channels, vJob.bytes.data()); break;
+        case ImageExportFormatEnum::IMAGE_EXPORT_HDR: resWrite = stbi_write_hdr(path, vJob.width, vJob.height, vJob.channels, vJob.floats.data()); break;
+        default: break;
+    }
+
+    if (resWrite) {
+        LogVarInfo("%s picture file saved : %s", GetFormatName(vJob.format), path);
+    } else {
+        LogVarError("Fail to save the %s picture file : %s", GetFormatName(vJob.format), path);
+    }
+
+    return (resWrite != 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///// POOL ////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ImageExportSystem::ImageExportSystem() {
+    // one thread is kept for the rendering
+    const size_t countThreads = std::max<size_t>(2U, std::thread::hardware_concurrency());
+    m_CountWorkers = std::min<size_t>(countThreads - 1U, 8U);
+    m_MaxPendingJobs = m_CountWorkers * 2U;
+}
+
+ImageExportSystem::~ImageExportSystem() {
+    StopWorkers();
+}
+
+bool ImageExportSystem::Submit(ImageExportJobPtr vJob) {
+    ZoneScoped;
+
+    if (!vJob || vJob->filePathName.empty())
+        return false;
+
+    while (true) {
+        // wait the end of a restart of the workers
+        StartWorkers();
+
+        std::unique_lock<std::mutex> lock(m_JobsMutex);
+        // backpressure, the render thread wait a free place
+        m_SpaceCondition.wait(lock, [this]() { return m_Jobs.size() < m_MaxPendingJobs || !m_Working; });
+        if (m_Working) {
+            m_Jobs.push_back(std::move(vJob));
+            break;
+        }
+        if (!m_Restarting)
+            return false;
+    }
+    m_JobsCondition.notify_one();
+
+    return true;
+}
+
+void ImageExportSystem::WaitIdle() {
+    std::unique_lock<std::mutex> lock(m_JobsMutex);
+    m_SpaceCondition.wait(lock, [this]() { return (m_Jobs.empty() && !m_CountRunningJobs) || !m_Working; });
+}
+
+void ImageExportSystem::SetCountWorkers(size_t vCountWorkers) {
+    vCountWorkers = std::max<size_t>(1U, vCountWorkers);
+
+    std::lock_guard<std::recursive_mutex> poolLock(m_PoolMutex);
+
+    bool needRestart = false;
+    {
+        std::lock_guard<std::mutex> lock(m_JobsMutex);
+        if (m_CountWorkers != vCountWorkers) {
+            m_CountWorkers = vCountWorkers;
+            needRestart = !m_Workers.empty();
+            m_Restarting = needRestart;
+        }
+    }
+
+    // the pool mutex is kept, so no new submit until the restart is done
+    if (needRestart) {
+        WaitIdle();
+        StopWorkers();
+        StartWorkers();
+        {
+            std::lock_guard<std::mutex> lock(m_JobsMutex);
+            m_Restarting = false;
+        }
+        m_SpaceCondition.notify_all();
+    }
+}
+
+void ImageExportSystem::SetMaxPendingJobs(size_t vMaxPendingJobs) {
+    {
+        std::lock_guard<std::mutex> lock(m_JobsMutex);
+        m_MaxPendingJobs = std::max<size_t>(1U, vMaxPendingJobs);
+    }
+    m_SpaceCondition.notify_all();
+}
+
+size_t ImageExportSystem::GetCountPendingJobs() {
+    std::lock_guard<std::mutex> lock(m_JobsMutex);
+    return m_Jobs.size() + m_CountRunningJobs;
+}
+
+size_t ImageExportSystem::GetCountWrittenFiles() const {
+    return m_CountWrittenFiles;
+}
+
+size_t ImageExportSystem::GetCountFailedFiles() const {
+    return m_CountFailedFiles;
+}
+
+void ImageExportSystem::StartWorkers() {
+    std::lock_guard<std::recursive_mutex> poolLock(m_PoolMutex);
+    std::lock_guard<std::mutex> lock(m_JobsMutex);
+    if (m_Workers.empty()) {
+        m_Working = true;
+        for (size_t i = 0U; i < m_CountWorkers; ++i) {
+            m_Workers.emplace_back(&ImageExportSystem::WorkerLoop, this);
+        }
+    }
+}
+
+void ImageExportSystem::StopWorkers() {
+    std::lock_guard<std::recursive_mutex> poolLock(m_PoolMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_JobsMutex);
+        m_Working = false;
+    }
+    m_JobsCondition.notify_all();
+    m_SpaceCondition.notify_all();
+    for (auto& worker : m_Workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    m_Workers.clear();
+}
+
+void ImageExportSystem::WorkerLoop() {
+    while (true) {
+        ImageExportJobPtr job = nullptr;
+        size_t countThreads = 1U;
+
+        {
+            std::unique_lock<std::mutex> lock(m_JobsMutex);
+            // the pending jobs are finished before the stop
+            m_JobsCondition.wait(lock, [this]() { return !m_Jobs.empty() || !m_Working; });
+            if (m_Jobs.empty())
+                break;
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+            ++m_CountRunningJobs;
+
+            // the free cores are used for the subsampling of this job
+            const size_t countCores = std::max<size_t>(1U, std::thread::hardware_concurrency());
+            countThreads = std::max<size_t>(1U, countCores / std::max<size_t>(1U, m_CountRunningJobs + m_Jobs.size()));
+        }
+        m_SpaceCondition.notify_all();
+
+        if (WriteImageFile(*job, countThreads)) {
+            ++m_CountWrittenFiles;
+        } else {
+            ++m_CountFailedFiles;
+        }
+        job.reset();  // the pixels are released before the notification
+
+        {
+            std::lock_guard<std::mutex> lock(m_JobsMutex);
+            --m_CountRunningJobs;
+        }
+        m_SpaceCondition.notify_all();
+    }
+}
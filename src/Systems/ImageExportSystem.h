@@ -0,0 +1,106 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <ctools/cTools.h>
+
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <list>
+
+enum class ImageExportFormatEnum : uint8_t { IMAGE_EXPORT_PNG = 0, IMAGE_EXPORT_BMP, IMAGE_EXPORT_JPG, IMAGE_EXPORT_TGA, IMAGE_EXPORT_HDR, IMAGE_EXPORT_Count };
+
+// a picture to write, the job own his pixels
+// bytes for the 8 bits formats, floats for hdr
+struct ImageExportJob {
+    std::string filePathName;
+    ImageExportFormatEnum format = ImageExportFormatEnum::IMAGE_EXPORT_PNG;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<uint8_t> bytes;
+    std::vector<float> floats;
+    bool flipY = false;
+    int subSamplesCount = 0;
+    ct::ivec2 newSize;  // empty for keep the size
+    int jpgQuality = 90;
+};
+typedef std::shared_ptr<ImageExportJob> ImageExportJobPtr;
+
+// subsampling, resizing, encoding and writing of the pictures on a bounded pool of workers
+// the render thread only give the pixels, Submit block when the queue is full (backpressure)
+class ImageExportSystem {
+private:
+    std::vector<std::thread> m_Workers;
+    std::recursive_mutex m_PoolMutex;  // the start and the stop of the workers
+    std::mutex m_JobsMutex;
+    std::condition_variable m_JobsCondition;  // a job is available for the workers
+    std::condition_variable m_SpaceCondition;  // a job is finished, for the producers
+    std::list<ImageExportJobPtr> m_Jobs;
+    size_t m_CountRunningJobs = 0U;
+    size_t m_CountWorkers = 0U;
+    size_t m_MaxPendingJobs = 0U;
+    bool m_Working = false;
+    bool m_Restarting = false;  // the workers are stopped for a change of their count
+    std::atomic<size_t> m_CountWrittenFiles{0U};
+    std::atomic<size_t> m_CountFailedFiles{0U};
+
+public:
+    // subsample, resize, flip, encode and write the picture on the calling thread
+    // vCountThreads is the count of threads for the row parallel subsampling
+    static bool WriteImageFile(ImageExportJob& vJob, size_t vCountThreads = 0U);
+    static const char* GetFormatName(ImageExportFormatEnum vFormat);
+
+public:
+    // return false if the job is not valid
+    bool Submit(ImageExportJobPtr vJob);
+    // wait the end of all the submitted jobs
+    void WaitIdle();
+
+    // if the workers are running, the pending jobs are finished, then the workers are restarted
+    // the Submit calls of the other threads wait the end of the restart
+    void SetCountWorkers(size_t vCountWorkers);
+    void SetMaxPendingJobs(size_t vMaxPendingJobs);
+
+    size_t GetCountPendingJobs();
+    size_t GetCountWrittenFiles() const;
+    size_t GetCountFailedFiles() const;
+
+private:
+    void StartWorkers();
+    void StopWorkers();
+    void WorkerLoop();
+
+public:
+    static ImageExportSystem* Instance() {
+        static ImageExportSystem _instance;
+        return &_instance;
+    }
+
+protected:
+    ImageExportSystem();                                    // Prevent construction
+    ImageExportSystem(const ImageExportSystem&) = delete;  // Prevent construction by copying
+    ImageExportSystem& operator=(const ImageExportSystem&) {
+        return *this;
+    };                     // Prevent assignment
+    ~ImageExportSystem();  // Prevent unwanted destruction
+};
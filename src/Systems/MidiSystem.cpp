@@ -28,6 +28,8 @@
 #include <Res/CustomFont.h>
 #include <Gui/GuiBackend.h>
 
+#include <algorithm>
+
 #ifdef USE_SDL2
 
 #else
@@ -42,6 +44,13 @@ void mycallback(double deltatime, std::vector<uint8_t>* message, void* userData)
     MidiSystem::Instance()->AddMessage(deltatime, message, userData);
 }
 
+static MidiMessage MidiSystem_ToMessage(const std::string& vDeviceName, const MidiEvent& vEvent) {
+    MidiMessage msg;
+    msg.name = vDeviceName;
+    msg.bytes.assign(vEvent.bytes, vEvent.bytes + vEvent.countBytes);
+    return msg;
+}
+
 static void Markdown(const std::string& markdown_) {
     ImFont* font = ImGui::GetFont();
 
@@ -76,12 +85,16 @@ MidiSystem::~MidiSystem() {
 bool MidiSystem::Init(CodeTreePtr vCodeTree) {
     m_RtMidis.push_back(std::make_shared<RtMidiIn>());
     m_MidiDevices.push_back(MidiStruct());
+    m_MidiPortQueues.push_back(std::make_unique<MidiPortQueue>());
+    m_DrainedEvents.resize(MIDI_QUEUE_CAPACITY);
 
     return true;
 }
 
 void MidiSystem::Unit() {
+    // the callbacks are stopped before the destruction of their queues
     m_RtMidis.clear();
+    m_MidiPortQueues.clear();
 }
 
 // update va gerer les cas ou on connect/deconnect un device midi
@@ -98,16 +111,10 @@ void MidiSystem::Update() {
         if (countPorts > 0) {
             if (maxOpenedPort == 0) {
                 maxOpenedPort = countPorts;
-                m_RtMidis[0]->openPort(0);
-                m_RtMidis[0]->setCallback(&mycallback, (void*)0);
-                m_RtMidis[0]->ignoreTypes(false, false, false);
-                std::string deviceName = m_RtMidis[0]->getPortName(0);
-                ct::replaceString(deviceName, " ", "");
-                m_MidiDevices[0].deviceName = deviceName;
+                OpenPort(0);
             }
         } else if (maxOpenedPort) {
-            m_RtMidis[0]->closePort();
-            m_RtMidis[0]->cancelCallback();
+            ClosePort(0);
             maxOpenedPort = 0;
         }
 
@@ -115,98 +122,230 @@ void MidiSystem::Update() {
             // il doit toujours rester une instance au mini
             if (countPorts < countInstance && countInstance > 1)  // supression d'instance
             {
-                auto ptr = m_RtMidis.back();
-                if (ptr) {
-                    ptr->closePort();
-                    ptr->cancelCallback();
-                }
+                ClosePort(countInstance - 1);
 
                 m_RtMidis.erase(m_RtMidis.end() - 1);
                 m_MidiDevices.erase(m_MidiDevices.end() - 1);
+                m_MidiPortQueues.erase(m_MidiPortQueues.end() - 1);
             } else if (countPorts > countInstance)  // ajout d'instance
             {
                 m_RtMidis.push_back(std::make_shared<RtMidiIn>(RtMidi::Api::UNSPECIFIED, "RtMidiIn", 2));
                 m_MidiDevices.push_back(MidiStruct());
-                std::string deviceName = (*(m_RtMidis.end() - 1))->getPortName(countInstance);
-                ct::replaceString(deviceName, " ", "");
-                m_MidiDevices.back().deviceName = deviceName;
-                auto ptr = m_RtMidis.back();
-                if (ptr) {
-                    ptr->openPort(countInstance);
-                    ptr->setCallback(&mycallback, (void*)(size_t)countInstance);
-                    ptr->ignoreTypes(false, false, false);
-                }
+                m_MidiPortQueues.push_back(std::make_unique<MidiPortQueue>());
+                OpenPort(countInstance);
             }
         }
     } catch (std::exception ex) {
         LogVarError("Maybe Another app is using the Midi : %s", ex.what());
     }
+
+    DrainMessages();
+}
+
+void MidiSystem::OpenPort(const uint32_t& vPort) {
+    auto ptr = m_RtMidis[vPort];
+    auto queuePtr = m_MidiPortQueues[vPort].get();
+    if (ptr && queuePtr) {
+        std::string deviceName = ptr->getPortName(vPort);
+        ct::replaceString(deviceName, " ", "");
+        m_MidiDevices[vPort].deviceName = deviceName;
+
+        // before the callback, after that the queue is shared with the rtmidi thread
+        queuePtr->port = vPort;
+        queuePtr->deviceId = GetDeviceId(deviceName);
+        queuePtr->timeStamp = 0.0;
+        queuePtr->events.Clear();
+
+        ptr->openPort(vPort);
+        ptr->setCallback(&mycallback, queuePtr);
+        ptr->ignoreTypes(false, false, false);
+    }
+}
+
+void MidiSystem::ClosePort(const uint32_t& vPort) {
+    auto ptr = m_RtMidis[vPort];
+    if (ptr) {
+        ptr->closePort();
+        ptr->cancelCallback();
+    }
+
+    auto queuePtr = m_MidiPortQueues[vPort].get();
+    if (queuePtr) {
+        queuePtr->events.Clear();
+    }
+}
+
+void MidiSystem::DrainMessages() {
+    // the reduced values are only for one frame
+    for (auto& binding : m_Bindings) {
+        binding.newValue = false;
+        binding.deltaValue = 0.0f;
+        binding.countNoteOn = 0U;
+        binding.countNoteOff = 0U;
+    }
+
+    updateMidiNeeded = false;
+
+    for (size_t port = 0U; port < m_MidiPortQueues.size() && port < m_MidiDevices.size(); ++port) {
+        auto queuePtr = m_MidiPortQueues[port].get();
+        if (queuePtr) {
+            // the drain buffer have the capacity of the queue, one pop is enough
+            const size_t count = queuePtr->events.Pop(m_DrainedEvents.data(), m_DrainedEvents.size());
+            if (count) {
+                for (size_t idx = 0U; idx < count; ++idx) {
+                    ReduceEvent(queuePtr->deviceId, m_DrainedEvents[idx]);
+                }
+
+                // only the two last messages are shown by the config pane
+                auto& device = m_MidiDevices[port];
+                if (count > 1U) {
+                    device.lastMessage = MidiSystem_ToMessage(device.deviceName, m_DrainedEvents[count - 2U]);
+                } else {
+                    device.lastMessage = device.currentMessage;
+                }
+                device.currentMessage = MidiSystem_ToMessage(device.deviceName, m_DrainedEvents[count - 1U]);
+
+                updateMidiNeeded = true;  // upload in gpu
+            }
+        }
+    }
+}
+
+void MidiSystem::ReduceEvent(const int32_t& vDeviceId, const MidiEvent& vEvent) {
+    if (vDeviceId < 0 || (size_t)vDeviceId >= m_BindingsByDevice.size() || !vEvent.countBytes)
+        return;
+
+    const uint8_t status = vEvent.bytes[0] & 0xF0;
+    const bool isNoteOff = (status == 0x80) || (status == 0x90 && vEvent.countBytes > 2U && vEvent.bytes[2] == 0U);
+    const bool isNoteOn = (status == 0x90) && !isNoteOff;
+
+    for (const auto& bindingId : m_BindingsByDevice[vDeviceId]) {
+        auto& binding = m_Bindings[bindingId];
+        if (binding.idBytes.size() != (size_t)vEvent.countBytes)  // les deux messages doivent avoir le meme nombre de bytes
+            continue;
+
+        bool match = true;
+        for (size_t j = 0U; j < binding.idBytes.size() && match; ++j) {
+            const int id = binding.idBytes[j];
+            if (id < 0)  // c'est une valeur
+                continue;
+            if (j == 0U && isNoteOff && (id & 0xF0) == 0x90) {
+                // the note off of a note on binding, on the same channel
+                match = ((vEvent.bytes[0] & 0x0F) == (id & 0x0F));
+            } else {
+                match = ((int)vEvent.bytes[j] == id);
+            }
+        }
+
+        if (match) {
+            if (isNoteOff || binding.valueByte >= 0) {
+                const float value = isNoteOff ? 0.0f : (float)vEvent.bytes[binding.valueByte];
+                if (binding.hasValue) {
+                    binding.deltaValue += value - binding.lastValue;
+                }
+                binding.lastValue = value;
+                binding.hasValue = true;
+                binding.newValue = true;
+            }
+            if (isNoteOn) {
+                ++binding.countNoteOn;
+            } else if (isNoteOff) {
+                ++binding.countNoteOff;
+            }
+        }
+    }
+}
+
+int32_t MidiSystem::GetDeviceId(const std::string& vDeviceName) {
+    if (vDeviceName.empty())
+        return -1;
+
+    auto it = m_DeviceIds.find(vDeviceName);
+    if (it != m_DeviceIds.end())
+        return it->second;
+
+    const auto id = (int32_t)m_DeviceNames.size();
+    m_DeviceNames.push_back(vDeviceName);
+    m_DeviceIds[vDeviceName] = id;
+    m_BindingsByDevice.emplace_back();
+    return id;
+}
+
+int32_t MidiSystem::GetBindingId(const std::string& vDeviceName, const std::vector<int>& vIdBytes, const std::vector<uint8_t>& vValueBytes) {
+    const int32_t deviceId = GetDeviceId(vDeviceName);
+    if (deviceId < 0 || vIdBytes.empty() || vIdBytes.size() > MIDI_EVENT_MAX_BYTES)
+        return -1;
+
+    // only the first value byte is used, and it must be a value in the id
+    int32_t valueByte = -1;
+    if (!vValueBytes.empty() && (size_t)vValueBytes[0] < vIdBytes.size() && vIdBytes[vValueBytes[0]] < 0) {
+        valueByte = (int32_t)vValueBytes[0];
+    }
+
+    for (const auto& bindingId : m_BindingsByDevice[deviceId]) {
+        const auto& binding = m_Bindings[bindingId];
+        if (binding.idBytes == vIdBytes && binding.valueByte == valueByte) {
+            return bindingId;
+        }
+    }
+
+    MidiBinding binding;
+    binding.deviceId = deviceId;
+    binding.idBytes = vIdBytes;
+    binding.valueByte = valueByte;
+
+    const auto id = (int32_t)m_Bindings.size();
+    m_Bindings.push_back(binding);
+    m_BindingsByDevice[deviceId].push_back(id);
+    return id;
+}
+
+const MidiBinding* MidiSystem::GetBinding(const int32_t& vBindingId) const {
+    if (vBindingId >= 0 && (size_t)vBindingId < m_Bindings.size()) {
+        return &m_Bindings[vBindingId];
+    }
+    return nullptr;
 }
 
 ///////////////////////////////////////////////////////
 //// WIDGET CONFIGURATION /////////////////////////////
 ///////////////////////////////////////////////////////
 
+// called by the rtmidi thread, only the queue of the port can be used here
 void MidiSystem::AddMessage(double vDeltatime, std::vector<uint8_t>* vMessagePtr, void* vUserDataPtr) {
-    UNUSED(vDeltatime);
-
     if (vMessagePtr && vUserDataPtr) {
-        const size_t& port = (size_t)vUserDataPtr;
-        if (port < m_MidiDevices.size()) {
-            if (!vMessagePtr->empty()) {
-                // vUserData va contenir ici le numero du port
-
-                m_MidiDevices[port].lastMessage = m_MidiDevices[port].currentMessage;
-                m_MidiDevices[port].currentMessage.name = m_MidiDevices[port].deviceName, m_MidiDevices[port].currentMessage.bytes = *vMessagePtr;
-                updateMidiNeeded = true;  // upload in gpu
-            }
+        auto queuePtr = static_cast<MidiPortQueue*>(vUserDataPtr);
+        queuePtr->timeStamp += vDeltatime;
+        // the sysex messages bigger than an event are ignored
+        if (!vMessagePtr->empty() && vMessagePtr->size() <= MIDI_EVENT_MAX_BYTES) {
+            MidiEvent evt;
+            evt.timeStamp = queuePtr->timeStamp;
+            evt.countBytes = (uint32_t)vMessagePtr->size();
+            std::copy(vMessagePtr->begin(), vMessagePtr->end(), evt.bytes);
+            queuePtr->events.Push(evt);  // dropped if the main thread is late of MIDI_QUEUE_CAPACITY messages
         }
     }
 }
 
+// the messages are reduced by DrainMessages, the uniforms only read the reduction of their binding
+// x : the last value, y : the value changes in the frame, z : the note on count, w : the note off count
 bool MidiSystem::UpdateUniforms(UniformVariantPtr vUniPtr) {
     const bool change = false;
 
-    if (vUniPtr && vUniPtr->widget == "midi" && updateMidiNeeded) {
-        bool found = false;
-        ct::fvec4 val = 0.0f;
-
-        const uint32_t& countDevices = GetCountDevices();
-        for (uint32_t i = 0; i < countDevices; i++) {
-            auto msg = GetMidiMessage(i);
-            if (msg.name == vUniPtr->midiDeviceName)  // les deux devices doivent avoir le meme nom
-            {
-                uint32_t count = (uint32_t)vUniPtr->midiId.size();
-                if (msg.bytes.size() == count)  // les deux messages doivent avoir le meme nombre de bytes
-                {
-                    val = 0.0f;
-                    uint32_t vIdx = 0;
-                    for (uint32_t j = 0; j < count; j++) {
-                        if ((int)msg.bytes[j] != vUniPtr->midiId[j])  // si les bytes ne correspondet pas, ca peut etre une valeur
-                        {
-                            if (vUniPtr->midiId[j] < 0)  // si c'est un valeur
-                            {
-                                if (vIdx < (uint32_t)vUniPtr->midiBytes.size() && vIdx < 1) {
-                                    if (vUniPtr->midiBytes[vIdx] == j)  // on prendre le byter 0 de la valeur
-                                    {
-                                        float* ptr = &val.x + vIdx;
-                                        *ptr = msg.bytes[j];
-                                        vIdx++;
-                                        found = true;
-                                    }
-                                }
-                            } else
-                                break;
-                        }
-                    }
+    if (vUniPtr && vUniPtr->widget == "midi") {
+        const auto bindingPtr = GetBinding(vUniPtr->midiBindingId);
+        if (bindingPtr) {
+            if (bindingPtr->newValue) {
+                vUniPtr->x = ct::mix(vUniPtr->inf.x, vUniPtr->sup.x, ct::clamp(bindingPtr->lastValue / 127.0f, 0.0f, 1.0f));
+                if (vUniPtr->step.x) {
+                    vUniPtr->x = (float)(ct::floor(vUniPtr->x / vUniPtr->step.x) * vUniPtr->step.x);
                 }
             }
-        }
 
-        if (found) {
-            vUniPtr->x = ct::mix(vUniPtr->inf.x, vUniPtr->sup.x, ct::clamp(val.x / 127.0f, 0.0f, 1.0f));
-            if (vUniPtr->step.x) {
-                vUniPtr->x = (float)(ct::floor(vUniPtr->x / vUniPtr->step.x) * vUniPtr->step.x);
+            if (vUniPtr->glslType != uType::uTypeEnum::U_FLOAT) {
+                vUniPtr->y = bindingPtr->deltaValue / 127.0f;
+                vUniPtr->z = (float)bindingPtr->countNoteOn;
+                vUniPtr->w = (float)bindingPtr->countNoteOff;
             }
         }
     }
@@ -373,7 +512,13 @@ void MidiSystem::Complete_Uniform(ShaderKeyPtr vParentKey, RenderPackWeak vRende
     vUniform->z = vUniform->def.z;
     vUniform->w = vUniform->def.w;
 
-    if (vUniform->glslType == uType::uTypeEnum::U_FLOAT) {
+    // the device and the controller are resolved one time here, not at each frame
+    vUniform->midiBindingId = GetBindingId(vUniform->midiDeviceName, vUniform->midiId, vUniform->midiBytes);
+
+    if (vUniform->glslType == uType::uTypeEnum::U_FLOAT ||  //
+        vUniform->glslType == uType::uTypeEnum::U_VEC2 ||   //
+        vUniform->glslType == uType::uTypeEnum::U_VEC3 ||   //
+        vUniform->glslType == uType::uTypeEnum::U_VEC4) {
         catched = true;
     }
 
@@ -382,7 +527,7 @@ void MidiSystem::Complete_Uniform(ShaderKeyPtr vParentKey, RenderPackWeak vRende
                                                       "Parsing Error :",
                                                       "Bad Uniform Type",
                                                       false,
-                                                      LineFileErrors(vUniformParsed.sourceCodeLine, "", "uniform of type midi can only be a float for the moment"));
+                                                      LineFileErrors(vUniformParsed.sourceCodeLine, "", "uniform of type midi can only be a float, vec2, vec3 or vec4"));
     }
 }
 
@@ -25,6 +25,7 @@
 #include <Headers/RenderPackHeaders.h>
 #include <CodeTree/Parsing/UniformParsing.h>
 #include <Uniforms/UniformWidgets.h>
+#include <Helper/SpscRingBuffer.h>
 #include <RtMidi.h>
 #include <imgui.h>
 #include <string>
@@ -32,6 +33,40 @@
 #include <unordered_map>
 #include <set>
 
+#define MIDI_EVENT_MAX_BYTES 8
+#define MIDI_QUEUE_CAPACITY 4096  // by port, 4s of a 1 kHz controller
+
+// a midi message as pushed by the rtmidi thread, no allocation
+struct MidiEvent {
+    double timeStamp = 0.0;  // seconds since the opening of the port
+    uint32_t countBytes = 0U;
+    uint8_t bytes[MIDI_EVENT_MAX_BYTES] = {};
+};
+
+// the queue of an opened port, his address is given to the rtmidi callback
+// rtmidi thread => producer, main thread => consumer
+struct MidiPortQueue {
+    uint32_t port = 0U;
+    int32_t deviceId = -1;   // resolved on the main thread at the opening of the port
+    double timeStamp = 0.0;  // owned by the producer
+    SpscRingBuffer<MidiEvent> events = SpscRingBuffer<MidiEvent>(MIDI_QUEUE_CAPACITY);
+};
+
+// an uniform binding, id bytes (-1 for the value bytes) of a device, resolved at parse time
+// the events of a frame are reduced in it
+struct MidiBinding {
+    int32_t deviceId = -1;
+    std::vector<int> idBytes;
+    int32_t valueByte = -1;
+    // reduced for the last frame
+    bool hasValue = false;    // a value was received one time at least
+    bool newValue = false;    // a value was received in the last frame
+    float lastValue = 0.0f;   // [0:127]
+    float deltaValue = 0.0f;  // sum of the value changes of the last frame
+    uint32_t countNoteOn = 0U;
+    uint32_t countNoteOff = 0U;
+};
+
 class CodeTree;
 class ShaderKey;
 class RenderPack;
@@ -47,6 +82,16 @@ private:
     bool m_WasChanged = false;
     bool m_Activated = false;
 
+    // one queue by port, like m_RtMidis
+    std::vector<std::unique_ptr<MidiPortQueue>> m_MidiPortQueues;
+    std::vector<MidiEvent> m_DrainedEvents;
+
+    // the device names and bindings used by the uniforms, by id
+    std::vector<std::string> m_DeviceNames;
+    std::unordered_map<std::string, int32_t> m_DeviceIds;
+    std::vector<MidiBinding> m_Bindings;
+    std::vector<std::vector<int32_t>> m_BindingsByDevice;  // device id => binding ids
+
 public:
     bool Init(CodeTreePtr vCodeTree) override;
     void Unit() override;
@@ -67,6 +112,12 @@ public:
     void Update();
     void AddMessage(double vDeltatime, std::vector<uint8_t>* vMessage, void* vUserData);
 
+    // return an id who is the same for the same device name, -1 if empty
+    int32_t GetDeviceId(const std::string& vDeviceName);
+    // return an id who is the same for the same device and bytes
+    int32_t GetBindingId(const std::string& vDeviceName, const std::vector<int>& vIdBytes, const std::vector<uint8_t>& vValueBytes);
+    const MidiBinding* GetBinding(const int32_t& vBindingId) const;
+
     bool UpdateIfNeeded(ShaderKeyPtr vKey, ct::ivec2 vScreenSize);
     bool WasChanged();
     void ResetChange();  // will reset puWasChanged
@@ -88,6 +139,11 @@ public:
 
 private:
     void DisplayConfigPane(GuiBackend_Window vWin);
+    void OpenPort(const uint32_t& vPort);
+    void ClosePort(const uint32_t& vPort);
+    // pop the messages received since the last frame, and reduce them in the bindings
+    void DrainMessages();
+    void ReduceEvent(const int32_t& vDeviceId, const MidiEvent& vEvent);
 
 public:  // overide
     std::vector<MidiMessage> GetMidiMessages() override;
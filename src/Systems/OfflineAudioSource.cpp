@@ -0,0 +1,247 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "OfflineAudioSource.h"
+
+#include <ctools/Logger.h>
+#include <Profiler/TracyProfiler.h>
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#define OFFLINE_AUDIO_READ_CHUNK_SIZE 4096U  // frames of 2 samples
+
+bool OfflineAudioSource::IsSupportedFile(const std::string& vFilePathName) {
+    auto pos = vFilePathName.find_last_of('.');
+    if (pos != std::string::npos) {
+        auto ext = vFilePathName.substr(pos + 1U);
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        return (ext == "wav" || ext == "flac" || ext == "mp3");
+    }
+    return false;
+}
+
+OfflineAudioSource::~OfflineAudioSource() {
+    Close();
+}
+
+bool OfflineAudioSource::Open(const std::string& vFilePathName) {
+    Close();
+
+    // always the same output format, the resampling is done by miniaudio if needed
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, 2, scSampleRate);
+    const ma_result result = ma_decoder_init_file(vFilePathName.c_str(), &config, &m_Decoder);
+    if (result != MA_SUCCESS) {
+        LogVarError("Failed to decode the sound file %s : %d", vFilePathName.c_str(), result);
+        return false;
+    }
+
+    m_IsOpened = true;
+    m_FilePathName = vFilePathName;
+
+    ma_uint64 length = 0U;
+    if (ma_decoder_get_length_in_pcm_frames(&m_Decoder, &length) == MA_SUCCESS) {
+        m_LengthInSamples = (uint64_t)length;
+    }
+
+    Invalidate();
+
+    return true;
+}
+
+void OfflineAudioSource::Close() {
+    if (m_IsOpened) {
+        ma_decoder_uninit(&m_Decoder);
+        m_IsOpened = false;
+    }
+    m_FilePathName.clear();
+    m_LengthInSamples = 0U;
+    Invalidate();
+}
+
+bool OfflineAudioSource::IsOpened() const {
+    return m_IsOpened;
+}
+
+const std::string& OfflineAudioSource::GetFilePathName() const {
+    return m_FilePathName;
+}
+
+float OfflineAudioSource::GetLengthInSeconds() const {
+    return (float)((double)m_LengthInSamples / (double)scSampleRate);
+}
+
+void OfflineAudioSource::SetLoop(const bool& vLoop) {
+    if (vLoop != m_Loop) {
+        m_Loop = vLoop;
+        Invalidate();
+    }
+}
+
+bool OfflineAudioSource::IsLoop() const {
+    return m_Loop;
+}
+
+void OfflineAudioSource::Invalidate() {
+    m_LastFrame = -1;
+    m_LastFrameRate = 0;
+}
+
+size_t OfflineAudioSource::AnalyseFrame(FFTAnalyzer& vAnalyzer, const int& vFrame, const int& vFrameRate) {
+    ZoneScoped;
+
+    if (!m_IsOpened || vFrame < 0 || vFrameRate <= 0)
+        return 0U;
+
+    if (vFrame == m_LastFrame && vFrameRate == m_LastFrameRate)
+        return 0U;  // already done
+
+    if (vFrame != m_LastFrame + 1 || vFrameRate != m_LastFrameRate) {
+        // not in sequence, only the frames needed by the history and the smoothing are analysed again
+        const int64_t firstFrame = GetPreRollFrame(vAnalyzer, vFrame, vFrameRate);
+        const uint64_t firstSample = GetFrameStartSample(firstFrame, vFrameRate);
+        if (!SeekToSample(firstSample))
+            return 0U;
+        vAnalyzer.Reset(firstSample, GetCountFFTsBefore(vAnalyzer, firstFrame, vFrameRate));
+        for (int64_t frame = firstFrame; frame < (int64_t)vFrame; ++frame) {
+            PushFrame(vAnalyzer, frame, vFrameRate);
+        }
+    }
+
+    const size_t countFFTs = PushFrame(vAnalyzer, vFrame, vFrameRate);
+
+    m_LastFrame = vFrame;
+    m_LastFrameRate = vFrameRate;
+
+    return countFFTs;
+}
+
+uint64_t OfflineAudioSource::GetFrameStartSample(const int64_t& vFrame, const int& vFrameRate) {
+    // integer maths, no rounding error accumulated
+    return ((uint64_t)vFrame * (uint64_t)scSampleRate) / (uint64_t)vFrameRate;
+}
+
+// the count of fft done by a sequential analysis of the frames before vFrame
+// a frame give at most FFTAnalyzer::scMaxFFTsByPush fft
+uint64_t OfflineAudioSource::GetCountFFTsBefore(const FFTAnalyzer& vAnalyzer, const int64_t& vFrame, const int& vFrameRate) {
+    const uint64_t hopSize = (uint64_t)vAnalyzer.GetHopSize();
+    const uint64_t maxSamplesByFrame = GetFrameStartSample(1, vFrameRate) + 1U;
+    if (maxSamplesByFrame <= FFTAnalyzer::scMaxFFTsByPush * hopSize) {
+        return GetFrameStartSample(vFrame, vFrameRate) / hopSize;  // no fft skipped
+    }
+
+    uint64_t countFFTs = 0U;
+    for (int64_t frame = 0; frame < vFrame; ++frame) {
+        const uint64_t start = GetFrameStartSample(frame, vFrameRate);
+        const uint64_t end = GetFrameStartSample(frame + 1, vFrameRate);
+        const uint64_t countHops = (start % hopSize + end - start) / hopSize;
+        countFFTs += std::min<uint64_t>(countHops, FFTAnalyzer::scMaxFFTsByPush);
+    }
+    return countFFTs;
+}
+
+// the first frame to analyse for have vFrame like in a sequential analysis :
+// the fft size samples of the history, and the spectrums kept by the smoothing
+int64_t OfflineAudioSource::GetPreRollFrame(const FFTAnalyzer& vAnalyzer, const int64_t& vFrame, const int& vFrameRate) const {
+    if (m_LengthInSamples == 0U) {
+        return 0;  // unknown length, the seek position can't be found
+    }
+
+    uint64_t countFFTs = 0U;
+    if (vAnalyzer.GetSmoothingMode() == FFTSmoothingModeEnum::FFT_SMOOTHING_EXPONENTIAL) {
+        // the weight of the older spectrums is under 1e-6
+        const double factor = (double)vAnalyzer.GetSmoothingFactor();
+        countFFTs = (factor > 0.0) ? (uint64_t)ceil(log(1e-6) / log(factor)) : 1U;
+    } else {
+        // all the slots of the mean, then a full turn, so the sum is done again from the slots
+        countFFTs = 2U * (uint64_t)vAnalyzer.GetAverageSize();
+    }
+
+    // when a frame have more than FFTAnalyzer::scMaxFFTsByPush hops, some are skipped, so the count of frames is used
+    const uint64_t hopSize = (uint64_t)vAnalyzer.GetHopSize();
+    const uint64_t minSamplesByFrame = GetFrameStartSample(1, vFrameRate);
+    const uint64_t minFFTsByFrame = std::min<uint64_t>(minSamplesByFrame / hopSize, FFTAnalyzer::scMaxFFTsByPush);
+    uint64_t countSamples = (uint64_t)vAnalyzer.GetFFTSize();
+    if (minFFTsByFrame > 0U) {
+        countSamples += ((countFFTs + minFFTsByFrame - 1U) / minFFTsByFrame) * (minSamplesByFrame + 1U);
+    } else {
+        countSamples += countFFTs * hopSize;
+    }
+    const uint64_t frameStart = GetFrameStartSample(vFrame, vFrameRate);
+    if (countSamples >= frameStart) {
+        return 0;
+    }
+
+    // the frame containing the first sample to push
+    const int64_t frame = (int64_t)(((frameStart - countSamples) * (uint64_t)vFrameRate) / (uint64_t)scSampleRate);
+    return std::min(frame, vFrame);
+}
+
+size_t OfflineAudioSource::PushFrame(FFTAnalyzer& vAnalyzer, const int64_t& vFrame, const int& vFrameRate) {
+    const uint64_t start = GetFrameStartSample(vFrame, vFrameRate);
+    const uint64_t end = GetFrameStartSample(vFrame + 1, vFrameRate);
+    const size_t count = (size_t)(end - start);
+    m_MonoSamples.resize(count);
+    ReadSamples(m_MonoSamples.data(), count);
+    // one push by frame, so the result is the same than in a sequential rendering
+    return vAnalyzer.PushSamples(m_MonoSamples.data(), count);
+}
+
+void OfflineAudioSource::ReadSamples(float* vMonoSamples, const size_t& vCount) {
+    m_StereoSamples.resize(OFFLINE_AUDIO_READ_CHUNK_SIZE * 2U);
+
+    size_t countRead = 0U;
+    bool readSinceSeek = true;
+    while (countRead < vCount) {
+        const size_t countToRead = std::min<size_t>(vCount - countRead, OFFLINE_AUDIO_READ_CHUNK_SIZE);
+        ma_uint64 framesRead = 0U;
+        ma_decoder_read_pcm_frames(&m_Decoder, m_StereoSamples.data(), (ma_uint64)countToRead, &framesRead);
+
+        for (size_t i = 0U; i < (size_t)framesRead; ++i) {
+            // moyenne des deux canaux, comme pour la capture
+            vMonoSamples[countRead + i] = (m_StereoSamples[i * 2U] + m_StereoSamples[i * 2U + 1U]) * 0.5f;
+        }
+        countRead += (size_t)framesRead;
+        readSinceSeek |= (framesRead > 0U);
+
+        if (framesRead < (ma_uint64)countToRead) {
+            // end of file, an empty file can't loop
+            if (m_Loop && readSinceSeek && SeekToSample(0U)) {
+                readSinceSeek = false;
+                continue;
+            }
+            memset(vMonoSamples + countRead, 0, sizeof(float) * (vCount - countRead));
+            break;
+        }
+    }
+}
+
+bool OfflineAudioSource::SeekToSample(const uint64_t& vSample) {
+    // same position than a sequential read, after the end it's silence or a loop
+    uint64_t sample = vSample;
+    if (m_LengthInSamples > 0U) {
+        sample = m_Loop ? (sample % m_LengthInSamples) : std::min(sample, m_LengthInSamples);
+    }
+    if (ma_decoder_seek_to_pcm_frame(&m_Decoder, (ma_uint64)sample) != MA_SUCCESS) {
+        LogVarError("Failed to seek in the sound file %s", m_FilePathName.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <Systems/FFTAnalyzer.h>
+
+#include <miniaudio.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// a sound file (wav, flac, mp3) decoded by miniaudio and analysed frame by frame, without audio device
+// the frame N of a rendering at F fps give the samples [N * rate / F, (N + 1) * rate / F[ to the analyzer
+// so the spectrum of a frame depend only of the file, the frame, the frame rate and the analyzer settings
+// if the frames are not given in sequence, the analysis restart a few frames before, enough to fill the history and the smoothing,
+// in the same hop phase, so the spectrum is the same than in sequence (in exponential smoothing, less than 1e-6 of the old spectrums stay)
+class OfflineAudioSource {
+public:
+    static constexpr uint32_t scSampleRate = 44100U;
+
+private:
+    ma_decoder m_Decoder;
+    bool m_IsOpened = false;
+    std::string m_FilePathName;
+    uint64_t m_LengthInSamples = 0U;
+    bool m_Loop = false;
+
+    // the last analysed frame, -1 if the next frame must be analysed again with a pre roll
+    int64_t m_LastFrame = -1;
+    int m_LastFrameRate = 0;
+
+    std::vector<float> m_StereoSamples;
+    std::vector<float> m_MonoSamples;
+
+public:
+    static bool IsSupportedFile(const std::string& vFilePathName);
+
+public:
+    OfflineAudioSource() = default;
+    ~OfflineAudioSource();
+    OfflineAudioSource(const OfflineAudioSource&) = delete;
+    OfflineAudioSource& operator=(const OfflineAudioSource&) = delete;
+
+    bool Open(const std::string& vFilePathName);
+    void Close();
+    bool IsOpened() const;
+    const std::string& GetFilePathName() const;
+    float GetLengthInSeconds() const;
+
+    // after the end of the file, silence or loop
+    void SetLoop(const bool& vLoop);
+    bool IsLoop() const;
+
+    // the next frame will be analysed again with a pre roll, to call when the analyzer settings changed
+    void Invalidate();
+
+    // give to vAnalyzer the samples of vFrame, return the count of fft done
+    size_t AnalyseFrame(FFTAnalyzer& vAnalyzer, const int& vFrame, const int& vFrameRate);
+
+private:
+    static uint64_t GetFrameStartSample(const int64_t& vFrame, const int& vFrameRate);
+    static uint64_t GetCountFFTsBefore(const FFTAnalyzer& vAnalyzer, const int64_t& vFrame, const int& vFrameRate);
+    int64_t GetPreRollFrame(const FFTAnalyzer& vAnalyzer, const int64_t& vFrame, const int& vFrameRate) const;
+    size_t PushFrame(FFTAnalyzer& vAnalyzer, const int64_t& vFrame, const int& vFrameRate);
+    void ReadSamples(float* vMonoSamples, const size_t& vCount);
+    bool SeekToSample(const uint64_t& vSample);
+};
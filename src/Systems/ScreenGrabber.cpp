@@ -22,6 +22,7 @@
 #include "stb_image_resize2.h"
 
 #include "ScreenGrabber.h"
+#include <Systems/ImageExportSystem.h>
 #include <ctools/Logger.h>
 
 ScreenGrabber::ScreenGrabber() {
@@ -32,326 +33,78 @@ ScreenGrabber::~ScreenGrabber() {
 
 bool ScreenGrabber::SaveToPng(const GuiBackend_Window& vWin, const std::string& vFilePathName, int vSubSamplesCount, ct::fvec2
                               /*vNewSize*/) {
-    bool res = false;
-
-    int width;
-    int height;
-    int bufSize;
-    uint8_t* bmBytesRGBA = GetRGBABytesFromWindow(vWin, &width, &height, &bufSize);
-
-    const int bytesPerPixel = 4;
-
-    const int ss = vSubSamplesCount;
-
-    // Sub Sampling
-    if (ss > 0) {
-        uint8_t* tempdata = new uint8_t[bufSize];
-        memcpy(tempdata, bmBytesRGBA, bufSize);
-
-        const unsigned indexMaxSize = width * height;
-        for (unsigned int index = 0; index < indexMaxSize; ++index) {
-            int count = 0;
-            int r = 0, g = 0, b = 0, a = 0;
-
-            for (int i = -ss; i <= ss; i += ss) {
-                for (int j = -ss; j <= ss; j += ss) {
-                    const int ssIndex = index + width * j + i;
-                    if (ssIndex > 0 && (unsigned int)ssIndex < indexMaxSize) {
-                        r += tempdata[ssIndex * bytesPerPixel + 0];
-                        g += tempdata[ssIndex * bytesPerPixel + 1];
-                        b += tempdata[ssIndex * bytesPerPixel + 2];
-                        a += tempdata[ssIndex * bytesPerPixel + 3];
-
-                        count++;
-                    }
-                }
-            }
-
-            bmBytesRGBA[index * bytesPerPixel + 0] = (uint8_t)((float)r / (float)count);
-            bmBytesRGBA[index * bytesPerPixel + 1] = (uint8_t)((float)g / (float)count);
-            bmBytesRGBA[index * bytesPerPixel + 2] = (uint8_t)((float)b / (float)count);
-            bmBytesRGBA[index * bytesPerPixel + 3] = (uint8_t)((float)a / (float)count);
-        }
-
-        SAFE_DELETE_ARRAY(tempdata);
-    }
-
-    // resize
-    /*if (!vNewSize.emptyAND() && (IS_FLOAT_DIFFERENT(vNewSize.x, width) || IS_FLOAT_DIFFERENT(vNewSize.y, height)))
-    {
-        // resize
-        int newWidth = vNewSize.x;
-        int newHeight = vNewSize.y;
-        unsigned int newBufSize = newWidth * newHeight * bytesPerPixel;
-        uint8_t* resizedData = new uint8_t[newBufSize];
-
-        int resizeRes = stbir_resize_uint8(bmBytesRGBA, width, height, width * bytesPerPixel,
-            resizedData, newWidth, newHeight, newWidth * bytesPerPixel,
-            bytesPerPixel);
-
-        if (resizeRes)
-        {
-            stbi_flip_vertically_on_write(1);
-            int resWrite = stbi_write_png(vFilePathName.c_str(),
-                newWidth,
-                newHeight,
-                bytesPerPixel,
-                resizedData,
-                newWidth * bytesPerPixel);
-
-            if (resWrite)
-                res = true;
-        }
-
-        SAFE_DELETE_ARRAY(resizedData);
-    }
-    else*/
-    {
-        stbi_flip_vertically_on_write(1);
-        const int resWrite = stbi_write_png(vFilePathName.c_str(), width, height, bytesPerPixel, bmBytesRGBA, width * bytesPerPixel);
-
-        if (resWrite)
-            res = true;
-    }
-
-    SAFE_DELETE_ARRAY(bmBytesRGBA);
-
-    return res;
+    return SaveToFile(vWin, vFilePathName, ImageExportFormatEnum::IMAGE_EXPORT_PNG, vSubSamplesCount, 0, ct::fvec2());
 }
 
 bool ScreenGrabber::SaveToBmp(const GuiBackend_Window& vWin, const std::string& vFilePathName, int vSubSamplesCount, ct::fvec2 vNewSize) {
-    bool res = false;
-
-    int width;
-    int height;
-    int bufSize;
-    uint8_t* bmBytesRGB = GetRGBABytesFromWindow(vWin, &width, &height, &bufSize);
-
-    const int bytesPerPixel = 3;
-
-    const int ss = vSubSamplesCount;
-
-    // Sub Sampling
-    if (ss > 0) {
-        uint8_t* tempdata = new uint8_t[bufSize];
-        memcpy(tempdata, bmBytesRGB, bufSize);
-
-        const unsigned indexMaxSize = width * height;
-        for (unsigned int index = 0; index < indexMaxSize; ++index) {
-            int count = 0;
-            int r = 0, g = 0, b = 0;  // , a = 0;
-
-            for (int i = -ss; i <= ss; i += ss) {
-                for (int j = -ss; j <= ss; j += ss) {
-                    const int ssIndex = index + width * j + i;
-                    if (ssIndex > 0 && (unsigned int)ssIndex < indexMaxSize) {
-                        r += tempdata[ssIndex * bytesPerPixel + 0];
-                        g += tempdata[ssIndex * bytesPerPixel + 1];
-                        b += tempdata[ssIndex * bytesPerPixel + 2];
-
-                        count++;
-                    }
-                }
-            }
-
-            bmBytesRGB[index * bytesPerPixel + 0] = (uint8_t)((float)r / (float)count);
-            bmBytesRGB[index * bytesPerPixel + 1] = (uint8_t)((float)g / (float)count);
-            bmBytesRGB[index * bytesPerPixel + 2] = (uint8_t)((float)b / (float)count);
-        }
-
-        SAFE_DELETE_ARRAY(tempdata);
-    }
-
-    // resize
-    if (IS_FLOAT_DIFFERENT(vNewSize.x, width) || IS_FLOAT_DIFFERENT(vNewSize.y, height)) {
-        // resize
-        const int newWidth = (int)vNewSize.x;
-        const int newHeight = (int)vNewSize.y;
-        const unsigned int newBufSize = newWidth * newHeight * bytesPerPixel;
-        uint8_t* resizedData = new uint8_t[newBufSize];
-
-        const auto* resizeRes = stbir_resize_uint8_linear(
-            bmBytesRGB, width, height, width * bytesPerPixel, resizedData, newWidth, newHeight, newWidth * bytesPerPixel, (stbir_pixel_layout)bytesPerPixel);
-
-        if (resizeRes) {
-            stbi_flip_vertically_on_write(1);
-            const int resWrite = stbi_write_bmp(vFilePathName.c_str(), newWidth, newHeight, bytesPerPixel, resizedData);
-
-            if (resWrite)
-                res = true;
-        }
-
-        SAFE_DELETE_ARRAY(resizedData);
-    } else {
-        stbi_flip_vertically_on_write(1);
-        const int resWrite = stbi_write_bmp(vFilePathName.c_str(), width, height, bytesPerPixel, bmBytesRGB);
-
-        if (resWrite)
-            res = true;
-    }
-
-    SAFE_DELETE_ARRAY(bmBytesRGB);
-
-    return res;
+    return SaveToFile(vWin, vFilePathName, ImageExportFormatEnum::IMAGE_EXPORT_BMP, vSubSamplesCount, 0, vNewSize);
 }
 
 bool ScreenGrabber::SaveToJpg(const GuiBackend_Window& vWin, const std::string& vFilePathName, int vSubSamplesCount, int vQualityFrom0To100, ct::fvec2 vNewSize) {
-    bool res = false;
-
-    int width;
-    int height;
-    int bufSize;
-    const int bytesPerPixel = 3;
-    uint8_t* bmBytesRGB = GetRGBABytesFromWindow(vWin, &width, &height, &bufSize);
-
-    const int ss = vSubSamplesCount;
-
-    // Sub Sampling
-    if (ss > 0) {
-        uint8_t* tempdata = new uint8_t[bufSize];
-        memcpy(tempdata, bmBytesRGB, bufSize);
-
-        const unsigned indexMaxSize = width * height;
-        for (unsigned int index = 0; index < indexMaxSize; ++index) {
-            int count = 0;
-            int r = 0, g = 0, b = 0;  // , a = 0;
-
-            for (int i = -ss; i <= ss; i += ss) {
-                for (int j = -ss; j <= ss; j += ss) {
-                    const int ssIndex = index + width * j + i;
-                    if (ssIndex > 0 && (unsigned int)ssIndex < indexMaxSize) {
-                        r += tempdata[ssIndex * bytesPerPixel + 0];
-                        g += tempdata[ssIndex * bytesPerPixel + 1];
-                        b += tempdata[ssIndex * bytesPerPixel + 2];
-
-                        count++;
-                    }
-                }
-            }
-
-            bmBytesRGB[index * bytesPerPixel + 0] = (uint8_t)((float)r / (float)count);
-            bmBytesRGB[index * bytesPerPixel + 1] = (uint8_t)((float)g / (float)count);
-            bmBytesRGB[index * bytesPerPixel + 2] = (uint8_t)((float)b / (float)count);
-        }
-
-        SAFE_DELETE_ARRAY(tempdata);
-    }
-
-    // resize
-    if (IS_FLOAT_DIFFERENT(vNewSize.x, width) || IS_FLOAT_DIFFERENT(vNewSize.y, height)) {
-        // resize
-        const int newWidth = (int)vNewSize.x;
-        const int newHeight = (int)vNewSize.y;
-        const unsigned int newBufSize = newWidth * newHeight * bytesPerPixel;
-        uint8_t* resizedData = new uint8_t[newBufSize];
-
-        const auto* resizeRes = stbir_resize_uint8_linear(
-            bmBytesRGB, width, height, width * bytesPerPixel, resizedData, newWidth, newHeight, newWidth * bytesPerPixel, (stbir_pixel_layout)bytesPerPixel);
-
-        if (resizeRes) {
-            stbi_flip_vertically_on_write(1);
-            const int resWrite = stbi_write_jpg(vFilePathName.c_str(), newWidth, newHeight, bytesPerPixel, resizedData, vQualityFrom0To100);
-
-            if (resWrite)
-                res = true;
-        }
-
-        SAFE_DELETE_ARRAY(resizedData);
-    } else {
-        stbi_flip_vertically_on_write(1);
-        const int resWrite = stbi_write_jpg(vFilePathName.c_str(), width, height, bytesPerPixel, bmBytesRGB, vQualityFrom0To100);
-
-        if (resWrite)
-            res = true;
-    }
-
-    SAFE_DELETE_ARRAY(bmBytesRGB);
-
-    return res;
+    return SaveToFile(vWin, vFilePathName, ImageExportFormatEnum::IMAGE_EXPORT_JPG, vSubSamplesCount, vQualityFrom0To100, vNewSize);
 }
 
 bool ScreenGrabber::SaveToTga(const GuiBackend_Window& vWin, const std::string& vFilePathName, int vSubSamplesCount, ct::fvec2 vNewSize) {
-    bool res = false;
-
-    int width;
-    int height;
-    int bufSize;
-    uint8_t* bmBytesRGBA = GetRGBABytesFromWindow(vWin, &width, &height, &bufSize);
-
-    const int bytesPerPixel = 4;
-
-    const int ss = vSubSamplesCount;
-
-    // Sub Sampling
-    if (ss > 0) {
-        uint8_t* tempdata = new uint8_t[bufSize];
-        memcpy(tempdata, bmBytesRGBA, bufSize);
-
-        const unsigned indexMaxSize = width * height;
-        for (unsigned int index = 0; index < indexMaxSize; ++index) {
-            int count = 0;
-            int r = 0, g = 0, b = 0, a = 0;
-
-            for (int i = -ss; i <= ss; i += ss) {
-                for (int j = -ss; j <= ss; j += ss) {
-                    const int ssIndex = index + width * j + i;
-                    if (ssIndex > 0 && (unsigned int)ssIndex < indexMaxSize) {
-                        r += tempdata[ssIndex * bytesPerPixel + 0];
-                        g += tempdata[ssIndex * bytesPerPixel + 1];
-                        b += tempdata[ssIndex * bytesPerPixel + 2];
-                        a += tempdata[ssIndex * bytesPerPixel + 3];
-
-                        count++;
-                    }
-                }
-            }
-
-            bmBytesRGBA[index * bytesPerPixel + 0] = (uint8_t)((float)r / (float)count);
-            bmBytesRGBA[index * bytesPerPixel + 1] = (uint8_t)((float)g / (float)count);
-            bmBytesRGBA[index * bytesPerPixel + 2] = (uint8_t)((float)b / (float)count);
-            bmBytesRGBA[index * bytesPerPixel + 3] = (uint8_t)((float)a / (float)count);
-        }
+    return SaveToFile(vWin, vFilePathName, ImageExportFormatEnum::IMAGE_EXPORT_TGA, vSubSamplesCount, 0, vNewSize);
+}
 
-        SAFE_DELETE_ARRAY(tempdata);
+std::future<ReadBackResultPtr> ScreenGrabber::ReadRGBABytesFromWindowAsync(const GuiBackend_Window& vWin, ReadBackCallback vCallback) {
+    auto& readBack = m_AsyncReadBacks[(void*)vWin.win];
+    if (!readBack) {
+        readBack = std::make_unique<AsyncReadBack>(vWin);
     }
 
-    // resize
-    if (IS_FLOAT_DIFFERENT(vNewSize.x, width) || IS_FLOAT_DIFFERENT(vNewSize.y, height)) {
-        // resize
-        const int newWidth = (int)vNewSize.x;
-        const int newHeight = (int)vNewSize.y;
-        const unsigned int newBufSize = newWidth * newHeight * bytesPerPixel;
-        uint8_t* resizedData = new uint8_t[newBufSize];
-
-        const auto* resizeRes = stbir_resize_uint8_linear(
-            bmBytesRGBA, width, height, width * bytesPerPixel, resizedData, newWidth, newHeight, newWidth * bytesPerPixel, (stbir_pixel_layout)bytesPerPixel);
-
-        if (resizeRes) {
-            stbi_flip_vertically_on_write(1);
-            const int resWrite = stbi_write_tga(vFilePathName.c_str(), newWidth, newHeight, bytesPerPixel, resizedData);
-
-            if (resWrite)
-                res = true;
-        }
+    int width = 0;
+    int height = 0;
+    GuiBackend::Instance()->GetWindowSize(vWin, &width, &height);
 
-        SAFE_DELETE_ARRAY(resizedData);
-    } else {
-        stbi_flip_vertically_on_write(1);
-        const int resWrite = stbi_write_tga(vFilePathName.c_str(), width, height, bytesPerPixel, bmBytesRGBA);
+    return readBack->ReadPixels(0, GL_BACK, ct::ivec4(0, 0, width, height), GL_RGBA, GL_UNSIGNED_BYTE, vCallback);
+}
 
-        if (resWrite)
-            res = true;
+size_t ScreenGrabber::UpdateAsyncReadBacks() {
+    size_t count = 0U;
+    for (auto& readBack : m_AsyncReadBacks) {
+        count += readBack.second->Update();
     }
+    return count;
+}
 
-    SAFE_DELETE_ARRAY(bmBytesRGBA);
-
-    return res;
+void ScreenGrabber::FlushAsyncReadBacks() {
+    for (auto& readBack : m_AsyncReadBacks) {
+        readBack.second->Flush();
+    }
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// PRIVATE ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+bool ScreenGrabber::SaveToFile(const GuiBackend_Window& vWin,
+                               const std::string& vFilePathName,
+                               ImageExportFormatEnum vFormat,
+                               int vSubSamplesCount,
+                               int vQualityFrom0To100,
+                               ct::fvec2 vNewSize) {
+    ImageExportJob job;
+    job.filePathName = vFilePathName;
+    job.format = vFormat;
+    job.flipY = true;
+    job.subSamplesCount = vSubSamplesCount;
+    job.newSize = ct::ivec2((int)vNewSize.x, (int)vNewSize.y);
+    job.jpgQuality = vQualityFrom0To100;
+    job.channels = 4;
+
+    int bufSize = 0;
+    uint8_t* bmBytesRGBA = GetRGBABytesFromWindow(vWin, &job.width, &job.height, &bufSize);
+    if (!bmBytesRGBA)
+        return false;
+    job.bytes.assign(bmBytesRGBA, bmBytesRGBA + bufSize);
+    SAFE_DELETE_ARRAY(bmBytesRGBA);
+
+    // bmp and jpg are converted to RGB by the export
+    return ImageExportSystem::WriteImageFile(job);
+}
+
 uint8_t* ScreenGrabber::GetRGBABytesFromWindow(const GuiBackend_Window& vWin, int* vWidth, int* vHeight, int* vBufSize) {
     GuiBackend::MakeContextCurrent(vWin);
 
@@ -17,10 +17,18 @@
 
 #include <ctools/cTools.h>
 #include <Headers/RenderPackHeaders.h>
+#include <Buffer/AsyncReadBack.h>
+
+#include <map>
+#include <memory>
 
 class FloatBuffer;
+enum class ImageExportFormatEnum : uint8_t;
 
 class ScreenGrabber {
+private:
+    std::map<void*, std::unique_ptr<AsyncReadBack>> m_AsyncReadBacks;  // by window
+
 public:
     static ScreenGrabber* Instance() {
         static ScreenGrabber _instance;
@@ -41,7 +49,18 @@ public:  // save screenshot to file format
     bool SaveToJpg(const GuiBackend_Window& vWin, const std::string& vFilePathName, int vSubSamplesCount, int vQualityFrom0To100, ct::fvec2 vNewSize);
     bool SaveToTga(const GuiBackend_Window& vWin, const std::string& vFilePathName, int vSubSamplesCount, ct::fvec2 vNewSize);
 
+public:  // async grab of the back buffer, the bytes come some frames later (see AsyncReadBack)
+    std::future<ReadBackResultPtr> ReadRGBABytesFromWindowAsync(const GuiBackend_Window& vWin, ReadBackCallback vCallback = nullptr);
+    size_t UpdateAsyncReadBacks();
+    void FlushAsyncReadBacks();
+
 private:
+    bool SaveToFile(const GuiBackend_Window& vWin,
+                    const std::string& vFilePathName,
+                    ImageExportFormatEnum vFormat,
+                    int vSubSamplesCount,
+                    int vQualityFrom0To100,
+                    ct::fvec2 vNewSize);
     uint8_t* GetRGBABytesFromWindow(const GuiBackend_Window& vWin, int* vWidth, int* vHeight, int* vBufSize);
     std::shared_ptr<FloatBuffer> GetFloatBufferFromWindow_4_Chan(const GuiBackend_Window& vWin);
 };
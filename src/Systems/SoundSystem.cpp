@@ -22,6 +22,7 @@
 #include <imgui.h>
 #include <Gui/CustomGuiWidgets.h>
 #include <Systems/CameraSystem.h>
+#include <Systems/TimeLineSystem.h>
 #include <CodeTree/Parsing/SectionCode.h>
 #include <CodeTree/ShaderKey.h>
 #include <ctools/Logger.h>
@@ -44,6 +45,7 @@ bool SoundSystem::Init(CodeTreePtr vCodeTree) {
 
 void SoundSystem::Unit() {
     UnitAudioDriver();
+    m_OfflineAudioSource.Close();
 }
 
 bool SoundSystem::Use() {
@@ -82,13 +84,13 @@ bool SoundSystem::DrawTooltips(RenderPackWeak /*vRenderPack*/, float /*vDisplayQ
     return change;
 }
 
-static inline ImPlotPoint fft_points(int idx, void* /*user_data*/) {
-    if (ImPlot::IsPlotHovered()) {
+static inline ImPlotPoint fft_points(int idx, void* user_data) {
+    if (ImPlot::IsPlotHovered() && user_data) {
         auto pi = (int)ImPlot::PixelsToPlot(ImGui::GetMousePos()).x;
         if (pi == idx) {
-            static float af = 1.0f / (float)SoundSystem::scFftSize;
-            auto uvx = ct::clamp(idx * af, 0.0f, 1.0f);
-            auto hz = 44100.0f * uvx;
+            const auto* analyzer_ptr = (const FFTAnalyzer*)user_data;
+            auto uvx = ct::clamp(idx / (float)analyzer_ptr->GetCountBins(), 0.0f, 1.0f);
+            auto hz = 44100.0f * idx / (float)analyzer_ptr->GetFFTSize();
             ImGui::SetTooltip("Hz : %.4f\nuv.x : %.4f", hz, uvx);
         }
     }
@@ -105,77 +107,134 @@ bool SoundSystem::DrawPane(CodeTreePtr vCodeTree, RenderPackWeak vRenderPack, fl
             if (ImGui::CollapsingHeader("Sound System")) {
                 ImGui::Indent();
 
-                if (ImGui::ContrastedButton("Refresh")) {
-                    EnumerateAudioDevices();
+                const auto paneWidth = ImGui::GetContentRegionAvail().x;
+
+                bool analysisChange = false;
+
+                int soundSource = (int)m_SoundSource;
+                if (ImGui::ContrastedCombo(paneWidth, "Source", &soundSource, "Audio device\0Sound file\0\0", -1)) {
+                    SetSoundSource((SoundSourceEnum)soundSource);
                 }
 
-                if (!m_AudioDevices.empty()) {
-                    if (m_CurrentAudioDeviceIndex >= m_AudioDevices.size()) {
-                        SelectAudioDevice(m_CurrentAudioDeviceIndex);
+                if (IsOfflineMode()) {
+                    if (ImGui::ContrastedButton("Open sound file")) {
+                        OpenSoundFileDialog();
+                    }
+                    if (m_OfflineAudioSource.IsOpened()) {
+                        ImGui::Text("File : %s", m_SoundFilePathName.c_str());
+                        ImGui::Text("Length : %.2f s", m_OfflineAudioSource.GetLengthInSeconds());
+                        int frameRate = 0;
+                        const int frame = GetOfflineFrame(&frameRate);
+                        ImGui::Text("Frame : %i at %i fps", frame, frameRate);
+                    } else if (!m_SoundFilePathName.empty()) {
+                        ImGui::Text("Failed to open %s", m_SoundFilePathName.c_str());
+                    }
+                    bool loop = m_OfflineAudioSource.IsLoop();
+                    if (ImGui::CheckBoxBoolDefault("Loop", &loop, false)) {
+                        m_OfflineAudioSource.SetLoop(loop);
+                        InvalidateOfflineAnalysis();
+                    }
+                    // the frame rate of the timeline is used during his renderings
+                    if (ImGui::SliderIntDefaultCompact(paneWidth, "Frame rate", &m_OfflineFrameRate, 1, 240, 60)) {
+                        m_OfflineFrameRate = ct::maxi(m_OfflineFrameRate, 1);
+                    }
+                    if (ImGui::ContrastedButton("Restart")) {
+                        m_OfflineFrame = 0;
+                        InvalidateOfflineAnalysis();
                     }
+                } else if (ImGui::ContrastedButton("Refresh")) {
+                    EnumerateAudioDevices();
+                }
+
+                if (IsOfflineMode() || !m_AudioDevices.empty()) {
+                    if (!IsOfflineMode()) {
+                        if (m_CurrentAudioDeviceIndex >= m_AudioDevices.size()) {
+                            SelectAudioDevice(m_CurrentAudioDeviceIndex);
+                        }
+
+                        ImGui::Text("Audio devices :");
+                        ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x);
+                        if (ImGui::BeginContrastedCombo("##Audio devices", m_AudioDevices[m_CurrentAudioDeviceIndex].name, ImGuiComboFlags_None)) {
+                            size_t idx = 0U;
+                            for (const auto& device : m_AudioDevices) {
+                                if (ImGui::Selectable(device.name, m_CurrentAudioDeviceIndex == idx)) {
+                                    SelectAudioDevice(idx);
+                                }
 
-                    ImGui::Text("Audio devices :");
-                    ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x);
-                    if (ImGui::BeginContrastedCombo("##Audio devices", m_AudioDevices[m_CurrentAudioDeviceIndex].name, ImGuiComboFlags_None)) {
-                        size_t idx = 0U;
-                        for (const auto& device : m_AudioDevices) {
-                            if (ImGui::Selectable(device.name, m_CurrentAudioDeviceIndex == idx)) {
-                                SelectAudioDevice(idx);
+                                ++idx;
                             }
 
-                            ++idx;
+                            ImGui::EndCombo();
                         }
+                        ImGui::PopItemWidth();
 
-                        ImGui::EndCombo();
-                    }
-                    ImGui::PopItemWidth();
+                        ImGui::Separator();
 
-                    ImGui::Separator();
+                        const auto& current_device = m_AudioDevices[m_CurrentAudioDeviceIndex];
 
-                    const auto& current_device = m_AudioDevices[m_CurrentAudioDeviceIndex];
+                        // ImGui::Text("%s", current_device.name);
+                        // ImGui::Text("%u", current_device.id);
 
-                    // ImGui::Text("%s", current_device.name);
-                    // ImGui::Text("%u", current_device.id);
+                        ImGui::Text("Formats :");
+                        ImGui::Indent();
+                        for (size_t i = 0U; i < current_device.nativeDataFormatCount; ++i) {
+                            if (i) {
+                                ImGui::Text("");
+                            }
 
-                    ImGui::Text("Formats :");
-                    ImGui::Indent();
-                    for (size_t i = 0U; i < current_device.nativeDataFormatCount; ++i) {
-                        if (i) {
-                            ImGui::Text("");
+                            const auto& data_format = current_device.nativeDataFormats[i];
+                            ImGui::Text("Channels : %u", data_format.channels);
+                            ImGui::Text("Sample rate : %u", data_format.sampleRate);
+
+                            switch (data_format.format) {
+                                case ma_format_unknown: ImGui::Text("Type : Unknow"); break;
+                                case ma_format_u8: ImGui::Text("Type : U8"); break;
+                                case ma_format_s16: ImGui::Text("Type : S16"); break;
+                                case ma_format_s24: ImGui::Text("Type : S24"); break;
+                                case ma_format_s32: ImGui::Text("Type : S32"); break;
+                                case ma_format_f32: ImGui::Text("Type : F32"); break;
+                                case ma_format_count:
+                                default: break;
+                            }
                         }
+                        ImGui::Unindent();
 
-                        const auto& data_format = current_device.nativeDataFormats[i];
-                        ImGui::Text("Channels : %u", data_format.channels);
-                        ImGui::Text("Sample rate : %u", data_format.sampleRate);
-
-                        switch (data_format.format) {
-                            case ma_format_unknown: ImGui::Text("Type : Unknow"); break;
-                            case ma_format_u8: ImGui::Text("Type : U8"); break;
-                            case ma_format_s16: ImGui::Text("Type : S16"); break;
-                            case ma_format_s24: ImGui::Text("Type : S24"); break;
-                            case ma_format_s32: ImGui::Text("Type : S32"); break;
-                            case ma_format_f32: ImGui::Text("Type : F32"); break;
-                            case ma_format_count:
-                            default: break;
+                        ImGui::Separator();
+
+                        if (current_device.name[1] == 'i')  // [in] => mic
+                        {
+                        } else if (current_device.name[1] == 'o')  // [out] => playback
+                        {
                         }
                     }
-                    ImGui::Unindent();
 
-                    ImGui::Separator();
+                    ImGui::Header("FFT Sound");
 
-                    if (current_device.name[1] == 'i')  // [in] => mic
-                    {
-                    } else if (current_device.name[1] == 'o')  // [out] => playback
-                    {
-                    }
+                    const auto aw = paneWidth;
 
-                    ImGui::Header("FFT Sound");
+                    static const size_t s_FFTSizes[] = {256U, 512U, 1024U, 2048U, 4096U, 8192U};
+                    int fftSizeIndex = 0;
+                    while (fftSizeIndex < 5 && s_FFTSizes[fftSizeIndex] < m_FFTAnalyzer.GetFFTSize()) {
+                        ++fftSizeIndex;
+                    }
+                    if (ImGui::ContrastedCombo(aw, "FFT Size", &fftSizeIndex, "256\0" "512\0" "1024\0" "2048\0" "4096\0" "8192\0\0", -1)) {
+                        const auto hopRatio = (float)m_FFTAnalyzer.GetHopSize() / (float)m_FFTAnalyzer.GetFFTSize();
+                        m_FFTAnalyzer.SetFFTSize(s_FFTSizes[fftSizeIndex]);
+                        m_FFTAnalyzer.SetHopSize((size_t)(hopRatio * m_FFTAnalyzer.GetFFTSize()));
+                        analysisChange = true;
+                    }
 
-                    const auto aw = ImGui::GetContentRegionAvail().x;
+                    size_t hopSize = m_FFTAnalyzer.GetHopSize();
+                    if (ImGui::SliderSizeTDefaultCompact(aw, "Hop Size", &hopSize, 32U, m_FFTAnalyzer.GetFFTSize(), m_FFTAnalyzer.GetFFTSize())) {
+                        m_FFTAnalyzer.SetHopSize(hopSize);
+                        analysisChange = true;
+                    }
 
-                    if (ImGui::SliderSizeTDefaultCompact(aw, "Count Points", &m_CountDisplayPoints, 1U, scFftSize, 150U)) {
-                        m_CountDisplayPoints = ct::clamp<size_t>(m_CountDisplayPoints, 1U, scFftSize);
+                    const auto countBins = m_FFTAnalyzer.GetCountBins();
+                    if (ImGui::SliderSizeTDefaultCompact(aw, "Count Points", &m_CountDisplayPoints, 1U, countBins, 150U)) {
+                        m_CountDisplayPoints = ct::clamp<size_t>(m_CountDisplayPoints, 1U, countBins);
                     }
+                    const auto countDisplayPoints = ct::mini(m_CountDisplayPoints, countBins);
 
                     if (ImPlot::BeginPlot("FFT", ImVec2(aw, 150.0f), ImPlotFlags_NoChild | ImPlotFlags_CanvasOnly | ImPlotFlags_NoFrame)) {
                         ImPlot::SetupAxes(nullptr,
@@ -184,23 +243,53 @@ bool SoundSystem::DrawPane(CodeTreePtr vCodeTree, RenderPackWeak vRenderPack, fl
                                           ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_NoDecorations | ImPlotAxisFlags_NoMenus);
                         ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 1.0f);
 
-                        ImPlot::PlotBars("##FFTPoints", m_AverageFFTValues, (int)m_CountDisplayPoints, 0.67f);
-                        ImPlot::PlotBarsG("##FFTPoints2", fft_points, m_AverageFFTValues, (int)m_CountDisplayPoints, 0.67f);
+                        ImPlot::PlotBars("##FFTPoints", m_FFTAnalyzer.GetSpectrum(), (int)countDisplayPoints, 0.67f);
+                        ImPlot::PlotBarsG("##FFTPoints2", fft_points, &m_FFTAnalyzer, (int)countDisplayPoints, 0.67f);
 
                         ImPlot::EndPlot();
                     }
 
                     if (ImGui::SliderFloatDefaultCompact(aw, "Audio Amplification", &m_AudioFloatAmplification, 0.0f, 500.0f, 100.0f)) {
                         m_AudioFloatAmplification = ct::maxi(m_AudioFloatAmplification, 1.0f);
+                        analysisChange = true;
+                    }
+
+                    int smoothingMode = (int)m_FFTAnalyzer.GetSmoothingMode();
+                    if (ImGui::ContrastedCombo(aw, "Smoothing", &smoothingMode, "Mean\0Exponential\0\0", -1)) {
+                        m_FFTAnalyzer.SetSmoothingMode((FFTSmoothingModeEnum)smoothingMode);
+                        analysisChange = true;
                     }
 
-                    if (ImGui::SliderSizeTDefaultCompact(aw, "Mean Average size", &m_CurrentAverageSize, 1U, scMaxAverageSize, 3U)) {
-                        m_CurrentAverageSize = ct::clamp<size_t>(m_CurrentAverageSize, 1U, scMaxAverageSize);
+                    if (m_FFTAnalyzer.GetSmoothingMode() == FFTSmoothingModeEnum::FFT_SMOOTHING_MEAN) {
+                        size_t averageSize = m_FFTAnalyzer.GetAverageSize();
+                        if (ImGui::SliderSizeTDefaultCompact(aw, "Mean Average size", &averageSize, 1U, FFTAnalyzer::scMaxAverageSize, 3U)) {
+                            m_FFTAnalyzer.SetAverageSize(averageSize);
+                            analysisChange = true;
+                        }
+                    } else {
+                        float smoothingFactor = m_FFTAnalyzer.GetSmoothingFactor();
+                        if (ImGui::SliderFloatDefaultCompact(aw, "Smoothing factor", &smoothingFactor, 0.0f, 0.99f, 0.8f)) {
+                            m_FFTAnalyzer.SetSmoothingFactor(smoothingFactor);
+                            analysisChange = true;
+                        }
+                    }
 
-                        // reset
-                        m_AverageLastValueIndex = 0U;
-                        memset(m_AverageFFTDatas, 0, sizeof(float) * SoundSystem::scFftSize * SoundSystem::scMaxAverageSize);
-                        memset(m_AverageFFTValues, 0, sizeof(float) * SoundSystem::scFftSize);
+                    bool logScale = m_FFTAnalyzer.IsLogScale();
+                    float minDecibels = m_FFTAnalyzer.GetMinDecibels();
+                    float maxDecibels = m_FFTAnalyzer.GetMaxDecibels();
+                    bool logScaleChange = ImGui::CheckBoxBoolDefault("Log scale (dB)", &logScale, false);
+                    if (logScale) {
+                        logScaleChange |= ImGui::SliderFloatDefaultCompact(aw, "Min dB", &minDecibels, -200.0f, 0.0f, -100.0f);
+                        logScaleChange |= ImGui::SliderFloatDefaultCompact(aw, "Max dB", &maxDecibels, -200.0f, 0.0f, -30.0f);
+                    }
+                    if (logScaleChange) {
+                        m_FFTAnalyzer.SetLogScale(logScale, minDecibels, maxDecibels);
+                        analysisChange = true;
+                    }
+
+                    if (analysisChange && IsOfflineMode()) {
+                        // the frames already analysed with the old settings are analysed again
+                        InvalidateOfflineAnalysis();
                     }
 
                     if (m_SoundHisto_RenderPack_Ptr) {
@@ -236,8 +325,19 @@ std::string SoundSystem::getXml(const std::string& vOffset, const std::string& v
 
     str += vOffset + "\t<active>" + ct::toStr(puActivated ? "true" : "false") + "</active>\n";
     str += vOffset + "\t<audio_amplification>" + ct::toStr(m_AudioFloatAmplification) + "</audio_amplification>\n";
-    str += vOffset + "\t<average_size>" + ct::toStr(m_CurrentAverageSize) + "</average_size>\n";
+    str += vOffset + "\t<fft_size>" + ct::toStr(m_FFTAnalyzer.GetFFTSize()) + "</fft_size>\n";
+    str += vOffset + "\t<hop_size>" + ct::toStr(m_FFTAnalyzer.GetHopSize()) + "</hop_size>\n";
+    str += vOffset + "\t<smoothing_mode>" + ct::toStr((int)m_FFTAnalyzer.GetSmoothingMode()) + "</smoothing_mode>\n";
+    str += vOffset + "\t<average_size>" + ct::toStr(m_FFTAnalyzer.GetAverageSize()) + "</average_size>\n";
+    str += vOffset + "\t<smoothing_factor>" + ct::toStr(m_FFTAnalyzer.GetSmoothingFactor()) + "</smoothing_factor>\n";
+    str += vOffset + "\t<log_scale>" + ct::toStr(m_FFTAnalyzer.IsLogScale() ? "true" : "false") + "</log_scale>\n";
+    str += vOffset + "\t<min_db>" + ct::toStr(m_FFTAnalyzer.GetMinDecibels()) + "</min_db>\n";
+    str += vOffset + "\t<max_db>" + ct::toStr(m_FFTAnalyzer.GetMaxDecibels()) + "</max_db>\n";
     str += vOffset + "\t<count_display_points>" + ct::toStr(m_CountDisplayPoints) + "</count_display_points>\n";
+    str += vOffset + "\t<offline_frame_rate>" + ct::toStr(m_OfflineFrameRate) + "</offline_frame_rate>\n";
+    str += vOffset + "\t<offline_loop>" + ct::toStr(m_OfflineAudioSource.IsLoop() ? "true" : "false") + "</offline_loop>\n";
+    str += vOffset + "\t<sound_file>" + m_SoundFilePathName + "</sound_file>\n";
+    str += vOffset + "\t<sound_source>" + ct::toStr((int)m_SoundSource) + "</sound_source>\n";
 
     str += vOffset + "</soundsystem>\n";
 
@@ -263,10 +363,32 @@ bool SoundSystem::setFromXml(tinyxml2::XMLElement* vElem, tinyxml2::XMLElement*
             puActivated = ct::ivariant(strValue).GetB();
         else if (strName == "audio_amplification")
             m_AudioFloatAmplification = ct::fvariant(strValue).GetF();
+        else if (strName == "fft_size")
+            m_FFTAnalyzer.SetFFTSize((size_t)ct::uvariant(strValue).GetU());
+        else if (strName == "hop_size")
+            m_FFTAnalyzer.SetHopSize((size_t)ct::uvariant(strValue).GetU());
+        else if (strName == "smoothing_mode")
+            m_FFTAnalyzer.SetSmoothingMode((FFTSmoothingModeEnum)ct::ivariant(strValue).GetI());
         else if (strName == "average_size")
-            m_CurrentAverageSize = (size_t)ct::uvariant(strValue).GetU();
+            m_FFTAnalyzer.SetAverageSize((size_t)ct::uvariant(strValue).GetU());
+        else if (strName == "smoothing_factor")
+            m_FFTAnalyzer.SetSmoothingFactor(ct::fvariant(strValue).GetF());
+        else if (strName == "log_scale")
+            m_FFTAnalyzer.SetLogScale(ct::ivariant(strValue).GetB(), m_FFTAnalyzer.GetMinDecibels(), m_FFTAnalyzer.GetMaxDecibels());
+        else if (strName == "min_db")
+            m_FFTAnalyzer.SetLogScale(m_FFTAnalyzer.IsLogScale(), ct::fvariant(strValue).GetF(), m_FFTAnalyzer.GetMaxDecibels());
+        else if (strName == "max_db")
+            m_FFTAnalyzer.SetLogScale(m_FFTAnalyzer.IsLogScale(), m_FFTAnalyzer.GetMinDecibels(), ct::fvariant(strValue).GetF());
         else if (strName == "count_display_points")
             m_CountDisplayPoints = (size_t)ct::uvariant(strValue).GetU();
+        else if (strName == "offline_frame_rate")
+            m_OfflineFrameRate = ct::maxi(ct::ivariant(strValue).GetI(), 1);
+        else if (strName == "offline_loop")
+            m_OfflineAudioSource.SetLoop(ct::ivariant(strValue).GetB());
+        else if (strName == "sound_file")
+            OpenSoundFile(strValue);
+        else if (strName == "sound_source")
+            SetSoundSource((SoundSourceEnum)ct::ivariant(strValue).GetI());
     }
 
     return false;
@@ -286,7 +408,7 @@ bool SoundSystem::UpdateUniforms(UniformVariantPtr vUniPtr) {
 int SoundSystem::UploadUniformForGlslType(const GuiBackend_Window& /*vWin*/, UniformVariantPtr vUniPtr, int vTextureSlotId, bool /*vIsCompute*/) {
     if (vUniPtr) {
         if (vUniPtr->widgetType == "sound") {
-            vUniPtr->sound_ptr = m_FFTTexture1DPtr;
+            vUniPtr->sound_ptr = GetFFTTexture(vUniPtr->soundBins);
 
             if (vUniPtr->sound_ptr) {
                 vUniPtr->uSampler1D = vUniPtr->sound_ptr->glTex;
@@ -347,7 +469,7 @@ bool SoundSystem::DrawWidget(CodeTreePtr vCodeTree,
             ImGui::SameLine(vFirstColumnWidth);
 
             //this is a texture1D, cant shown with imgui
-            ImGui::Texture(m_FFTTexture1DPtr, 100.0f, ImVec4(1, 1, 1, 1), 1);
+            ImGui::Texture(GetFFTTexture(v->soundBins), 100.0f, ImVec4(1, 1, 1, 1), 1);
         }
         else */
         if (v->widgetType == "sound_histo" && m_SoundHisto_RenderPack_Ptr) {
@@ -455,6 +577,7 @@ void SoundSystem::Complete_Uniform(ShaderKeyPtr vParentKey, RenderPackWeak vRend
             if (rpPtr) {
                 vUniform->widget = "sound";
                 vUniform->timeLineSupported = true;
+                vUniform->soundBins = (uint32_t)SoundSystem::scDefaultCountBins;
 
                 for (auto it = vUniformParsed.paramsDico.begin(); it != vUniformParsed.paramsDico.end(); ++it) {
                     std::string key = it->first;
@@ -470,6 +593,10 @@ void SoundSystem::Complete_Uniform(ShaderKeyPtr vParentKey, RenderPackWeak vRend
                         }
 
                         vUniform->soundChoiceActivated = false;
+                    } else if (key == "bins") {
+                        if (!it->second.empty()) {
+                            vUniform->soundBins = ct::clamp<uint32_t>(ct::uvariant(*it->second.begin()).GetU(), 1U, (uint32_t)(FFTAnalyzer::scMaxFFTSize / 2U));
+                        }
                     }
                 }
             }
@@ -552,7 +679,7 @@ std::string SoundSystem::InitRenderPack(const GuiBackend_Window& vWin, CodeTreeP
         auto shader_string = GetSoundHistoShaderString();
         m_SoundHisto_Key_Ptr = vCodeTree->LoadFromString("SoundHisto", shader_string, "SoundHisto.glsl", "", KEY_TYPE_Enum::KEY_TYPE_SHADER);
         m_SoundHisto_RenderPack_Ptr =
-            RenderPack::createBufferWithFileWithoutLoading(vWin, "SoundHisto", ct::ivec3(SoundSystem::scFftSize, 240U, 0), m_SoundHisto_Key_Ptr, false, true);
+            RenderPack::createBufferWithFileWithoutLoading(vWin, "SoundHisto", GetHistoSize(), m_SoundHisto_Key_Ptr, false, true);
     }
 
     return "";
@@ -632,32 +759,42 @@ void SoundSystem::NewNotification(const ma_device_notification* /*pNotification*
     }
 }
 
-// https://webaudio.github.io/web-audio-api/#current-time-domain-data
-double SoundSystem::BlackmanWindow(const int& n) {
-    static const double& N_coef = 1.0 / (scFftSize - 1U);  // Longueur du filtre
-    static const double& pi = 3.14159265358979323846;
-    static const double& a = 0.16;
-    static const double& a0 = (1.0 - a) * 0.5;
-    static const double& a1 = 0.5;
-    static const double& a2 = a * 0.5;
-    return a0 - a1 * cos(2.0 * pi * n * N_coef) + a2 * cos(4.0 * pi * n * N_coef);
-}
-
+// called by the capture thread of miniaudio
+// no lock, no allocation, no cos, the samples are only pushed in the ring
 void SoundSystem::AddFrames(const uint32_t& vFrameCount, const void* vInputPtr) {
-    m_IsNewCaptureDataAvailable = true;
+    const float* samples = (const float*)vInputPtr;
 
-    auto frameCount = ct::mini(vFrameCount, (uint32_t)SoundSystem::scFullFftSize);
+    float mono[256];
+    uint32_t frameIndex = 0U;
+    while (frameIndex < vFrameCount) {
+        const uint32_t count = ct::mini(vFrameCount - frameIndex, 256U);
+        for (uint32_t i = 0U; i < count; ++i) {
+            // moyenne des deux canneaux comme defini par m_AudioDeviceConfig.capture.channels
+            const uint32_t idx = (frameIndex + i) * 2U;
+            mono[i] = (samples[idx] + samples[idx + 1U]) * 0.5f;
+        }
+        // if the ring is full, the render thread is late, the new samples are dropped
+        m_AudioCaptureRing.Push(mono, count);
+        frameIndex += count;
+    }
 
-    // Just rotate the buffer; copy existing, append new
-    const float* samples = (const float*)vInputPtr;
-    memset(m_AudioCaptureSampleBuffer, 0, sizeof(float) * SoundSystem::scFullFftSize);
+    m_IsNewCaptureDataAvailable.store(true, std::memory_order_release);
+}
+
+// the pending samples of the ring are given to the analyzer
+// return the count of fft done
+size_t SoundSystem::DrainCaptureRing() {
+    size_t countFFTs = 0U;
 
-    float* p = m_AudioCaptureSampleBuffer;
+    m_FFTAnalyzer.SetAmplification(m_AudioFloatAmplification);
 
-    for (uint32_t i = 0; i < frameCount; ++i) {
-        // moyenne des deux canneaux comme defini par m_AudioDeviceConfig.capture.channels
-        *(p++) = (samples[i * 2] + samples[i * 2 + 1]) * 0.5f * m_AudioFloatAmplification * (float)BlackmanWindow(i);
+    float chunk[1024];
+    size_t count = 0U;
+    while ((count = m_AudioCaptureRing.Pop(chunk, 1024U)) > 0U) {
+        countFFTs += m_FFTAnalyzer.PushSamples(chunk, count);
     }
+
+    return countFFTs;
 }
 
 /*
@@ -668,35 +805,77 @@ this.mRenderer.UpdateTexture(inp.globject, 0, 1, waveLen, 1, inp.mWaveData); //
 */
 
 bool SoundSystem::ComputeFFT() {
-    if (Use() && m_IsAudioCaptureReady && m_IsNewCaptureDataAvailable) {
-        static kiss_fft_cpx out_spectrum[SoundSystem::scFftSize + 1U];  // N / 2 + 1
-        kiss_fftr(m_FFTConfig, m_AudioCaptureSampleBuffer, out_spectrum);
+    if (Use()) {
+        if (IsOfflineMode()) {
+            // the device can be always running, his samples are forgotten
+            m_AudioCaptureRing.Clear();
+            return (AnalyseOfflineFrame() > 0U);
+        } else if (m_IsAudioCaptureReady) {
+            return (DrainCaptureRing() > 0U);
+        }
+    }
 
-        static const float scaling = 1.0f / (float)SoundSystem::scFftSize / (float)m_CurrentAverageSize;
+    return false;
+}
 
-        float* p = m_AverageFFTDatas + m_AverageLastValueIndex * SoundSystem::scFftSize;
+////////////////////////////////////////////////////
+//// PUBLIC / OFFLINE //////////////////////////////
+////////////////////////////////////////////////////
 
-        for (size_t i = 0U; i < SoundSystem::scFftSize; ++i) {
-            const auto& v = out_spectrum[i];
-            float magnitude = sqrtf((float)(v.r * v.r + v.i * v.i)) * scaling;
-            // magnitude = 10.0f * std::log10f(magnitude); // conversion in db
+void SoundSystem::SetSoundSource(const SoundSourceEnum& vSoundSource) {
+    if (vSoundSource >= SoundSourceEnum::SOUND_SOURCE_Count)
+        return;
 
-            // Retirer la valeur la plus ancienne de la somme
-            auto* old_value = p + i;
-            m_AverageFFTValues[i] -= *old_value;
+    if (vSoundSource != m_SoundSource) {
+        m_SoundSource = vSoundSource;
+        m_AudioCaptureRing.Clear();
+        m_FFTAnalyzer.Reset();
+        m_OfflineFrame = 0;
+        InvalidateOfflineAnalysis();
+    }
+}
 
-            // Ajouter la nouvelle valeur � la somme
-            *old_value = magnitude;
-            m_AverageFFTValues[i] += magnitude;
-        }
+SoundSourceEnum SoundSystem::GetSoundSource() const {
+    return m_SoundSource;
+}
 
-        // Incr�menter l'index
-        m_AverageLastValueIndex = ct::maxi<size_t>((m_AverageLastValueIndex + 1U) % m_CurrentAverageSize, 0U);
+bool SoundSystem::OpenSoundFile(const std::string& vFilePathName) {
+    m_SoundFilePathName = vFilePathName;
+    m_OfflineFrame = 0;
+    InvalidateOfflineAnalysis();
 
-        return true;
+    if (vFilePathName.empty()) {
+        m_OfflineAudioSource.Close();
+        return false;
     }
 
-    return false;
+    return m_OfflineAudioSource.Open(vFilePathName);
+}
+
+void SoundSystem::OpenSoundFileDialog() {
+    IGFD::FileDialogConfig config;
+    config.path = m_SoundFilePath;
+    config.filePathName = m_SoundFilePathName;
+    config.countSelectionMax = 1;
+    config.flags = ImGuiFileDialogFlags_DisableThumbnailMode | ImGuiFileDialogFlags_Modal;
+    ImGuiFileDialog::Instance()->OpenDialog("OpenSoundFileDialog", "Open Sound File", "Sound Files {.wav,.flac,.mp3}", config);
+}
+
+void SoundSystem::ShowDialog(ct::ivec2 vScreenSize) {
+    ImVec2 min = ImVec2(0, 0);
+    ImVec2 max = ImVec2(FLT_MAX, FLT_MAX);
+    if (!(ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)) {
+        max = ImVec2((float)vScreenSize.x, (float)vScreenSize.y);
+        min = max * 0.5f;
+    }
+
+    if (ImGuiFileDialog::Instance()->Display("OpenSoundFileDialog", ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoDocking, min, max)) {
+        if (ImGuiFileDialog::Instance()->IsOk()) {
+            m_SoundFilePath = ImGuiFileDialog::Instance()->GetCurrentPath();
+            OpenSoundFile(ImGuiFileDialog::Instance()->GetFilePathName());
+        }
+        ImGuiFileDialog::Instance()->Close();
+    }
 }
 
 void SoundSystem::Update() {
@@ -737,12 +916,25 @@ void SoundSystem::Update() {
 }
 
 void SoundSystem::Render(float vDeltaTime) {
-    if (Use() && m_IsNewCaptureDataAvailable) {
+    // in offline mode, one new frame of audio by new rendered frame
+    if (Use() && (IsOfflineMode() ? IsNewOfflineFrame() : m_IsNewCaptureDataAvailable.exchange(false, std::memory_order_acquire))) {
         TracyGpuZone("MainBackend::RenderSoundHisto");
 
         if (m_SoundHisto_RenderPack_Ptr) {
             if (ComputeFFT()) {
-                UpdateR32FTexture1D(m_FFTTexture1DPtr, m_AverageFFTValues);
+                // only the bins asked by the shaders are uploaded
+                for (const auto& it : m_FFTTextures) {
+                    m_FFTUploadBuffer.resize(it.first);
+                    m_FFTAnalyzer.CopyBins(m_FFTUploadBuffer.data(), it.first);
+                    UpdateR32FTexture1D(it.second, m_FFTUploadBuffer.data());
+                }
+            }
+
+            // the fft size can have changed
+            const auto histoSize = GetHistoSize();
+            if (m_SoundHisto_RenderPack_Ptr->GetSize() != histoSize) {
+                m_SoundHisto_RenderPack_Ptr->Resize(histoSize, false);
+                m_SoundHisto_RenderPack_Ptr->ResetFrame();
             }
 
             m_SoundHisto_RenderPack_Ptr->UpdateTimeWidgets(vDeltaTime);
@@ -755,8 +947,6 @@ void SoundSystem::Render(float vDeltaTime) {
                                                                   std::placeholders::_5));
             m_SoundHisto_RenderPack_Ptr->RenderNode();
         }
-
-        m_IsNewCaptureDataAvailable = false;
     }
 }
 
@@ -765,9 +955,9 @@ void SoundSystem::ResetFrame() {
         m_SoundHisto_RenderPack_Ptr->ResetFrame();
     }
 
-    m_AverageLastValueIndex = 0U;
-    memset(m_AverageFFTDatas, 0, sizeof(float) * SoundSystem::scFftSize * SoundSystem::scMaxAverageSize);
-    memset(m_AverageFFTValues, 0, sizeof(float) * SoundSystem::scFftSize);
+    m_FFTAnalyzer.Reset();
+    m_OfflineFrame = 0;
+    InvalidateOfflineAnalysis();
 }
 
 void SoundSystem::ResetTime() {
@@ -775,9 +965,9 @@ void SoundSystem::ResetTime() {
         m_SoundHisto_RenderPack_Ptr->ResetTime();
     }
 
-    m_AverageLastValueIndex = 0U;
-    memset(m_AverageFFTDatas, 0, sizeof(float) * SoundSystem::scFftSize * SoundSystem::scMaxAverageSize);
-    memset(m_AverageFFTValues, 0, sizeof(float) * SoundSystem::scFftSize);
+    m_FFTAnalyzer.Reset();
+    m_OfflineFrame = 0;
+    InvalidateOfflineAnalysis();
 }
 
 void SoundSystem::UpdateHistoRenderPackUniforms(RenderPackWeak /*vRenderPack*/,
@@ -787,9 +977,80 @@ void SoundSystem::UpdateHistoRenderPackUniforms(RenderPackWeak /*vRenderPack*/,
                                                 CameraInterface* /*vCamera*/) {
     if (vUniPtr) {
         if (vUniPtr->widgetType == "sound") {
-            vUniPtr->sound_ptr = m_FFTTexture1DPtr;
+            // the histogram show all the bins of the fft
+            vUniPtr->soundBins = (uint32_t)GetHistoSize().x;
+            vUniPtr->sound_ptr = GetFFTTexture(vUniPtr->soundBins);
+        }
+    }
+}
+
+// one column by bin of the fft, one line by analysed frame
+ct::ivec3 SoundSystem::GetHistoSize() const {
+    const size_t countBins = m_FFTAnalyzer.GetCountBins();
+    return ct::ivec3((int)(countBins ? countBins : SoundSystem::scDefaultCountBins), (int)SoundSystem::scHistoCountLines, 0);
+}
+
+////////////////////////////////////////////////////
+//// PRIVATE / OFFLINE /////////////////////////////
+////////////////////////////////////////////////////
+
+bool SoundSystem::IsOfflineMode() const {
+    return (m_SoundSource == SoundSourceEnum::SOUND_SOURCE_FILE);
+}
+
+// during a rendering of the timeline, his frame and his frame rate
+// else a frame counter advanced by each analysed frame
+int SoundSystem::GetOfflineFrame(int* vOutFrameRate) {
+    auto timeLinePtr = TimeLineSystem::Instance();
+    if (timeLinePtr->IsRendering()) {
+        if (vOutFrameRate) {
+            *vOutFrameRate = timeLinePtr->GetFrameRate();
         }
+        return timeLinePtr->GetCurrentFrame();
     }
+
+    if (vOutFrameRate) {
+        *vOutFrameRate = m_OfflineFrameRate;
+    }
+    return m_OfflineFrame;
+}
+
+bool SoundSystem::IsNewOfflineFrame() {
+    if (!m_OfflineAudioSource.IsOpened())
+        return false;
+
+    int frameRate = 0;
+    const int frame = GetOfflineFrame(&frameRate);
+    return (frame != m_OfflineLastFrame || frameRate != m_OfflineLastFrameRate);
+}
+
+size_t SoundSystem::AnalyseOfflineFrame() {
+    int frameRate = 0;
+    const int frame = GetOfflineFrame(&frameRate);
+
+    // a jump in the frames, the history restart from this frame
+    if (m_OfflineLastFrame < 0 || frame != m_OfflineLastFrame + 1 || frameRate != m_OfflineLastFrameRate) {
+        if (m_SoundHisto_RenderPack_Ptr) {
+            m_SoundHisto_RenderPack_Ptr->ResetFrame();
+        }
+    }
+
+    m_FFTAnalyzer.SetAmplification(m_AudioFloatAmplification);
+    const size_t countFFTs = m_OfflineAudioSource.AnalyseFrame(m_FFTAnalyzer, frame, frameRate);
+
+    m_OfflineLastFrame = frame;
+    m_OfflineLastFrameRate = frameRate;
+    if (!TimeLineSystem::Instance()->IsRendering()) {
+        m_OfflineFrame = frame + 1;
+    }
+
+    return countFFTs;
+}
+
+void SoundSystem::InvalidateOfflineAnalysis() {
+    m_OfflineAudioSource.Invalidate();
+    m_OfflineLastFrame = -1;
+    m_OfflineLastFrameRate = 0;
 }
 
 ////////////////////////////////////////////////////
@@ -797,28 +1058,29 @@ void SoundSystem::UpdateHistoRenderPackUniforms(RenderPackWeak /*vRenderPack*/,
 ////////////////////////////////////////////////////
 
 bool SoundSystem::InitAudioDriver() {
+    // the fft is needed even without audio device, for the sound files
+    m_AudioCaptureRing.Clear();
+    if (!m_FFTAnalyzer.SetFFTSize(m_FFTAnalyzer.GetFFTSize())) {
+        LogVarError("Failed to initialize the fft.\n");
+    }
+
+    GetFFTTexture(SoundSystem::scDefaultCountBins);
+
     if (ma_context_init(NULL, 0, NULL, &m_AudioDriverContext) != MA_SUCCESS) {
         LogVarError("Failed to initialize context.\n");
         return false;
     }
 
-    memset(m_AudioCaptureSampleBuffer, 0, sizeof(float) * SoundSystem::scFullFftSize);
-    memset(m_AverageFFTDatas, 0, sizeof(float) * SoundSystem::scFftSize * SoundSystem::scMaxAverageSize);
-    memset(m_AverageFFTValues, 0, sizeof(float) * SoundSystem::scFftSize);
-    m_FFTConfig = kiss_fftr_alloc(SoundSystem::scFullFftSize, 0, NULL, NULL);
-
     EnumerateAudioDevices();
     SelectAudioDevice(m_CurrentAudioDeviceIndex);
 
-    m_FFTTexture1DPtr = CreateR32FTexture1D(SoundSystem::scFftSize);
-
     return true;
 }
 
 void SoundSystem::UnitAudioDriver() {
-    m_FFTTexture1DPtr.reset();
+    m_FFTTextures.clear();
 
-    kiss_fft_free(m_FFTConfig);
+    m_FFTAnalyzer.Unit();
 
     if (ma_device_is_started(&m_AudioCaptureDevice)) {
         ma_device_stop(&m_AudioCaptureDevice);
@@ -939,6 +1201,15 @@ void SoundSystem::SelectAudioDevice(const size_t& vDeviceIndex) {
     }
 }
 
+ctTexturePtr SoundSystem::GetFFTTexture(const size_t& vCountBins) {
+    const size_t countBins = vCountBins ? vCountBins : SoundSystem::scDefaultCountBins;
+    auto& texturePtr = m_FFTTextures[countBins];
+    if (!texturePtr) {
+        texturePtr = CreateR32FTexture1D(countBins);
+    }
+    return texturePtr;
+}
+
 ctTexturePtr SoundSystem::CreateR32FTexture1D(const size_t& vWidth) {
     auto res = std::make_shared<ct::texture>();
 
@@ -1054,11 +1325,15 @@ void SoundSystem::UpdateR32FTexture1D(ctTexturePtr vTexturePtr, const float* vSa
     }
 }
 
-void SoundSystem::UpdateR32FTexture2D(ctTexturePtr vTexturePtr, const float* vSamplesPtr) {
-    if (vTexturePtr && vSamplesPtr && vTexturePtr->glTextureType == GL_TEXTURE_2D && vTexturePtr->glTex) {
+// vSamplesPtr have vCountBins floats by line, only these bins are uploaded
+void SoundSystem::UpdateR32FTexture2D(ctTexturePtr vTexturePtr, const float* vSamplesPtr, const size_t& vCountBins) {
+    if (vTexturePtr && vSamplesPtr && vCountBins && vTexturePtr->glTextureType == GL_TEXTURE_2D && vTexturePtr->glTex) {
         glBindTexture(GL_TEXTURE_2D, vTexturePtr->glTex);
         LogGlError();
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (int)vTexturePtr->w, (int)vTexturePtr->h, GL_RED, GL_FLOAT, vSamplesPtr);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)vCountBins);
+        const auto width = (int)ct::mini<size_t>(vCountBins, vTexturePtr->w);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, (int)vTexturePtr->h, GL_RED, GL_FLOAT, vSamplesPtr);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
         LogGlError();
         glBindTexture(GL_TEXTURE_2D, 0);
         LogGlError();
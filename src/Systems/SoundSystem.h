@@ -21,9 +21,14 @@
 #include <Interfaces/WidgetInterface.h>
 #include <Interfaces/SubSystemInterface.h>
 #include <Renderer/RenderPack.h>
+#include <Helper/SpscRingBuffer.h>
+#include <Systems/FFTAnalyzer.h>
+#include <Systems/OfflineAudioSource.h>
 
 #include <miniaudio.h>
-#include <kiss_fftr.h>
+
+#include <map>
+#include <atomic>
 
 class CameraSystem;
 class CodeTree;
@@ -33,11 +38,18 @@ class RenderPack;
 class UniformVariant;
 
 struct UniformParsedStruct;
+
+enum class SoundSourceEnum {  //
+    SOUND_SOURCE_CAPTURE = 0,  // audio device, realtime
+    SOUND_SOURCE_FILE,         // sound file, one frame duration of audio by rendered frame
+    SOUND_SOURCE_Count         //
+};                             //
+
 class SoundSystem : public WidgetInterface, public SubSystemInterface, public conf::ConfigAbstract {
 public:
-    static constexpr size_t scFftSize = 512U;
-    static constexpr size_t scFullFftSize = scFftSize * 2U;
-    static constexpr size_t scMaxAverageSize = 50U;
+    static constexpr size_t scDefaultCountBins = 512U;  // when the shader not ask a count of bins, ex : sampler1D(sound:bins=128)
+    static constexpr size_t scCaptureRingSize = 8192U;  // mono samples, ~185 ms at 44100 Hz
+    static constexpr size_t scHistoCountLines = 240U;   // analysed frames kept by the histogram
 
 public:
     bool puActivated = false;
@@ -47,7 +59,6 @@ private:
     ct::ActionTime m_ActionTime;
 
 private:  // audio
-    kiss_fftr_cfg m_FFTConfig;
     ma_context m_AudioDriverContext;
     ma_device_id m_AudioCaptureDeviceID;
     ma_device m_AudioCaptureDevice;
@@ -58,20 +69,28 @@ private:  // audio
 
     bool m_FirstAudioDriverCheck = true;
     bool m_IsAudioCaptureReady = false;
-    bool m_IsNewCaptureDataAvailable = false;
+    std::atomic<bool> m_IsNewCaptureDataAvailable{false};
     bool m_NeedNewDeviceCheck = false;
 
-    ctTexturePtr m_FFTTexture1DPtr = nullptr;
+    // one texture by count of bins asked by the shaders, only these bins are uploaded
+    std::map<size_t, ctTexturePtr> m_FFTTextures;
+    std::vector<float> m_FFTUploadBuffer;
 
-    // * 2 because left and right channel
-    kiss_fft_scalar m_AudioCaptureSampleBuffer[scFullFftSize] = {};
+    // capture thread => render thread, the mono samples
+    SpscRingBuffer<float> m_AudioCaptureRing{scCaptureRingSize};
+    FFTAnalyzer m_FFTAnalyzer;
+
+    // offline analysis of a sound file, the same textures for the same frames at each run
+    SoundSourceEnum m_SoundSource = SoundSourceEnum::SOUND_SOURCE_CAPTURE;
+    OfflineAudioSource m_OfflineAudioSource;
+    std::string m_SoundFilePathName;
+    std::string m_SoundFilePath;
+    int m_OfflineFrame = 0;          // next frame to analyse when the timeline is not rendering
+    int m_OfflineFrameRate = 60;     // frame rate when the timeline is not rendering
+    int m_OfflineLastFrame = -1;     // last analysed frame, -1 for none
+    int m_OfflineLastFrameRate = 0;
 
-    size_t m_AverageLastValueIndex = 0U;
-    float m_AverageFFTDatas[scFftSize * scMaxAverageSize] = {};
-    float m_AverageFFTValues[scFftSize] = {};
-    size_t m_CurrentAverageSize = 10U;
     size_t m_CountDisplayPoints = 150U;
-    float m_MaxFFTValue = 0.0f;
 
     RenderPackPtr m_SoundHisto_RenderPack_Ptr = nullptr;
     ShaderKeyPtr m_SoundHisto_Key_Ptr = nullptr;
@@ -115,6 +134,12 @@ public:
     void ResetFrame();
     void ResetTime();
 
+    void SetSoundSource(const SoundSourceEnum& vSoundSource);
+    SoundSourceEnum GetSoundSource() const;
+    bool OpenSoundFile(const std::string& vFilePathName);
+    void OpenSoundFileDialog();
+    void ShowDialog(ct::ivec2 vScreenSize);
+
 public:
     std::string getXml(const std::string& vOffset, const std::string& vUserDatas) override;
     bool setFromXml(tinyxml2::XMLElement* vElem, tinyxml2::XMLElement* vParent, const std::string& vUserDatas) override;
@@ -148,9 +173,12 @@ private:  // audio
     void UnitAudioDriver();
     void EnumerateAudioDevices();
     void SelectAudioDevice(const size_t& vDeviceIndex);
-
-private:  // effects
-    double BlackmanWindow(const int& n);
+    size_t DrainCaptureRing();
+    bool IsOfflineMode() const;
+    int GetOfflineFrame(int* vOutFrameRate);
+    bool IsNewOfflineFrame();
+    size_t AnalyseOfflineFrame();
+    void InvalidateOfflineAnalysis();
 
 private:  // opengl
     void UpdateHistoRenderPackUniforms(RenderPackWeak vRenderPack,
@@ -158,10 +186,12 @@ private:  // opengl
                                        DisplayQualityType vDisplayQuality,
                                        MouseInterface* vMouse,
                                        CameraInterface* vCamera);
+    ctTexturePtr GetFFTTexture(const size_t& vCountBins);
+    ct::ivec3 GetHistoSize() const;
     ctTexturePtr CreateR32FTexture1D(const size_t& vWidth);
     ctTexturePtr CreateR32FTexture2D(const size_t& vWidth, const size_t& vHeight);
     void UpdateR32FTexture1D(ctTexturePtr vTexturePtr, const float* vSamplesPtr);
-    void UpdateR32FTexture2D(ctTexturePtr vTexturePtr, const float* vSamplesPtr);
+    void UpdateR32FTexture2D(ctTexturePtr vTexturePtr, const float* vSamplesPtr, const size_t& vCountBins);
 
 public:
     static SoundSystem* Instance() {
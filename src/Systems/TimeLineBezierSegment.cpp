@@ -0,0 +1,113 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "TimeLineBezierSegment.h"
+
+#include <cmath>
+
+#define BEZIER_SOLVE_NEWTON_ITERATIONS 8
+#define BEZIER_SOLVE_BISECTION_ITERATIONS 32
+#define BEZIER_SOLVE_EPSILON 1e-4f  // in frames
+
+void TimeLineBezierSegment::SetQuadratic(const ct::fvec2& vP0, const ct::fvec2& vP1, const ct::fvec2& vP2) {
+    // P(t) = (1 - t) ^ 2 * P0 + 2 * t * (1 - t) * P1 + t ^ 2 * P2
+    m_Ax = 0.0f;
+    m_Bx = vP0.x - 2.0f * vP1.x + vP2.x;
+    m_Cx = 2.0f * (vP1.x - vP0.x);
+    m_Dx = vP0.x;
+
+    m_Ay = 0.0f;
+    m_By = vP0.y - 2.0f * vP1.y + vP2.y;
+    m_Cy = 2.0f * (vP1.y - vP0.y);
+    m_Dy = vP0.y;
+
+    m_LastT = 0.0f;
+}
+
+void TimeLineBezierSegment::SetCubic(const ct::fvec2& vP0, const ct::fvec2& vP1, const ct::fvec2& vP2, const ct::fvec2& vP3) {
+    // P(t) = (1 - t) ^ 3 * P0 + 3t(1 - t) ^ 2 * P1 + 3 * t ^ 2 (1 - t) * P2 + t ^ 3 * P3
+    m_Ax = -vP0.x + 3.0f * vP1.x - 3.0f * vP2.x + vP3.x;
+    m_Bx = 3.0f * vP0.x - 6.0f * vP1.x + 3.0f * vP2.x;
+    m_Cx = 3.0f * (vP1.x - vP0.x);
+    m_Dx = vP0.x;
+
+    m_Ay = -vP0.y + 3.0f * vP1.y - 3.0f * vP2.y + vP3.y;
+    m_By = 3.0f * vP0.y - 6.0f * vP1.y + 3.0f * vP2.y;
+    m_Cy = 3.0f * (vP1.y - vP0.y);
+    m_Dy = vP0.y;
+
+    m_LastT = 0.0f;
+}
+
+float TimeLineBezierSegment::SolveT(const float& vX) {
+    const float startX = m_Dx;
+    const float endX = GetX(1.0f);
+    if (vX <= startX)
+        return m_LastT = 0.0f;
+    if (vX >= endX)
+        return m_LastT = 1.0f;
+
+    // newton-raphson from the last t
+    float t = m_LastT;
+    for (int i = 0; i < BEZIER_SOLVE_NEWTON_ITERATIONS; ++i) {
+        const float dx = GetX(t) - vX;
+        if (std::fabs(dx) < BEZIER_SOLVE_EPSILON)
+            return m_LastT = t;
+        const float d = GetDerivativeX(t);
+        if (std::fabs(d) < 1e-6f)
+            break;  // flat tangent, newton will diverge
+        t -= dx / d;
+        if (t < 0.0f || t > 1.0f)
+            break;
+    }
+
+    // bisection, x(0) < vX < x(1)
+    float lo = 0.0f;
+    float hi = 1.0f;
+    t = 0.5f;
+    for (int i = 0; i < BEZIER_SOLVE_BISECTION_ITERATIONS; ++i) {
+        t = (lo + hi) * 0.5f;
+        const float dx = GetX(t) - vX;
+        if (std::fabs(dx) < BEZIER_SOLVE_EPSILON)
+            break;
+        if (dx < 0.0f) {
+            lo = t;
+        } else {
+            hi = t;
+        }
+    }
+
+    return m_LastT = t;
+}
+
+float TimeLineBezierSegment::GetX(const float& vT) const {
+    return ((m_Ax * vT + m_Bx) * vT + m_Cx) * vT + m_Dx;
+}
+
+float TimeLineBezierSegment::GetY(const float& vT) const {
+    return ((m_Ay * vT + m_By) * vT + m_Cy) * vT + m_Dy;
+}
+
+float TimeLineBezierSegment::GetDerivativeX(const float& vT) const {
+    return (3.0f * m_Ax * vT + 2.0f * m_Bx) * vT + m_Cx;
+}
+
+float TimeLineBezierSegment::GetDerivativeY(const float& vT) const {
+    return (3.0f * m_Ay * vT + 2.0f * m_By) * vT + m_Cy;
+}
@@ -0,0 +1,42 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <ctools/cTools.h>
+
+// a quadratic or cubic bezier segment of the timeline, x is the frame and y the value
+// the polynomial coefficients are computed one time by segment
+// the t of a frame is found by newton-raphson, with a bisection fallback, starting from the t of the last solve
+class TimeLineBezierSegment {
+private:
+    // x(t) = ((a * t + b) * t + c) * t + d, same for y
+    float m_Ax = 0.0f, m_Bx = 0.0f, m_Cx = 0.0f, m_Dx = 0.0f;
+    float m_Ay = 0.0f, m_By = 0.0f, m_Cy = 0.0f, m_Dy = 0.0f;
+    float m_LastT = 0.0f;  // warm start, the frames are solved in order by the bake
+
+public:
+    void SetQuadratic(const ct::fvec2& vP0, const ct::fvec2& vP1, const ct::fvec2& vP2);
+    void SetCubic(const ct::fvec2& vP0, const ct::fvec2& vP1, const ct::fvec2& vP2, const ct::fvec2& vP3);
+
+    // t in [0:1] where x(t) = vX
+    float SolveT(const float& vX);
+
+    float GetX(const float& vT) const;
+    float GetY(const float& vT) const;
+    float GetDerivativeX(const float& vT) const;
+    float GetDerivativeY(const float& vT) const;
+};
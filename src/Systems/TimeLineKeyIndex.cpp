@@ -0,0 +1,118 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "TimeLineKeyIndex.h"
+
+#include <Systems/TimeLineSystem.h>
+#include <Profiler/TracyProfiler.h>
+
+#include <algorithm>
+
+static bool TimeLineKeyIndex_IsBeforeFrame(const TimeLineKeyIndexEntry& vEntry, const int& vFrame) {
+    return vEntry.frame < vFrame;
+}
+
+static bool TimeLineKeyIndex_IsAfterFrame(const int& vFrame, const TimeLineKeyIndexEntry& vEntry) {
+    return vFrame < vEntry.frame;
+}
+
+void TimeLineKeyIndex::Clear() {
+    m_Entries.clear();
+    m_Dirty = true;
+}
+
+void TimeLineKeyIndex::Invalidate() {
+    m_Dirty = true;
+}
+
+bool TimeLineKeyIndex::IsDirty() const {
+    return m_Dirty;
+}
+
+void TimeLineKeyIndex::Build(std::map<std::string, UniformTimeKey>& vTimeLine) {
+    ZoneScoped;
+
+    m_Entries.clear();
+
+    size_t count = 0U;
+    for (const auto& timeKey : vTimeLine) {
+        for (const auto& comp : timeKey.second.keys) {
+            count += comp.second.size();
+        }
+    }
+    m_Entries.reserve(count);
+
+    for (auto& timeKey : vTimeLine) {
+        for (auto& comp : timeKey.second.keys) {
+            for (auto& key : comp.second) {
+                if (key.second) {
+                    TimeLineKeyIndexEntry entry;
+                    entry.frame = key.first;
+                    entry.component = comp.first;
+                    entry.timeKey = &timeKey.second;
+                    entry.key = key.second;
+                    m_Entries.push_back(entry);
+                }
+            }
+        }
+    }
+
+    // the keys of a component are already sorted, the stable sort keep the uniform order in a frame
+    std::stable_sort(m_Entries.begin(), m_Entries.end(), [](const TimeLineKeyIndexEntry& a, const TimeLineKeyIndexEntry& b) {
+        return a.frame < b.frame;
+    });
+
+    m_Dirty = false;
+}
+
+bool TimeLineKeyIndex::empty() const {
+    return m_Entries.empty();
+}
+
+size_t TimeLineKeyIndex::size() const {
+    return m_Entries.size();
+}
+
+bool TimeLineKeyIndex::GetNextFrame(const int& vFrame, int* vOutFrame) const {
+    auto it = std::upper_bound(m_Entries.begin(), m_Entries.end(), vFrame, TimeLineKeyIndex_IsAfterFrame);
+    if (it != m_Entries.end()) {
+        if (vOutFrame)
+            *vOutFrame = it->frame;
+        return true;
+    }
+    return false;
+}
+
+bool TimeLineKeyIndex::GetPreviousFrame(const int& vFrame, int* vOutFrame) const {
+    auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), vFrame, TimeLineKeyIndex_IsBeforeFrame);
+    if (it != m_Entries.begin()) {
+        --it;
+        if (vOutFrame)
+            *vOutFrame = it->frame;
+        return true;
+    }
+    return false;
+}
+
+std::pair<TimeLineKeyIndex::ConstIterator, TimeLineKeyIndex::ConstIterator> TimeLineKeyIndex::GetRange(const int& vStartFrame, const int& vEndFrame) const {
+    if (vEndFrame < vStartFrame)
+        return std::make_pair(m_Entries.end(), m_Entries.end());
+    auto itStart = std::lower_bound(m_Entries.begin(), m_Entries.end(), vStartFrame, TimeLineKeyIndex_IsBeforeFrame);
+    auto itEnd = std::upper_bound(itStart, m_Entries.end(), vEndFrame, TimeLineKeyIndex_IsAfterFrame);
+    return std::make_pair(itStart, itEnd);
+}
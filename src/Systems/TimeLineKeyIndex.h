@@ -0,0 +1,60 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+
+class UniformTimeKey;
+class UploadableUniform;
+
+struct TimeLineKeyIndexEntry {
+    int frame = 0;
+    int component = 0;
+    UniformTimeKey* timeKey = nullptr;
+    std::shared_ptr<UploadableUniform> key = nullptr;
+};
+
+// all the keys of a timeline in a flat vector sorted by frame
+// the next / previous key and the keys of a frame range are found by binary search
+// rebuilt from the timeline after each change of the keys, the entries point in the timeline map
+class TimeLineKeyIndex {
+public:
+    typedef std::vector<TimeLineKeyIndexEntry>::const_iterator ConstIterator;
+
+private:
+    std::vector<TimeLineKeyIndexEntry> m_Entries;
+    bool m_Dirty = true;
+
+public:
+    void Clear();
+    void Invalidate();
+    bool IsDirty() const;
+    void Build(std::map<std::string, UniformTimeKey>& vTimeLine);
+
+    bool empty() const;
+    size_t size() const;
+
+    // the first key frame > vFrame, false if not found
+    bool GetNextFrame(const int& vFrame, int* vOutFrame) const;
+    // the last key frame < vFrame, false if not found
+    bool GetPreviousFrame(const int& vFrame, int* vOutFrame) const;
+    // the keys with a frame in [vStartFrame:vEndFrame]
+    std::pair<ConstIterator, ConstIterator> GetRange(const int& vStartFrame, const int& vEndFrame) const;
+};
@@ -17,7 +17,13 @@
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 
 #include <Systems/TimeLineSystem.h>
+#include <Systems/TimeLineBezierSegment.h>
 #include <Renderer/RenderPack.h>
+#include <Buffer/AsyncReadBack.h>
+#include <Buffer/FrameBuffer.h>
+#include <Systems/FrameSinks/Y4mFrameSink.h>
+#include <Systems/FrameSinks/AviFrameSink.h>
+#include <Systems/FrameSinks/GifFrameSink.h>
 #include <CodeTree/ShaderKey.h>
 #include <CodeTree/CodeTree.h>
 #include <Gui/CustomGuiWidgets.h>
@@ -27,6 +33,9 @@
 #include <Res/CustomFont.h>
 #include <Res/CustomFont2.h>
 
+#include <cmath>
+#include <algorithm>
+
 // contrib
 #include <imgui.h>  // https://github.com/ocornut/imgui
 #ifndef IMGUI_DEFINE_MATH_OPERATORS
@@ -214,6 +223,127 @@ UniformTimeKey::UniformTimeKey() {
 //////////////////////////////////////////////////////
 //////////////////////////////////////////////////////
 
+bool TimeLineBakedKey::operator==(const TimeLineBakedKey& v) const {
+    // exact comparisons, any change must be baked
+    return frame == v.frame &&                                          //
+        value == v.value &&                                             //
+        mat4 == v.mat4 &&                                               //
+        bezierControlStartPoint.x == v.bezierControlStartPoint.x &&     //
+        bezierControlStartPoint.y == v.bezierControlStartPoint.y &&     //
+        bezierContorlEndPoint.x == v.bezierContorlEndPoint.x &&         //
+        bezierContorlEndPoint.y == v.bezierContorlEndPoint.y &&         //
+        timeLineHandlerType == v.timeLineHandlerType;
+}
+
+bool TimeLineBakedKey::operator!=(const TimeLineBakedKey& v) const {
+    return !(*this == v);
+}
+
+void TimeLineBakedComponent::Clear() {
+    glslType = uType::uTypeEnum::U_VOID;
+    startFrame = 0;
+    countValuesByFrame = 0;
+    values.clear();
+    keys.clear();
+}
+
+bool TimeLineBakedComponent::IsEmpty() const {
+    return countValuesByFrame == 0 || values.empty();
+}
+
+int TimeLineBakedComponent::GetEndFrame() const {
+    if (IsEmpty())
+        return startFrame - 1;
+    return startFrame + (int)(values.size() / (size_t)countValuesByFrame) - 1;
+}
+
+const float* TimeLineBakedComponent::GetValues(const int& vFrame) const {
+    if (IsEmpty() || vFrame < startFrame)
+        return nullptr;
+    const size_t offset = (size_t)(vFrame - startFrame) * (size_t)countValuesByFrame;
+    if (offset >= values.size())
+        return nullptr;
+    return values.data() + offset;
+}
+
+float* TimeLineBakedComponent::GetValues(const int& vFrame) {
+    return const_cast<float*>(static_cast<const TimeLineBakedComponent*>(this)->GetValues(vFrame));
+}
+
+bool TimeLineBakedComponent::GetValue(const int& vFrame, float* vOutValue) const {
+    if (vOutValue && countValuesByFrame == 1) {
+        const float* values_ptr = GetValues(vFrame);
+        if (values_ptr) {
+            *vOutValue = *values_ptr;
+            return true;
+        }
+    }
+    return false;
+}
+
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+// unique for all the TimeLineInfos, so a binding can't be valid for another timeline
+static uint64_t s_TimeLineBindingVersion = 0U;
+
+TimeLineInfos::TimeLineInfos() {
+    rangeFrames = ct::ivec2(0, 90);
+    InvalidateBindings();
+}
+
+TimeLineInfos::TimeLineInfos(const TimeLineInfos& v) : rangeFrames(v.rangeFrames), timeLine(v.timeLine) {
+    InvalidateBindings();
+}
+
+TimeLineInfos& TimeLineInfos::operator=(const TimeLineInfos& v) {
+    if (this != &v) {
+        rangeFrames = v.rangeFrames;
+        timeLine = v.timeLine;
+        InvalidateBindings();
+    }
+    return *this;
+}
+
+void TimeLineInfos::InvalidateBindings() {
+    bindingVersion = ++s_TimeLineBindingVersion;
+    // the entries of the index point on the UniformTimeKey's too
+    InvalidateKeyIndex();
+}
+
+UniformTimeKey* TimeLineInfos::GetBoundTimeKey(UniformVariantPtr vUniPtr) {
+    if (!vUniPtr)
+        return nullptr;
+
+    // the nodes of a std::map are stable, only a removal can invalidate a bound key
+    // but an insertion can add the key of an uniform bound to nothing
+    if (vUniPtr->timeLineBindingVersion != bindingVersion ||  //
+        (!vUniPtr->timeLineKeyPtr && vUniPtr->timeLineBindingCount != timeLine.size())) {
+        auto it = timeLine.find(vUniPtr->name);
+        vUniPtr->timeLineKeyPtr = (it != timeLine.end()) ? &it->second : nullptr;
+        vUniPtr->timeLineBindingVersion = bindingVersion;
+        vUniPtr->timeLineBindingCount = timeLine.size();
+    }
+
+    return vUniPtr->timeLineKeyPtr;
+}
+
+void TimeLineInfos::InvalidateKeyIndex() {
+    m_KeyIndex.Invalidate();
+}
+
+const TimeLineKeyIndex& TimeLineInfos::GetKeyIndex() {
+    if (m_KeyIndex.IsDirty()) {
+        m_KeyIndex.Build(timeLine);
+    }
+    return m_KeyIndex;
+}
+
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
 TimeLineSystem::TimeLineSystem() {
     ZoneScoped;
 
@@ -237,6 +367,11 @@ TimeLineSystem::TimeLineSystem() {
 
 TimeLineSystem::~TimeLineSystem() {
     ZoneScoped;
+
+    // the file is closed even if the rendering was not finished
+    if (m_FrameSinkPtr) {
+        m_FrameSinkPtr->Close();
+    }
 }
 
 void TimeLineSystem::ClearLocalVar() {
@@ -320,6 +455,14 @@ bool TimeLineSystem::IsPlaying() {
     return puPlayTimeLineReverse || puPlayTimeLine;
 }
 
+int TimeLineSystem::GetCurrentFrame() const {
+    return puCurrentFrame;
+}
+
+int TimeLineSystem::GetFrameRate() const {
+    return puFrameRate;
+}
+
 std::string TimeLineSystem::GetRenderingFilePathNameForCurrentFrame() {
     ZoneScoped;
 
@@ -333,6 +476,96 @@ std::string TimeLineSystem::GetRenderingFilePathNameForCurrentFrame() {
     return file;
 }
 
+static FrameSinkPtr TimeLineSystem_CreateFrameSink(RenderingModeEnum vRenderingMode, const std::string& vFilePathName) {
+    if (vRenderingMode == RenderingModeEnum::RENDERING_MODE_GIF) {
+        return GifFrameSink::Create();
+    } else if (vRenderingMode == RenderingModeEnum::RENDERING_MODE_VIDEO) {
+        auto ext = FileHelper::Instance()->ParsePathFileName(vFilePathName).ext;
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext == "avi") {
+            return AviFrameSink::Create();
+        }
+        return Y4mFrameSink::Create();
+    }
+    return nullptr;
+}
+
+bool TimeLineSystem::WriteCurrentFrameToSink(RenderPackWeak vRenderPack, int vAttachmentId) {
+    ZoneScoped;
+
+    if (!IsRendering() ||  //
+        (puRenderingMode != RenderingModeEnum::RENDERING_MODE_VIDEO &&  //
+         puRenderingMode != RenderingModeEnum::RENDERING_MODE_GIF))
+        return false;
+
+    auto rpPtr = vRenderPack.lock();
+    if (!rpPtr || !rpPtr->GetPipe())
+        return false;
+
+    auto fboPtr = rpPtr->GetPipe()->getBackBuffer();
+    if (!fboPtr)
+        return false;
+
+    const auto size = fboPtr->getSize();
+
+    if (!m_FrameSinkPtr) {
+        auto file = puRenderingPath + "/" + puRenderingFileName;
+        file = FileHelper::Instance()->CorrectSlashTypeForFilePathName(file);
+        m_FrameSinkPtr = TimeLineSystem_CreateFrameSink(puRenderingMode, file);
+        if (m_FrameSinkPtr && puRenderingFileName == puRenderingPrefix) {  // no extension
+            file += m_FrameSinkPtr->GetFileExtension();
+        }
+        if (!m_FrameSinkPtr || !m_FrameSinkPtr->Open(file, size.x, size.y, puFrameRate)) {
+            LogVarError("Fail to open the rendering file %s", file.c_str());
+            m_FrameSinkPtr.reset();
+            StopRendering();
+            return false;
+        }
+        m_FrameSinkError = false;
+        m_FrameSinkReadBackPtr = std::make_unique<AsyncReadBack>(rpPtr->GetGuiBackendWindow());
+    }
+
+    auto sinkPtr = m_FrameSinkPtr;
+    m_FrameSinkReadBackPtr->ReadPixels(fboPtr->getFboID(),
+                                       GL_COLOR_ATTACHMENT0 + vAttachmentId,
+                                       ct::ivec4(0, 0, size.x, size.y),
+                                       GL_RGBA,
+                                       GL_UNSIGNED_BYTE,
+                                       [this, sinkPtr](ReadBackResultPtr vResult) {
+                                           if (m_FrameSinkError)
+                                               return;
+                                           // glReadPixels give the rows from bottom to top
+                                           if (!vResult || !vResult->isOk ||  //
+                                               !sinkPtr->WriteFrame(vResult->bytes.data(), vResult->rect.z, vResult->rect.w, true)) {
+                                               LogVarError("Fail to write a frame in the rendering file");
+                                               m_FrameSinkError = true;
+                                           }
+                                       });
+    m_FrameSinkReadBackPtr->Update();
+
+    if (m_FrameSinkError) {
+        StopRendering();
+        return false;
+    }
+
+    return true;
+}
+
+void TimeLineSystem::CloseFrameSink() {
+    ZoneScoped;
+
+    // the last frames are still in the ring
+    if (m_FrameSinkReadBackPtr) {
+        m_FrameSinkReadBackPtr->Flush();
+        m_FrameSinkReadBackPtr.reset();
+    }
+
+    if (m_FrameSinkPtr) {
+        m_FrameSinkPtr->Close();
+        m_FrameSinkPtr.reset();
+    }
+}
+
 void TimeLineSystem::SetActiveKey(ShaderKeyPtr vKey) {
     ZoneScoped;
 
@@ -581,6 +814,7 @@ void TimeLineSystem::DelUniform(ShaderKeyPtr vKey, std::string vUniformName) {
 
     if (vKey && !vUniformName.empty()) {
         vKey->puTimeLine.timeLine.erase(vUniformName);
+        vKey->puTimeLine.InvalidateBindings();
         HideCurveForUniform(vUniformName);
     }
 }
@@ -737,20 +971,6 @@ void TimeLineSystem::DeselectAllKeys(ShaderKeyPtr vKey) {
     ZoneScoped;
 
     if (vKey) {
-        for (auto itStruct = vKey->puTimeLine.timeLine.begin(); itStruct != vKey->puTimeLine.timeLine.end(); ++itStruct) {
-            // std::string name = itStruct->first;
-            for (auto itKey = itStruct->second.keys.begin(); itKey != itStruct->second.keys.end(); ++itKey) {
-                // int chan = itKey->first;
-                for (auto itChan = itKey->second.begin(); itChan != itKey->second.end(); ++itChan) {
-                    // int frame = itChan->first;
-                    const auto st = itChan->second;
-                    if (st.use_count()) {
-                        RemoveKeyFromSelection(st);
-                    }
-                }
-            }
-        }
-
         puSelectedKeys.clear();
     }
 }
@@ -763,29 +983,27 @@ void TimeLineSystem::SelectAllKeysInMouseSelectionRect(ShaderKeyPtr vKey, ImRect
         rc.Combine(puStartMouseClick);
         rc.Combine(puEndMouseClick);
 
-        for (auto itStruct = vKey->puTimeLine.timeLine.begin(); itStruct != vKey->puTimeLine.timeLine.end(); ++itStruct) {
-            // std::string name = itStruct->first;
-            for (auto itKey = itStruct->second.keys.begin(); itKey != itStruct->second.keys.end(); ++itKey) {
-                const int chan = itKey->first;
-                for (auto itChan = itKey->second.begin(); itChan != itKey->second.end(); ++itChan) {
-                    const int frame = itChan->first;
-                    auto st = itChan->second;
-                    if (itChan->second.use_count()) {
-                        // on recup la valeur
-                        float v = 0.0f;
-                        itChan->second->GetValue(&v, chan);
+        // only the keys in the frame range of the rect are tested
+        const float startX = std::min(puStartMouseClick.x, puEndMouseClick.x);
+        const float endX = std::max(puStartMouseClick.x, puEndMouseClick.x);
+        const int startFrame = (int)std::floor(GetFrameValueFromWorldPos(ct::fvec2(startX, 0.0f), vZone).x);
+        const int endFrame = (int)std::ceil(GetFrameValueFromWorldPos(ct::fvec2(endX, 0.0f), vZone).x);
 
-                        ct::fvec2 p = GetWorldPosFromFrameValue(ct::fvec2((float)frame, v), vZone);
+        std::unordered_set<std::shared_ptr<UploadableUniform>> selection;
+        const auto range = vKey->puTimeLine.GetKeyIndex().GetRange(startFrame, endFrame);
+        for (auto it = range.first; it != range.second; ++it) {
+            // on recup la valeur
+            float v = 0.0f;
+            it->key->GetValue(&v, it->component);
 
-                        if (rc.ContainsPoint(p)) {
-                            AddKeyToSelection(itChan->second);
-                        } else {
-                            RemoveKeyFromSelection(itChan->second);
-                        }
-                    }
-                }
+            ct::fvec2 p = GetWorldPosFromFrameValue(ct::fvec2((float)it->frame, v), vZone);
+
+            if (rc.ContainsPoint(p)) {
+                selection.emplace(it->key);
             }
         }
+
+        puSelectedKeys = std::move(selection);
     }
 }
 
@@ -904,71 +1122,80 @@ float TimeLineSystem::Interpolate_Linear(const float& vStart, const float& vEnd,
     return ct::mix(vStart, vEnd, vRatio);
 }
 
-float TimeLineSystem::Interpolate_Quadratic(const int& vStartFrame,
+// the control points of the segment, like they are displayed in the graph
+static bool TimeLineSystem_SetBezierSegment(const TimeLineSegmentInterpolation& vInterpolationMode,
+                                            const int& vStartFrame,
                                             const float& vStartValue,
-                                            std::shared_ptr<UploadableUniform> vStart,
+                                            const std::shared_ptr<UploadableUniform>& vStart,
                                             const int& vEndFrame,
                                             const float& vEndValue,
-                                            std::shared_ptr<UploadableUniform> vEnd,
-                                            const float& vRatio,
-                                            bool vUseDerivation) {
-    ZoneScoped;
+                                            const std::shared_ptr<UploadableUniform>& vEnd,
+                                            TimeLineBezierSegment* vOutSegment) {
+    if (!vStart || !vEnd || !vOutSegment)
+        return false;
 
-    if (vStart && vEnd) {
-        const ct::fvec2 p0 = ct::fvec2((float)vStartFrame, (float)vStartValue);
-        const ct::fvec2 p2 = ct::fvec2((float)vEndFrame, (float)vEndValue);
+    const ct::fvec2 p0 = ct::fvec2((float)vStartFrame, (float)vStartValue);
+    const ct::fvec2 p3 = ct::fvec2((float)vEndFrame, (float)vEndValue);
+
+    if (vInterpolationMode == TimeLineSegmentInterpolation::TIMELINE_INTERPOLATION_SPLINE_QUADRATIC) {
         ct::fvec2 p1;
         if (vStart->timeLineHandlerType == TimeLineHandlerType::TIMELINE_HANDLER_TYPE_CONTROL_POINT_RIGHT ||
             vStart->timeLineHandlerType == TimeLineHandlerType::TIMELINE_HANDLER_TYPE_CONTROL_POINT_BOTH)
             p1 = p0 + vStart->bezierControlStartPoint;
         else if (vEnd->timeLineHandlerType == TimeLineHandlerType::TIMELINE_HANDLER_TYPE_CONTROL_POINT_LEFT ||
                  vEnd->timeLineHandlerType == TimeLineHandlerType::TIMELINE_HANDLER_TYPE_CONTROL_POINT_BOTH)
-            p1 = p2 - vEnd->bezierContorlEndPoint;
+            p1 = p3 - vEnd->bezierContorlEndPoint;
         else {
             CTOOL_DEBUG_BREAK;
         }
+        vOutSegment->SetQuadratic(p0, p1, p3);
+        return true;
+    } else if (vInterpolationMode == TimeLineSegmentInterpolation::TIMELINE_INTERPOLATION_SPLINE_CUBIC) {
+        const ct::fvec2 p1 = p0 + vStart->bezierControlStartPoint;
+        const ct::fvec2 p2 = p3 - vEnd->bezierContorlEndPoint;
+        vOutSegment->SetCubic(p0, p1, p2, p3);
+        return true;
+    }
 
-        if (IS_FLOAT_EQUAL(vRatio, 0.0f))
-            return vStartValue;
-        if (IS_FLOAT_EQUAL(vRatio, 1.0f))
-            return vEndValue;
-
-        const float targetX = ct::mix(p0.x, p2.x, vRatio);
-
-        // TODO: a optimiser, l'algo de recherche part du debut a chaque fois, voir a partir de ratio dans un sens puis dans l'autre ci on s'eloigne
-        float _x = 1e5f, x = -1e5f;
-        float w[3] = {0.0f, 0.0f, 0.0f};
-        for (float t = 0.0f; t <= 1.0f; t += 0.001f) {
-            if (vUseDerivation)  // derivee pour le calcul de la pente pour afficher les tangeante
-            {
-                // dP(t) / dt =  - 2 * (1 - t) * P0 + 2 * t * P1 + 2 * P2
-                // dP(t) / dt =  -2 * u * P0 + 2 * t * P1 + P2
-                const float u = 1.0f - t;
-                w[0] = -2.0f * u;
-                w[1] = 2.0f * t;
-                w[2] = 2.0f;
-            } else {
-                // P(t) = (1 - t) ^ 2 * P0 + 2 * t * (1 - t) * P1 + t ^ 2 * P2
-                // P(t) = u ^ 2 * P0 + 2 * t * u * P1 + t * t  * P2
-
-                const float u = 1.0f - t;
-                w[0] = u * u;
-                w[1] = 2.0f * u * t;
-                w[2] = t * t;
-            }
-
-            x = w[0] * p0.x + w[1] * p1.x + w[2] * p2.x;
+    return false;
+}
 
-            if (x > targetX && _x < targetX) {
-                const float y = w[0] * p0.y + w[1] * p1.y + w[2] * p2.y;
-                // LogVar("t:" + ct::toStr(t) + "\tf:" + ct::toStr(targetX) + "\ty:" + ct::toStr(y));
-                return y;
-            }
+static float TimeLineSystem_EvalBezierSegment(TimeLineBezierSegment& vSegment,
+                                              const int& vStartFrame,
+                                              const float& vStartValue,
+                                              const int& vEndFrame,
+                                              const float& vEndValue,
+                                              const float& vRatio,
+                                              bool vUseDerivation) {
+    if (IS_FLOAT_EQUAL(vRatio, 0.0f))
+        return vStartValue;
+    if (IS_FLOAT_EQUAL(vRatio, 1.0f))
+        return vEndValue;
+
+    const float targetX = ct::mix((float)vStartFrame, (float)vEndFrame, vRatio);
+    const float t = vSegment.SolveT(targetX);
+
+    // derivee pour le calcul de la pente pour afficher les tangeante
+    if (vUseDerivation)
+        return vSegment.GetDerivativeY(t);
+
+    return vSegment.GetY(t);
+}
 
-            _x = x;
-        }
+float TimeLineSystem::Interpolate_Quadratic(const int& vStartFrame,
+                                            const float& vStartValue,
+                                            std::shared_ptr<UploadableUniform> vStart,
+                                            const int& vEndFrame,
+                                            const float& vEndValue,
+                                            std::shared_ptr<UploadableUniform> vEnd,
+                                            const float& vRatio,
+                                            bool vUseDerivation) {
+    ZoneScoped;
 
-        return _x;
+    TimeLineBezierSegment segment;
+    if (TimeLineSystem_SetBezierSegment(TimeLineSegmentInterpolation::TIMELINE_INTERPOLATION_SPLINE_QUADRATIC,  //
+                                        vStartFrame, vStartValue, vStart, vEndFrame, vEndValue, vEnd, &segment)) {
+        return TimeLineSystem_EvalBezierSegment(segment, vStartFrame, vStartValue, vEndFrame, vEndValue, vRatio, vUseDerivation);
     }
 
     return 0.0f;
@@ -984,55 +1211,10 @@ float TimeLineSystem::Interpolate_Bezier(const int& vStartFrame,
                                          bool vUseDerivation) {
     ZoneScoped;
 
-    if (vStart && vEnd) {
-        const ct::fvec2 p0 = ct::fvec2((float)vStartFrame, (float)vStartValue);
-        const ct::fvec2 p1 = p0 + vStart->bezierControlStartPoint;
-        const ct::fvec2 p3 = ct::fvec2((float)vEndFrame, (float)vEndValue);
-        const ct::fvec2 p2 = p3 - vEnd->bezierContorlEndPoint;
-
-        if (IS_FLOAT_EQUAL(vRatio, 0.0f))
-            return vStartValue;
-        if (IS_FLOAT_EQUAL(vRatio, 1.0f))
-            return vEndValue;
-
-        const float targetX = ct::mix(p0.x, p3.x, vRatio);
-
-        // TODO: a optimiser, l'algo de recherche part du debut a chaque fois, voir a partir de ratio dans un sens puis dans l'autre ci on s'eloigne
-        float _x = 1e5f, x = -1e5f;
-        float w[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-        for (float t = 0.0f; t <= 1.0f; t += 0.001f) {
-            if (vUseDerivation)  // derivee pour le calcul de la pente pour afficher les tangeante
-            {
-                // dP(t) / dt =  -3 * (1-t)^2 * P0 + 3 * (1-t)^2 * P1 - 6 * t * (1-t) * P1 - 3 * t^2 * P2 + 6 * t(1-t) * P2 + 3 * t^2 * P3
-                // dP(t) / dt =  -3 * u^2 * P0 + (3 * u^2 - 6 * t * u) * P1 + (6 * t * u - 3 * t^2) * P2 + 3 * t^2 * P3
-                const float u = 1.0f - t;
-                w[0] = -3.0f * u * u;
-                w[1] = 3.0f * u * u - 6.0f * t * u;
-                w[2] = 6.0f * t * u - 3.0f * t * t;
-                w[3] = 3.0f * t * t;
-            } else {
-                // P(t) = (1 - t) ^ 3 * P0 + 3t(1 - t) ^ 2 * P1 + 3 * t ^ 2 (1 - t) * P2 + t ^ 3 * P3
-                // P(t) = u ^ 3 * P0 + 3 * t * u^2 * P1 + 3 * t^2 * u * P2 + t ^ 3 * P3
-
-                const float u = 1.0f - t;
-                w[0] = u * u * u;
-                w[1] = 3.0f * u * u * t;
-                w[2] = 3.0f * u * t * t;
-                w[3] = t * t * t;
-            }
-
-            x = w[0] * p0.x + w[1] * p1.x + w[2] * p2.x + w[3] * p3.x;
-
-            if (x > targetX && _x < targetX) {
-                const float y = w[0] * p0.y + w[1] * p1.y + w[2] * p2.y + w[3] * p3.y;
-                // LogVar("t:" + ct::toStr(t) + "\tf:" + ct::toStr(targetX) + "\ty:" + ct::toStr(y));
-                return y;
-            }
-
-            _x = x;
-        }
-
-        return _x;
+    TimeLineBezierSegment segment;
+    if (TimeLineSystem_SetBezierSegment(TimeLineSegmentInterpolation::TIMELINE_INTERPOLATION_SPLINE_CUBIC,  //
+                                        vStartFrame, vStartValue, vStart, vEndFrame, vEndValue, vEnd, &segment)) {
+        return TimeLineSystem_EvalBezierSegment(segment, vStartFrame, vStartValue, vEndFrame, vEndValue, vRatio, vUseDerivation);
     }
 
     return 0.0f;
@@ -1046,10 +1228,10 @@ void TimeLineSystem::ReComputeInterpolation(ShaderKeyPtr vKey) {
     ZoneScoped;
 
     if (vKey) {
+        vKey->puTimeLine.InvalidateKeyIndex();
         for (auto& it : vKey->puTimeLine.timeLine) {
-            it.second.values.clear();
-            for (auto it2 = it.second.keys.begin(); it2 != it.second.keys.end(); ++it2) {
-                ReComputeInterpolation(vKey, it.first, it2->first);
+            for (int comp = 0; comp < TIMELINE_COUNT_COMPONENTS; ++comp) {
+                ReComputeInterpolation(&it.second, comp);
             }
         }
     }
@@ -1058,28 +1240,23 @@ void TimeLineSystem::ReComputeInterpolation(ShaderKeyPtr vKey) {
 void TimeLineSystem::ReComputeInterpolation(ShaderKeyPtr vKey, std::string vUniformName) {
     ZoneScoped;
 
-    // ca va remplir la map value du container
+    // ca va remplir les valeurs bakées du container
     if (vKey && !vUniformName.empty()) {
-        if (vKey->puTimeLine.timeLine.find(vUniformName) != vKey->puTimeLine.timeLine.end()) {  // trouvé
-            auto st = &vKey->puTimeLine.timeLine[vUniformName];
-            st->values.clear();
-            for (auto it = st->keys.begin(); it != st->keys.end(); ++it) {
-                ReComputeInterpolation(vKey, vUniformName, it->first);
-            }
-        }
+        ReComputeInterpolation(&(vKey->puTimeLine), vUniformName);
     }
 }
 
 void TimeLineSystem::ReComputeInterpolation(TimeLineInfos* vTimeLineInfos, std::string vUniformName) {
     ZoneScoped;
 
-    // ca va remplir la map value du container
+    // ca va remplir les valeurs bakées du container
     if (vTimeLineInfos && !vUniformName.empty()) {
-        if (vTimeLineInfos->timeLine.find(vUniformName) != vTimeLineInfos->timeLine.end()) {  // trouvé
-            auto st = &vTimeLineInfos->timeLine[vUniformName];
-            st->values.clear();
-            for (auto it = st->keys.begin(); it != st->keys.end(); ++it) {
-                ReComputeInterpolation(vTimeLineInfos, vUniformName, it->first);
+        vTimeLineInfos->InvalidateKeyIndex();
+        auto it = vTimeLineInfos->timeLine.find(vUniformName);
+        if (it != vTimeLineInfos->timeLine.end()) {  // trouvé
+            // the components without keys are cleared
+            for (int comp = 0; comp < TIMELINE_COUNT_COMPONENTS; ++comp) {
+                ReComputeInterpolation(&it->second, comp);
             }
         }
     }
@@ -1088,7 +1265,7 @@ void TimeLineSystem::ReComputeInterpolation(TimeLineInfos* vTimeLineInfos, std::
 void TimeLineSystem::ReComputeInterpolation(ShaderKeyPtr vKey, std::string vUniformName, int vComponent) {
     ZoneScoped;
 
-    // ca va remplir la map value du container
+    // ca va remplir les valeurs bakées du container
     if (vKey && !vUniformName.empty()) {
         ReComputeInterpolation(&(vKey->puTimeLine), vUniformName, vComponent);
     }
@@ -1097,164 +1274,294 @@ void TimeLineSystem::ReComputeInterpolation(ShaderKeyPtr vKey, std::string vUnif
 void TimeLineSystem::ReComputeInterpolation(TimeLineInfos* vTimeLineInfos, std::string vUniformName, int vComponent) {
     ZoneScoped;
 
-    // ca va remplir la map value du container
+    // ca va remplir les valeurs bakées du container
     if (vTimeLineInfos && !vUniformName.empty()) {
-        if (vTimeLineInfos->timeLine.find(vUniformName) != vTimeLineInfos->timeLine.end())  // trouvé
-        {
-            const auto st = &vTimeLineInfos->timeLine[vUniformName];
-            ReComputeInterpolation(st, vComponent);
-        } else  // non trouvé
-        {
+        vTimeLineInfos->InvalidateKeyIndex();
+        auto it = vTimeLineInfos->timeLine.find(vUniformName);
+        if (it != vTimeLineInfos->timeLine.end()) {  // trouvé
+            ReComputeInterpolation(&it->second, vComponent);
         }
     }
 }
 
+// only the segments around the keys who have changed since the last bake are baked again
+// all the component is baked again if his frame range or his type changed
 void TimeLineSystem::ReComputeInterpolation(UniformTimeKey* vUniformTimeKeyStruct, int vComponent) {
     ZoneScoped;
 
-    // ca va remplir la map value du container
-    if (vUniformTimeKeyStruct) {
+    if (vUniformTimeKeyStruct && vComponent >= 0 && vComponent < TIMELINE_COUNT_COMPONENTS) {
         UniformTimeKey* st = vUniformTimeKeyStruct;
-        if (st->keys.find(vComponent) != st->keys.end()) {  // trouvé
-            if (st->keys[vComponent].size() != 1) {
-                int lastFrame = st->keys[vComponent].begin()->first;
-                auto last = st->keys[vComponent].begin()->second;
-                if (last.use_count()) {
-                    int currentFrame = 0;
-                    for (auto frame : st->keys[vComponent]) {
-                        currentFrame = frame.first;
-                        auto current = frame.second;
-                        if (current.use_count()) {
-                            int countFrameToInterpolate = currentFrame - lastFrame;
-                            if (countFrameToInterpolate > 0) {
-                                for (int i = lastFrame; i <= currentFrame; i++) {
-                                    float ratio = (float)(i - lastFrame) / (float)(currentFrame - lastFrame);
-                                    std::shared_ptr<UploadableUniform> val_ptr = nullptr;
-                                    if (st->values.size() > i) {
-                                        val_ptr = st->values[i];
-                                    } else {
-                                        val_ptr = std::make_shared<UploadableUniform>();
-                                    }
-                                    if (val_ptr.use_count()) {
-                                        val_ptr->glslType = st->glslType;
-                                        switch (st->glslType) {
-                                            case uType::uTypeEnum::U_FLOAT:
-                                            case uType::uTypeEnum::U_VEC2:
-                                            case uType::uTypeEnum::U_VEC3:
-                                            case uType::uTypeEnum::U_VEC4: {
-                                                val_ptr->xyzw[vComponent] =
-                                                    Interpolate(st, lastFrame, last->xyzw[vComponent], last, currentFrame, current->xyzw[vComponent], current, ratio);
-                                                val_ptr->useFloat[vComponent] = 1;
-                                            } break;
-                                            case uType::uTypeEnum::U_BOOL:
-                                            case uType::uTypeEnum::U_BVEC2:
-                                            case uType::uTypeEnum::U_BVEC3:
-                                            case uType::uTypeEnum::U_BVEC4: {
-                                                val_ptr->xyzw[vComponent] =
-                                                    Interpolate(st, lastFrame, last->xyzw[vComponent], last, currentFrame, current->xyzw[vComponent], current, ratio);
-                                                val_ptr->useBool[vComponent] = 1;
-                                            } break;
-                                            case uType::uTypeEnum::U_INT:
-                                            case uType::uTypeEnum::U_IVEC2:
-                                            case uType::uTypeEnum::U_IVEC3:
-                                            case uType::uTypeEnum::U_IVEC4: {
-                                                val_ptr->ixyzw[vComponent] = (int)Interpolate(
-                                                    st, lastFrame, (float)last->ixyzw[vComponent], last, currentFrame, (float)current->ixyzw[vComponent], current, ratio);
-                                                val_ptr->useInt[vComponent] = 1;
-                                            } break;
-                                            case uType::uTypeEnum::U_MAT2: {
-                                                float* arr = glm::value_ptr(val_ptr->mat4[0]);
-                                                float* arrLast = glm::value_ptr(last->mat4[0]);
-                                                float* arrCurr = glm::value_ptr(current->mat4[0]);
-                                                for (int j = 0; j < 4; j++) {
-                                                    arr[j] = (float)ct::mix(arrLast[j], arrCurr[j], ratio);
-                                                }
-                                                val_ptr->useMat = 1;
-                                            } break;
-                                            case uType::uTypeEnum::U_MAT3: {
-                                                float* arr = glm::value_ptr(val_ptr->mat4[0]);
-                                                float* arrLast = glm::value_ptr(last->mat4[0]);
-                                                float* arrCurr = glm::value_ptr(current->mat4[0]);
-                                                for (int j = 0; j < 9; j++) {
-                                                    arr[j] = (float)ct::mix(arrLast[j], arrCurr[j], ratio);
-                                                }
-                                                val_ptr->useMat = 1;
-                                            } break;
-                                            case uType::uTypeEnum::U_MAT4: {
-                                                float* arr = glm::value_ptr(val_ptr->mat4[0]);
-                                                float* arrLast = glm::value_ptr(last->mat4[0]);
-                                                float* arrCurr = glm::value_ptr(current->mat4[0]);
-                                                for (int j = 0; j < 16; j++) {
-                                                    arr[j] = (float)ct::mix(arrLast[j], arrCurr[j], ratio);
-                                                }
-                                                val_ptr->useMat = 1;
-                                            } break;
-                                            default: break;
-                                        }
-                                        st->values[i] = val_ptr;
-                                    }
-                                }
-                            }
-                            lastFrame = currentFrame;
-                            last = current;
-                        }
+        auto& baked = st->baked[vComponent];
+
+        auto itKeys = st->keys.find(vComponent);
+        if (itKeys == st->keys.end()) {  // non trouvé
+            baked.Clear();
+            puFrameChanged = true;
+            return;
+        }
+
+        int countValuesByFrame = 1;
+        bool isIntType = false;
+        switch (st->glslType) {
+            case uType::uTypeEnum::U_INT:
+            case uType::uTypeEnum::U_IVEC2:
+            case uType::uTypeEnum::U_IVEC3:
+            case uType::uTypeEnum::U_IVEC4: isIntType = true; break;
+            case uType::uTypeEnum::U_MAT2: countValuesByFrame = 4; break;
+            case uType::uTypeEnum::U_MAT3: countValuesByFrame = 9; break;
+            case uType::uTypeEnum::U_MAT4: countValuesByFrame = 16; break;
+            default: break;
+        }
+
+        std::vector<TimeLineBakedKey> newKeys;
+        newKeys.reserve(itKeys->second.size());
+        for (const auto& frameKey : itKeys->second) {
+            if (frameKey.second.use_count()) {
+                TimeLineBakedKey key;
+                key.frame = frameKey.first;
+                key.value = isIntType ? (float)frameKey.second->ixyzw[vComponent] : frameKey.second->xyzw[vComponent];
+                key.mat4 = frameKey.second->mat4;
+                key.bezierControlStartPoint = frameKey.second->bezierControlStartPoint;
+                key.bezierContorlEndPoint = frameKey.second->bezierContorlEndPoint;
+                key.timeLineHandlerType = frameKey.second->timeLineHandlerType;
+                newKeys.push_back(key);
+            }
+        }
+
+        if (newKeys.size() < 2U) {  // no segment to interpolate
+            baked.Clear();
+            puFrameChanged = true;
+            return;
+        }
+
+        const int startFrame = newKeys.front().frame;
+        const int endFrame = newKeys.back().frame;
+        int dirtyStartFrame = startFrame;
+        int dirtyEndFrame = endFrame;
+
+        if (baked.IsEmpty() || baked.glslType != st->glslType || baked.countValuesByFrame != countValuesByFrame ||  //
+            baked.startFrame != startFrame || baked.GetEndFrame() != endFrame) {
+            baked.glslType = st->glslType;
+            baked.startFrame = startFrame;
+            baked.countValuesByFrame = countValuesByFrame;
+            baked.values.assign((size_t)(endFrame - startFrame + 1) * (size_t)countValuesByFrame, 0.0f);
+        } else {
+            // frames of the keys added, removed or modified
+            int firstChangedFrame = endFrame + 1;
+            int lastChangedFrame = startFrame - 1;
+            auto markChange = [&firstChangedFrame, &lastChangedFrame](const int& vFrame) {
+                firstChangedFrame = ct::mini(firstChangedFrame, vFrame);
+                lastChangedFrame = ct::maxi(lastChangedFrame, vFrame);
+            };
+            const auto& oldKeys = baked.keys;
+            size_t o = 0U, n = 0U;
+            while (o < oldKeys.size() || n < newKeys.size()) {
+                if (n == newKeys.size() || (o < oldKeys.size() && oldKeys[o].frame < newKeys[n].frame)) {
+                    markChange(oldKeys[o++].frame);
+                } else if (o == oldKeys.size() || newKeys[n].frame < oldKeys[o].frame) {
+                    markChange(newKeys[n++].frame);
+                } else {
+                    if (oldKeys[o] != newKeys[n]) {
+                        markChange(newKeys[n].frame);
                     }
+                    ++o;
+                    ++n;
                 }
             }
-        } else {  // non trouvé
+
+            if (firstChangedFrame > lastChangedFrame) {  // nothing to bake
+                baked.keys = std::move(newKeys);
+                return;
+            }
+
+            // the segments who touch a changed key, from the key before to the key after
+            auto itFirst = std::lower_bound(newKeys.begin(), newKeys.end(), firstChangedFrame, [](const TimeLineBakedKey& vKey, const int& vFrame) {
+                return vKey.frame < vFrame;
+            });
+            dirtyStartFrame = (itFirst != newKeys.begin()) ? (itFirst - 1)->frame : startFrame;
+            auto itLast = std::upper_bound(newKeys.begin(), newKeys.end(), lastChangedFrame, [](const int& vFrame, const TimeLineBakedKey& vKey) {
+                return vFrame < vKey.frame;
+            });
+            dirtyEndFrame = (itLast != newKeys.end()) ? itLast->frame : endFrame;
         }
+
+        int lastFrame = 0;
+        std::shared_ptr<UploadableUniform> last = nullptr;
+        for (const auto& frameKey : itKeys->second) {
+            if (!frameKey.second.use_count())
+                continue;
+            if (last.use_count() && lastFrame >= dirtyStartFrame && frameKey.first <= dirtyEndFrame) {
+                BakeSegment(st, &baked, vComponent, lastFrame, last, frameKey.first, frameKey.second);
+            }
+            if (frameKey.first >= dirtyEndFrame)
+                break;
+            lastFrame = frameKey.first;
+            last = frameKey.second;
+        }
+
+        baked.keys = std::move(newKeys);
+
         puFrameChanged = true;
     }
 }
 
+void TimeLineSystem::BakeSegment(UniformTimeKey* vUniformTimeKeyStruct,
+                                 TimeLineBakedComponent* vBaked,
+                                 int vComponent,
+                                 int vStartFrame,
+                                 std::shared_ptr<UploadableUniform> vStart,
+                                 int vEndFrame,
+                                 std::shared_ptr<UploadableUniform> vEnd) {
+    ZoneScoped;
+
+    const int countFrameToInterpolate = vEndFrame - vStartFrame;
+    if (!vUniformTimeKeyStruct || !vBaked || countFrameToInterpolate <= 0)
+        return;
+
+    UniformTimeKey* st = vUniformTimeKeyStruct;
+    const auto& last = vStart;
+    const auto& current = vEnd;
+
+    // the bezier coefficients are computed one time for all the frames of the segment
+    const auto interpolation_mode = GetTimeLineSegmentInterpolationMode(last, current);
+    float startValue = 0.0f;
+    float endValue = 0.0f;
+    bool isIntType = false;
+    switch (st->glslType) {
+        case uType::uTypeEnum::U_INT:
+        case uType::uTypeEnum::U_IVEC2:
+        case uType::uTypeEnum::U_IVEC3:
+        case uType::uTypeEnum::U_IVEC4:
+            startValue = (float)last->ixyzw[vComponent];
+            endValue = (float)current->ixyzw[vComponent];
+            isIntType = true;
+            break;
+        default:
+            startValue = last->xyzw[vComponent];
+            endValue = current->xyzw[vComponent];
+            break;
+    }
+    TimeLineBezierSegment segment;
+    const bool isBezier = TimeLineSystem_SetBezierSegment(interpolation_mode, vStartFrame, startValue, last, vEndFrame, endValue, current, &segment);
+
+    // the frame of the end key is given by the next segment, except for the last key
+    // like this a partial bake give the same values than a full bake
+    const int lastFrameToBake = (vEndFrame < vBaked->GetEndFrame()) ? vEndFrame - 1 : vEndFrame;
+    for (int i = vStartFrame; i <= lastFrameToBake; i++) {
+        const float ratio = (float)(i - vStartFrame) / (float)countFrameToInterpolate;
+        float* arr = vBaked->GetValues(i);
+        if (!arr)
+            continue;
+        switch (st->glslType) {
+            case uType::uTypeEnum::U_FLOAT:
+            case uType::uTypeEnum::U_VEC2:
+            case uType::uTypeEnum::U_VEC3:
+            case uType::uTypeEnum::U_VEC4:
+            case uType::uTypeEnum::U_BOOL:
+            case uType::uTypeEnum::U_BVEC2:
+            case uType::uTypeEnum::U_BVEC3:
+            case uType::uTypeEnum::U_BVEC4:
+            case uType::uTypeEnum::U_INT:
+            case uType::uTypeEnum::U_IVEC2:
+            case uType::uTypeEnum::U_IVEC3:
+            case uType::uTypeEnum::U_IVEC4: {
+                float value = 0.0f;
+                if (isBezier) {
+                    value = TimeLineSystem_EvalBezierSegment(segment, vStartFrame, startValue, vEndFrame, endValue, ratio, false);
+                } else {
+                    value = Interpolate(st, vStartFrame, startValue, last, vEndFrame, endValue, current, ratio);
+                }
+                arr[0] = isIntType ? (float)(int)value : value;
+            } break;
+            case uType::uTypeEnum::U_MAT2:
+            case uType::uTypeEnum::U_MAT3:
+            case uType::uTypeEnum::U_MAT4: {
+                const float* arrLast = glm::value_ptr(last->mat4[0]);
+                const float* arrCurr = glm::value_ptr(current->mat4[0]);
+                for (int j = 0; j < vBaked->countValuesByFrame; j++) {
+                    arr[j] = (float)ct::mix(arrLast[j], arrCurr[j], ratio);
+                }
+            } break;
+            default: break;
+        }
+    }
+}
+
 bool TimeLineSystem::UpdateUniforms(ShaderKeyPtr vKey, UniformVariantPtr vUniPtr) {
     ZoneScoped;
     const bool change = false;
     if (vKey && vUniPtr) {
         if (puUploadToGpu && puFrameChanged || puRendering) {
             if (!vKey->puTimeLine.timeLine.empty()) {
-                if (vKey->puTimeLine.timeLine.find(vUniPtr->name) != vKey->puTimeLine.timeLine.end()) {  // trouvé
-                    auto st = &vKey->puTimeLine.timeLine[vUniPtr->name];
-                    if (st->values.find(puCurrentFrame) != st->values.end()) {  // trouvé
-                        auto v = st->values[puCurrentFrame];
-                        if (v.use_count()) {
-                            if (v->useFloat[0])
-                                vUniPtr->x = v->xyzw[0];
-                            if (v->useFloat[1])
-                                vUniPtr->y = v->xyzw[1];
-                            if (v->useFloat[2])
-                                vUniPtr->z = v->xyzw[2];
-                            if (v->useFloat[3])
-                                vUniPtr->w = v->xyzw[3];
-                            if (v->useBool[0])
-                                vUniPtr->bx = (v->xyzw[0] > 0.5f);
-                            if (v->useBool[1])
-                                vUniPtr->by = (v->xyzw[1] > 0.5f);
-                            if (v->useBool[2])
-                                vUniPtr->bz = (v->xyzw[2] > 0.5f);
-                            if (v->useBool[3])
-                                vUniPtr->bw = (v->xyzw[3] > 0.5f);
-                            if (v->useInt[0])
-                                vUniPtr->ix = v->ixyzw[0];
-                            if (v->useInt[1])
-                                vUniPtr->iy = v->ixyzw[1];
-                            if (v->useInt[2])
-                                vUniPtr->iz = v->ixyzw[2];
-                            if (v->useInt[3])
-                                vUniPtr->iw = v->ixyzw[3];
-                            if (v->useMat)
-                                vUniPtr->mat4 = v->mat4;
+                auto st = vKey->puTimeLine.GetBoundTimeKey(vUniPtr);
+                if (st) {  // trouvé
+                    const float* v[TIMELINE_COUNT_COMPONENTS];
+                    for (int comp = 0; comp < TIMELINE_COUNT_COMPONENTS; ++comp) {
+                        v[comp] = st->baked[comp].GetValues(puCurrentFrame);
+                    }
+                    switch (st->glslType) {
+                        case uType::uTypeEnum::U_FLOAT:
+                        case uType::uTypeEnum::U_VEC2:
+                        case uType::uTypeEnum::U_VEC3:
+                        case uType::uTypeEnum::U_VEC4: {
+                            if (v[0])
+                                vUniPtr->x = *v[0];
+                            if (v[1])
+                                vUniPtr->y = *v[1];
+                            if (v[2])
+                                vUniPtr->z = *v[2];
+                            if (v[3])
+                                vUniPtr->w = *v[3];
                             if (vUniPtr->widget == "checkbox" || vUniPtr->widget == "radio") {
-                                if (v->useFloat[0])
+                                if (v[0])
                                     vUniPtr->bx = vUniPtr->x > 0.5f;
-                                if (v->useFloat[1])
+                                if (v[1])
                                     vUniPtr->by = vUniPtr->y > 0.5f;
-                                if (v->useFloat[2])
+                                if (v[2])
                                     vUniPtr->bz = vUniPtr->z > 0.5f;
-                                if (v->useFloat[3])
+                                if (v[3])
                                     vUniPtr->bw = vUniPtr->w > 0.5f;
                             }
-                        }
+                        } break;
+                        case uType::uTypeEnum::U_BOOL:
+                        case uType::uTypeEnum::U_BVEC2:
+                        case uType::uTypeEnum::U_BVEC3:
+                        case uType::uTypeEnum::U_BVEC4: {
+                            if (v[0])
+                                vUniPtr->bx = (*v[0] > 0.5f);
+                            if (v[1])
+                                vUniPtr->by = (*v[1] > 0.5f);
+                            if (v[2])
+                                vUniPtr->bz = (*v[2] > 0.5f);
+                            if (v[3])
+                                vUniPtr->bw = (*v[3] > 0.5f);
+                        } break;
+                        case uType::uTypeEnum::U_INT:
+                        case uType::uTypeEnum::U_IVEC2:
+                        case uType::uTypeEnum::U_IVEC3:
+                        case uType::uTypeEnum::U_IVEC4: {
+                            if (v[0])
+                                vUniPtr->ix = (int)*v[0];
+                            if (v[1])
+                                vUniPtr->iy = (int)*v[1];
+                            if (v[2])
+                                vUniPtr->iz = (int)*v[2];
+                            if (v[3])
+                                vUniPtr->iw = (int)*v[3];
+                        } break;
+                        case uType::uTypeEnum::U_MAT2:
+                        case uType::uTypeEnum::U_MAT3:
+                        case uType::uTypeEnum::U_MAT4: {
+                            // the last animated component win, like before
+                            for (int comp = 0; comp < TIMELINE_COUNT_COMPONENTS; ++comp) {
+                                if (v[comp]) {
+                                    glm::mat4 mat = glm::mat4(1.0f);
+                                    memcpy(glm::value_ptr(mat[0]), v[comp], sizeof(float) * (size_t)st->baked[comp].countValuesByFrame);
+                                    vUniPtr->mat4 = mat;
+                                }
+                            }
+                        } break;
+                        default: break;
                     }
                 }
             }
@@ -1346,21 +1653,53 @@ void TimeLineSystem::ShowDialog(ShaderKeyPtr vKey, ct::ivec2 vScreenSize) {
 
         if (ImGuiFileDialog::Instance()->Display("TimeLineRenderingToPictures", ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoDocking, min, max)) {
             if (ImGuiFileDialog::Instance()->IsOk()) {
-                puRenderingPrefix = ImGuiFileDialog::Instance()->GetCurrentFileName();
-                const size_t lastPoint = puRenderingPrefix.find_last_of('.');
-                if (lastPoint != std::string::npos) {
-                    puRenderingPrefix = puRenderingPrefix.substr(0, lastPoint);
-                }
-                puRenderingPath = ImGuiFileDialog::Instance()->GetCurrentPath();
-                puRendering = true;
-                puCurrentFrame = vKey->puTimeLine.rangeFrames.x;
-                puRenderingMode = RenderingModeEnum::RENDERING_MODE_PICTURES;
+                StartRenderingToFile(vKey, RenderingModeEnum::RENDERING_MODE_PICTURES);
+            }
+            ImGuiFileDialog::Instance()->Close();
+        }
+
+        if (ImGuiFileDialog::Instance()->Display("TimeLineRenderingToVideo", ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoDocking, min, max)) {
+            if (ImGuiFileDialog::Instance()->IsOk()) {
+                StartRenderingToFile(vKey, RenderingModeEnum::RENDERING_MODE_VIDEO);
             }
             ImGuiFileDialog::Instance()->Close();
         }
+
+        if (ImGuiFileDialog::Instance()->Display("TimeLineRenderingToGif", ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoDocking, min, max)) {
+            if (ImGuiFileDialog::Instance()->IsOk()) {
+                StartRenderingToFile(vKey, RenderingModeEnum::RENDERING_MODE_GIF);
+            }
+            ImGuiFileDialog::Instance()->Close();
+        }
+    }
+}
+
+void TimeLineSystem::StartRenderingToFile(ShaderKeyPtr vKey, RenderingModeEnum vRenderingMode) {
+    ZoneScoped;
+
+    if (vKey) {
+        CloseFrameSink();
+
+        puRenderingFileName = ImGuiFileDialog::Instance()->GetCurrentFileName();
+        puRenderingPrefix = puRenderingFileName;
+        const size_t lastPoint = puRenderingPrefix.find_last_of('.');
+        if (lastPoint != std::string::npos) {
+            puRenderingPrefix = puRenderingPrefix.substr(0, lastPoint);
+        }
+        puRenderingPath = ImGuiFileDialog::Instance()->GetCurrentPath();
+        puRendering = true;
+        puCurrentFrame = vKey->puTimeLine.rangeFrames.x;
+        puRenderingMode = vRenderingMode;
     }
 }
 
+void TimeLineSystem::StopRendering() {
+    ZoneScoped;
+
+    puRendering = false;
+    CloseFrameSink();
+}
+
 bool TimeLineSystem::DrawBar(ShaderKeyPtr vKey, ct::ivec2 vScreenSize) {
     ZoneScoped;
 
@@ -1388,25 +1727,36 @@ bool TimeLineSystem::DrawBar(ShaderKeyPtr vKey, ct::ivec2 vScreenSize) {
                 ImGuiFileDialog::Instance()->OpenDialog("TimeLineRenderingToPictures", puRenderingPrefix.c_str(), ".png", config);
             }
 
-            /*
+            if (ImGui::BeginMenu("To Video")) {
+                if (ImGui::MenuItem("y4m")) {
+                    IGFD::FileDialogConfig config;
+                    config.path = puRenderingPath;
+                    config.countSelectionMax = 1;
+                    config.flags = ImGuiFileDialogFlags_Modal;
+                    ImGuiFileDialog::Instance()->OpenDialog("TimeLineRenderingToVideo", puRenderingPrefix.c_str(), ".y4m", config);
+                }
 
-            if (ImGui::BeginMenu("To Video"))
-            {
-                if (ImGui::MenuItem("avi"))
-                {
-                    puRenderingMode = TimeLineRenderingModeEnum::TIMELINE_RENDERING_MODE_VIDEO;
+                if (ImGui::MenuItem("avi")) {
+                    IGFD::FileDialogConfig config;
+                    config.path = puRenderingPath;
+                    config.countSelectionMax = 1;
+                    config.flags = ImGuiFileDialogFlags_Modal;
+                    ImGuiFileDialog::Instance()->OpenDialog("TimeLineRenderingToVideo", puRenderingPrefix.c_str(), ".avi", config);
                 }
 
                 ImGui::EndMenu();
             }
 
-            if (ImGui::MenuItem("To Gif"))
-            {
-                puRenderingMode = TimeLineRenderingModeEnum::TIMELINE_RENDERING_MODE_GIF;
-
-                ImGui::EndMenu();
+            if (ImGui::MenuItem("To Gif")) {
+                IGFD::FileDialogConfig config;
+                config.path = puRenderingPath;
+                config.countSelectionMax = 1;
+                config.flags = ImGuiFileDialogFlags_Modal;
+                ImGuiFileDialog::Instance()->OpenDialog("TimeLineRenderingToGif", puRenderingPrefix.c_str(), ".gif", config);
             }
 
+            /*
+
             if (ImGui::MenuItem("To HEIC"))
             {
                 //puRendering = true;
@@ -1788,7 +2138,7 @@ bool TimeLineSystem::DrawBar(ShaderKeyPtr vKey, ct::ivec2 vScreenSize) {
         ImGui::BeginGroup();
         {
             if (ImGui_AbortButton("Abort")) {
-                puRendering = false;
+                StopRendering();
             }
         }
         ImGui::EndGroup();
@@ -1806,25 +2156,8 @@ void TimeLineSystem::GoToNextKey(ShaderKeyPtr vKey, int vCurrentFrame) {
     ZoneScoped;
 
     if (vKey) {
-        bool defined = false;
         int closestFrame = vCurrentFrame;
-        for (auto it = vKey->puTimeLine.timeLine.begin(); it != vKey->puTimeLine.timeLine.end(); ++it) {
-            for (auto itComps = it->second.keys.begin(); itComps != it->second.keys.end(); ++itComps) {
-                for (auto itKeys = itComps->second.begin(); itKeys != itComps->second.end(); ++itKeys) {
-                    if (itKeys->first > vCurrentFrame) {
-                        if (defined) {
-                            closestFrame = ct::mini(itKeys->first, closestFrame);
-                        } else {
-                            closestFrame = itKeys->first;
-                            defined = true;
-                        }
-                        break;
-                    }
-                }
-            }
-        }
-
-        if (closestFrame != vCurrentFrame) {
+        if (vKey->puTimeLine.GetKeyIndex().GetNextFrame(vCurrentFrame, &closestFrame)) {
             GoToFrame(closestFrame);
         }
     }
@@ -1834,25 +2167,8 @@ void TimeLineSystem::GoToPreviousKey(ShaderKeyPtr vKey, int vCurrentFrame) {
     ZoneScoped;
 
     if (vKey) {
-        bool defined = false;
         int closestFrame = vCurrentFrame;
-        for (auto it = vKey->puTimeLine.timeLine.begin(); it != vKey->puTimeLine.timeLine.end(); ++it) {
-            for (auto itComps = it->second.keys.begin(); itComps != it->second.keys.end(); ++itComps) {
-                for (auto itKeys = itComps->second.rbegin(); itKeys != itComps->second.rend(); ++itKeys) {
-                    if (itKeys->first < vCurrentFrame) {
-                        if (defined) {
-                            closestFrame = ct::maxi(itKeys->first, closestFrame);
-                        } else {
-                            closestFrame = itKeys->first;
-                            defined = true;
-                        }
-                        break;
-                    }
-                }
-            }
-        }
-
-        if (closestFrame != vCurrentFrame) {
+        if (vKey->puTimeLine.GetKeyIndex().GetPreviousFrame(vCurrentFrame, &closestFrame)) {
             GoToFrame(closestFrame);
         }
     }
@@ -1876,6 +2192,7 @@ void TimeLineSystem::ScaleTimeLine(ShaderKeyPtr vKey, float vScale) {
         // et re interpoler
         std::map<std::string, UniformTimeKey> tmp = vKey->puTimeLine.timeLine;
         vKey->puTimeLine.timeLine.clear();
+        vKey->puTimeLine.InvalidateBindings();
 
         bool conversioNotPermise = false;
 
@@ -1907,6 +2224,7 @@ void TimeLineSystem::ScaleTimeLine(ShaderKeyPtr vKey, float vScale) {
         if (conversioNotPermise) {
             vKey->puTimeLine.timeLine.clear();
             vKey->puTimeLine.timeLine = tmp;
+            vKey->puTimeLine.InvalidateBindings();
         } else {
             vKey->puTimeLine.rangeFrames.y = (int)((float)vKey->puTimeLine.rangeFrames.y * vScale);
 
@@ -1934,16 +2252,13 @@ void TimeLineSystem::ReArrangeForViewContent(ShaderKeyPtr vKey, ImRect vZone, fl
                 std::string name = itStruct->first;
                 if (puUniformsToEdit.find(name) != puUniformsToEdit.end())  // trouvé
                 {
-                    for (auto val : itStruct->second.values) {
-                        const int frame = val.first;
-
-                        if (val.second.use_count()) {
-                            for (int i = 0; i < 4; i++) {
-                                if (puUniformsToEdit[name] & puTimeLineItemAxisMasks[i]) {
-                                    float v = 0.0f;
-                                    if (val.second->GetValue(&v, i)) {
-                                        aabb.Combine(ct::fvec2((float)frame, v));
-                                    }
+                    for (int i = 0; i < TIMELINE_COUNT_COMPONENTS; i++) {
+                        if (puUniformsToEdit[name] & puTimeLineItemAxisMasks[i]) {
+                            const auto& baked = itStruct->second.baked[i];
+                            for (int frame = baked.startFrame; frame <= baked.GetEndFrame(); ++frame) {
+                                float v = 0.0f;
+                                if (baked.GetValue(frame, &v)) {
+                                    aabb.Combine(ct::fvec2((float)frame, v));
                                 }
                             }
                         }
@@ -2064,7 +2379,7 @@ bool TimeLineSystem::DoAnimation_WithoutUiTriggering(ShaderKeyPtr vKey) {
                 puFrameChanged = true;
                 change |= true;
             } else {
-                puRendering = false;
+                StopRendering();
             }
         } else if (IsPlaying()) {
             if (puAnimationTimer.IsTimeToAct(puFrameRateInMS, true)) {
@@ -2697,7 +3012,7 @@ bool TimeLineSystem::ImGui_DrawTimeLinePointList(ShaderKeyPtr vKey,
 
         // draw items points
         offsetY += g.FontSize + g.Style.FramePadding.y;
-        for (auto sec : vKey->puTimeLine.timeLine) {
+        for (auto& sec : vKey->puTimeLine.timeLine) {
             if (++paningIndex < vPaneOffsetY)
                 continue;
 
@@ -2711,15 +3026,16 @@ bool TimeLineSystem::ImGui_DrawTimeLinePointList(ShaderKeyPtr vKey,
                         float oy = offsetY;
                         for (auto itChan = vTimeKey->keys.begin(); itChan != vTimeKey->keys.end(); ++itChan) {
                             if (!itChan->second.empty()) {
-                                for (auto frame : itChan->second) {
-                                    const int f = frame.first;  // frame
-                                    if (frame.second.use_count()) {
-                                        if (f >= startFrame && f <= endFrame) {
-                                            const float ox = vPaneOffsetX + (int)(f * puStepSize) / puStepScale;
-                                            const ImVec2 center = ImVec2(frame_bb.Min.x + ox, frame_bb.Min.y + oy + g.FontSize * 0.5f);
-
-                                            value_changed |= ImGui_DrawGraphPointButton(vTimeKey, frame.second, f, center, hovered);
-                                        }
+                                // only the visible keys
+                                for (auto itFrame = itChan->second.lower_bound(startFrame); itFrame != itChan->second.end(); ++itFrame) {
+                                    const int f = itFrame->first;  // frame
+                                    if (f > endFrame)
+                                        break;
+                                    if (itFrame->second.use_count()) {
+                                        const float ox = vPaneOffsetX + (int)(f * puStepSize) / puStepScale;
+                                        const ImVec2 center = ImVec2(frame_bb.Min.x + ox, frame_bb.Min.y + oy + g.FontSize * 0.5f);
+
+                                        value_changed |= ImGui_DrawGraphPointButton(vTimeKey, itFrame->second, f, center, hovered);
                                     }
                                 }
                                 oy += g.FontSize + g.Style.FramePadding.y;
@@ -2779,37 +3095,38 @@ bool TimeLineSystem::ImGui_DrawTimeLineCurveGraph(ShaderKeyPtr vKey,
                                                 int _lastFrame = lineStruct->begin()->first;
                                                 auto _lastStruct = vTimeKey->keys[axis].begin()->second;
                                                 ImVec2 _lastPos = ImVec2(0.0f, 0.0f);
-                                                for (auto frame : *lineStruct) {
-                                                    int curFrame = frame.first;  // frame
-                                                    auto _Struct = frame.second;
-                                                    if (curFrame >= vStartFrame && curFrame <= vEndFrame) {
-                                                        // float oy = 0.0f;
-                                                        float v = 0.0f;
-                                                        _Struct->GetValue(&v, axis);
-                                                        ImVec2 pos;
-                                                        pos.x = vFrameBB.Min.x + vPaneOffsetX + GetLocalPosFromFrame(curFrame);
-                                                        pos.y = vFrameBB.Min.y + vPaneOffsetY - GetLocalPosFromValue(v);
-
-                                                        if (curFrame != _lastFrame) {
-                                                            ImVec4 colLine = ImVec4(0.9f, 0.1f, 0.1f, 0.6f);
-                                                            if (axis == 1)
-                                                                colLine = ImVec4(0.1f, 0.9f, 0.1f, 0.6f);
-                                                            if (axis == 2)
-                                                                colLine = ImVec4(0.1f, 0.1f, 0.9f, 0.6f);
-                                                            if (axis == 3)
-                                                                colLine = ImVec4(0.6f, 0.6f, 0.6f, 0.6f);
-
-                                                            value_changed |= ImGui_DrawGraphLineButton(
-                                                                vTimeKey, _lastFrame, curFrame, _lastPos, pos, _lastStruct, _Struct, colLine, vFrameBB, axis);
-                                                        }
+                                                // only the visible keys
+                                                for (auto itFrame = lineStruct->lower_bound(vStartFrame); itFrame != lineStruct->end(); ++itFrame) {
+                                                    int curFrame = itFrame->first;  // frame
+                                                    auto _Struct = itFrame->second;
+                                                    if (curFrame > vEndFrame)
+                                                        break;
+                                                    // float oy = 0.0f;
+                                                    float v = 0.0f;
+                                                    _Struct->GetValue(&v, axis);
+                                                    ImVec2 pos;
+                                                    pos.x = vFrameBB.Min.x + vPaneOffsetX + GetLocalPosFromFrame(curFrame);
+                                                    pos.y = vFrameBB.Min.y + vPaneOffsetY - GetLocalPosFromValue(v);
+
+                                                    if (curFrame != _lastFrame) {
+                                                        ImVec4 colLine = ImVec4(0.9f, 0.1f, 0.1f, 0.6f);
+                                                        if (axis == 1)
+                                                            colLine = ImVec4(0.1f, 0.9f, 0.1f, 0.6f);
+                                                        if (axis == 2)
+                                                            colLine = ImVec4(0.1f, 0.1f, 0.9f, 0.6f);
+                                                        if (axis == 3)
+                                                            colLine = ImVec4(0.6f, 0.6f, 0.6f, 0.6f);
+
+                                                        value_changed |= ImGui_DrawGraphLineButton(
+                                                            vTimeKey, _lastFrame, curFrame, _lastPos, pos, _lastStruct, _Struct, colLine, vFrameBB, axis);
+                                                    }
 
-                                                        window->DrawList->ChannelsSetCurrent(2);
-                                                        value_changed |= ImGui_DrawGraphPointButton(vTimeKey, _Struct, curFrame, pos, vHovered);
+                                                    window->DrawList->ChannelsSetCurrent(2);
+                                                    value_changed |= ImGui_DrawGraphPointButton(vTimeKey, _Struct, curFrame, pos, vHovered);
 
-                                                        _lastFrame = curFrame;
-                                                        _lastStruct = _Struct;
-                                                        _lastPos = pos;
-                                                    }
+                                                    _lastFrame = curFrame;
+                                                    _lastStruct = _Struct;
+                                                    _lastPos = pos;
                                                 }
                                             }
                                         }
@@ -2864,8 +3181,8 @@ bool TimeLineSystem::ImGui_DrawGraphLineButton(UniformTimeKey* vKeyStruct,
                     int frame = i * puStepScale;
                     const int posX = (int)puPaneOffsetX + GetLocalPosFromFrame(frame);
                     float v = 0.0f;
-                    if (vKeyStruct->values[frame].use_count()) {
-                        if (vKeyStruct->values[frame]->GetValue(&v, vAxis)) {
+                    if (vAxis >= 0 && vAxis < TIMELINE_COUNT_COMPONENTS) {
+                        if (vKeyStruct->baked[vAxis].GetValue(frame, &v)) {
                             const int posY = (int)(puPaneOffsetY - GetLocalPosFromValue(v));
                             ImGui_DrawGraphPoint(vFrame_bb.Min + ImVec2((float)posX, (float)posY), col);
                         }
@@ -2886,8 +3203,8 @@ bool TimeLineSystem::ImGui_DrawGraphLineButton(UniformTimeKey* vKeyStruct,
                     int frame = i * puStepScale;
                     const int posX = (int)puPaneOffsetX + GetLocalPosFromFrame(frame);
                     float v = 0.0f;
-                    if (vKeyStruct->values[frame].use_count()) {
-                        if (vKeyStruct->values[frame]->GetValue(&v, vAxis)) {
+                    if (vAxis >= 0 && vAxis < TIMELINE_COUNT_COMPONENTS) {
+                        if (vKeyStruct->baked[vAxis].GetValue(frame, &v)) {
                             const int posY = (int)(puPaneOffsetY - GetLocalPosFromValue(v));
                             const ImVec2 pt = vFrame_bb.Min + ImVec2((float)posX, (float)posY);
                             ImGui_DrawGraphPoint(pt, col);
@@ -2945,8 +3262,8 @@ bool TimeLineSystem::ImGui_DrawGraphLineButton(UniformTimeKey* vKeyStruct,
                     int frame = i * puStepScale;
                     const int posX = (int)puPaneOffsetX + GetLocalPosFromFrame(frame);
                     float v = 0.0f;
-                    if (vKeyStruct->values[frame].use_count()) {
-                        if (vKeyStruct->values[frame]->GetValue(&v, vAxis)) {
+                    if (vAxis >= 0 && vAxis < TIMELINE_COUNT_COMPONENTS) {
+                        if (vKeyStruct->baked[vAxis].GetValue(frame, &v)) {
                             const int posY = (int)(puPaneOffsetY - GetLocalPosFromValue(v));
                             const ImVec2 pt = vFrame_bb.Min + ImVec2((float)posX, (float)posY);
                             ImGui_DrawGraphPoint(pt, col);
@@ -3692,6 +4009,7 @@ void TimeLineSystem::Clean_All(ShaderKeyPtr vKey) {
 
     if (vKey) {
         vKey->puTimeLine.timeLine.clear();
+        vKey->puTimeLine.InvalidateBindings();
     }
 }
 
@@ -3767,6 +4085,9 @@ void TimeLineSystem::Clean_KeepOnlyChangedUniforms(ShaderKeyPtr vKey) {
         for (auto uni : UniformsToRemove) {
             vKey->puTimeLine.timeLine.erase(uni);
         }
+        if (!UniformsToRemove.empty()) {
+            vKey->puTimeLine.InvalidateBindings();
+        }
     }
 }
 
@@ -21,6 +21,8 @@
 #include <Uniforms/UniformVariant.h>
 #include <Headers/RenderPackHeaders.h>
 #include <Interfaces/RenderingInterface.h>
+#include <Interfaces/FrameSinkInterface.h>
+#include <Systems/TimeLineKeyIndex.h>
 
 #include <unordered_set>
 
@@ -100,6 +102,43 @@ public:
     bool SetValue(float val, int vChannel);
 };
 
+#define TIMELINE_COUNT_COMPONENTS 4
+
+// what the interpolation of a segment use from a key
+// the keys of the last bake are compared to the current keys, for bake again only the segments around the changed keys
+struct TimeLineBakedKey {
+    int frame = 0;
+    float value = 0.0f;
+    glm::mat4 mat4 = glm::mat4(1.0f);
+    ct::fvec2 bezierControlStartPoint;
+    ct::fvec2 bezierContorlEndPoint;
+    TimeLineHandlerType timeLineHandlerType = TimeLineHandlerType::TIMELINE_HANDLER_TYPE_CONTROL_POINT_BOTH;
+
+    bool operator==(const TimeLineBakedKey& v) const;
+    bool operator!=(const TimeLineBakedKey& v) const;
+};
+
+// interpolated values of one component of an uniform
+// contiguous from the first key to the last key, one value by frame (4, 9 or 16 for the matrices)
+class TimeLineBakedComponent {
+public:
+    uType::uTypeEnum glslType = uType::uTypeEnum::U_VOID;
+    int startFrame = 0;
+    int countValuesByFrame = 0;          // 0 if nothing is baked
+    std::vector<float> values;           // [(frame - startFrame) * countValuesByFrame]
+    std::vector<TimeLineBakedKey> keys;  // keys of the last bake, sorted by frame
+
+public:
+    void Clear();
+    bool IsEmpty() const;
+    int GetEndFrame() const;
+    // nullptr if vFrame is not between the first and the last key
+    const float* GetValues(const int& vFrame) const;
+    float* GetValues(const int& vFrame);
+    // only for the not matrix types, like UploadableUniform::GetValue
+    bool GetValue(const int& vFrame, float* vOutValue) const;
+};
+
 class UniformTimeKey {
 public:
     std::string uniformName;
@@ -109,9 +148,8 @@ public:
     // component, frame, uniform value
     std::map<int, std::map<int, std::shared_ptr<UploadableUniform>>> keys;
 
-    // calculated values / activations
-    // uniform value (interpolated)
-    std::unordered_map<int, std::shared_ptr<UploadableUniform>> values;
+    // calculated values (interpolated), by component
+    TimeLineBakedComponent baked[TIMELINE_COUNT_COMPONENTS];
 
     // l'interpolation a utilsier depend des point de chaque segments. si les point ont des points de controls ou pas
     // TimeLineSegmentInterpolation interpolationMode = TimeLineSegmentInterpolation::TIMELINE_INTERPOLATION_SPLINE_CUBIC;
@@ -135,15 +173,32 @@ public:
     // TimeLine +> uniform name, struct (contain keys, values, activations)
     std::map<std::string, UniformTimeKey> timeLine;
 
+    // the uniforms keep a pointer on their UniformTimeKey, for not search it by name at each frame
+    // must be changed each time an UniformTimeKey is removed from timeLine
+    uint64_t bindingVersion = 0U;
+
+private:
+    // the keys of all the uniforms sorted by frame, rebuilt on demand after a change of the keys
+    TimeLineKeyIndex m_KeyIndex;
+
 public:
-    TimeLineInfos() {
-        rangeFrames = ct::ivec2(0, 90);
-    }
+    TimeLineInfos();
+    TimeLineInfos(const TimeLineInfos& v);
+    TimeLineInfos& operator=(const TimeLineInfos& v);
+
+    void InvalidateBindings();
+    // the UniformTimeKey of vUniPtr, searched by name only after a change of the timeLine map
+    UniformTimeKey* GetBoundTimeKey(UniformVariantPtr vUniPtr);
+
+    // must be called each time a key is added, removed or moved to another frame
+    void InvalidateKeyIndex();
+    const TimeLineKeyIndex& GetKeyIndex();
 };
 
 class RenderPack;
 class ShaderKey;
 class CodeTree;
+class AsyncReadBack;
 struct ImGuiContext;
 struct ImRect;
 class TimeLineSystem : public conf::ConfigAbstract, public RenderingInterface {
@@ -203,6 +258,11 @@ private:                                 // temp var for display
 private:
     ShaderKeyPtr puActiveKey = nullptr;
 
+private:  // rendering to a video or a gif
+    FrameSinkPtr m_FrameSinkPtr = nullptr;
+    std::unique_ptr<AsyncReadBack> m_FrameSinkReadBackPtr = nullptr;  // one ring for the front and back fbos, so the frames stay in order
+    bool m_FrameSinkError = false;
+
 private:  // ImGui Style
     ImVec4 puThickLinesDark;
     ImVec4 puThickLinesLight;
@@ -232,6 +292,8 @@ public:
     bool IsActive();
     bool CanWeRecord();
     bool IsPlaying();
+    int GetCurrentFrame() const;
+    int GetFrameRate() const;
     void SetActiveKey(ShaderKeyPtr vKey);
     ShaderKeyPtr GetActiveKey();
     void Resize(ct::ivec2 vNewSize);
@@ -313,6 +375,15 @@ public:  // Interpolation Computation
     void ReComputeInterpolation(TimeLineInfos* vTimeLineInfos, std::string vUniformName, int vComponent);
     void ReComputeInterpolation(UniformTimeKey* vUniformTimeKeyStruct, int vComponent);
 
+private:
+    void BakeSegment(UniformTimeKey* vUniformTimeKeyStruct,
+                     TimeLineBakedComponent* vBaked,
+                     int vComponent,
+                     int vStartFrame,
+                     std::shared_ptr<UploadableUniform> vStart,
+                     int vEndFrame,
+                     std::shared_ptr<UploadableUniform> vEnd);
+
 public:  // load save
     TimeLineInfos LoadTimeLineConfig(std::string vConfigFile);
     bool SaveTimeLineConfig(std::string vConfigFile, TimeLineInfos vTimeLineInfos);
@@ -323,6 +394,13 @@ public:  // load save
 public:  // Rendering flag
     std::string GetRenderingFilePathNameForCurrentFrame() override;
 
+public:  // Rendering to a frame sink (RENDERING_MODE_VIDEO, RENDERING_MODE_GIF)
+    // the frame of the back fbo is read without stalling the gpu and given to the sink some frames later
+    // the sink is opened at the first frame, with the size of the fbo
+    bool WriteCurrentFrameToSink(RenderPackWeak vRenderPack, int vAttachmentId = 0);
+    // wait the pending frames and close the file
+    void CloseFrameSink();
+
 public:
     bool DrawBar(ShaderKeyPtr vKey, ct::ivec2 vScreenSize);
     bool DrawTimeLine(const char* label, ShaderKeyPtr vKey);
@@ -330,6 +408,8 @@ public:
 private:
     void ShowHelpPopup();
     void ShowDialog(ShaderKeyPtr vKey, ct::ivec2 vScreenSize);
+    void StartRenderingToFile(ShaderKeyPtr vKey, RenderingModeEnum vRenderingMode);
+    void StopRendering();
     void GoToNextKey(ShaderKeyPtr vKey, int vCurrentFrame);
     void GoToPreviousKey(ShaderKeyPtr vKey, int vCurrentFrame);
     void GoToFrame(int vFrame);
@@ -33,6 +33,7 @@
 #include <Uniforms/UniformVariant.h>
 #include <Buffer/FrameBuffersPipeLine.h>
 #include <Profiler/TracyProfiler.h>
+#include <Systems/TimeLineSystem.h>
 
 #include <stdio.h>
 #include <functional>
@@ -67,6 +68,9 @@ TextureSound::TextureSound() {
 TextureSound::~TextureSound() {
     SAFE_DELETE_ARRAY(puDatas);
 
+    puOfflineSource.Close();
+    puFFTAnalyzer.Unit();
+
     if (glIsTexture(puFFTTexture.glTex) == GL_TRUE) {
         glDeleteTextures(1, &puFFTTexture.glTex);
         LogGlError();
@@ -80,7 +84,19 @@ bool TextureSound::Load(const std::string& vFilePathName, int vNumHistorySamples
 
     if (vFilePathName == "mic") {
         puType = "mic";
-    } else {
+    } else if (OfflineAudioSource::IsSupportedFile(vFilePathName)) {
+        puType = "file";
+        if (puOfflineSource.Open(vFilePathName)) {
+            puOfflineSource.SetLoop(puLoopPlayBack);
+            if (puFFTAnalyzer.SetFFTSize(puFFTAnalyzer.GetFFTSize())) {
+                puFilePathName = vFilePathName;
+                puFrame = 0;
+                if (!puDatas) {
+                    return CreateTexture(scCountBins);
+                }
+                return true;
+            }
+        }
     }
 
     return res;
@@ -91,7 +107,10 @@ void TextureSound::ReplaceSoundFilePathName(const std::string& vFilePathName) {
 }
 
 void TextureSound::SetLoopPlayBack(bool vLoopPlayBack) {
-    UNUSED(vLoopPlayBack);
+    if (puOfflineSource.IsOpened()) {
+        puLoopPlayBack = vLoopPlayBack;
+        puOfflineSource.SetLoop(vLoopPlayBack);
+    }
 
 #ifdef USE_BASS_LIB
     if (puChannel) {
@@ -111,6 +130,9 @@ void TextureSound::SetLoopPlayBack(bool vLoopPlayBack) {
 }
 
 void TextureSound::Reset() {
+    puFrame = 0;
+    puOfflineSource.Invalidate();
+
 #ifdef USE_BASS_LIB
     if (puChannel) {
         if (BASS_ChannelPlay(puChannel, true)) {
@@ -256,6 +278,10 @@ float TextureSound::GetCurrentPosInPercents() {
 }
 
 float TextureSound::GetLengthInSeconds() {
+    if (puOfflineSource.IsOpened()) {
+        return puOfflineSource.GetLengthInSeconds();
+    }
+
 #ifdef USE_BASS_LIB
     if (puChannel) {
         QWORD len = BASS_ChannelGetLength(puChannel, BASS_POS_BYTE);
@@ -266,8 +292,36 @@ float TextureSound::GetLengthInSeconds() {
     return 0.0f;
 }
 
+void TextureSound::SetFrame(int vFrame, int vFrameRate) {
+    puFrame = ct::maxi(vFrame, 0);
+    puFrameRate = ct::maxi(vFrameRate, 1);
+}
+
+// same frame than SoundSystem::GetOfflineFrame
+// during a rendering of the timeline, his frame and his frame rate
+// else the frame counter, advanced by each analysed frame
+void TextureSound::UpdateFrame() {
+    auto timeLinePtr = TimeLineSystem::Instance();
+    if (timeLinePtr->IsRendering()) {
+        SetFrame(timeLinePtr->GetCurrentFrame(), timeLinePtr->GetFrameRate());
+    }
+}
+
 bool TextureSound::GetFFT(float* vSamples) {
-    UNUSED(vSamples);
+    if (puOfflineSource.IsOpened()) {
+        UpdateFrame();
+
+        // the texture keep the last spectrum if no fft was done for this frame
+        const size_t countFFTs = puOfflineSource.AnalyseFrame(puFFTAnalyzer, puFrame, puFrameRate);
+        if (!TimeLineSystem::Instance()->IsRendering()) {
+            ++puFrame;
+        }
+        if (countFFTs > 0U) {
+            puFFTAnalyzer.CopyBins(vSamples, puFFTTexture.w);
+            return true;
+        }
+        return false;
+    }
 
 #ifdef USE_BASS_LIB
     if (!puChannel)
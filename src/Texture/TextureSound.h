@@ -35,6 +35,9 @@
 #include <kiss_fft.h>
 #include <kiss_fftr.h>
 
+#include <Systems/FFTAnalyzer.h>
+#include <Systems/OfflineAudioSource.h>
+
 class TextureSound {
 private:
     std::string puType;
@@ -46,6 +49,15 @@ private:
     bool puPlay;
     int puNumHistorySamples;
 
+    // sound file analysed frame by frame, the same spectrum for the same frame at each run
+    OfflineAudioSource puOfflineSource;
+    FFTAnalyzer puFFTAnalyzer;
+    int puFrame = 0;
+    int puFrameRate = 60;
+
+public:
+    static constexpr int scCountBins = 512;
+
 public:
     static TextureSound* Create(/*const GuiBackend_Window& vWin, */ const std::string& vFilePathName, int vNumHistorySamples = 0);
     static void Init();
@@ -81,11 +93,16 @@ public:
     float GetCurrentPosInPercents();
     float GetLengthInSeconds();
 
+    // the frame to analyse at the next UpdateTexture, the audio of [vFrame / vFrameRate, (vFrame + 1) / vFrameRate[
+    // each UpdateTexture advance the frame, or take the one of the timeline during a rendering
+    void SetFrame(int vFrame, int vFrameRate);
+
     GLuint GetTexId();
 
     bool CreateTexture(int vWidth);
     bool UpdateTexture(int vTextureIndex);
 
 private:
+    void UpdateFrame();
     bool GetFFT(float* vSamples);
 };
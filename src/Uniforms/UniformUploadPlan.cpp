@@ -0,0 +1,193 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "UniformUploadPlan.h"
+
+#include <CodeTree/ShaderKey.h>
+#include <Uniforms/UniformVariant.h>
+#include <Profiler/TracyProfiler.h>
+
+#include <cstring>
+
+void UniformUploadPlan::Compile(ShaderKeyPtr vShaderKey) {
+    ZoneScoped;
+
+    m_Entries.clear();
+    m_ShaderKey = vShaderKey;
+    m_CountUniforms = 0U;
+    m_Compiled = false;
+
+    if (vShaderKey) {
+        m_CountUniforms = vShaderKey->puUniformsDataBase.size();
+        m_UniformsGeneration = vShaderKey->puUniformsDataBaseGeneration;
+        m_Entries.reserve(m_CountUniforms);
+
+        for (auto it = vShaderKey->puUniformsDataBase.begin(); it != vShaderKey->puUniformsDataBase.end(); ++it) {
+            UniformVariantPtr v = it->second;
+            if (!v)
+                continue;
+
+            UniformUploadEntry entry;
+            entry.uniform = v;
+            entry.loc = v->loc;
+            entry.glslType = v->glslType;
+
+            if (v->widget == "deltatime") {
+                entry.source = UniformUploadSourceEnum::UPLOAD_SOURCE_DELTATIME;
+            } else if (v->widget == "frame") {
+                entry.source = UniformUploadSourceEnum::UPLOAD_SOURCE_FRAME;
+            } else if (v->widget == "record") {
+                entry.source = UniformUploadSourceEnum::UPLOAD_SOURCE_RECORD;
+            } else if (v->widget == "depth") {
+                entry.source = UniformUploadSourceEnum::UPLOAD_SOURCE_DEPTH;
+            } else if (v->widget == "buffer") {
+                if (v->bufferShaderName.empty()) {
+                    entry.source = UniformUploadSourceEnum::UPLOAD_SOURCE_BUFFER;
+                } else {
+                    entry.source = UniformUploadSourceEnum::UPLOAD_SOURCE_BUFFER_OTHER;
+                    entry.otherBufferName = v->bufferShaderName;
+                }
+            } else if (v->widget == "compute") {
+                if (v->computeShaderName.empty()) {
+                    entry.source = UniformUploadSourceEnum::UPLOAD_SOURCE_COMPUTE;
+                } else {
+                    entry.source = UniformUploadSourceEnum::UPLOAD_SOURCE_COMPUTE_OTHER;
+                    entry.otherBufferName = v->computeShaderName;
+                }
+                // like before, the buffer name have the priority on the compute name
+                if (!v->bufferShaderName.empty()) {
+                    entry.otherBufferName = v->bufferShaderName;
+                }
+            }
+
+            entry.sound = (v->widgetType == "sound" || v->widgetType == "sound_histo");
+
+            BindDatas(entry);
+
+            entry.dynamic = (entry.source != UniformUploadSourceEnum::UPLOAD_SOURCE_VALUE) ||  //
+                            entry.sound ||                                                    //
+                            (entry.datasSize == 0U);  // samplers, images, arrays and untracked types
+
+            m_Entries.push_back(entry);
+        }
+
+        m_Compiled = true;
+    }
+}
+
+void UniformUploadPlan::Invalidate() {
+    m_Compiled = false;
+}
+
+bool UniformUploadPlan::IsValidFor(ShaderKeyPtr vShaderKey) const {
+    if (m_Compiled && vShaderKey) {
+        return (m_ShaderKey.lock() == vShaderKey) &&                                  //
+               (m_UniformsGeneration == vShaderKey->puUniformsDataBaseGeneration) &&  //
+               (m_CountUniforms == vShaderKey->puUniformsDataBase.size());
+    }
+    return false;
+}
+
+std::vector<UniformUploadEntry>& UniformUploadPlan::GetEntries() {
+    return m_Entries;
+}
+
+bool UniformUploadPlan::NeedUpload(UniformUploadEntry& vEntry) {
+    auto& v = vEntry.uniform;
+
+    // the size uniforms are updated by the leaf emitter from the pipe
+    if (vEntry.dynamic || v->pipe != nullptr)
+        return true;
+
+    if (v->loc < 0)
+        return false;
+
+    // matrix arrays can be reallocated by widgets or systems
+    if (vEntry.glslType == uType::uTypeEnum::U_MAT2 ||  //
+        vEntry.glslType == uType::uTypeEnum::U_MAT3 ||  //
+        vEntry.glslType == uType::uTypeEnum::U_MAT4) {
+        vEntry.datas = v->uFloatArr;
+    }
+
+    if (!vEntry.datas)
+        return false;
+
+    if (vEntry.uploaded && vEntry.loc == v->loc) {
+        if (memcmp(vEntry.lastDatas, vEntry.datas, vEntry.datasSize) == 0) {
+            return false;
+        }
+    }
+
+    memcpy(vEntry.lastDatas, vEntry.datas, vEntry.datasSize);
+    vEntry.loc = v->loc;
+    vEntry.uploaded = true;
+
+    return true;
+}
+
+void UniformUploadPlan::BindDatas(UniformUploadEntry& vEntry) {
+    auto& v = vEntry.uniform;
+
+    vEntry.datas = nullptr;
+    vEntry.datasSize = 0U;
+
+    switch (vEntry.glslType) {
+        case uType::uTypeEnum::U_FLOAT:
+        case uType::uTypeEnum::U_VEC2:
+        case uType::uTypeEnum::U_VEC3:
+        case uType::uTypeEnum::U_VEC4:
+            vEntry.datas = &v->x;
+            vEntry.datasSize = (uint32_t)(sizeof(float) * 4U);
+            break;
+        case uType::uTypeEnum::U_INT:
+        case uType::uTypeEnum::U_IVEC2:
+        case uType::uTypeEnum::U_IVEC3:
+        case uType::uTypeEnum::U_IVEC4:
+            vEntry.datas = &v->ix;
+            vEntry.datasSize = (uint32_t)(sizeof(int) * 4U);
+            break;
+        case uType::uTypeEnum::U_UINT:
+        case uType::uTypeEnum::U_UVEC2:
+        case uType::uTypeEnum::U_UVEC3:
+        case uType::uTypeEnum::U_UVEC4:
+            vEntry.datas = &v->ux;
+            vEntry.datasSize = (uint32_t)(sizeof(uint32_t) * 4U);
+            break;
+        case uType::uTypeEnum::U_BOOL:
+        case uType::uTypeEnum::U_BVEC2:
+        case uType::uTypeEnum::U_BVEC3:
+        case uType::uTypeEnum::U_BVEC4:
+            // the leaf emitter read the bools as GLint from bx, so we track the same memory
+            vEntry.datas = &v->bx;
+            vEntry.datasSize = (uint32_t)(sizeof(GLint));
+            break;
+        case uType::uTypeEnum::U_MAT2:
+            vEntry.datas = v->uFloatArr;
+            vEntry.datasSize = (uint32_t)(sizeof(float) * 4U);
+            break;
+        case uType::uTypeEnum::U_MAT3:
+            vEntry.datas = v->uFloatArr;
+            vEntry.datasSize = (uint32_t)(sizeof(float) * 9U);
+            break;
+        case uType::uTypeEnum::U_MAT4:
+            vEntry.datas = v->uFloatArr;
+            vEntry.datasSize = (uint32_t)(sizeof(float) * 16U);
+            break;
+        default: break;
+    }
+}
@@ -0,0 +1,82 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <Headers/RenderPackHeaders.h>
+#include <uTypes/uTypes.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// where the value of an uniform come from each frame
+// resolved once from the widget string when the plan is compiled
+enum class UniformUploadSourceEnum : uint8_t {
+    UPLOAD_SOURCE_VALUE = 0,       // value edited by widgets / systems, uploaded only when changed
+    UPLOAD_SOURCE_DELTATIME,       // widget "deltatime"
+    UPLOAD_SOURCE_FRAME,           // widget "frame"
+    UPLOAD_SOURCE_RECORD,          // widget "record"
+    UPLOAD_SOURCE_DEPTH,           // widget "depth"
+    UPLOAD_SOURCE_BUFFER,          // widget "buffer" on the current renderpack
+    UPLOAD_SOURCE_BUFFER_OTHER,    // widget "buffer" on an other renderpack
+    UPLOAD_SOURCE_COMPUTE,         // widget "compute" on the current renderpack
+    UPLOAD_SOURCE_COMPUTE_OTHER,   // widget "compute" on an other renderpack
+    UPLOAD_SOURCE_Count
+};
+
+struct UniformUploadEntry {
+    UniformVariantPtr uniform = nullptr;
+    int loc = -1;
+    uType::uTypeEnum glslType = uType::uTypeEnum::U_VOID;
+    UniformUploadSourceEnum source = UniformUploadSourceEnum::UPLOAD_SOURCE_VALUE;
+    const void* datas = nullptr;  // value uploaded by the leaf emitter, compared for dirty tracking
+    uint32_t datasSize = 0U;      // in bytes, 0 if the uniform cant be tracked
+    bool dynamic = false;         // uploaded each frame (samplers, arrays, sizes, sources)
+    bool sound = false;           // need the SoundSystem leaf emitter
+    bool uploaded = false;        // false until the first upload in the current program
+    std::string otherBufferName;  // for UPLOAD_SOURCE_BUFFER_OTHER / UPLOAD_SOURCE_COMPUTE_OTHER
+    RenderPackWeak otherBuffer;   // resolved lazily by name, only when expired
+    uint8_t lastDatas[64] = {};   // last uploaded value (mat4 max)
+};
+
+class UniformUploadPlan {
+private:
+    std::vector<UniformUploadEntry> m_Entries;
+    ShaderKeyWeak m_ShaderKey;
+    size_t m_CountUniforms = 0U;
+    uint64_t m_UniformsGeneration = 0U;  // ShaderKey::puUniformsDataBaseGeneration at the compilation
+    bool m_Compiled = false;
+
+public:
+    // build the flat entry list from the uniforms database of the key
+    // must be called after the locations have been resolved (after link)
+    void Compile(ShaderKeyPtr vShaderKey);
+
+    // force a recompilation at next frame
+    void Invalidate();
+
+    // false if never compiled, invalidated or if the uniforms database has changed since the compilation
+    bool IsValidFor(ShaderKeyPtr vShaderKey) const;
+
+    std::vector<UniformUploadEntry>& GetEntries();
+
+    // refresh the data pointer, compare with the last uploaded value and snapshot it
+    // return true if the entry must be uploaded this frame
+    static bool NeedUpload(UniformUploadEntry& vEntry);
+
+private:
+    static void BindDatas(UniformUploadEntry& vEntry);
+};
@@ -204,6 +204,7 @@ UniformVariant::UniformVariant() {
     ownSound = false;
     soundLoop = true;
     soundHisto = 0;
+    soundBins = 0U;
 
     uSamplerCube = -1;
     cubemap_ptr = nullptr;
@@ -409,6 +410,7 @@ void UniformVariant::copy(UniformVariantPtr vUniPtr, RenderPackWeak /*vMainRende
         soundVolume = vUniPtr->soundVolume;
         soundLoop = vUniPtr->soundLoop;
         soundHisto = vUniPtr->soundHisto;
+        soundBins = vUniPtr->soundBins;
 
         cubemap_ptr = vUniPtr->cubemap_ptr;
         ownCubeMap = vUniPtr->ownCubeMap;
@@ -552,6 +554,7 @@ void UniformVariant::copyValues(UniformVariantPtr vUniPtr, RenderPackWeak /*vMai
             soundVolume = vUniPtr->soundVolume;
             soundLoop = vUniPtr->soundLoop;
             soundHisto = vUniPtr->soundHisto;
+            soundBins = vUniPtr->soundBins;
         }
 
         pipe = vUniPtr->pipe;
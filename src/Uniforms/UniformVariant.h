@@ -42,6 +42,7 @@ class UniformsMultiLoc;
 class FrameBuffersPipeLine;
 class RecordBuffer;
 class ShaderKey;
+class UniformTimeKey;
 class UniformVariant {
 public:
 #ifdef DEBUG_UNIFORMS
@@ -88,6 +89,9 @@ public:
     std::string widget;
     std::string widgetType;
     bool timeLineSupported = false;
+    UniformTimeKey* timeLineKeyPtr = nullptr;  // bound by TimeLineInfos::GetBoundTimeKey
+    uint64_t timeLineBindingVersion = 0U;
+    size_t timeLineBindingCount = 0U;  // count of time keys when bound, an added time key can be for this uniform
     std::vector<std::string> filePathNames;
     std::vector<std::string> choices;
     std::string bufferShaderName;
@@ -148,6 +152,7 @@ public:
     float soundVolume = 0.0f;
     bool soundLoop = false;
     int soundHisto = -1;
+    uint32_t soundBins = 0U;  // count of bins of the fft texture, 0 for the default
     bool ownSound = false;
 
     TextureCubePtr cubemap_ptr = nullptr;
@@ -244,6 +249,7 @@ public:
     std::vector<int> midiId;  // identification bytes
     uint32_t midiCountBytes = 0;
     std::vector<uint8_t> midiBytes;  // midi bytes used for value
+    int32_t midiBindingId = -1;      // resolved by MidiSystem at parse time
 
 public:
     void operator=(const UniformVariant &) = delete;
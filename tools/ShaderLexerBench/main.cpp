@@ -0,0 +1,371 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+// compare the tag detection of SectionCode done with ShaderCodeLexer
+// with the old find + IfInCommentZone search, over generated shader libraries of 5k, 20k and 50k lines
+// the libraries are full of comments, strings, @ tags, #include, uniforms, configs and replace codes
+// the two paths do what GetSectionsFromCode and the Parse* functions of SectionCode are doing :
+// find the sections, then the tags of each type not in a comment zone, with their line
+// usage : ShaderLexerBench [count_runs] [seed]
+// return 1 if the two paths not give the same tag positions
+
+#include <CodeTree/Parsing/ShaderCodeLexer.h>
+#include <CodeTree/Parsing/SectionCode.h>
+
+#include <map>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+struct LexerBench_Result {
+    std::map<size_t, std::string> sections;
+    std::vector<std::vector<size_t>> tags;   // pos of the tags not in a comment zone, by type
+    std::vector<std::vector<size_t>> lines;  // line of each tag, like the Parse* functions was computing
+    size_t countTags = 0U;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///// OLD PATH ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// the old helpers removed from ShaderStageParsing, kept with only the options used by the parse
+
+static bool LexerBench_OldIfInCommentZone(const std::string& vCode, size_t vPos) {
+    size_t mark_comment = 0;
+
+    // zone de commentaire //
+    size_t lastLine = vCode.rfind('\n', vPos);
+    if (lastLine != std::string::npos) {
+        mark_comment = vCode.find("//", lastLine + 1);
+    } else {
+        mark_comment = vCode.rfind("//", vPos);
+    }
+    if (mark_comment != std::string::npos) {
+        if (mark_comment < vPos) {
+            return true;
+        }
+    }
+
+    size_t mark_start_before = vCode.rfind("/*", vPos);
+    if (mark_start_before != std::string::npos) {
+        // on verifie que c'est le notre
+        size_t mark_end_before = vCode.rfind("*/", vPos);
+        if (mark_end_before != std::string::npos) {
+            // zone de com deja fermee
+            if (mark_start_before < mark_end_before) {
+                return false;
+            }
+        }
+        size_t mark_end_after = vCode.find("*/", vPos);
+        if (mark_end_after != std::string::npos) {
+            // on verifie que c'est le notre
+            size_t mark_start_after = vCode.find("/*", vPos);
+            if (mark_start_after != std::string::npos) {
+                // zone de com deja fermee
+                if (mark_start_after < mark_end_after) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool LexerBench_OldIfOnIncludeLine(const std::string& vCode, size_t vPos) {
+    size_t mark_include = 0;
+
+    // zone de includ //
+    size_t lastLine = vCode.rfind('\n', vPos);
+    if (lastLine != std::string::npos) {
+        mark_include = vCode.find(SectionCode::codeTags.IncludeWordTag, lastLine + 1);
+    } else {
+        mark_include = vCode.rfind(SectionCode::codeTags.IncludeWordTag, vPos);
+    }
+    if (mark_include != std::string::npos) {
+        if (mark_include < vPos) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static size_t LexerBench_OldGetTagPos(const std::string& vCode, const std::string& vTag, size_t vStartPos, bool vCheckIfInCommentZone) {
+    size_t tagPos = std::string::npos;
+
+    if (!vCode.empty()) {
+        tagPos = vCode.find(vTag, vStartPos);
+        if (tagPos != std::string::npos) {
+            if (vCheckIfInCommentZone)
+                if (LexerBench_OldIfInCommentZone(vCode, tagPos))
+                    tagPos = std::string::npos;
+        }
+    }
+
+    return tagPos;
+}
+
+static std::string LexerBench_OldGetTagIfFound(const std::string& vCode, size_t vStartPos, size_t* vApproxPos) {
+    std::string tagFound;
+
+    size_t tagPos = std::string::npos;
+
+    if (!vCode.empty()) {
+        tagPos = vCode.find('@', vStartPos);
+        if (tagPos != std::string::npos) {
+            ++tagPos;
+
+            // on va juste verifier qu'on est pas attaché a un include
+            if (tagPos > 1 && vCode[tagPos - 2] == ':') {
+                // la on est sur un include
+            } else {
+                size_t endtag = vCode.find_first_of(" \n\t\r", tagPos);
+                if (endtag == std::string::npos)  // then end of file
+                {
+                    endtag = vCode.size();
+                }
+                tagFound = vCode.substr(tagPos, endtag - tagPos);
+
+                // il y a des tags qui sont speciaux et que nous devons echapper
+                auto tagFoundToCompare = "@" + tagFound;
+                if (tagFoundToCompare == SectionCode::codeTags.ConfigStartTag || tagFoundToCompare == SectionCode::codeTags.ConfigEndTag ||
+                    tagFoundToCompare == SectionCode::codeTags.BufferStartTag || tagFoundToCompare == SectionCode::codeTags.BufferEndTag) {
+                    tagFound.clear();
+                }
+
+                if (!tagFound.empty()) {
+                    if (LexerBench_OldIfInCommentZone(vCode, tagPos))  // dans un commentaire alors on echappe
+                    {
+                        tagFound.clear();
+                    }
+
+                    // si un #include existe sur la meme ligne juste avant le @ alors on echappe
+                    if (LexerBench_OldIfOnIncludeLine(vCode, tagPos)) {
+                        tagFound.clear();
+                    }
+                }
+            }
+        }
+
+        if (vApproxPos) {
+            *vApproxPos = tagPos - 1;
+        }
+    }
+
+    return tagFound;
+}
+
+static LexerBench_Result LexerBench_OldPath(const std::string& vCode) {
+    LexerBench_Result res;
+
+    // the old GetSectionsFromCode
+    size_t lastFound = 0;
+    while (lastFound != std::string::npos) {
+        auto tag = LexerBench_OldGetTagIfFound(vCode, lastFound, &lastFound);
+        if (!tag.empty()) {
+            res.sections[lastFound] = tag;
+        }
+        if (lastFound != std::string::npos)
+            ++lastFound;
+    }
+
+    // the old Parse* loops, the line was counted from the start of the code
+    const auto& tags = SectionCode::codeTags;
+    const std::vector<std::string> tagWords = {
+        tags.IncludeWordTag, tags.UniformWordTag, tags.LayoutWordTag, tags.ConfigStartTag, tags.ConfigEndTag, tags.CodeToReplaceStartTag, tags.CodeToReplaceEndTag};
+    res.tags.resize(tagWords.size());
+    res.lines.resize(tagWords.size());
+    for (size_t t = 0; t < tagWords.size(); ++t) {
+        size_t nextPos = 0;
+        while ((nextPos = LexerBench_OldGetTagPos(vCode, tagWords[t], nextPos, false)) != std::string::npos) {
+            if (!LexerBench_OldIfInCommentZone(vCode, nextPos)) {
+                res.tags[t].push_back(nextPos);
+                res.lines[t].push_back((size_t)std::count(vCode.begin(), vCode.begin() + nextPos, '\n'));
+                ++res.countTags;
+            }
+            ++nextPos;
+        }
+    }
+
+    return res;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///// LEXER PATH //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static LexerBench_Result LexerBench_LexerPath(const std::string& vCode) {
+    LexerBench_Result res;
+
+    ShaderCodeLexer lexer(vCode);
+    res.sections = lexer.GetSections();
+
+    // same order as the tag words of the old path
+    const std::vector<ShaderTokenEnum> tagTypes = {ShaderTokenEnum::TOKEN_INCLUDE,
+                                                   ShaderTokenEnum::TOKEN_UNIFORM,
+                                                   ShaderTokenEnum::TOKEN_LAYOUT,
+                                                   ShaderTokenEnum::TOKEN_CONFIG_START,
+                                                   ShaderTokenEnum::TOKEN_CONFIG_END,
+                                                   ShaderTokenEnum::TOKEN_REPLACE_START,
+                                                   ShaderTokenEnum::TOKEN_REPLACE_END};
+    res.tags.resize(tagTypes.size());
+    res.lines.resize(tagTypes.size());
+    for (size_t t = 0; t < tagTypes.size(); ++t) {
+        size_t nextPos = 0;
+        while ((nextPos = lexer.FindNextTag(tagTypes[t], nextPos)) != std::string::npos) {
+            if (!lexer.IsInCommentZone(nextPos)) {
+                res.tags[t].push_back(nextPos);
+                res.lines[t].push_back(lexer.GetCountLinesBefore(nextPos));
+                ++res.countTags;
+            }
+            ++nextPos;
+        }
+    }
+
+    return res;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///// GENERATION //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// the strings stay without // or /* because the old path not know the strings
+static std::string LexerBench_GenerateLibrary(const size_t& vCountLines, std::mt19937& vGen) {
+    static const char* s_Sections[] = {"@UNIFORMS", "@COMMON", "@VERTEX", "@FRAGMENT", "@NOTE"};
+
+    std::uniform_int_distribution<int> dist(0, 15);
+    std::string code;
+    code.reserve(vCountLines * 48U);
+
+    size_t line = 0U;
+    auto addLine = [&code, &line](const std::string& vLine) {
+        code += vLine;
+        code += '\n';
+        ++line;
+    };
+
+    int idx = 0;
+    while (line < vCountLines) {
+        const std::string n = std::to_string(idx++);
+        switch (dist(vGen)) {
+            case 0: addLine(std::string(s_Sections[idx % 5])); break;
+            case 1: addLine("// a line comment with a fake @TAG_" + n + ", a uniform, a layout and an #include \"no.glsl\""); break;
+            case 2:
+                addLine("/* a block comment with [[FAKE:" + n + "]] inside");
+                addLine(" * @NOT_A_SECTION uniform float fake; #include \"fake.glsl\"");
+                addLine(" */");
+                break;
+            case 3: addLine("#include \"lib/common_" + n + ".glsl\""); break;
+            case 4: addLine("#include \"lib/sdf_" + n + ".glsl\":@SDF"); break;
+            case 5: addLine("#include \"lib/noise_" + n + ".glsl\" @NOISE // an include with a tag on his line"); break;
+            case 6: addLine("uniform float(0.0:1.0:0.5) uSlider" + n + "; // a slider"); break;
+            case 7: addLine("layout(location = 0) out vec4 fragColor" + n + ";"); break;
+            case 8:
+                addLine("@CONFIG_START conf" + n);
+                addLine("uniform vec3(color:1,0,0) uColor" + n + ";");
+                addLine("@CONFIG_END");
+                break;
+            case 9:
+                addLine("[[SLOT:map" + n + ":the distance function " + n);
+                addLine("float map" + n + "(vec3 p) { return length(p) - 1.0; }");
+                addLine("]]");
+                break;
+            case 10: addLine("#pragma message \"a string with a @STRING_TAG and a uniform word " + n + "\""); break;
+            case 11: addLine("vec3 col" + n + " = vec3(0.5); /* an inline comment @INLINE */ col" + n + " *= 2.0;"); break;
+            case 12: addLine("#define NAME_" + n + " \"name " + n + "\""); break;
+            default: addLine("float f" + n + "(vec3 p) { return dot(p, vec3(0.5)) * " + n + ".0; }"); break;
+        }
+    }
+
+    return code;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///// MAIN ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool LexerBench_Compare(const LexerBench_Result& vOld, const LexerBench_Result& vNew) {
+    bool res = true;
+    if (vOld.sections != vNew.sections) {
+        printf("  the sections differ : old %zu, lexer %zu\n", vOld.sections.size(), vNew.sections.size());
+        res = false;
+    }
+    for (size_t t = 0; t < vOld.tags.size(); ++t) {
+        if (vOld.tags[t] != vNew.tags[t]) {
+            printf("  the tags of type %zu differ : old %zu, lexer %zu\n", t, vOld.tags[t].size(), vNew.tags[t].size());
+            res = false;
+        } else if (vOld.lines[t] != vNew.lines[t]) {
+            printf("  the lines of the tags of type %zu differ\n", t);
+            res = false;
+        }
+    }
+    return res;
+}
+
+int main(int argc, char** argv) {
+    const int countRuns = (argc > 1) ? std::max(atoi(argv[1]), 1) : 1;
+    const unsigned int seed = (argc > 2) ? (unsigned int)atoi(argv[2]) : 1U;
+
+    std::mt19937 gen(seed);
+
+    bool ok = true;
+    const size_t countLines[] = {5000U, 20000U, 50000U};
+    for (const auto& count : countLines) {
+        const auto code = LexerBench_GenerateLibrary(count, gen);
+        const double sizeMB = (double)code.size() / (1024.0 * 1024.0);
+
+        // best of the runs
+        double timeOld = 1e30, timeNew = 1e30;
+        LexerBench_Result resOld, resNew;
+        for (int r = 0; r < countRuns; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            resOld = LexerBench_OldPath(code);
+            auto middle = std::chrono::steady_clock::now();
+            resNew = LexerBench_LexerPath(code);
+            auto end = std::chrono::steady_clock::now();
+            timeOld = std::min(timeOld, std::chrono::duration<double>(middle - start).count());
+            timeNew = std::min(timeNew, std::chrono::duration<double>(end - middle).count());
+        }
+
+        printf("lines %zu (%.2f MB, %zu sections, %zu tags)\n", count, sizeMB, resNew.sections.size(), resNew.countTags);
+        printf("  old find   : %10.3f ms, %10.2f MB/s\n", timeOld * 1000.0, sizeMB / timeOld);
+        printf("  lexer      : %10.3f ms, %10.2f MB/s\n", timeNew * 1000.0, sizeMB / timeNew);
+        if (timeNew > 0.0) {
+            printf("  speedup    : x%.1f\n", timeOld / timeNew);
+        }
+
+        if (!LexerBench_Compare(resOld, resNew)) {
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        printf("FAILED : the lexer not give the same tag positions as the old search\n");
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,178 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+// compare the newton-raphson + bisection solve of TimeLineBezierSegment
+// with the old 0.001 step search of the timeline bake, over random segments
+// the reference is a 64 steps bisection in double
+// usage : TimeLineBezierCheck [count_segments] [seed]
+// return 1 if the error of the new solve is over the tolerance
+
+#include <Systems/TimeLineBezierSegment.h>
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+
+#define CHECK_TOLERANCE 1e-3  // in value units, the values are in [-10:10]
+
+struct BezierCheck_Segment {
+    ct::fvec2 p[4];
+    bool cubic = true;
+};
+
+static void BezierCheck_Weights(const double& vT, const bool& vCubic, double vWeights[4]) {
+    const double u = 1.0 - vT;
+    if (vCubic) {
+        vWeights[0] = u * u * u;
+        vWeights[1] = 3.0 * u * u * vT;
+        vWeights[2] = 3.0 * u * vT * vT;
+        vWeights[3] = vT * vT * vT;
+    } else {
+        vWeights[0] = u * u;
+        vWeights[1] = 2.0 * u * vT;
+        vWeights[2] = vT * vT;
+        vWeights[3] = 0.0;
+    }
+}
+
+// the old search removed from TimeLineSystem, kept as is (float, 0.001 step)
+// when no step cross vX (last frames of a segment), it return the x and not the y, so the max err old is big
+static float BezierCheck_OldSearch(const BezierCheck_Segment& vSeg, const float& vX) {
+    float _x = 1e5f;
+    for (float t = 0.0f; t <= 1.0f; t += 0.001f) {
+        const float u = 1.0f - t;
+        float w[4];
+        if (vSeg.cubic) {
+            w[0] = u * u * u;
+            w[1] = 3.0f * u * u * t;
+            w[2] = 3.0f * u * t * t;
+            w[3] = t * t * t;
+        } else {
+            w[0] = u * u;
+            w[1] = 2.0f * u * t;
+            w[2] = t * t;
+            w[3] = 0.0f;
+        }
+        const float x = w[0] * vSeg.p[0].x + w[1] * vSeg.p[1].x + w[2] * vSeg.p[2].x + w[3] * vSeg.p[3].x;
+        if (x > vX && _x < vX) {
+            return w[0] * vSeg.p[0].y + w[1] * vSeg.p[1].y + w[2] * vSeg.p[2].y + w[3] * vSeg.p[3].y;
+        }
+        _x = x;
+    }
+    return _x;
+}
+
+static double BezierCheck_Reference(const BezierCheck_Segment& vSeg, const double& vX) {
+    double w[4];
+    double lo = 0.0, hi = 1.0;
+    for (int i = 0; i < 64; ++i) {
+        const double t = (lo + hi) * 0.5;
+        BezierCheck_Weights(t, vSeg.cubic, w);
+        const double x = w[0] * vSeg.p[0].x + w[1] * vSeg.p[1].x + w[2] * vSeg.p[2].x + w[3] * vSeg.p[3].x;
+        if (x < vX) {
+            lo = t;
+        } else {
+            hi = t;
+        }
+    }
+    BezierCheck_Weights((lo + hi) * 0.5, vSeg.cubic, w);
+    return w[0] * vSeg.p[0].y + w[1] * vSeg.p[1].y + w[2] * vSeg.p[2].y + w[3] * vSeg.p[3].y;
+}
+
+int main(int argc, char** argv) {
+    const int countSegments = (argc > 1) ? atoi(argv[1]) : 1000;
+    const unsigned int seed = (argc > 2) ? (unsigned int)atoi(argv[2]) : 1U;
+
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+    double maxErrNew = 0.0, maxErrOld = 0.0;
+    double timeNew = 0.0, timeOld = 0.0;
+    size_t countFrames = 0U;
+    volatile float sink = 0.0f;  // for avoid the compiler to drop the solves
+
+    for (int s = 0; s < countSegments; ++s) {
+        // x monotonic like in the timeline : the control points stay inside the segment
+        const float len = 10.0f + dist(gen) * 990.0f;
+        BezierCheck_Segment seg;
+        seg.cubic = (s % 2 == 0);
+        seg.p[0] = ct::fvec2(0.0f, dist(gen) * 20.0f - 10.0f);
+        if (seg.cubic) {
+            seg.p[1] = ct::fvec2(dist(gen) * len * 0.45f, dist(gen) * 20.0f - 10.0f);
+            seg.p[2] = ct::fvec2(len - dist(gen) * len * 0.45f, dist(gen) * 20.0f - 10.0f);
+            seg.p[3] = ct::fvec2(len, dist(gen) * 20.0f - 10.0f);
+        } else {
+            seg.p[1] = ct::fvec2(len * (0.05f + dist(gen) * 0.9f), dist(gen) * 20.0f - 10.0f);
+            seg.p[2] = ct::fvec2(len, dist(gen) * 20.0f - 10.0f);
+            seg.p[3] = seg.p[2];
+        }
+
+        TimeLineBezierSegment bezier;
+        if (seg.cubic) {
+            bezier.SetCubic(seg.p[0], seg.p[1], seg.p[2], seg.p[3]);
+        } else {
+            bezier.SetQuadratic(seg.p[0], seg.p[1], seg.p[2]);
+        }
+
+        const int countFramesInSegment = (int)len;
+        countFrames += (size_t)countFramesInSegment;
+
+        // timings first, without the reference in the loops
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 1; f < countFramesInSegment; ++f) {
+            sink = sink + bezier.GetY(bezier.SolveT((float)f));
+        }
+        auto middle = std::chrono::steady_clock::now();
+        for (int f = 1; f < countFramesInSegment; ++f) {
+            sink = sink + BezierCheck_OldSearch(seg, (float)f);
+        }
+        auto end = std::chrono::steady_clock::now();
+        timeNew += std::chrono::duration<double, std::milli>(middle - start).count();
+        timeOld += std::chrono::duration<double, std::milli>(end - middle).count();
+
+        // errors
+        TimeLineBezierSegment bezierErr = bezier;
+        for (int f = 1; f < countFramesInSegment; ++f) {
+            const double ref = BezierCheck_Reference(seg, (double)f);
+            const double errNew = std::fabs((double)bezierErr.GetY(bezierErr.SolveT((float)f)) - ref);
+            const double errOld = std::fabs((double)BezierCheck_OldSearch(seg, (float)f) - ref);
+            if (errNew > maxErrNew) maxErrNew = errNew;
+            if (errOld > maxErrOld) maxErrOld = errOld;
+        }
+    }
+
+    printf("segments       : %i (seed %u)\n", countSegments, seed);
+    printf("frames         : %zu\n", countFrames);
+    printf("max err new    : %g\n", maxErrNew);
+    printf("max err old    : %g\n", maxErrOld);
+    printf("time new       : %.3f ms\n", timeNew);
+    printf("time old       : %.3f ms\n", timeOld);
+    if (timeNew > 0.0) {
+        printf("speedup        : x%.1f\n", timeOld / timeNew);
+    }
+
+    if (maxErrNew > CHECK_TOLERANCE) {
+        printf("FAILED : the error of the new solve is over %g\n", CHECK_TOLERANCE);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,176 @@
+// NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+// check of UrlFetcher against the local http server tools/UrlFetcherCheck/server.py
+// the cache is in a temporary directory, cleared at start
+// the checks are :
+// - a first fetch get a 200 and write the cache
+// - a second fetch is served by the cache without request
+// - with the revalidation, the server answer a 304 and the cached content is used
+// - the duplicated urls of a FetchAll are fetched one time
+// - when the server is stopped, the cached content is used
+// the server is stopped by the check at the end
+// usage : python3 tools/UrlFetcherCheck/server.py 8765 & UrlFetcherCheck 8765
+// return 1 if a check fail
+
+#include <Importer/UrlFetcher.h>
+
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+
+#define CHECK_TIMEOUT_IN_SECOND 5
+
+static int s_CountFails = 0;
+
+static void UrlFetcherCheck_Expect(const bool& vCondition, const char* vLabel) {
+    printf("%s : %s\n", vCondition ? "ok    " : "FAILED", vLabel);
+    if (!vCondition) {
+        ++s_CountFails;
+    }
+}
+
+// count of requests and count of 304 received by the server for vPath
+static bool UrlFetcherCheck_GetStats(const std::string& vBaseUrl, const std::string& vPath, int* vOutCountRequests, int* vOutCountNotModified) {
+    const auto url = vBaseUrl + "/stats?path=" + vPath;
+    UrlFetcher::Instance()->Invalidate(url);  // never from the cache
+    const auto result = UrlFetcher::Instance()->Fetch(url, CHECK_TIMEOUT_IN_SECOND);
+    UrlFetcher::Instance()->Invalidate(url);
+    if (result.ok && !result.fromCache) {
+        return sscanf(result.content.c_str(), "%i %i", vOutCountRequests, vOutCountNotModified) == 2;
+    }
+    return false;
+}
+
+static std::string UrlFetcherCheck_GetExpectedContent(const std::string& vName) {
+    return "content of " + vName + "\n";
+}
+
+int main(int argc, char** argv) {
+    const int port = (argc > 1) ? atoi(argv[1]) : 8765;
+    const std::string baseUrl = "http://127.0.0.1:" + std::to_string(port);
+
+    const auto cacheDir = std::filesystem::temp_directory_path() / ("UrlFetcherCheck_" + std::to_string(port));
+    std::error_code ec;
+    std::filesystem::remove_all(cacheDir, ec);
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    auto fetcherPtr = UrlFetcher::Instance();
+    fetcherPtr->SetCacheDirectory(cacheDir.string());
+    fetcherPtr->SetRevalidateCache(false);
+
+    // wait for the server
+    int countRequests = 0, countNotModified = 0;
+    bool serverReady = false;
+    for (int i = 0; i < 50 && !serverReady; ++i) {
+        serverReady = UrlFetcherCheck_GetStats(baseUrl, "/file/a.glsl", &countRequests, &countNotModified);
+        if (!serverReady) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    if (!serverReady) {
+        printf("FAILED : no server on %s\n", baseUrl.c_str());
+        return 1;
+    }
+
+    const auto urlA = baseUrl + "/file/a.glsl";
+
+    // first fetch : 200 and cache written
+    {
+        const auto result = fetcherPtr->Fetch(urlA, CHECK_TIMEOUT_IN_SECOND);
+        UrlFetcherCheck_Expect(result.ok && result.httpCode == 200 && !result.fromCache, "first fetch get a 200");
+        UrlFetcherCheck_Expect(result.content == UrlFetcherCheck_GetExpectedContent("a.glsl"), "first fetch content");
+        UrlFetcherCheck_Expect(fetcherPtr->IsCached(urlA), "first fetch write the cache");
+        UrlFetcherCheck_Expect(UrlFetcherCheck_GetStats(baseUrl, "/file/a.glsl", &countRequests, &countNotModified) && countRequests == 1,
+                               "first fetch do one request");
+    }
+
+    // second fetch : from the cache, no request
+    {
+        const auto result = fetcherPtr->Fetch(urlA, CHECK_TIMEOUT_IN_SECOND);
+        UrlFetcherCheck_Expect(result.ok && result.fromCache, "second fetch is from the cache");
+        UrlFetcherCheck_Expect(result.content == UrlFetcherCheck_GetExpectedContent("a.glsl"), "second fetch content");
+        UrlFetcherCheck_Expect(UrlFetcherCheck_GetStats(baseUrl, "/file/a.glsl", &countRequests, &countNotModified) && countRequests == 1,
+                               "second fetch do no request");
+    }
+
+    // revalidation : 304 and cached content
+    {
+        fetcherPtr->SetRevalidateCache(true);
+        const auto result = fetcherPtr->Fetch(urlA, CHECK_TIMEOUT_IN_SECOND);
+        fetcherPtr->SetRevalidateCache(false);
+        UrlFetcherCheck_Expect(result.ok && result.httpCode == 304 && result.fromCache, "revalidation get a 304");
+        UrlFetcherCheck_Expect(result.content == UrlFetcherCheck_GetExpectedContent("a.glsl"), "revalidation content is the cached one");
+        UrlFetcherCheck_Expect(UrlFetcherCheck_GetStats(baseUrl, "/file/a.glsl", &countRequests, &countNotModified) && countRequests == 2 && countNotModified == 1,
+                               "revalidation do one conditional request");
+    }
+
+    // duplicated urls in FetchAll : one request by url
+    {
+        const std::vector<std::string> names = {"b.glsl", "c.glsl", "b.glsl", "c.glsl", "b.glsl"};
+        std::vector<std::string> urls;
+        for (const auto& name : names) {
+            urls.push_back(baseUrl + "/file/" + name);
+        }
+        const auto results = fetcherPtr->FetchAll(urls, CHECK_TIMEOUT_IN_SECOND);
+        bool allOk = (results.size() == urls.size());
+        for (size_t idx = 0U; allOk && idx < results.size(); ++idx) {
+            allOk = results[idx].ok && results[idx].url == urls[idx] && results[idx].content == UrlFetcherCheck_GetExpectedContent(names[idx]);
+        }
+        UrlFetcherCheck_Expect(allOk, "FetchAll give the results in the order of the urls");
+        int countB = 0, countC = 0;
+        UrlFetcherCheck_Expect(UrlFetcherCheck_GetStats(baseUrl, "/file/b.glsl", &countB, &countNotModified) &&
+                                   UrlFetcherCheck_GetStats(baseUrl, "/file/c.glsl", &countC, &countNotModified) && countB == 1 && countC == 1,
+                               "FetchAll fetch the duplicated urls one time");
+    }
+
+    // server stopped : the cached content is used
+    {
+        const auto shutdownUrl = baseUrl + "/shutdown";
+        fetcherPtr->Fetch(shutdownUrl, CHECK_TIMEOUT_IN_SECOND);
+        fetcherPtr->Invalidate(shutdownUrl);
+        fetcherPtr->Release();  // close the kept connections to the stopped server
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+        fetcherPtr->SetRevalidateCache(true);
+        const auto result = fetcherPtr->Fetch(urlA, CHECK_TIMEOUT_IN_SECOND);
+        UrlFetcherCheck_Expect(result.ok && result.fromCache && !result.error.empty(), "server stopped, fallback on the cache");
+        UrlFetcherCheck_Expect(result.content == UrlFetcherCheck_GetExpectedContent("a.glsl"), "server stopped, cached content");
+
+        const auto resultNotCached = fetcherPtr->Fetch(baseUrl + "/file/d.glsl", CHECK_TIMEOUT_IN_SECOND);
+        UrlFetcherCheck_Expect(!resultNotCached.ok && resultNotCached.content.empty(), "server stopped, not cached url fail");
+        fetcherPtr->SetRevalidateCache(false);
+    }
+
+    fetcherPtr->Release();
+    curl_global_cleanup();
+    std::filesystem::remove_all(cacheDir, ec);
+
+    if (s_CountFails > 0) {
+        printf("FAILED : %i checks\n", s_CountFails);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
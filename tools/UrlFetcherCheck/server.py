@@ -0,0 +1,90 @@
+# NoodlesPlate Copyright (C) 2017-2024 Stephane Cuillerdier aka Aiekick
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+# local http stand-in server for UrlFetcherCheck
+# GET /file/<name>      : "content of <name>\n", with an ETag and a Last-Modified, 304 if If-None-Match match
+# GET /stats?path=<p>   : "<count of requests> <count of 304>" for the path p
+# GET /shutdown         : stop the server, for check the fallback on the cache
+# usage : python3 server.py [port] [latency_ms]
+
+import sys
+import threading
+import time
+import zlib
+from email.utils import formatdate
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import urlparse, parse_qs
+
+PORT = int(sys.argv[1]) if len(sys.argv) > 1 else 8765
+LATENCY = (float(sys.argv[2]) if len(sys.argv) > 2 else 0.0) / 1000.0
+LAST_MODIFIED = formatdate(time.time(), usegmt=True)
+
+stats_lock = threading.Lock()
+stats = {}  # path : [count requests, count 304]
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # keep alive, for the connection reuse
+
+    def send_text(self, code, text, headers=None):
+        body = text.encode("utf-8")
+        self.send_response(code)
+        self.send_header("Content-Type", "text/plain")
+        self.send_header("Content-Length", str(len(body)))
+        for name, value in (headers or {}).items():
+            self.send_header(name, value)
+        self.end_headers()
+        self.wfile.write(body)
+
+    def do_GET(self):
+        url = urlparse(self.path)
+        if url.path.startswith("/file/"):
+            if LATENCY > 0.0:
+                time.sleep(LATENCY)
+            content = "content of " + url.path[len("/file/"):] + "\n"
+            etag = '"%08x"' % zlib.crc32(content.encode("utf-8"))
+            not_modified = self.headers.get("If-None-Match") == etag
+            with stats_lock:
+                stat = stats.setdefault(url.path, [0, 0])
+                stat[0] += 1
+                if not_modified:
+                    stat[1] += 1
+            if not_modified:
+                self.send_response(304)
+                self.send_header("ETag", etag)
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+            else:
+                self.send_text(200, content, {"ETag": etag, "Last-Modified": LAST_MODIFIED})
+        elif url.path == "/stats":
+            path = parse_qs(url.query).get("path", [""])[0]
+            with stats_lock:
+                stat = stats.get(path, [0, 0])
+                self.send_text(200, "%d %d" % (stat[0], stat[1]))
+        elif url.path == "/shutdown":
+            self.send_text(200, "bye")
+            threading.Thread(target=self.server.shutdown).start()
+        else:
+            self.send_text(404, "not found")
+
+    def log_message(self, format, *args):
+        pass
+
+
+if __name__ == "__main__":
+    server = ThreadingHTTPServer(("127.0.0.1", PORT), Handler)
+    print("UrlFetcherCheck server on port %d" % PORT, flush=True)
+    server.serve_forever()
+    server.server_close()